@@ -1,4 +1,5 @@
 TEMPLATE = subdirs
 CONFIG  += ordered
 SUBDIRS += src
+SUBDIRS += headless
 SUBDIRS += test
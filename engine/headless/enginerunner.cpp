@@ -0,0 +1,332 @@
+/*
+  Q Light Controller Plus
+  enginerunner.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QXmlStreamReader>
+#include <QCoreApplication>
+#include <QDomDocument>
+#include <QDomElement>
+#include <QStringList>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QFileInfo>
+#include <QFile>
+#include <QDebug>
+
+#include "qlcfixturedefcache.h"
+#include "inputoutputmap.h"
+#include "ioplugincache.h"
+#include "workspacesnapshot.h"
+#include "rgbalgorithm.h"
+#include "enginerunner.h"
+#include "mastertimer.h"
+#include "function.h"
+#include "rgbimage.h"
+#include "fixture.h"
+#include "rgbtext.h"
+#include "qlcfile.h"
+#include "doc.h"
+
+/*****************************************************************************
+ * Initialization
+ *****************************************************************************/
+
+EngineRunner::EngineRunner(QObject* parent)
+    : QObject(parent)
+    , m_doc(NULL)
+    , m_server(NULL)
+{
+}
+
+EngineRunner::~EngineRunner()
+{
+    foreach (QTcpSocket* client, m_clients)
+        client->abort();
+    m_clients.clear();
+
+    if (m_doc != NULL)
+    {
+        m_doc->masterTimer()->stop();
+        delete m_doc;
+    }
+    m_doc = NULL;
+}
+
+void EngineRunner::initDoc()
+{
+    Q_ASSERT(m_doc == NULL);
+    m_doc = new Doc(this);
+
+    /* Load user fixtures first so that they override system fixtures */
+    m_doc->fixtureDefCache()->load(QLCFixtureDefCache::userDefinitionDirectory(), true);
+    m_doc->fixtureDefCache()->loadMap(QLCFixtureDefCache::systemDefinitionDirectory());
+
+    /* Load plugins */
+    m_doc->ioPluginCache()->load(IOPluginCache::systemPluginDirectory());
+
+    /* Load input plugins & profiles */
+    m_doc->inputOutputMap()->loadProfiles(InputOutputMap::userProfileDirectory());
+    m_doc->inputOutputMap()->loadProfiles(InputOutputMap::systemProfileDirectory());
+    m_doc->inputOutputMap()->loadDefaults();
+
+    m_doc->masterTimer()->start();
+}
+
+Doc* EngineRunner::doc() const
+{
+    return m_doc;
+}
+
+/*****************************************************************************
+ * Workspace
+ *****************************************************************************/
+
+bool EngineRunner::loadWorkspace(const QString& fileName)
+{
+    Q_ASSERT(m_doc != NULL);
+
+    m_doc->setWorkspacePath(QFileInfo(fileName).absolutePath());
+
+    /* The snapshot holds the whole engine, no need to read the XML */
+    if (WorkspaceSnapshot::load(m_doc, fileName) == true)
+    {
+        m_doc->setMode(Doc::Operate);
+        m_doc->resetModified();
+        return true;
+    }
+
+    QFile file(fileName);
+    if (file.open(QIODevice::ReadOnly) == false)
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to open file:" << fileName;
+        return false;
+    }
+
+    QXmlStreamReader reader(&file);
+    if (reader.readNextStartElement() == false ||
+        reader.name() != QLatin1String(KXMLQLCWorkspace))
+    {
+        qWarning() << Q_FUNC_INFO << "Workspace node not found in" << fileName;
+        return false;
+    }
+
+    while (reader.readNextStartElement() == true)
+    {
+        if (reader.name() == QLatin1String(KXMLQLCEngine))
+        {
+            m_doc->loadXML(reader);
+        }
+        else if (reader.name() == QLatin1String(KXMLFixture) ||
+                 reader.name() == QLatin1String(KXMLQLCFunction))
+        {
+            /* Legacy support code, nowadays in Doc */
+            QDomDocument element = QLCFile::readXMLElement(reader);
+            QDomElement tag = element.documentElement();
+            if (tag.tagName() == KXMLFixture)
+                Fixture::loader(tag, m_doc);
+            else
+                Function::loader(tag, m_doc);
+        }
+        else
+        {
+            /* Anything else belongs to the user interface */
+            reader.skipCurrentElement();
+        }
+    }
+
+    if (reader.hasError() == true)
+    {
+        qWarning() << Q_FUNC_INFO << "Error loading workspace:" << reader.errorString();
+        return false;
+    }
+
+    m_doc->setMode(Doc::Operate);
+    m_doc->resetModified();
+
+    return true;
+}
+
+bool EngineRunner::needsGuiApplication(const QString& fileName)
+{
+    QFile file(fileName);
+    if (file.open(QIODevice::ReadOnly) == false)
+        return false;
+
+    QXmlStreamReader reader(&file);
+    while (reader.atEnd() == false)
+    {
+        if (reader.readNext() != QXmlStreamReader::StartElement ||
+            reader.name() != QLatin1String(KXMLQLCRGBAlgorithm))
+            continue;
+
+        QStringRef type = reader.attributes().value(KXMLQLCRGBAlgorithmType);
+        if (type == QLatin1String(KXMLQLCRGBText) || type == QLatin1String(KXMLQLCRGBImage))
+            return true;
+    }
+
+    return false;
+}
+
+bool EngineRunner::startFunction(quint32 id)
+{
+    Q_ASSERT(m_doc != NULL);
+
+    if (id == Function::invalidId())
+        return m_doc->checkStartupFunction();
+
+    Function* function = m_doc->function(id);
+    if (function == NULL)
+    {
+        qWarning() << Q_FUNC_INFO << "No such function:" << id;
+        return false;
+    }
+
+    if (function->stopped() == true)
+        function->start(m_doc->masterTimer());
+
+    return true;
+}
+
+/*****************************************************************************
+ * Control socket
+ *****************************************************************************/
+
+bool EngineRunner::listen(const QHostAddress& address, quint16 port)
+{
+    if (m_server == NULL)
+    {
+        m_server = new QTcpServer(this);
+        connect(m_server, SIGNAL(newConnection()),
+                this, SLOT(slotNewConnection()));
+    }
+
+    if (m_server->listen(address, port) == false)
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to listen on"
+                   << address.toString() << port << ":" << m_server->errorString();
+        return false;
+    }
+
+    return true;
+}
+
+QString EngineRunner::executeCommand(const QString& command)
+{
+    Q_ASSERT(m_doc != NULL);
+
+    QStringList tokens = command.simplified().split(" ", QString::SkipEmptyParts);
+    if (tokens.isEmpty() == true)
+        return QString();
+
+    QString cmd = tokens.first().toLower();
+
+    if (cmd == "list")
+    {
+        QList <Function*> functions = m_doc->functions();
+        QStringList lines;
+        lines << QString("OK %1").arg(functions.size());
+        foreach (Function* function, functions)
+        {
+            /* Names can't break the one line per function format */
+            lines << QString("%1 %2 %3 %4").arg(function->id())
+                                           .arg(Function::typeToString(function->type()))
+                                           .arg(function->stopped() ? "stopped" : "running")
+                                           .arg(function->name().simplified());
+        }
+        return lines.join("\n");
+    }
+    else if (cmd == "stopall")
+    {
+        m_doc->masterTimer()->stopAllFunctions();
+        return QString("OK");
+    }
+    else if (cmd == "quit")
+    {
+        QCoreApplication::quit();
+        return QString("OK");
+    }
+    else if (cmd == "start" || cmd == "stop" || cmd == "status")
+    {
+        if (tokens.size() != 2)
+            return QString("ERROR Syntax: %1 <id>").arg(cmd);
+
+        bool ok = false;
+        quint32 id = tokens[1].toUInt(&ok);
+        Function* function = (ok == true) ? m_doc->function(id) : NULL;
+        if (function == NULL)
+            return QString("ERROR No such function: %1").arg(tokens[1]);
+
+        if (cmd == "start")
+        {
+            if (function->stopped() == true)
+                function->start(m_doc->masterTimer());
+        }
+        else if (cmd == "stop")
+        {
+            if (function->stopped() == false)
+                function->stop();
+        }
+        else
+        {
+            return QString(function->stopped() ? "stopped" : "running");
+        }
+
+        return QString("OK");
+    }
+
+    return QString("ERROR Unknown command: %1").arg(tokens.first());
+}
+
+void EngineRunner::slotNewConnection()
+{
+    while (m_server->hasPendingConnections() == true)
+    {
+        QTcpSocket* client = m_server->nextPendingConnection();
+        connect(client, SIGNAL(readyRead()), this, SLOT(slotReadyRead()));
+        connect(client, SIGNAL(disconnected()), this, SLOT(slotDisconnected()));
+        m_clients.append(client);
+    }
+}
+
+void EngineRunner::slotReadyRead()
+{
+    QTcpSocket* client = qobject_cast<QTcpSocket*> (sender());
+    if (client == NULL)
+        return;
+
+    while (client->canReadLine() == true)
+    {
+        QString line = QString::fromUtf8(client->readLine()).trimmed();
+        if (line.isEmpty() == true)
+            continue;
+
+        QString reply = executeCommand(line);
+        client->write(reply.toUtf8());
+        client->write("\n\n");
+    }
+}
+
+void EngineRunner::slotDisconnected()
+{
+    QTcpSocket* client = qobject_cast<QTcpSocket*> (sender());
+    if (client == NULL)
+        return;
+
+    m_clients.removeAll(client);
+    client->deleteLater();
+}
@@ -0,0 +1,132 @@
+/*
+  Q Light Controller Plus
+  enginerunner.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef ENGINERUNNER_H
+#define ENGINERUNNER_H
+
+#include <QHostAddress>
+#include <QObject>
+#include <QString>
+#include <QList>
+
+class QTcpServer;
+class QTcpSocket;
+class Doc;
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+#define ENGINE_RUNNER_DEFAULT_PORT 9997
+
+/**
+ * EngineRunner runs a workspace without any user interface: it creates
+ * the Doc, loads fixture definitions, I/O plugins and input profiles,
+ * loads the engine part of a workspace file and starts the MasterTimer.
+ *
+ * Functions can be controlled thru a TCP control socket accepting one
+ * command per line:
+ *
+ * list               - print "OK <count>" and then list all functions
+ *                      as "<id> <type> <running> <name>"
+ * start <id>         - start a function
+ * stop <id>          - stop a function
+ * status <id>        - print "running" or "stopped"
+ * stopall            - stop all running functions
+ * quit               - stop the engine and exit
+ *
+ * Each command is answered with "OK", "ERROR <reason>" or its output
+ * followed by an empty line. Output lines are never empty, so that even
+ * an empty function list can't be mistaken for the terminator.
+ */
+class EngineRunner : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(EngineRunner)
+
+    /*********************************************************************
+     * Initialization
+     *********************************************************************/
+public:
+    EngineRunner(QObject* parent = 0);
+    ~EngineRunner();
+
+    /** Create the Doc, load plugins & definitions and start MasterTimer */
+    void initDoc();
+
+    /** Get the engine Doc */
+    Doc* doc() const;
+
+private:
+    Doc* m_doc;
+
+    /*********************************************************************
+     * Workspace
+     *********************************************************************/
+public:
+    /**
+     * Load the engine contents of a workspace file, or of its binary
+     * snapshot when it is up to date. User interface contents (Virtual
+     * Console, Simple Desk) are ignored.
+     *
+     * @return true if successful, otherwise false
+     */
+    bool loadWorkspace(const QString& fileName);
+
+    /**
+     * Check if the workspace file uses RGB Matrix algorithms that draw
+     * text or images, which need fonts and image plugins and therefore a
+     * GUI application. The file is only scanned, not loaded.
+     */
+    static bool needsGuiApplication(const QString& fileName);
+
+    /**
+     * Start the function with the given ID. If $id is invalid, the
+     * workspace startup function is started instead, if any.
+     *
+     * @return true if a function was started, otherwise false
+     */
+    bool startFunction(quint32 id);
+
+    /*********************************************************************
+     * Control socket
+     *********************************************************************/
+public:
+    /** Start listening for control connections on $address:$port */
+    bool listen(const QHostAddress& address, quint16 port);
+
+    /**
+     * Execute a single control command and return its reply, without
+     * the terminating empty line.
+     */
+    QString executeCommand(const QString& command);
+
+private slots:
+    void slotNewConnection();
+    void slotReadyRead();
+    void slotDisconnected();
+
+private:
+    QTcpServer* m_server;
+    QList <QTcpSocket*> m_clients;
+};
+
+/** @} */
+
+#endif
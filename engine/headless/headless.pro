@@ -0,0 +1,31 @@
+include(../../variables.pri)
+
+TEMPLATE = app
+LANGUAGE = C++
+TARGET   = qlcplus-engine
+
+# Workspaces drawing text or images with RGB Matrix need a GUI
+# application, which runs on the offscreen platform so that no display
+# server is needed
+QT      += core xml script network
+QT      += gui
+
+INCLUDEPATH += ../src
+INCLUDEPATH += ../../plugins/interfaces
+DEPENDPATH  += ../src
+
+QMAKE_LIBDIR += ../src
+LIBS         += -lqlcplusengine
+
+HEADERS += enginerunner.h
+SOURCES += enginerunner.cpp main.cpp
+
+macx {
+    # This must be after "TARGET = " and before target installation so that
+    # install_name_tool can be run before target installation
+    include(../../macx/nametool.pri)
+}
+
+# Installation
+target.path = $$INSTALLROOT/$$BINDIR
+INSTALLS   += target
@@ -0,0 +1,230 @@
+/*
+  Q Light Controller Plus
+  main.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QCoreApplication>
+#include <QScopedPointer>
+#include <QHostAddress>
+#include <QStringList>
+#include <QTextStream>
+#include <QMetaType>
+#include <QtGlobal>
+#include <QVariant>
+#include <QString>
+#include <QDebug>
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+  #include <QApplication>
+#else
+  #include <QGuiApplication>
+#endif
+
+#include "qlcconfig.h"
+#include "enginerunner.h"
+#include "function.h"
+
+/* Use this namespace for command-line arguments so that we don't pollute
+   the global namespace. */
+namespace QLCArgs
+{
+    /** The workspace file to load */
+    QString workspace;
+
+    /** The function to start after loading. Invalid means the startup function. */
+    quint32 startFunction = Function::invalidId();
+
+    /** The address where the control socket listens */
+    QHostAddress listenAddress = QHostAddress(QHostAddress::LocalHost);
+
+    /** The port of the control socket. Zero disables it. */
+    quint16 listenPort = ENGINE_RUNNER_DEFAULT_PORT;
+
+    /** Debug output level */
+    QtMsgType debugLevel = QtSystemMsg;
+}
+
+/**
+ * Suppresses debug messages
+ */
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+void qlcMessageHandler(QtMsgType type, const char* msg)
+{
+    if (type >= QLCArgs::debugLevel)
+    {
+        fprintf(stderr, "%s\n", msg);
+        fflush(stderr);
+    }
+}
+#else
+void qlcMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg)
+{
+    Q_UNUSED(context)
+
+    if (type >= QLCArgs::debugLevel)
+    {
+        fprintf(stderr, "%s\n", msg.toLocal8Bit().constData());
+        fflush(stderr);
+    }
+}
+#endif
+
+/**
+ * Prints possible command-line options
+ */
+void printUsage()
+{
+    QTextStream cout(stdout, QIODevice::WriteOnly);
+
+    cout << "Usage:" << endl;
+    cout << "  qlcplus-engine [options] <workspace>" << endl;
+    cout << "Options:" << endl;
+    cout << "  -d or --debug <level>\t\tSet debug output level (0-3, see QtMsgType)" << endl;
+    cout << "  -f or --function <id>\t\tStart the given function instead of the startup function" << endl;
+    cout << "  -h or --help\t\t\tPrint this help" << endl;
+    cout << "  -l or --listen <address>\tAddress of the control socket (default: localhost)" << endl;
+    cout << "  -p or --port <port>\t\tPort of the control socket, 0 to disable (default: "
+         << ENGINE_RUNNER_DEFAULT_PORT << ")" << endl;
+    cout << "  -v or --version\t\tPrint version information" << endl;
+    cout << endl;
+}
+
+/**
+ * Parse command line arguments, without the program name
+ *
+ * @return true to continue with application launch; otherwise false
+ */
+bool parseArgs(const QStringList& args)
+{
+    QStringListIterator it(args);
+    while (it.hasNext() == true)
+    {
+        QString arg(it.next());
+
+        if ((arg == "-d" || arg == "--debug") && it.hasNext() == true)
+        {
+            QLCArgs::debugLevel = QtMsgType(it.next().toInt());
+        }
+        else if ((arg == "-f" || arg == "--function") && it.hasNext() == true)
+        {
+            bool ok = false;
+            QLCArgs::startFunction = it.next().toUInt(&ok);
+            if (ok == false)
+            {
+                printUsage();
+                return false;
+            }
+        }
+        else if ((arg == "-l" || arg == "--listen") && it.hasNext() == true)
+        {
+            QHostAddress address;
+            if (address.setAddress(it.next()) == false)
+            {
+                printUsage();
+                return false;
+            }
+            QLCArgs::listenAddress = address;
+        }
+        else if ((arg == "-p" || arg == "--port") && it.hasNext() == true)
+        {
+            QLCArgs::listenPort = it.next().toUShort();
+        }
+        else if (arg == "-v" || arg == "--version")
+        {
+            QTextStream cout(stdout, QIODevice::WriteOnly);
+            cout << APPNAME << " engine " << "version " << APPVERSION << endl;
+            return false;
+        }
+        else if (arg == "-h" || arg == "--help")
+        {
+            printUsage();
+            return false;
+        }
+        else if (arg.startsWith("-") == false)
+        {
+            QLCArgs::workspace = arg;
+        }
+    }
+
+    if (QLCArgs::workspace.isEmpty() == true)
+    {
+        printUsage();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Entry point of the engine without user interface
+ *
+ * @param argc Number of arguments in array argv
+ * @param argv Arguments array
+ */
+int main(int argc, char** argv)
+{
+    /* The workspace decides which application is needed, so arguments
+       are parsed before creating it */
+    QStringList args;
+    for (int i = 1; i < argc; i++)
+        args << QString::fromLocal8Bit(argv[i]);
+
+    if (parseArgs(args) == false)
+        return 0;
+
+    /* Fonts and images (RGB Matrix text and image algorithms) need a GUI
+       application, but no widgets and no display server are required.
+       Any other workspace runs on a core application. */
+    QScopedPointer <QCoreApplication> qapp;
+    if (EngineRunner::needsGuiApplication(QLCArgs::workspace) == true)
+    {
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+        qapp.reset(new QApplication(argc, argv, false));
+#else
+        if (qgetenv("QT_QPA_PLATFORM").isEmpty() == true)
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+        qapp.reset(new QGuiApplication(argc, argv));
+#endif
+    }
+    else
+    {
+        qapp.reset(new QCoreApplication(argc, argv));
+    }
+
+    /* At least MIDI plugin requires this so best to declare it here for everyone */
+    qRegisterMetaType<QVariant>("QVariant");
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+    qInstallMsgHandler(qlcMessageHandler);
+#else
+    qInstallMessageHandler(qlcMessageHandler);
+#endif
+
+    EngineRunner runner;
+    runner.initDoc();
+
+    if (runner.loadWorkspace(QLCArgs::workspace) == false)
+        return 1;
+
+    if (QLCArgs::listenPort != 0 &&
+        runner.listen(QLCArgs::listenAddress, QLCArgs::listenPort) == false)
+        return 1;
+
+    runner.startFunction(QLCArgs::startFunction);
+
+    return qapp->exec();
+}
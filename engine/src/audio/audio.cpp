@@ -140,6 +140,26 @@ QStringList Audio::getCapabilities()
     return cap;
 }
 
+AudioDecoder* Audio::createDecoder(const QString& filename)
+{
+    AudioDecoder *decoder = NULL;
+#ifdef HAS_LIBSNDFILE
+    decoder = new AudioDecoderSndFile(filename);
+    if (decoder->initialize() == true)
+        return decoder;
+    delete decoder;
+#endif
+#ifdef HAS_LIBMAD
+    decoder = new AudioDecoderMAD(filename);
+    if (decoder->initialize() == true)
+        return decoder;
+    delete decoder;
+#endif
+    Q_UNUSED(decoder)
+    Q_UNUSED(filename)
+    return NULL;
+}
+
 /*********************************************************************
  * Properties
  *********************************************************************/
@@ -202,33 +222,12 @@ bool Audio::setSourceFileName(QString filename)
     connect(m_object, SIGNAL(totalTimeChanged(qint64)), this, SLOT(slotTotalTimeChanged(qint64)));
 #endif
 
-#ifdef HAS_LIBSNDFILE
-    m_decoder = new AudioDecoderSndFile(m_sourceFileName);
-    if (m_decoder->initialize() == false)
-    {
-        delete m_decoder;
-        m_decoder = NULL;
-    }
-    else
-    {
-        m_audioDuration = m_decoder->totalTime();
-        return true;
-    }
-#endif
-#ifdef HAS_LIBMAD
-    m_decoder = new AudioDecoderMAD(m_sourceFileName);
-    if (m_decoder->initialize() == false)
-    {
-        delete m_decoder;
-        m_decoder = NULL;
-    }
-    else
-    {
-        m_audioDuration = m_decoder->totalTime();
-        return true;
-    }
-#endif
-    return false;
+    m_decoder = createDecoder(m_sourceFileName);
+    if (m_decoder == NULL)
+        return false;
+
+    m_audioDuration = m_decoder->totalTime();
+    return true;
 }
 
 QString Audio::getSourceFileName()
@@ -248,6 +247,15 @@ void Audio::adjustAttribute(qreal fraction, int attributeIndex)
     Function::adjustAttribute(fraction, attributeIndex);
 }
 
+qint64 Audio::playbackPosition()
+{
+    QMutexLocker locker(&m_audioOutMutex);
+    if (m_audio_out == NULL || m_audio_out->isRunning() == false)
+        return -1;
+
+    return m_audio_out->playbackPosition();
+}
+
 void Audio::slotEndOfStream()
 {
 #ifdef QT_PHONON_LIB
@@ -257,8 +265,10 @@ void Audio::slotEndOfStream()
     if (m_audio_out != NULL)
     {
         m_audio_out->stop();
+        m_audioOutMutex.lock();
         delete m_audio_out;
         m_audio_out = NULL;
+        m_audioOutMutex.unlock();
         m_decoder->seek(0);
     }
     Function::postRun(NULL, QList<Universe *>());
@@ -369,6 +379,7 @@ void Audio::preRun(MasterTimer* timer)
     {
         m_decoder->seek(elapsed());
         AudioParameters ap = m_decoder->audioParameters();
+        m_audioOutMutex.lock();
 #if defined(__APPLE__) || defined(Q_OS_MAC)
         //m_audio_out = new AudioRendererCoreAudio();
         m_audio_out = new AudioRendererPortAudio();
@@ -377,7 +388,9 @@ void Audio::preRun(MasterTimer* timer)
 #else
         m_audio_out = new AudioRendererAlsa();
 #endif
+        m_audioOutMutex.unlock();
         m_audio_out->setDecoder(m_decoder);
+        m_audio_out->setStartPosition(elapsed());
         m_audio_out->initialize(ap.sampleRate(), ap.channels(), ap.format());
         m_audio_out->setFadeIn(fadeInSpeed());
         m_audio_out->start();
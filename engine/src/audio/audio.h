@@ -68,6 +68,15 @@ public slots:
 public:
     static QStringList getCapabilities();
 
+    /**
+     * Create and initialize a new decoder for the given audio file,
+     * using the first available backend able to handle it.
+     * The caller owns the returned decoder.
+     *
+     * @return A decoder instance or NULL if the file is not supported
+     */
+    static AudioDecoder* createDecoder(const QString& filename);
+
     /*********************************************************************
      * Properties
      *********************************************************************/
@@ -120,6 +129,14 @@ public:
 
     void adjustAttribute(qreal fraction, int attributeIndex);
 
+    /**
+     * Returns the position in milliseconds, relative to the beginning
+     * of the source file, of the audio currently being played out,
+     * or -1 if this Audio function is not rendering.
+     * This is the clock used to keep a Show timeline in sync with audio.
+     */
+    qint64 playbackPosition();
+
 protected slots:
     void slotEndOfStream();
 
@@ -131,6 +148,8 @@ private:
     AudioDecoder *m_decoder;
     /** output interface to render audio data got from m_decoder */
     AudioRenderer *m_audio_out;
+    /** Guards m_audio_out creation/deletion against playbackPosition() */
+    QMutex m_audioOutMutex;
     /** Absolute start time of Audio over a timeline (in milliseconds) */
     quint32 m_startTime;
     /** Color to use when displaying the audio object in the Show manager */
@@ -20,7 +20,9 @@
 
 #include <QDebug>
 #include <qmath.h>
+#include <string.h>
 
+#include "timecodeclock.h"
 #include "audiocapture.h"
 
 #include "fftw3.h"
@@ -39,20 +41,67 @@ AudioCapture::AudioCapture (QObject* parent)
     , m_sampleRate(0)
     , m_channels(0)
     , m_audioBuffer(NULL)
+    , m_hopSize(0)
+    , m_windowBuffer(NULL)
+    , m_signalPower(0)
+    , m_maxMagnitude(0)
     , m_fftInputBuffer(NULL)
     , m_fftOutputBuffer(NULL)
+    , m_fftPlan(NULL)
+    , m_fftWindow(NULL)
+    , m_envelopeRelease(ENVELOPE_DEFAULT_RELEASE)
+    , m_envelopeDecay(0)
+    , m_maxEnvelope(0)
+    , m_onsetThreshold(1.5)
+    , m_fluxHistoryIndex(0)
+    , m_fluxHistorySum(0)
+    , m_samplesSinceOnset(0)
+    , m_onsetCount(0)
+    , m_samplesSinceDisplay(0)
+    , m_volumeLevel(0)
+    , m_users(0)
+    , m_timecodeClock(NULL)
+    , m_timecodeUsers(0)
 {
     m_subBandsNumber = FREQ_SUBBANDS_DEFAULT_NUMBER;
+
+    for (int i = 0; i < FREQ_SUBBANDS_MAX_NUMBER; i++)
+    {
+        m_fftMagnitudeBuffer[i] = 0;
+        m_bandEnvelope[i] = 0;
+        m_previousMagnitude[i] = 0;
+        m_bandLevels[i] = 0;
+    }
+    for (int i = 0; i < ONSET_HISTORY_SIZE; i++)
+        m_fluxHistory[i] = 0;
 }
 
 AudioCapture::~AudioCapture()
 {
+    releaseBuffers();
+}
+
+void AudioCapture::releaseBuffers()
+{
+    if (m_fftPlan)
+        fftw_destroy_plan((fftw_plan)m_fftPlan);
+    m_fftPlan = NULL;
+
     if (m_audioBuffer)
         delete[] m_audioBuffer;
+    m_audioBuffer = NULL;
+    if (m_windowBuffer)
+        delete[] m_windowBuffer;
+    m_windowBuffer = NULL;
     if (m_fftInputBuffer)
         delete[] m_fftInputBuffer;
+    m_fftInputBuffer = NULL;
+    if (m_fftWindow)
+        delete[] m_fftWindow;
+    m_fftWindow = NULL;
     if (m_fftOutputBuffer)
         fftw_free(m_fftOutputBuffer);
+    m_fftOutputBuffer = NULL;
 }
 
 void AudioCapture::setBandsNumber(int number)
@@ -71,18 +120,108 @@ bool AudioCapture::isInitialized()
     return m_isInitialized;
 }
 
+void AudioCapture::setHopSize(int samples)
+{
+    if (samples <= 0 || isRunning())
+        return;
+
+    // once initialized, the hop can't exceed the analysis window
+    if (m_captureSize != 0)
+    {
+        samples = qMin(samples, (int)m_captureSize);
+        samples -= samples % m_channels;
+        if (samples == 0)
+            return;
+    }
+    m_hopSize = samples;
+}
+
+int AudioCapture::hopSize()
+{
+    return m_hopSize;
+}
+
+void AudioCapture::setEnvelopeRelease(int msec)
+{
+    if (msec < 0)
+        return;
+
+    m_envelopeRelease = msec;
+    if (m_sampleRate == 0 || m_hopSize == 0 || msec == 0)
+    {
+        m_envelopeDecay = 0;
+        return;
+    }
+
+    // exponential decay reaching -60dB (1/1000) after msec milliseconds
+    double hopTime = (double(m_hopSize) / m_channels) / m_sampleRate;
+    m_envelopeDecay = qExp((qLn(0.001) * hopTime * 1000.0) / msec);
+}
+
+int AudioCapture::envelopeRelease()
+{
+    return m_envelopeRelease;
+}
+
+void AudioCapture::setOnsetThreshold(double ratio)
+{
+    if (ratio > 1.0)
+        m_onsetThreshold = ratio;
+}
+
+double AudioCapture::onsetThreshold()
+{
+    return m_onsetThreshold;
+}
+
 bool AudioCapture::initialize(unsigned int sampleRate, quint8 channels, quint16 bufferSize)
 {
-    Q_UNUSED(sampleRate)
+    releaseBuffers();
 
     m_captureSize = bufferSize * channels;
     m_sampleRate = sampleRate;
     m_channels = channels;
 
+    if (m_hopSize == 0 || m_hopSize > m_captureSize)
+        m_hopSize = m_captureSize / FFT_HOP_DEFAULT_DIVIDER;
+    // keep the hop aligned to whole frames
+    m_hopSize -= m_hopSize % channels;
+    if (m_hopSize == 0)
+        m_hopSize = m_captureSize;
+
     m_audioBuffer = new int16_t[m_captureSize];
+    m_windowBuffer = new int16_t[m_captureSize];
+    memset(m_windowBuffer, 0, m_captureSize * sizeof(int16_t));
     m_fftInputBuffer = new double[m_captureSize];
     m_fftOutputBuffer = fftw_malloc(sizeof(fftw_complex) * m_captureSize);
 
+    // 1 ********* Initialize FFTW once. FFTW_ESTIMATE doesn't touch the buffers
+    m_fftPlan = fftw_plan_dft_r2c_1d(m_captureSize, m_fftInputBuffer,
+                                     (fftw_complex*)m_fftOutputBuffer, FFTW_ESTIMATE);
+
+    // 2 ********* Precompute the window coefficients
+    m_fftWindow = new double[m_captureSize];
+    for (unsigned int i = 0; i < m_captureSize; i++)
+    {
+#ifdef USE_BLACKMAN
+        double a0 = (1-0.16)/2;
+        double a1 = 0.5;
+        double a2 = 0.16/2;
+        m_fftWindow[i] = a0 - a1 * qCos((M_2PI * i) / (m_captureSize - 1)) +
+                         a2 * qCos((2 * M_2PI * i) / (m_captureSize - 1));
+#endif
+#ifdef USE_HANNING
+        m_fftWindow[i] = 0.5 * (1.00 - qCos((M_2PI * i) / (m_captureSize - 1)));
+#endif
+#ifdef USE_NO_WINDOW
+        m_fftWindow[i] = 1.0;
+#endif
+    }
+
+    setEnvelopeRelease(m_envelopeRelease);
+
+    m_ltcDecoder.setSampleRate(sampleRate);
+
     m_isInitialized = true;
 
     return true;
@@ -95,43 +234,129 @@ void AudioCapture::stop()
         usleep(10000);
 }
 
+/*********************************************************************
+ * Analysis results
+ *********************************************************************/
+
+uchar AudioCapture::volumeLevel()
+{
+    QMutexLocker locker(&m_levelsMutex);
+    return m_volumeLevel;
+}
+
+uchar AudioCapture::bandLevel(int index)
+{
+    QMutexLocker locker(&m_levelsMutex);
+    if (index < 0 || index >= m_subBandsNumber)
+        return 0;
+    return m_bandLevels[index];
+}
+
+double AudioCapture::bandEnvelope(int index)
+{
+    QMutexLocker locker(&m_levelsMutex);
+    if (index < 0 || index >= m_subBandsNumber)
+        return 0;
+    return m_bandEnvelope[index];
+}
+
+quint32 AudioCapture::onsetCount()
+{
+    QMutexLocker locker(&m_levelsMutex);
+    return m_onsetCount;
+}
+
+/*********************************************************************
+ * Sharing
+ *********************************************************************/
+
+bool AudioCapture::acquire(TimecodeClock* clock)
+{
+    if (isRunning() == false)
+    {
+        if (isInitialized() == false && initialize(44100, 1, 2048) == false)
+            return false;
+        start();
+    }
+
+    m_users++;
+
+    if (clock != NULL)
+    {
+        QMutexLocker locker(&m_timecodeMutex);
+        m_timecodeClock = clock;
+        m_timecodeUsers++;
+    }
+
+    return true;
+}
+
+void AudioCapture::release(TimecodeClock* clock)
+{
+    if (clock != NULL)
+    {
+        QMutexLocker locker(&m_timecodeMutex);
+        if (m_timecodeUsers > 0 && --m_timecodeUsers == 0)
+            m_timecodeClock = NULL;
+    }
+
+    if (m_users > 0 && --m_users == 0 && isRunning() == true)
+        stop();
+}
+
+/*********************************************************************
+ * Linear timecode
+ *********************************************************************/
+
+void AudioCapture::processTimecode()
+{
+    QMutexLocker locker(&m_timecodeMutex);
+
+    if (m_timecodeClock == NULL)
+        return;
+
+    if (m_ltcDecoder.decode(m_audioBuffer, m_hopSize / m_channels, m_channels) == false)
+        return;
+
+    // The frame ended this long before the last sample, which has been
+    // captured latency() milliseconds ago
+    qint64 delay = (qint64(m_ltcDecoder.samplesSinceFrame()) * 1000000000) / m_sampleRate;
+    delay += latency() * 1000000;
+
+    m_timecodeClock->receive(0, m_ltcDecoder.msecs(), m_timecodeClock->now() - delay);
+}
+
+/*********************************************************************
+ * Thread functions
+ *********************************************************************/
+
 void AudioCapture::processData()
 {
     unsigned int i;
     quint64 pwrSum = 0;
 
-    // 1 ********* Initialize FFTW
-    fftw_plan plan_forward;
-    plan_forward = fftw_plan_dft_r2c_1d(m_captureSize, m_fftInputBuffer, (fftw_complex*)m_fftOutputBuffer , 0);
+    // 1 ********* Slide the analysis window by m_hopSize new samples
+    if (m_hopSize < m_captureSize)
+        memmove(m_windowBuffer, m_windowBuffer + m_hopSize,
+                (m_captureSize - m_hopSize) * sizeof(int16_t));
+    memcpy(m_windowBuffer + (m_captureSize - m_hopSize), m_audioBuffer,
+           m_hopSize * sizeof(int16_t));
 
     // 2 ********* Apply a window to audio data
     // *********** and convert it to doubles
 
     for (i = 0; i < m_captureSize; i++)
     {
-        if(m_audioBuffer[i] < 0)
-            pwrSum += -1 * m_audioBuffer[i];
+        if(m_windowBuffer[i] < 0)
+            pwrSum += -1 * m_windowBuffer[i];
         else
-            pwrSum += m_audioBuffer[i];
+            pwrSum += m_windowBuffer[i];
 
-#ifdef USE_BLACKMAN
-        double a0 = (1-0.16)/2;
-        double a1 = 0.5;
-        double a2 = 0.16/2;
-        m_fftInputBuffer[i] = m_audioBuffer[i]  * (a0 - a1 * qCos((M_2PI * i) / (m_captureSize - 1)) +
-                              a2 * qCos((2 * M_2PI * i) / (m_captureSize - 1)));
-#endif
-#ifdef USE_HANNING
-        m_fftInputBuffer[i] = m_audioBuffer[i] * (0.5 * (1.00 - qCos((M_2PI * i) / (m_captureSize - 1))));
-#endif
-#ifdef USE_NO_WINDOW
-        m_fftInputBuffer[i] = (double)m_audioBuffer[i];
-#endif
+        m_fftInputBuffer[i] = m_windowBuffer[i] * m_fftWindow[i];
     }
 
     // 3 ********* Perform FFT
-    fftw_execute(plan_forward);
-    fftw_destroy_plan(plan_forward);
+    fftw_execute((fftw_plan)m_fftPlan);
 
     // 4 ********* Clear FFT noise
 #ifdef CLEAR_FFT_NOISE
@@ -151,26 +376,89 @@ void AudioCapture::processData()
 
     // m_fftOutputBuffer contains the real and imaginary data of a spectrum
     // representing all the frequencies from 0 to m_sampleRate Hz.
-    // I will just consider 0 to 5000Hz and will calculate average magnitude
-    // for the number of desired bands.
+    // I will just consider 0 to 5000Hz and will calculate the RMS magnitude
+    // for the number of desired bands, so that only one square root
+    // per band is needed.
     i = 0;
     int subBandWidth = ((m_captureSize * SPECTRUM_MAX_FREQUENCY) / m_sampleRate) / m_subBandsNumber;
     m_maxMagnitude = 0;
+    fftw_complex *out = (fftw_complex*)m_fftOutputBuffer;
 
     for (int b = 0; b < m_subBandsNumber; b++)
     {
-        quint64 magnitudeSum = 0;
+        double powerSum = 0;
         for (int s = 0; s < subBandWidth; s++, i++)
         {
             if (i == m_captureSize)
                 break;
-            magnitudeSum += qSqrt((((fftw_complex*)m_fftOutputBuffer)[i][0] * ((fftw_complex*)m_fftOutputBuffer)[i][0]) +
-                                  (((fftw_complex*)m_fftOutputBuffer)[i][1] * ((fftw_complex*)m_fftOutputBuffer)[i][1]));
+            powerSum += (out[i][0] * out[i][0]) + (out[i][1] * out[i][1]);
         }
-        m_fftMagnitudeBuffer[b] = (magnitudeSum / subBandWidth);
+        m_fftMagnitudeBuffer[b] = subBandWidth ? qSqrt(powerSum / subBandWidth) : 0;
         if (m_maxMagnitude < m_fftMagnitudeBuffer[b])
             m_maxMagnitude = m_fftMagnitudeBuffer[b];
     }
+
+    // 7 ********* Update envelopes and detect onsets
+    processEnvelopes();
+}
+
+void AudioCapture::processEnvelopes()
+{
+    double flux = 0;
+    double maxEnvelope = 0;
+
+    for (int b = 0; b < m_subBandsNumber; b++)
+    {
+        double mag = m_fftMagnitudeBuffer[b];
+
+        // spectral flux: sum of the positive magnitude variations
+        double diff = mag - m_previousMagnitude[b];
+        if (diff > 0)
+            flux += diff;
+        m_previousMagnitude[b] = mag;
+
+        // instant attack, exponential release
+        double env = m_bandEnvelope[b] * m_envelopeDecay;
+        m_bandEnvelope[b] = qMax(mag, env);
+        if (m_bandEnvelope[b] > maxEnvelope)
+            maxEnvelope = m_bandEnvelope[b];
+    }
+
+    // adaptive threshold over the recent flux history
+    double fluxAverage = m_fluxHistorySum / ONSET_HISTORY_SIZE;
+    m_fluxHistorySum += flux - m_fluxHistory[m_fluxHistoryIndex];
+    m_fluxHistory[m_fluxHistoryIndex] = flux;
+    m_fluxHistoryIndex = (m_fluxHistoryIndex + 1) % ONSET_HISTORY_SIZE;
+
+    quint32 minInterval = (m_sampleRate * m_channels * ONSET_MIN_INTERVAL) / 1000;
+    bool onset = false;
+    if (m_samplesSinceOnset < minInterval)
+        m_samplesSinceOnset += m_hopSize;
+    else if (fluxAverage > 0 && flux > fluxAverage * m_onsetThreshold)
+    {
+        onset = true;
+        m_samplesSinceOnset = 0;
+    }
+
+    // publish the levels with the same scaling used by the spectrum display
+    uchar volume = (uchar)qMin(quint32(255), (m_signalPower * 255) / 0x7FFF);
+
+    m_levelsMutex.lock();
+    m_volumeLevel = volume;
+    for (int b = 0; b < m_subBandsNumber; b++)
+    {
+        if (maxEnvelope == 0)
+            m_bandLevels[b] = 0;
+        else
+            m_bandLevels[b] = (uchar)((volume * m_bandEnvelope[b]) / maxEnvelope);
+    }
+    m_maxEnvelope = maxEnvelope;
+    if (onset == true)
+        m_onsetCount++;
+    m_levelsMutex.unlock();
+
+    if (onset == true)
+        emit onsetDetected(flux / fluxAverage);
 }
 
 void AudioCapture::run()
@@ -182,10 +470,18 @@ void AudioCapture::run()
         m_mutex.lock();
         if (m_pause == false && m_captureSize != 0)
         {
-            if (readAudio(m_captureSize) == true)
+            if (readAudio(m_hopSize) == true)
             {
+                processTimecode();
                 processData();
-                emit dataProcessed(m_fftMagnitudeBuffer, m_maxMagnitude, m_signalPower);
+
+                // Displays don't need more than one update per window
+                m_samplesSinceDisplay += m_hopSize;
+                if (m_samplesSinceDisplay >= m_captureSize)
+                {
+                    m_samplesSinceDisplay = 0;
+                    emit dataProcessed(m_bandEnvelope, m_maxEnvelope, m_signalPower);
+                }
             }
             else
                 qDebug() << "Error reading data from audio source";
@@ -24,12 +24,25 @@
 #include <QThread>
 #include <QMutex>
 
+#include "ltcdecoder.h"
+
+class TimecodeClock;
+
 #define SETTINGS_AUDIO_INPUT_DEVICE  "audio/input"
 
 #define FREQ_SUBBANDS_MAX_NUMBER        32
 #define FREQ_SUBBANDS_DEFAULT_NUMBER    16
 #define SPECTRUM_MAX_FREQUENCY          5000
 
+/** Default analysis hop, expressed as a divider of the FFT window size */
+#define FFT_HOP_DEFAULT_DIVIDER         4
+/** Default release time of the band envelopes in milliseconds */
+#define ENVELOPE_DEFAULT_RELEASE        200
+/** Number of spectral flux values used to compute the onset threshold */
+#define ONSET_HISTORY_SIZE              43
+/** Minimum time between two detected onsets in milliseconds */
+#define ONSET_MIN_INTERVAL              100
+
 class AudioCapture : public QThread
 {
     Q_OBJECT
@@ -47,8 +60,65 @@ public:
 
     bool isInitialized();
 
+    /**
+     * Set the number of samples the analysis window is advanced by
+     * between two consecutive FFTs. A hop smaller than the buffer size
+     * makes the windows overlap and lowers the detection latency.
+     * The hop can't be changed while the capture is running.
+     */
+    void setHopSize(int samples);
+    int hopSize();
+
+    /** Set the release time in milliseconds of the band envelopes */
+    void setEnvelopeRelease(int msec);
+    int envelopeRelease();
+
+    /**
+     * Set the onset detection sensitivity, as the ratio between the
+     * current spectral flux and its recent average that triggers an onset
+     */
+    void setOnsetThreshold(double ratio);
+    double onsetThreshold();
+
+    /*********************************************************************
+     * Analysis results. These are safe to call from any thread
+     * (e.g. from DMXSource::writeDMX) and never block on audio reads.
+     *********************************************************************/
+    /** Returns the current volume level scaled to 0-255 */
+    uchar volumeLevel();
+
+    /** Returns the envelope of the given band, scaled to 0-255 */
+    uchar bandLevel(int index);
+
+    /** Returns the raw envelope value of the given band */
+    double bandEnvelope(int index);
+
+    /** Returns the number of onsets detected since the capture started */
+    quint32 onsetCount();
+
     static int maxFrequency() { return SPECTRUM_MAX_FREQUENCY; }
 
+    /*********************************************************************
+     * Sharing
+     *********************************************************************/
+    /**
+     * Register one more user of the capture (e.g. audio triggers or a show
+     * chasing LTC), initializing and starting it if it's not running yet.
+     * When $clock is not NULL, LTC is decoded from the first channel of the
+     * captured audio and fed to $clock, directly from the capture thread.
+     * Call from the main thread only.
+     *
+     * @return false if the audio input could not be opened
+     */
+    bool acquire(TimecodeClock* clock = NULL);
+
+    /**
+     * Unregister a user of the capture, given the same $clock passed to
+     * acquire(). LTC decoding stops with its last user, and the capture
+     * stops when its last user releases it.
+     */
+    void release(TimecodeClock* clock = NULL);
+
     /*!
      * Prepares object for usage and setups required audio parameters.
      * Subclass should reimplement this function.
@@ -85,15 +155,34 @@ public:
 private:
     void processData();
 
+    /** Update the band envelopes and detect onsets. Called by processData() */
+    void processEnvelopes();
+
+    /** Release the FFT plan and all the analysis buffers */
+    void releaseBuffers();
+
+    /** Decode LTC from the last samples read, if requested. Called by run() */
+    void processTimecode();
+
     bool m_userStop, m_pause;
 
 signals:
+    /**
+     * Emitted once per analysis window, not at every hop, with the band
+     * envelopes, their maximum and the signal power. This is meant for
+     * displays: the same values scaled to 0-255 are returned by
+     * bandLevel() and volumeLevel().
+     */
     void dataProcessed(double *spectrumBands, double maxMagnitude, quint32 power);
 
+    /** Emitted from the capture thread each time an onset (beat) is detected */
+    void onsetDetected(double strength);
+
 protected:
     /*!
-     * Reads up to \b maxSize bytes from \b the input interface device.
-     * Returns an array of the bytes read, or an empty array if an error occurred.
+     * Reads \b maxSize samples (frames times channels) from the input
+     * interface device into m_audioBuffer.
+     * Returns false if an error occurred.
      * Subclass should reimplement this function.
      */
     virtual bool readAudio(int maxSize) = 0;
@@ -103,9 +192,16 @@ protected:
 
     unsigned int m_captureSize, m_sampleRate, m_channels;
 
-    /** Data buffer for audio data coming from the sound card */
+    /** Data buffer for audio data coming from the sound card.
+     *  Each readAudio() call fills m_hopSize samples of it */
     int16_t *m_audioBuffer;
 
+    /** Number of new samples read for each analysis step */
+    unsigned int m_hopSize;
+
+    /** Sliding window of the last m_captureSize samples */
+    int16_t *m_windowBuffer;
+
     quint32 m_signalPower;
     double m_maxMagnitude;
     int m_subBandsNumber;
@@ -113,7 +209,47 @@ protected:
     /** **************** FFT variables ********************** */
     double *m_fftInputBuffer;
     void *m_fftOutputBuffer;
+    /** fftw_plan created once in initialize() */
+    void *m_fftPlan;
+    /** Precomputed window coefficients */
+    double *m_fftWindow;
     double m_fftMagnitudeBuffer[FREQ_SUBBANDS_MAX_NUMBER];
+
+    /** **************** Envelopes & onsets ****************** */
+    int m_envelopeRelease;
+    /** Envelope decay factor applied at every hop */
+    double m_envelopeDecay;
+    double m_bandEnvelope[FREQ_SUBBANDS_MAX_NUMBER];
+    double m_maxEnvelope;
+    double m_previousMagnitude[FREQ_SUBBANDS_MAX_NUMBER];
+
+    double m_onsetThreshold;
+    double m_fluxHistory[ONSET_HISTORY_SIZE];
+    int m_fluxHistoryIndex;
+    double m_fluxHistorySum;
+    /** Samples elapsed since the last detected onset */
+    quint32 m_samplesSinceOnset;
+    quint32 m_onsetCount;
+
+    /** Samples analysed since dataProcessed() was last emitted */
+    quint32 m_samplesSinceDisplay;
+
+    /** Levels published for other threads, guarded by m_levelsMutex */
+    QMutex m_levelsMutex;
+    uchar m_volumeLevel;
+    uchar m_bandLevels[FREQ_SUBBANDS_MAX_NUMBER];
+
+    /** **************** Sharing ***************************** */
+    /** Number of acquire() calls not released yet */
+    int m_users;
+
+    /** **************** Linear timecode ********************* */
+    /** Guards m_timecodeClock, which is set from other threads */
+    QMutex m_timecodeMutex;
+    TimecodeClock* m_timecodeClock;
+    /** Number of users that acquired the capture to decode LTC */
+    int m_timecodeUsers;
+    LTCDecoder m_ltcDecoder;
 };
 
 #endif // AUDIOCAPTURE_H
@@ -121,16 +121,15 @@ void AudioCaptureAlsa::resume()
 
 bool AudioCaptureAlsa::readAudio(int maxSize)
 {
-    int read;
-    if ((read = snd_pcm_readi (m_captureHandle, m_audioBuffer, maxSize)) != maxSize)
+    // snd_pcm_readi counts frames, maxSize counts the samples of all channels
+    snd_pcm_sframes_t frames = maxSize / m_channels;
+    snd_pcm_sframes_t read;
+    if ((read = snd_pcm_readi (m_captureHandle, m_audioBuffer, frames)) != frames)
     {
-        qWarning("read from audio interface failed (%s)\n", snd_strerror (read));
+        qWarning("read from audio interface failed (%s)\n", snd_strerror (int(read)));
         return false;
     }
 
-    //qDebug() << "Audio sample #0:" << m_audioBuffer[0] << ", #max:" << m_audioBuffer[m_captureSize - 1];
-    qDebug() << "[ALSA readAudio] " << maxSize << "bytes read";
-
     return true;
 }
 
@@ -120,15 +120,14 @@ void AudioCapturePortAudio::resume()
 
 bool AudioCapturePortAudio::readAudio(int maxSize)
 {
-    int err = Pa_ReadStream( stream, m_audioBuffer, maxSize );
+    // Pa_ReadStream counts frames, maxSize counts the samples of all channels
+    int err = Pa_ReadStream( stream, m_audioBuffer, maxSize / m_channels );
     if( err )
     {
         qWarning("read from audio interface failed (%s)\n", Pa_GetErrorText (err));
         return false;
     }
 
-    qDebug() << "[PORTAUDIO readAudio] " << maxSize << "bytes read";
-
     return true;
 }
 
@@ -116,10 +116,10 @@ bool AudioCaptureWaveIn::readAudio(int maxSize)
     {
         for (int i = 0; i < HEADERS_NUMBER; i++)
         {
-            m_internalBuffers[i] = new char[m_captureSize * 2];
+            m_internalBuffers[i] = new char[maxSize * 2];
             // Set up and prepare header for input
             waveHeaders[i].lpData = (LPSTR)m_internalBuffers[i];
-            waveHeaders[i].dwBufferLength = m_captureSize * 2; // multiply by 2 cause they're 16bit samples
+            waveHeaders[i].dwBufferLength = maxSize * 2; // multiply by 2 cause they're 16bit samples
             waveHeaders[i].dwBytesRecorded = 0;
             waveHeaders[i].dwUser = 0L;
             waveHeaders[i].dwFlags = 0L;
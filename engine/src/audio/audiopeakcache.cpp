@@ -0,0 +1,489 @@
+/*
+  Q Light Controller Plus
+  audiopeakcache.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QDir>
+#include <qmath.h>
+#include <string.h>
+#include <limits.h>
+
+#include "audiopeakcache.h"
+#include "audiodecoder.h"
+#include "audio.h"
+
+#define PEAK_CACHE_MAGIC    0x514C504B /* QLPK */
+#define PEAK_CACHE_VERSION  2
+
+/** Size of the buffer used to read decoded audio data */
+#define PEAK_READ_BUFFER_SIZE   (64 * 1024)
+
+/*****************************************************************************
+ * Helpers
+ *****************************************************************************/
+
+/** Convert one sample pointed by $data into a [-1.0, 1.0] float */
+static inline float sampleToFloat(const uchar *data, AudioFormat format)
+{
+    switch (format)
+    {
+        case PCM_S8:
+            return float((qint8)data[0]) / 128.0;
+        case PCM_S24LE:
+        {
+            // low three bytes of a 32 bit word, sign extended
+            qint32 value = (qint32)((quint32)data[0] << 8 | (quint32)data[1] << 16 |
+                                    (quint32)data[2] << 24) >> 8;
+            return float(value) / 8388608.0;
+        }
+        case PCM_S32LE:
+        {
+            qint32 value = (qint32)((quint32)data[0] | (quint32)data[1] << 8 |
+                                    (quint32)data[2] << 16 | (quint32)data[3] << 24);
+            return float(value) / 2147483648.0;
+        }
+        case PCM_S16LE:
+        default:
+        {
+            qint16 value = (qint16)((quint16)data[0] | (quint16)data[1] << 8);
+            return float(value) / 32768.0;
+        }
+    }
+}
+
+/*****************************************************************************
+ * Initialization
+ *****************************************************************************/
+
+AudioPeakCache::AudioPeakCache(const QString& sourceFile, const QString& cacheDir, QObject* parent)
+    : QThread(parent)
+    , m_sourceFile(sourceFile)
+    , m_abort(0)
+    , m_ready(false)
+    , m_sampleRate(0)
+    , m_channels(0)
+    , m_frames(0)
+{
+    if (cacheDir.isEmpty() == false)
+        m_cacheFile = cacheFilePath(sourceFile, cacheDir);
+}
+
+AudioPeakCache::~AudioPeakCache()
+{
+    m_abort.fetchAndStoreOrdered(1);
+    wait();
+}
+
+QString AudioPeakCache::cacheFilePath(const QString& sourceFile, const QString& cacheDir)
+{
+    QByteArray hash = QCryptographicHash::hash(QFileInfo(sourceFile).absoluteFilePath().toUtf8(),
+                                               QCryptographicHash::Md5);
+    QString name = QFileInfo(sourceFile).fileName() + "-" + QString(hash.toHex()) + PEAK_CACHE_EXTENSION;
+
+    return QDir(cacheDir).absoluteFilePath(name);
+}
+
+void AudioPeakCache::load()
+{
+    if (isRunning() == true || isReady() == true)
+        return;
+
+    start(QThread::LowPriority);
+}
+
+/*****************************************************************************
+ * Query
+ *****************************************************************************/
+
+bool AudioPeakCache::isReady()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_ready;
+}
+
+int AudioPeakCache::channels()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_channels;
+}
+
+qint64 AudioPeakCache::duration()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_sampleRate == 0)
+        return 0;
+    return (m_frames * 1000) / m_sampleRate;
+}
+
+bool AudioPeakCache::peak(int channel, qint64 startTime, qint64 endTime, AudioPeak& result)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_ready == false || m_levels.isEmpty() ||
+        channel < 0 || channel >= m_channels || endTime <= startTime)
+            return false;
+
+    qint64 startFrame = (startTime * m_sampleRate) / 1000;
+    qint64 endFrame = (endTime * m_sampleRate) / 1000;
+    if (startFrame >= m_frames)
+        return false;
+    endFrame = qMin(endFrame, m_frames);
+    qint64 span = qMax(endFrame - startFrame, qint64(1));
+
+    /* Pick the coarsest level whose buckets still fit in the span */
+    int level = 0;
+    qint64 bucketFrames = PEAK_BASE_BUCKET_FRAMES;
+    while (level + 1 < m_levels.count() && bucketFrames * PEAK_LEVEL_FACTOR <= span)
+    {
+        level++;
+        bucketFrames *= PEAK_LEVEL_FACTOR;
+    }
+
+    const QVector<Bucket>& buckets = m_levels.at(level);
+    if (buckets.isEmpty())
+        return false;
+
+    int first = startFrame / bucketFrames;
+    int last = qMax(startFrame, endFrame - 1) / bucketFrames;
+    last = qMin(last, buckets.count() - 1);
+    first = qMin(first, last);
+
+    qint16 min = SHRT_MAX, max = SHRT_MIN;
+    double rmsSum = 0;
+    for (int i = first; i <= last; i++)
+    {
+        const Bucket& b = buckets.at(i);
+        if (b.min[channel] < min)
+            min = b.min[channel];
+        if (b.max[channel] > max)
+            max = b.max[channel];
+        double rms = b.rms[channel];
+        rmsSum += rms * rms;
+    }
+
+    result.min = float(min) / 32767.0;
+    result.max = float(max) / 32767.0;
+    result.rms = qSqrt(rmsSum / (last - first + 1)) / 65535.0;
+
+    return true;
+}
+
+/*****************************************************************************
+ * Computation
+ *****************************************************************************/
+
+void AudioPeakCache::run()
+{
+    if (loadCacheFile() == true)
+    {
+        emit peaksReady();
+        return;
+    }
+
+    QList< QVector<Bucket> > levels;
+    quint32 sampleRate = 0;
+    int channels = 0;
+    qint64 frames = 0;
+
+    if (computeLevels(levels, sampleRate, channels, frames) == false)
+        return;
+
+    m_mutex.lock();
+    m_levels = levels;
+    m_sampleRate = sampleRate;
+    m_channels = channels;
+    m_frames = frames;
+    m_ready = true;
+    m_mutex.unlock();
+
+    saveCacheFile();
+
+    emit peaksReady();
+}
+
+AudioDecoder* AudioPeakCache::createDecoder()
+{
+    return Audio::createDecoder(m_sourceFile);
+}
+
+bool AudioPeakCache::isAborted() const
+{
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+    return m_abort != 0;
+#else
+    return m_abort.loadAcquire() != 0;
+#endif
+}
+
+bool AudioPeakCache::computeLevels(QList< QVector<Bucket> >& levels, quint32& sampleRate,
+                                   int& channels, qint64& frames)
+{
+    AudioDecoder *decoder = createDecoder();
+    if (decoder == NULL)
+    {
+        qWarning() << Q_FUNC_INFO << "Cannot decode" << m_sourceFile;
+        return false;
+    }
+
+    AudioParameters ap = decoder->audioParameters();
+    AudioFormat format = ap.format();
+    int sampleSize = ap.sampleSize();
+    int srcChannels = ap.channels();
+    int frameSize = sampleSize * srcChannels;
+
+    sampleRate = ap.sampleRate();
+    channels = qMin(srcChannels, PEAK_MAX_CHANNELS);
+    frames = 0;
+
+    if (frameSize == 0 || sampleRate == 0)
+    {
+        delete decoder;
+        return false;
+    }
+
+    QVector<Bucket> base;
+    base.reserve((decoder->totalTime() * sampleRate) / 1000 / PEAK_BASE_BUCKET_FRAMES + 1);
+
+    float bMin[PEAK_MAX_CHANNELS], bMax[PEAK_MAX_CHANNELS];
+    double bSquares[PEAK_MAX_CHANNELS];
+    int bFrames = 0;
+    for (int c = 0; c < PEAK_MAX_CHANNELS; c++)
+    {
+        bMin[c] = 1.0; bMax[c] = -1.0; bSquares[c] = 0;
+    }
+
+    QByteArray buffer(PEAK_READ_BUFFER_SIZE, 0);
+    uchar *data = (uchar *)buffer.data();
+    qint64 pending = 0;
+
+    while (isAborted() == false)
+    {
+        qint64 read = decoder->read((char *)data + pending, PEAK_READ_BUFFER_SIZE - pending);
+        if (read <= 0)
+            break;
+
+        qint64 available = pending + read;
+        qint64 i = 0;
+        for (; i + frameSize <= available; i += frameSize)
+        {
+            for (int c = 0; c < channels; c++)
+            {
+                float value = sampleToFloat(data + i + (c * sampleSize), format);
+                if (value < bMin[c])
+                    bMin[c] = value;
+                if (value > bMax[c])
+                    bMax[c] = value;
+                bSquares[c] += value * value;
+            }
+
+            if (++bFrames == PEAK_BASE_BUCKET_FRAMES)
+            {
+                Bucket b;
+                memset(&b, 0, sizeof(Bucket));
+                for (int c = 0; c < channels; c++)
+                {
+                    b.min[c] = bMin[c] * 32767;
+                    b.max[c] = bMax[c] * 32767;
+                    b.rms[c] = qMin(qSqrt(bSquares[c] / bFrames), 1.0) * 65535;
+                    bMin[c] = 1.0; bMax[c] = -1.0; bSquares[c] = 0;
+                }
+                base.append(b);
+                frames += bFrames;
+                bFrames = 0;
+            }
+        }
+
+        // keep the partial frame (if any) for the next read
+        pending = available - i;
+        if (pending > 0)
+            memmove(data, data + i, pending);
+    }
+
+    delete decoder;
+
+    if (isAborted() == true)
+        return false;
+
+    if (bFrames > 0)
+    {
+        Bucket b;
+        memset(&b, 0, sizeof(Bucket));
+        for (int c = 0; c < channels; c++)
+        {
+            b.min[c] = bMin[c] * 32767;
+            b.max[c] = bMax[c] * 32767;
+            b.rms[c] = qMin(qSqrt(bSquares[c] / bFrames), 1.0) * 65535;
+        }
+        base.append(b);
+        frames += bFrames;
+    }
+
+    levels.clear();
+    levels.append(base);
+    buildUpperLevels(levels);
+
+    qDebug() << "[AudioPeakCache]" << m_sourceFile << "summarized in" << levels.count()
+             << "levels," << base.count() << "base buckets";
+
+    return true;
+}
+
+void AudioPeakCache::buildUpperLevels(QList< QVector<Bucket> >& levels)
+{
+    while (levels.last().count() > 1)
+    {
+        const QVector<Bucket> lower = levels.last();
+        QVector<Bucket> upper((lower.count() + PEAK_LEVEL_FACTOR - 1) / PEAK_LEVEL_FACTOR);
+
+        for (int u = 0; u < upper.count(); u++)
+        {
+            Bucket& b = upper[u];
+            int first = u * PEAK_LEVEL_FACTOR;
+            int last = qMin(first + PEAK_LEVEL_FACTOR, lower.count());
+
+            for (int c = 0; c < PEAK_MAX_CHANNELS; c++)
+            {
+                qint16 min = SHRT_MAX, max = SHRT_MIN;
+                double squares = 0;
+                for (int l = first; l < last; l++)
+                {
+                    const Bucket& lb = lower.at(l);
+                    min = qMin(min, lb.min[c]);
+                    max = qMax(max, lb.max[c]);
+                    squares += double(lb.rms[c]) * double(lb.rms[c]);
+                }
+                b.min[c] = min;
+                b.max[c] = max;
+                b.rms[c] = qSqrt(squares / (last - first));
+            }
+        }
+        levels.append(upper);
+    }
+}
+
+/*****************************************************************************
+ * Disk cache
+ *****************************************************************************/
+
+bool AudioPeakCache::loadCacheFile()
+{
+    if (m_cacheFile.isEmpty())
+        return false;
+
+    QFileInfo srcInfo(m_sourceFile);
+    QFile file(m_cacheFile);
+    if (file.open(QIODevice::ReadOnly) == false)
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_6);
+
+    quint32 magic = 0, version = 0;
+    qint64 srcSize = 0;
+    QDateTime srcModified;
+    quint32 sampleRate = 0;
+    qint32 channels = 0;
+    qint64 frames = 0;
+    qint32 levelCount = 0;
+
+    stream >> magic >> version;
+    if (magic != PEAK_CACHE_MAGIC || version != PEAK_CACHE_VERSION)
+        return false;
+
+    /* The source file has changed since the cache was written */
+    stream >> srcSize >> srcModified;
+    if (srcSize != srcInfo.size() || srcModified != srcInfo.lastModified())
+        return false;
+
+    stream >> sampleRate >> channels >> frames >> levelCount;
+    if (stream.status() != QDataStream::Ok || channels <= 0 || channels > PEAK_MAX_CHANNELS ||
+        levelCount <= 0 || sampleRate == 0)
+            return false;
+
+    QList< QVector<Bucket> > levels;
+    for (int l = 0; l < levelCount; l++)
+    {
+        qint32 count = 0;
+        stream >> count;
+        if (count < 0 || stream.status() != QDataStream::Ok)
+            return false;
+
+        QVector<Bucket> buckets(count);
+        for (int i = 0; i < count; i++)
+        {
+            Bucket& b = buckets[i];
+            memset(&b, 0, sizeof(Bucket));
+            for (int c = 0; c < channels; c++)
+                stream >> b.min[c] >> b.max[c] >> b.rms[c];
+        }
+        if (stream.status() != QDataStream::Ok)
+            return false;
+        levels.append(buckets);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_levels = levels;
+    m_sampleRate = sampleRate;
+    m_channels = channels;
+    m_frames = frames;
+    m_ready = true;
+
+    return true;
+}
+
+bool AudioPeakCache::saveCacheFile()
+{
+    if (m_cacheFile.isEmpty())
+        return false;
+
+    QDir().mkpath(QFileInfo(m_cacheFile).absolutePath());
+
+    QFile file(m_cacheFile);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate) == false)
+    {
+        qWarning() << Q_FUNC_INFO << "Cannot write peak cache" << m_cacheFile;
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_6);
+
+    QMutexLocker locker(&m_mutex);
+
+    QFileInfo srcInfo(m_sourceFile);
+    stream << quint32(PEAK_CACHE_MAGIC) << quint32(PEAK_CACHE_VERSION);
+    stream << qint64(srcInfo.size()) << srcInfo.lastModified();
+    stream << m_sampleRate << qint32(m_channels) << m_frames << qint32(m_levels.count());
+
+    foreach (QVector<Bucket> buckets, m_levels)
+    {
+        stream << qint32(buckets.count());
+        foreach (Bucket b, buckets)
+        {
+            for (int c = 0; c < m_channels; c++)
+                stream << b.min[c] << b.max[c] << b.rms[c];
+        }
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
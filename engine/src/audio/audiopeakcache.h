@@ -0,0 +1,162 @@
+/*
+  Q Light Controller Plus
+  audiopeakcache.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef AUDIOPEAKCACHE_H
+#define AUDIOPEAKCACHE_H
+
+#include <QAtomicInt>
+#include <QThread>
+#include <QVector>
+#include <QMutex>
+
+class AudioDecoder;
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+#define PEAK_CACHE_DIRECTORY    ".qlcpluspeaks"
+#define PEAK_CACHE_EXTENSION    ".qpk"
+
+/** Maximum number of channels summarized by the cache */
+#define PEAK_MAX_CHANNELS       2
+
+/** Number of audio frames summarized by one bucket of the finest level */
+#define PEAK_BASE_BUCKET_FRAMES 256
+
+/** Number of buckets of a level merged into one bucket of the next level */
+#define PEAK_LEVEL_FACTOR       4
+
+/**
+ * AudioPeak holds the summary of an audio portion for a single channel.
+ * Values are normalized in the [-1.0, 1.0] range.
+ */
+typedef struct
+{
+    float min;
+    float max;
+    float rms;
+} AudioPeak;
+
+/**
+ * AudioPeakCache computes, in a worker thread, a multi-resolution summary
+ * (min/max/RMS per channel) of an audio file so that waveforms can be drawn
+ * at any zoom level without decoding the file again.
+ *
+ * The finest level summarizes PEAK_BASE_BUCKET_FRAMES frames per bucket and
+ * each following level merges PEAK_LEVEL_FACTOR buckets of the previous one.
+ * Once computed, the summary is stored on disk in the given cache directory
+ * and reused as long as the size and modification time of the source file
+ * don't change.
+ */
+class AudioPeakCache : public QThread
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(AudioPeakCache)
+
+public:
+    /**
+     * Create a new peak cache for the given audio file.
+     *
+     * @param sourceFile Absolute path of the audio file to summarize
+     * @param cacheDir Directory where the summary file is stored. If empty,
+     *                 the summary is kept only in memory.
+     */
+    AudioPeakCache(const QString& sourceFile, const QString& cacheDir, QObject* parent = 0);
+    ~AudioPeakCache();
+
+    /**
+     * Load the summary from the disk cache if valid, otherwise start
+     * computing it in the background. peaksReady() is emitted once
+     * the summary is available.
+     */
+    void load();
+
+    /** Returns true when the summary is available */
+    bool isReady();
+
+    /** Returns the number of summarized channels */
+    int channels();
+
+    /** Returns the duration of the summarized audio in milliseconds */
+    qint64 duration();
+
+    /**
+     * Get the summary of the audio between $startTime and $endTime
+     * (in milliseconds) for the given channel. The coarsest level with
+     * buckets not longer than the requested interval is used, so the cost
+     * of this call doesn't depend on the length of the interval.
+     *
+     * @return false if the summary is not ready or the range is invalid
+     */
+    bool peak(int channel, qint64 startTime, qint64 endTime, AudioPeak& result);
+
+    /** Returns the path of the disk cache file for $sourceFile */
+    static QString cacheFilePath(const QString& sourceFile, const QString& cacheDir);
+
+signals:
+    void peaksReady();
+
+protected:
+    /** @reimpl */
+    void run();
+
+    /** Create a decoder for the source file, owned by the caller */
+    virtual AudioDecoder* createDecoder();
+
+private:
+    typedef struct
+    {
+        qint16 min[PEAK_MAX_CHANNELS];
+        qint16 max[PEAK_MAX_CHANNELS];
+        quint16 rms[PEAK_MAX_CHANNELS];
+    } Bucket;
+
+    /** Decode the source file and build all the levels */
+    bool computeLevels(QList< QVector<Bucket> >& levels, quint32& sampleRate,
+                       int& channels, qint64& frames);
+
+    /** Build the levels above the finest one */
+    static void buildUpperLevels(QList< QVector<Bucket> >& levels);
+
+    /** Check if the destructor asked to interrupt the computation */
+    bool isAborted() const;
+
+    bool loadCacheFile();
+    bool saveCacheFile();
+
+private:
+    QString m_sourceFile;
+    QString m_cacheFile;
+
+    /** Set by the destructor to interrupt a running computation */
+    QAtomicInt m_abort;
+
+    /** Guards all the members below */
+    QMutex m_mutex;
+    bool m_ready;
+    quint32 m_sampleRate;
+    int m_channels;
+    qint64 m_frames;
+    QList< QVector<Bucket> > m_levels;
+};
+
+/** @} */
+
+#endif
@@ -24,10 +24,14 @@
 
 AudioRenderer::AudioRenderer (QObject* parent)
     : QThread (parent)
+    , m_startPosition(0)
+    , m_bytesWritten(0)
+    , m_latency(0)
     , m_fadeStep(0.0)
     , m_userStop(true)
     , m_pause(false)
     , m_intensity(1.0)
+    , m_adec(NULL)
     , audioDataRead(0)
     , pendingAudioBytes(0)
 {
@@ -43,6 +47,50 @@ void AudioRenderer::adjustIntensity(qreal fraction)
     m_intensity = CLAMP(fraction, 0.0, 1.0);
 }
 
+/*********************************************************************
+ * Playback clock
+ *********************************************************************/
+
+void AudioRenderer::setStartPosition(qint64 msec)
+{
+    QMutexLocker locker(&m_clockMutex);
+    m_startPosition = msec;
+    m_bytesWritten = 0;
+    m_latency = 0;
+}
+
+qint64 AudioRenderer::playbackPosition()
+{
+    if (m_adec == NULL)
+        return -1;
+
+    AudioParameters ap = m_adec->audioParameters();
+    qint64 bytesPerSecond = (qint64)ap.sampleRate() * ap.channels() * ap.sampleSize();
+    if (bytesPerSecond == 0)
+        return -1;
+
+    QMutexLocker locker(&m_clockMutex);
+    qint64 played = (m_bytesWritten * 1000) / bytesPerSecond - m_latency;
+
+    return m_startPosition + qMax(played, qint64(0));
+}
+
+void AudioRenderer::updatePlaybackClock(qint64 bytes)
+{
+    // latency() is queried here so that the backend is only
+    // ever accessed from the renderer thread
+    qint64 lat = latency();
+
+    QMutexLocker locker(&m_clockMutex);
+    if (bytes > 0)
+        m_bytesWritten += bytes;
+    m_latency = lat;
+}
+
+/*********************************************************************
+ * Fade sequences
+ *********************************************************************/
+
 void AudioRenderer::setFadeIn(uint fadeTime)
 {
     if (fadeTime == 0)
@@ -145,6 +193,7 @@ void AudioRenderer::run()
                 }
             }
             audioDataWritten = writeAudio(audioData, audioDataRead);
+            updatePlaybackClock(audioDataWritten);
             if (audioDataWritten < audioDataRead)
             {
                 pendingAudioBytes = audioDataRead - audioDataWritten;
@@ -154,6 +203,7 @@ void AudioRenderer::run()
           else
           {
             audioDataWritten = writeAudio(audioData + (audioDataRead - pendingAudioBytes), pendingAudioBytes);
+            updatePlaybackClock(audioDataWritten);
             pendingAudioBytes -= audioDataWritten;
             if (audioDataWritten == 0)
                 usleep(15000);
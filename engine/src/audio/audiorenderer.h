@@ -89,6 +89,39 @@ public:
 
     void adjustIntensity(qreal fraction);
 
+    /*********************************************************************
+     * Playback clock
+     *********************************************************************/
+public:
+    /**
+     * Set the position (in milliseconds from the beginning of the stream)
+     * at which the decoder has been placed before starting the renderer.
+     * This is needed to report a correct clock after a seek.
+     */
+    void setStartPosition(qint64 msec);
+
+    /**
+     * Returns the position (in milliseconds from the beginning of the stream)
+     * of the audio currently reaching the output device. This is computed
+     * from the number of samples written so far, minus the output latency,
+     * and it is safe to call from any thread.
+     */
+    qint64 playbackPosition();
+
+private:
+    /** Update the clock after $bytes have been handed to the device */
+    void updatePlaybackClock(qint64 bytes);
+
+private:
+    /** Guards the clock variables below */
+    QMutex m_clockMutex;
+    /** Position of the decoder when the renderer started */
+    qint64 m_startPosition;
+    /** Number of audio bytes written to the device since start */
+    qint64 m_bytesWritten;
+    /** Latency of the output device, sampled by the renderer thread */
+    qint64 m_latency;
+
     /*********************************************************************
      * Fade sequences
      *********************************************************************/
@@ -39,7 +39,9 @@ AudioRendererAlsa::AudioRendererAlsa(QObject * parent)
     if (var.isValid() == true)
         dev_name = var.toString();
 
+    m_inited = false;
     m_use_mmap = false;
+    m_rate = 0;
     pcm_name = strdup(dev_name.toLatin1().data());
     pcm_handle = NULL;
     m_prebuf = NULL;
@@ -184,6 +186,7 @@ bool AudioRendererAlsa::initialize(quint32 freq, int chan, AudioFormat format)
     }
     //setup needed values
     m_bits_per_frame = snd_pcm_format_physical_width(alsa_format) * chan;
+    m_rate = exact_rate;
     m_chunk_size = period_size;
     m_can_pause = snd_pcm_hw_params_can_pause(hwparams) && use_pause;
     qDebug("OutputALSA: can pause: %d", m_can_pause);
@@ -198,8 +201,16 @@ bool AudioRendererAlsa::initialize(quint32 freq, int chan, AudioFormat format)
 
 qint64 AudioRendererAlsa::latency()
 {
-    //return m_prebuf_fill * 1000 / sampleRate() / channels() / sampleSize();
-    return 0;
+    if (m_inited == false || pcm_handle == NULL || m_rate == 0)
+        return 0;
+
+    // frames queued in the device plus the ones still in the prebuffer
+    snd_pcm_sframes_t delay = 0;
+    if (snd_pcm_delay(pcm_handle, &delay) < 0 || delay < 0)
+        delay = 0;
+    delay += snd_pcm_bytes_to_frames(pcm_handle, m_prebuf_fill);
+
+    return (qint64)delay * 1000 / m_rate;
 }
 
 QList<AudioDeviceInfo> AudioRendererAlsa::getDevicesInfo()
@@ -80,6 +80,7 @@ private:
     char *pcm_name;
     snd_pcm_uframes_t m_chunk_size;
     size_t m_bits_per_frame;
+    uint m_rate;
     //prebuffer
     uchar *m_prebuf;
     qint64 m_prebuf_size;
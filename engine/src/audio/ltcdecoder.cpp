@@ -0,0 +1,230 @@
+/*
+  Q Light Controller Plus
+  ltcdecoder.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <climits>
+
+#include "ltcdecoder.h"
+
+/** Frame rates used to guess the initial bit period and the accepted range */
+#define LTC_DEFAULT_FPS 25
+#define LTC_MIN_FPS     20
+#define LTC_MAX_FPS     35
+
+LTCDecoder::LTCDecoder()
+    : m_sampleRate(44100)
+    , m_envelope(0)
+    , m_high(false)
+    , m_samplesSinceEdge(0)
+    , m_bitPeriod(0)
+    , m_halfBit(false)
+    , m_bitsLow(0)
+    , m_bitsHigh(0)
+    , m_bitCount(0)
+    , m_hours(0)
+    , m_minutes(0)
+    , m_seconds(0)
+    , m_frames(0)
+    , m_dropFrame(false)
+    , m_fps(LTC_DEFAULT_FPS)
+    , m_samplesSinceFrame(0)
+{
+    reset();
+}
+
+LTCDecoder::~LTCDecoder()
+{
+}
+
+void LTCDecoder::setSampleRate(uint rate)
+{
+    if (rate == 0)
+        return;
+
+    m_sampleRate = rate;
+    reset();
+}
+
+uint LTCDecoder::sampleRate() const
+{
+    return m_sampleRate;
+}
+
+void LTCDecoder::reset()
+{
+    m_envelope = 0;
+    m_high = false;
+    m_samplesSinceEdge = 0;
+    m_bitPeriod = qreal(m_sampleRate) / (LTC_FRAME_BITS * LTC_DEFAULT_FPS);
+    m_halfBit = false;
+    m_bitsLow = 0;
+    m_bitsHigh = 0;
+    m_bitCount = 0;
+}
+
+bool LTCDecoder::decode(const qint16* samples, int count, int channels)
+{
+    bool decoded = false;
+
+    if (samples == NULL || channels <= 0)
+        return false;
+
+    for (int i = 0; i < count; i++)
+    {
+        int sample = samples[i * channels];
+        int level = qAbs(sample);
+
+        // Peak follower with a release of about a thousand samples
+        if (level > m_envelope)
+            m_envelope = level;
+        else
+            m_envelope -= m_envelope >> 10;
+
+        // Schmitt trigger at a quarter of the peak level
+        int threshold = qMax(LTC_MIN_LEVEL, m_envelope / 4);
+        bool edge = (m_high == false && sample > threshold) ||
+                    (m_high == true && sample < -threshold);
+
+        // Don't overflow during long silences
+        if (m_samplesSinceEdge < INT_MAX)
+            m_samplesSinceEdge++;
+        if (edge == false)
+            continue;
+
+        m_high = !m_high;
+
+        int interval = m_samplesSinceEdge;
+        m_samplesSinceEdge = 0;
+
+        if (processEdge(interval) == true)
+        {
+            m_samplesSinceFrame = count - i - 1;
+            decoded = true;
+        }
+    }
+
+    if (decoded == false)
+        m_samplesSinceFrame += count;
+
+    return decoded;
+}
+
+quint32 LTCDecoder::msecs() const
+{
+    quint32 secs = (m_hours * 60 + m_minutes) * 60 + m_seconds;
+    return secs * 1000 + ((m_frames + 1) * 1000) / m_fps;
+}
+
+/****************************************************************************
+ * Private
+ ****************************************************************************/
+
+bool LTCDecoder::processEdge(int interval)
+{
+    const qreal minPeriod = qreal(m_sampleRate) / (LTC_FRAME_BITS * LTC_MAX_FPS);
+    const qreal maxPeriod = qreal(m_sampleRate) / (LTC_FRAME_BITS * LTC_MIN_FPS);
+
+    if (interval > m_bitPeriod * 1.5 || interval < m_bitPeriod * 0.25)
+    {
+        // Silence, noise or a bit rate change. Start over.
+        m_halfBit = false;
+        m_bitCount = 0;
+        if (interval <= maxPeriod && interval >= minPeriod)
+            m_bitPeriod = interval;
+        return false;
+    }
+
+    bool frame = false;
+
+    if (interval > m_bitPeriod * 0.75)
+    {
+        // A whole bit without transitions in the middle
+        m_bitPeriod += (interval - m_bitPeriod) / 8;
+        m_halfBit = false;
+        frame = processBit(false);
+    }
+    else
+    {
+        m_bitPeriod += (2 * interval - m_bitPeriod) / 8;
+        if (m_halfBit == false)
+        {
+            m_halfBit = true;
+        }
+        else
+        {
+            m_halfBit = false;
+            frame = processBit(true);
+        }
+    }
+
+    m_bitPeriod = qBound(minPeriod, m_bitPeriod, maxPeriod);
+
+    return frame;
+}
+
+bool LTCDecoder::processBit(bool bit)
+{
+    // Bits are sent LSB first: the oldest bit ends up in bit 0 of m_bitsLow
+    m_bitsLow = (m_bitsLow >> 1) | (quint64(m_bitsHigh & 0x01) << 63);
+    m_bitsHigh = (m_bitsHigh >> 1) | (bit ? 0x8000 : 0);
+
+    if (m_bitCount < LTC_FRAME_BITS)
+        m_bitCount++;
+
+    if (m_bitCount < LTC_FRAME_BITS || m_bitsHigh != LTC_SYNC_WORD)
+        return false;
+
+    // The next frame needs 80 new bits
+    m_bitCount = 0;
+    return parseFrame();
+}
+
+bool LTCDecoder::parseFrame()
+{
+    int frames = (m_bitsLow & 0x0F) + 10 * ((m_bitsLow >> 8) & 0x03);
+    int seconds = ((m_bitsLow >> 16) & 0x0F) + 10 * ((m_bitsLow >> 24) & 0x07);
+    int minutes = ((m_bitsLow >> 32) & 0x0F) + 10 * ((m_bitsLow >> 40) & 0x07);
+    int hours = ((m_bitsLow >> 48) & 0x0F) + 10 * ((m_bitsLow >> 56) & 0x03);
+
+    if (frames >= 30 || seconds >= 60 || minutes >= 60 || hours >= 24)
+    {
+        // Not a valid frame: wait for the next sync word
+        return false;
+    }
+
+    m_frames = frames;
+    m_seconds = seconds;
+    m_minutes = minutes;
+    m_hours = hours;
+    m_dropFrame = (m_bitsLow >> 10) & 0x01;
+
+    // Guess the frame rate from the bit rate
+    qreal fps = qreal(m_sampleRate) / (LTC_FRAME_BITS * m_bitPeriod);
+    if (m_dropFrame == true || fps > 27.5)
+        m_fps = 30;
+    else if (fps > 24.5)
+        m_fps = 25;
+    else
+        m_fps = 24;
+
+    // A frame number beyond the guess means the guess is wrong
+    if (m_frames >= m_fps)
+        m_fps = 30;
+
+    return true;
+}
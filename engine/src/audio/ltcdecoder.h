@@ -0,0 +1,147 @@
+/*
+  Q Light Controller Plus
+  ltcdecoder.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef LTCDECODER_H
+#define LTCDECODER_H
+
+#include <QtGlobal>
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/** Number of bits of an LTC frame, sync word included */
+#define LTC_FRAME_BITS  80
+
+/** The sync word closing each LTC frame, as the last 16 bits received */
+#define LTC_SYNC_WORD   0xBFFC
+
+/** Signals quieter than this (about -40dBFS) are ignored as noise */
+#define LTC_MIN_LEVEL   328
+
+/**
+ * LTCDecoder decodes SMPTE Linear Timecode from audio samples.
+ *
+ * LTC is biphase mark coded: the signal changes polarity at every bit
+ * boundary, and once more in the middle of the bits set to one. The decoder
+ * measures the time between polarity changes, adapting to the bit rate of
+ * the signal (24 to 30 frames per second, including some varispeed), and
+ * assembles the bits until an 80 bit frame is closed by the sync word.
+ *
+ * Only timecode played forward is decoded. The frame rate isn't written
+ * in LTC frames, so it is guessed from the measured bit rate.
+ */
+class LTCDecoder
+{
+public:
+    LTCDecoder();
+    ~LTCDecoder();
+
+    /** Set the sample rate of the audio to decode. Resets the decoder. */
+    void setSampleRate(uint rate);
+
+    /** Get the sample rate of the audio to decode */
+    uint sampleRate() const;
+
+    /** Forget any partially decoded frame */
+    void reset();
+
+    /**
+     * Decode $count frames of $channels interleaved samples. Only the
+     * first channel is decoded.
+     *
+     * @return true if at least one LTC frame has been completed
+     */
+    bool decode(const qint16* samples, int count, int channels);
+
+    /*********************************************************************
+     * Last decoded frame
+     *********************************************************************/
+public:
+    int hours() const { return m_hours; }
+    int minutes() const { return m_minutes; }
+    int seconds() const { return m_seconds; }
+    int frames() const { return m_frames; }
+
+    /** Check if the last frame has the drop frame flag set */
+    bool dropFrame() const { return m_dropFrame; }
+
+    /** Get the frame rate guessed from the bit rate: 24, 25 or 30 */
+    int fps() const { return m_fps; }
+
+    /**
+     * Get the timecode position in milliseconds at the end of the last
+     * frame. That is the start of the next frame, since a frame's
+     * timecode is the time of its beginning.
+     */
+    quint32 msecs() const;
+
+    /**
+     * Get the number of audio frames that the last decode() call received
+     * after the end of the last LTC frame
+     */
+    int samplesSinceFrame() const { return m_samplesSinceFrame; }
+
+    /*********************************************************************
+     * Private
+     *********************************************************************/
+private:
+    /**
+     * Process one polarity change, $interval samples after the previous one.
+     * Returns true if it completes a frame.
+     */
+    bool processEdge(int interval);
+
+    /** Shift $bit into the frame register. Returns true if it completes a frame. */
+    bool processBit(bool bit);
+
+    /** Extract the timecode fields of the frame in the register */
+    bool parseFrame();
+
+private:
+    uint m_sampleRate;
+
+    /** Signal level follower & current polarity */
+    int m_envelope;
+    bool m_high;
+    int m_samplesSinceEdge;
+
+    /** Bit period in samples, adapted to the received signal */
+    qreal m_bitPeriod;
+    /** The first half of a one bit has been received */
+    bool m_halfBit;
+
+    /** The last 80 bits received: bits 0-63 in m_bitsLow, 64-79 in m_bitsHigh */
+    quint64 m_bitsLow;
+    quint16 m_bitsHigh;
+    int m_bitCount;
+
+    int m_hours;
+    int m_minutes;
+    int m_seconds;
+    int m_frames;
+    bool m_dropFrame;
+    int m_fps;
+
+    int m_samplesSinceFrame;
+};
+
+/** @} */
+
+#endif
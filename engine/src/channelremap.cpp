@@ -0,0 +1,216 @@
+/*
+  Q Light Controller Plus
+  channelremap.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "channelremap.h"
+#include "channelsgroup.h"
+#include "efxfixture.h"
+#include "qlcchannel.h"
+#include "chaserstep.h"
+#include "fixture.h"
+#include "chaser.h"
+#include "scene.h"
+#include "efx.h"
+#include "doc.h"
+
+ChannelRemap::ChannelRemap(Doc* doc, QObject* parent)
+    : QObject(parent)
+    , m_doc(doc)
+    , m_positionTargetsValid(false)
+    , m_cancelled(false)
+{
+    Q_ASSERT(doc != NULL);
+}
+
+ChannelRemap::~ChannelRemap()
+{
+}
+
+/****************************************************************************
+ * Table
+ ****************************************************************************/
+
+void ChannelRemap::add(const SceneValue& source, const SceneValue& target)
+{
+    m_table.insert(key(source.fxi, source.channel), SceneValue(target.fxi, target.channel));
+    m_positionTargetsValid = false;
+}
+
+int ChannelRemap::count() const
+{
+    return m_table.count();
+}
+
+void ChannelRemap::clear()
+{
+    m_table.clear();
+    m_positionTargets.clear();
+    m_positionTargetsValid = false;
+}
+
+QList <SceneValue> ChannelRemap::remap(const QList <SceneValue>& values) const
+{
+    QList <SceneValue> remapped;
+
+    foreach (SceneValue val, values)
+    {
+        quint64 source = key(val.fxi, val.channel);
+        QMultiHash <quint64,SceneValue>::const_iterator it = m_table.find(source);
+        for (; it != m_table.end() && it.key() == source; ++it)
+            remapped.append(SceneValue(it.value().fxi, it.value().channel, val.value));
+    }
+
+    qSort(remapped.begin(), remapped.end());
+    return remapped;
+}
+
+QList <quint32> ChannelRemap::positionTargets(quint32 fxi) const
+{
+    if (m_positionTargetsValid == false)
+    {
+        m_positionTargets.clear();
+
+        QMultiHash <quint64,SceneValue>::const_iterator it = m_table.begin();
+        for (; it != m_table.end(); ++it)
+        {
+            Fixture* fixture = m_doc->fixture(it.value().fxi);
+            if (fixture == NULL)
+                continue;
+
+            const QLCChannel* channel = fixture->channel(it.value().channel);
+            if (channel == NULL)
+                continue;
+
+            if (channel->group() != QLCChannel::Pan && channel->group() != QLCChannel::Tilt)
+                continue;
+
+            QList <quint32>& targets = m_positionTargets[quint32(it.key() >> 32)];
+            if (targets.contains(fixture->id()) == false)
+                targets.append(fixture->id());
+        }
+
+        m_positionTargetsValid = true;
+    }
+
+    return m_positionTargets.value(fxi);
+}
+
+quint64 ChannelRemap::key(quint32 fxi, quint32 channel)
+{
+    return (quint64(fxi) << 32) | channel;
+}
+
+/****************************************************************************
+ * Project
+ ****************************************************************************/
+
+bool ChannelRemap::remapDoc()
+{
+    m_cancelled = false;
+
+    // The targets are in the new patch
+    m_positionTargetsValid = false;
+
+    // this is crucial: here all the "unmapped" channels will be lost forever !
+    foreach (ChannelsGroup* grp, m_doc->channelsGroups())
+    {
+        QList <SceneValue> channels = remap(grp->getChannels());
+        grp->resetChannels();
+        foreach (SceneValue val, channels)
+            grp->addChannel(val.fxi, val.channel);
+    }
+
+    QList <Function*> functions = m_doc->functions();
+    int percent = 0;
+
+    emit progressChanged(percent);
+
+    for (int i = 0; i < functions.count(); i++)
+    {
+        if (m_cancelled == true)
+            return false;
+
+        remapFunction(functions.at(i));
+
+        if (((i + 1) * 100) / functions.count() != percent)
+        {
+            percent = ((i + 1) * 100) / functions.count();
+            emit progressChanged(percent);
+        }
+    }
+
+    emit progressChanged(100);
+
+    return true;
+}
+
+void ChannelRemap::cancel()
+{
+    m_cancelled = true;
+}
+
+void ChannelRemap::remapFunction(Function* function)
+{
+    Q_ASSERT(function != NULL);
+
+    switch (function->type())
+    {
+        case Function::Scene:
+        {
+            Scene* scene = qobject_cast<Scene*> (function);
+            scene->setValues(remap(scene->values()));
+        }
+        break;
+        case Function::Chaser:
+        {
+            Chaser* chaser = qobject_cast<Chaser*> (function);
+            if (chaser->isSequence() == false)
+                break;
+
+            for (int i = 0; i < chaser->stepsCount(); i++)
+            {
+                ChaserStep step = chaser->stepAt(i);
+                step.values = remap(step.values);
+                chaser->replaceStep(step, i);
+            }
+        }
+        break;
+        case Function::EFX:
+        {
+            EFX* efx = qobject_cast<EFX*> (function);
+            QList <EFXFixture*> fixtures = efx->fixtures();
+            efx->removeAllFixtures();
+
+            foreach (EFXFixture* source, fixtures)
+            {
+                foreach (quint32 fxi, positionTargets(source->head().fxi))
+                {
+                    EFXFixture* ef = new EFXFixture(efx);
+                    ef->copyFrom(source);
+                    ef->setHead(GroupHead(fxi));
+                    if (efx->addFixture(ef) == false)
+                        delete ef;
+                }
+                delete source;
+            }
+        }
+        break;
+        default:
+        break;
+    }
+}
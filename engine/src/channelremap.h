@@ -0,0 +1,124 @@
+/*
+  Q Light Controller Plus
+  channelremap.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef CHANNELREMAP_H
+#define CHANNELREMAP_H
+
+#include <QMultiHash>
+#include <QObject>
+#include <QList>
+#include <QHash>
+
+#include "scenevalue.h"
+
+class Function;
+class Doc;
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/**
+ * ChannelRemap moves the contents of a project from one fixture patch to
+ * another. It holds a single table from (old fixture, channel) to
+ * (new fixture, channel), and rewrites the channel groups and functions of
+ * a Doc with one hash lookup per channel value.
+ *
+ * A source channel can be remapped to more than one target channel.
+ * Channels without a target are dropped from the project.
+ */
+class ChannelRemap : public QObject
+{
+    Q_OBJECT
+
+public:
+    ChannelRemap(Doc* doc, QObject* parent = 0);
+    ~ChannelRemap();
+
+    /*********************************************************************
+     * Table
+     *********************************************************************/
+public:
+    /** Remap the $source fixture channel to $target. Values are ignored. */
+    void add(const SceneValue& source, const SceneValue& target);
+
+    /** Get the number of channel associations */
+    int count() const;
+
+    /** Remove all channel associations */
+    void clear();
+
+    /**
+     * Remap $values, keeping their values. Unmapped channels are dropped.
+     * The returned list is sorted.
+     */
+    QList <SceneValue> remap(const QList <SceneValue>& values) const;
+
+    /**
+     * Get the fixtures that the position (pan/tilt) channels of the
+     * fixture $fxi are remapped to, in the Doc's current patch
+     */
+    QList <quint32> positionTargets(quint32 fxi) const;
+
+private:
+    /** Get the table key of $channel of fixture $fxi */
+    static quint64 key(quint32 fxi, quint32 channel);
+
+private:
+    Doc* m_doc;
+
+    /** Target channels by source key */
+    QMultiHash <quint64,SceneValue> m_table;
+
+    /** Position target fixtures by source fixture, built when first needed */
+    mutable QHash <quint32,QList<quint32> > m_positionTargets;
+    mutable bool m_positionTargetsValid;
+
+    /*********************************************************************
+     * Project
+     *********************************************************************/
+public:
+    /**
+     * Remap the channel groups and functions of the Doc, whose fixtures
+     * must already be replaced with the target ones. Progress is reported
+     * with progressChanged() after each function.
+     *
+     * @return false if cancel() was called before the end
+     */
+    bool remapDoc();
+
+public slots:
+    /** Stop remapDoc() after the current function */
+    void cancel();
+
+signals:
+    /** Emitted while remapping the Doc, with a $percent between 0 and 100 */
+    void progressChanged(int percent);
+
+private:
+    /** Rewrite the channels or fixtures used by $function */
+    void remapFunction(Function* function);
+
+private:
+    bool m_cancelled;
+};
+
+/** @} */
+
+#endif
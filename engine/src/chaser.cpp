@@ -580,7 +580,7 @@ void Chaser::write(MasterTimer* timer, QList<Universe *> universes)
             stop();
     }
 
-    incrementElapsed();
+    incrementElapsed(tickLength(timer));
 }
 
 void Chaser::postRun(MasterTimer* timer, QList<Universe *> universes)
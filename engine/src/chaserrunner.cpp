@@ -23,6 +23,7 @@
 #include "chaserrunner.h"
 #include "genericfader.h"
 #include "mastertimer.h"
+#include "tempoclock.h"
 #include "fadechannel.h"
 #include "chaserstep.h"
 #include "qlcmacros.h"
@@ -214,7 +215,16 @@ void ChaserRunner::previous()
 
 void ChaserRunner::tap()
 {
-    if (uint(m_roundTime->elapsed()) >= (currentDuration() / 4))
+    // Taps are timed in milliseconds, so beat-based durations (thousandths
+    // of a beat) are converted at the current tempo first
+    uint duration = currentDuration();
+    if (m_chaser->tempoType() == Function::Beats && duration != Function::infiniteSpeed())
+    {
+        qreal bpm = m_doc->masterTimer()->tempoClock()->bpm();
+        duration = uint(qreal(duration) * 60.0 / bpm);
+    }
+
+    if (uint(m_roundTime->elapsed()) >= (duration / 4))
         next();
 }
 
@@ -276,6 +286,11 @@ bool ChaserRunner::write(MasterTimer* timer, QList<Universe *> universes)
     if (m_chaser->steps().size() == 0)
         return false;
 
+    // The time that passes on this tick, in the chaser's tempo units. A step's
+    // first tick counts at least one unit, since zero means "not started".
+    uint tick = m_chaser->tickLength(timer);
+    uint stepTick = qMax(tick, uint(1));
+
     if (m_newCurrent != -1)
     {
         qDebug() << "Starting from step" << m_currentStep << "@ offset" << m_startOffset;
@@ -287,9 +302,9 @@ bool ChaserRunner::write(MasterTimer* timer, QList<Universe *> universes)
         // No need to do roundcheck here, since manually-set steps are
         // always within m_chaser->steps() limits.
         if (m_startOffset != 0)
-            m_elapsed = m_startOffset + MasterTimer::tick();
+            m_elapsed = m_startOffset + stepTick;
         else
-            m_elapsed = MasterTimer::tick();
+            m_elapsed = stepTick;
         m_startOffset = 0;
 
         switchFunctions(timer);
@@ -298,13 +313,19 @@ bool ChaserRunner::write(MasterTimer* timer, QList<Universe *> universes)
     else if (m_elapsed == 0)
     {
         // First step
-        m_elapsed = MasterTimer::tick();
+        m_elapsed = stepTick;
         switchFunctions(timer);
         emit currentStepChanged(m_currentStep);
     }
     else if (m_next == true || m_previous == true ||
              (currentDuration() != Function::infiniteSpeed() && m_elapsed >= currentDuration()))
     {
+        // Beat-based steps carry the time past the end of the step (up to
+        // one tick) over to the next step, so that the chaser stays on the beat
+        uint overshoot = 0;
+        if (m_chaser->tempoType() == Function::Beats && m_next == false && m_previous == false)
+            overshoot = qMin(m_elapsed - currentDuration(), tick);
+
         // Next step
         if (m_direction == Function::Forward)
         {
@@ -326,7 +347,7 @@ bool ChaserRunner::write(MasterTimer* timer, QList<Universe *> universes)
         if (roundCheck() == false)
             return false;
 
-        m_elapsed = MasterTimer::tick();
+        m_elapsed = overshoot + stepTick;
         m_next = false;
         m_previous = false;
 
@@ -337,7 +358,7 @@ bool ChaserRunner::write(MasterTimer* timer, QList<Universe *> universes)
     {
         // Current step. UINT_MAX is the maximum hold time.
         if (m_elapsed < UINT_MAX)
-            m_elapsed += MasterTimer::tick();
+            m_elapsed += tick;
     }
 
     // When the speeds of the chaser change, they need to be updated to the lower
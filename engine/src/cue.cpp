@@ -19,6 +19,7 @@
 
 #include <QDomDocument>
 #include <QDomElement>
+#include <QtAlgorithms>
 #include <QDebug>
 
 #include "cue.h"
@@ -33,16 +34,26 @@ Cue::Cue(const QString& name)
 
 Cue::Cue(const QHash <uint,uchar> values)
     : m_name(QString())
-    , m_values(values)
     , m_fadeInSpeed(0)
     , m_fadeOutSpeed(0)
     , m_duration(0)
 {
+    QList <uint> channels(values.keys());
+    qSort(channels.begin(), channels.end());
+
+    m_channels.reserve(channels.size());
+    m_values.reserve(channels.size());
+    foreach (uint channel, channels)
+    {
+        m_channels.append(channel);
+        m_values.append(values[channel]);
+    }
 }
 
 Cue::Cue(const Cue& cue)
     : m_name(cue.name())
-    , m_values(cue.values())
+    , m_channels(cue.m_channels)
+    , m_values(cue.m_values)
     , m_fadeInSpeed(cue.fadeInSpeed())
     , m_fadeOutSpeed(cue.fadeOutSpeed())
     , m_duration(cue.duration())
@@ -73,28 +84,70 @@ QString Cue::name() const
 
 void Cue::setValue(uint channel, uchar value)
 {
-    m_values[channel] = value;
+    // Values are mostly set in ascending order, e.g. when loading
+    if (m_channels.isEmpty() == true || m_channels.last() < channel)
+    {
+        m_channels.append(channel);
+        m_values.append(value);
+        return;
+    }
+
+    int index = channelIndex(channel);
+    if (m_channels[index] == channel)
+    {
+        m_values[index] = value;
+    }
+    else
+    {
+        m_channels.insert(index, channel);
+        m_values.insert(index, value);
+    }
 }
 
 void Cue::unsetValue(uint channel)
 {
-    if (m_values.contains(channel) == true)
-        m_values.remove(channel);
+    int index = channelIndex(channel);
+    if (index < m_channels.size() && m_channels[index] == channel)
+    {
+        m_channels.remove(index);
+        m_values.remove(index);
+    }
 }
 
 uchar Cue::value(uint channel) const
 {
-    if (m_values.contains(channel) == true)
-        return m_values[channel];
+    int index = channelIndex(channel);
+    if (index < m_channels.size() && m_channels[index] == channel)
+        return m_values[index];
     else
         return 0;
 }
 
 QHash <uint,uchar> Cue::values() const
+{
+    QHash <uint,uchar> values;
+    values.reserve(m_channels.size());
+    for (int i = 0; i < m_channels.size(); i++)
+        values[m_channels[i]] = m_values[i];
+
+    return values;
+}
+
+const QVector <uint>& Cue::channels() const
+{
+    return m_channels;
+}
+
+const QVector <uchar>& Cue::channelValues() const
 {
     return m_values;
 }
 
+int Cue::channelIndex(uint channel) const
+{
+    return qLowerBound(m_channels.begin(), m_channels.end(), channel) - m_channels.begin();
+}
+
 /****************************************************************************
  * Speed
  ****************************************************************************/
@@ -181,13 +234,11 @@ bool Cue::saveXML(QDomDocument* doc, QDomElement* stack_root) const
     root.setAttribute(KXMLQLCCueName, name());
     stack_root->appendChild(root);
 
-    QHashIterator <uint,uchar> it(values());
-    while (it.hasNext() == true)
+    for (int i = 0; i < m_channels.size(); i++)
     {
-        it.next();
         QDomElement e = doc->createElement(KXMLQLCCueValue);
-        e.setAttribute(KXMLQLCCueValueChannel, it.key());
-        QDomText t = doc->createTextNode(QString::number(it.value()));
+        e.setAttribute(KXMLQLCCueValueChannel, m_channels[i]);
+        QDomText t = doc->createTextNode(QString::number(m_values[i]));
         e.appendChild(t);
         root.appendChild(e);
     }
@@ -21,6 +21,7 @@
 #define CUE_H
 
 #include <QString>
+#include <QVector>
 #include <QHash>
 
 #include "scenevalue.h"
@@ -70,8 +71,23 @@ public:
 
     QHash <uint,uchar> values() const;
 
+    /**
+     * Get the channels that have a value in this cue, in ascending order.
+     * Use these instead of values() to walk thru big cues, e.g. to merge
+     * two of them in a single pass.
+     */
+    const QVector <uint>& channels() const;
+
+    /** Get the values of channels(), at the same indices */
+    const QVector <uchar>& channelValues() const;
+
+private:
+    /** Get the index of $channel in m_channels, or where it should be inserted */
+    int channelIndex(uint channel) const;
+
 private:
-    QHash <uint,uchar> m_values;
+    QVector <uint> m_channels;
+    QVector <uchar> m_values;
 
     /************************************************************************
      * Speed
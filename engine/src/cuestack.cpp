@@ -31,6 +31,11 @@
 #include "cue.h"
 #include "doc.h"
 
+/** States of the channels in m_intensityMask */
+#define MASK_UNKNOWN    0
+#define MASK_INTENSITY  1
+#define MASK_OTHER      2
+
 /****************************************************************************
  * Initialization
  ****************************************************************************/
@@ -45,12 +50,17 @@ CueStack::CueStack(Doc* doc)
     , m_currentIndex(-1)
     , m_flashing(false)
     , m_fader(NULL)
+    , m_intensityMaskDirty(false)
     , m_elapsed(0)
     , m_previous(false)
     , m_next(false)
 {
     qDebug() << Q_FUNC_INFO << (void*) this;
     Q_ASSERT(doc != NULL);
+
+    connect(doc, SIGNAL(fixtureAdded(quint32)), this, SLOT(slotFixturesChanged()));
+    connect(doc, SIGNAL(fixtureRemoved(quint32)), this, SLOT(slotFixturesChanged()));
+    connect(doc, SIGNAL(fixtureChanged(quint32)), this, SLOT(slotFixturesChanged()));
 }
 
 CueStack::~CueStack()
@@ -426,16 +436,13 @@ void CueStack::writeDMX(MasterTimer* timer, QList<Universe*> ua)
     Q_UNUSED(timer);
     if (isFlashing() == true && m_cues.size() > 0)
     {
-        QHashIterator <uint,uchar> it(m_cues.first().values());
-        while (it.hasNext() == true)
+        const Cue& cue(m_cues.first());
+        for (int i = 0; i < cue.channels().size(); i++)
         {
-            it.next();
-            FadeChannel fc;
-            fc.setChannel(it.key());
-            fc.setTarget(it.value());
-            int uni = floor(fc.channel() / 512);
+            uint channel = cue.channels().at(i);
+            int uni = floor(channel / 512);
             if (uni < ua.size())
-                ua[uni]->write(fc.channel() - (uni * 512), fc.target());
+                ua[uni]->write(channel - (uni * 512), cue.channelValues().at(i));
         }
     }
 }
@@ -459,6 +466,7 @@ void CueStack::preRun()
     Q_ASSERT(m_fader == NULL);
     m_fader = new GenericFader(doc());
     m_fader->adjustIntensity(intensity());
+    m_intensityMask.clear();
     m_elapsed = 0;
     emit started();
 }
@@ -476,7 +484,7 @@ void CueStack::write(QList<Universe*> ua)
         m_elapsed = 0;
         int from = m_currentIndex;
         int to = previous();
-        switchCue(from, to, ua);
+        switchCue(from, to);
         m_previous = false;
         emit currentCueChanged(m_currentIndex);
     }
@@ -486,7 +494,7 @@ void CueStack::write(QList<Universe*> ua)
         m_elapsed = 0;
         int from = m_currentIndex;
         int to = next();
-        switchCue(from, to, ua);
+        switchCue(from, to);
         m_next = false;
         emit currentCueChanged(m_currentIndex);
     }
@@ -569,7 +577,7 @@ int CueStack::next()
     return m_currentIndex;
 }
 
-void CueStack::switchCue(int from, int to, const QList<Universe *> ua)
+void CueStack::switchCue(int from, int to)
 {
     qDebug() << Q_FUNC_INFO;
 
@@ -580,70 +588,126 @@ void CueStack::switchCue(int from, int to, const QList<Universe *> ua)
         newCue = m_cues[to];
     if (from >= 0 && from < m_cues.size())
         oldCue = m_cues[from];
-    m_mutex.unlock();
-
-    // Fade out the HTP channels of the previous cue
-    QHashIterator <uint,uchar> oldit(oldCue.values());
-    while (oldit.hasNext() == true)
+    if (m_intensityMaskDirty == true)
     {
-        oldit.next();
+        m_intensityMask.clear();
+        m_intensityMaskDirty = false;
+    }
+    m_mutex.unlock();
 
-        FadeChannel fc;
-        fc.setFixture(doc(), Fixture::invalidId());
-        fc.setChannel(oldit.key());
+    const QVector <uint>& oldChannels(oldCue.channels());
+    const QVector <uchar>& oldValues(oldCue.channelValues());
+    const QVector <uint>& newChannels(newCue.channels());
+    const QVector <uchar>& newValues(newCue.channelValues());
 
-        if (fc.group(doc()) == QLCChannel::Intensity)
+    int i = 0, j = 0;
+    while (i < oldChannels.size() || j < newChannels.size())
+    {
+        if (j == newChannels.size() ||
+            (i < oldChannels.size() && oldChannels[i] < newChannels[j]))
         {
-            fc.setElapsed(0);
-            fc.setReady(false);
-            fc.setTarget(0);
-            fc.setFadeTime(oldCue.fadeOutSpeed());
-            insertStartValue(fc, ua);
-            m_fader->add(fc);
+            // Fade out the HTP channels of the previous cue
+            if (isIntensity(oldChannels[i]) == true)
+                addFade(oldChannels[i], 0, oldCue.fadeOutSpeed(), true);
+            i++;
+        }
+        else if (i == oldChannels.size() || newChannels[j] < oldChannels[i])
+        {
+            // Fade in the channels of the new cue
+            addFade(newChannels[j], newValues[j], newCue.fadeInSpeed(),
+                    isIntensity(newChannels[j]));
+            j++;
+        }
+        else
+        {
+            // Channels in both cues fade only if their value changes
+            if (oldValues[i] != newValues[j])
+            {
+                addFade(newChannels[j], newValues[j], newCue.fadeInSpeed(),
+                        isIntensity(newChannels[j]));
+            }
+            i++;
+            j++;
         }
     }
+}
 
-    // Fade in all channels of the new cue
-    QHashIterator <uint,uchar> newit(newCue.values());
-    while (newit.hasNext() == true)
-    {
-        newit.next();
-        FadeChannel fc;
+void CueStack::addFade(uint channel, uchar target, uint fadeTime, bool intensity)
+{
+    FadeChannel fc;
+    fc.setFixture(doc(), Fixture::invalidId());
+    fc.setChannel(channel);
+    fc.setTarget(target);
+    fc.setElapsed(0);
+    fc.setReady(false);
+    fc.setFadeTime(fadeTime);
+    insertStartValue(fc, intensity);
+    m_fader->add(fc);
+}
 
-        fc.setFixture(doc(), Fixture::invalidId());
-        fc.setChannel(newit.key());
-        fc.setTarget(newit.value());
-        fc.setElapsed(0);
-        fc.setReady(false);
-        fc.setFadeTime(newCue.fadeInSpeed());
-        insertStartValue(fc, ua);
-        m_fader->add(fc);
-    }
+void CueStack::insertStartValue(FadeChannel& fc)
+{
+    insertStartValue(fc, fc.group(doc()) == QLCChannel::Intensity);
 }
 
-void CueStack::insertStartValue(FadeChannel& fc, const QList<Universe *> ua)
+void CueStack::insertStartValue(FadeChannel& fc, bool intensity)
 {
-    qDebug() << Q_FUNC_INFO;
     const QHash <FadeChannel,FadeChannel>& channels(m_fader->channels());
-    if (channels.contains(fc) == true)
+    QHash <FadeChannel,FadeChannel>::const_iterator existing = channels.find(fc);
+    if (existing != channels.end())
     {
         // GenericFader contains the channel so grab its current
         // value as the new starting value to get a smoother fade
-        FadeChannel existing = channels[fc];
-        fc.setStart(existing.current());
+        fc.setStart(existing.value().current());
         fc.setCurrent(fc.start());
     }
     else
     {
-        // GenericFader didn't have the channel. Grab the starting value from UniverseArray.
-        quint32 uni = fc.universe();
-        if (uni != Universe::invalid())
+        // GenericFader didn't have the channel. Grab the starting value from
+        // the universes, as they were at the end of the previous tick.
+        // Cue channels are absolute DMX addresses.
+        if (intensity == false)
         {
-            if (fc.group(doc()) != QLCChannel::Intensity)
-                fc.setStart(ua[uni]->preGMValues()[fc.address()]);
-            else
-                fc.setStart(0); // HTP channels must start at zero
+            const UniverseSnapshot* snapshot = doc()->masterTimer()->snapshot();
+            fc.setStart(snapshot->preGMValue(fc.channel() / UNIVERSE_SIZE,
+                                             fc.channel() % UNIVERSE_SIZE));
+        }
+        else
+        {
+            fc.setStart(0); // HTP channels must start at zero
         }
         fc.setCurrent(fc.start());
     }
 }
+
+bool CueStack::isIntensity(uint address)
+{
+    // Addresses beyond the patched universes are not worth caching
+    uint size = doc()->inputOutputMap()->universes() * UNIVERSE_SIZE;
+    if (address >= size)
+    {
+        FadeChannel fc;
+        fc.setChannel(address);
+        return fc.group(doc()) == QLCChannel::Intensity;
+    }
+
+    if (uint(m_intensityMask.size()) < size)
+        m_intensityMask.append(QByteArray(size - m_intensityMask.size(), MASK_UNKNOWN));
+
+    char state = m_intensityMask.at(address);
+    if (state == MASK_UNKNOWN)
+    {
+        FadeChannel fc;
+        fc.setChannel(address);
+        state = (fc.group(doc()) == QLCChannel::Intensity) ? MASK_INTENSITY : MASK_OTHER;
+        m_intensityMask[address] = state;
+    }
+
+    return state == MASK_INTENSITY;
+}
+
+void CueStack::slotFixturesChanged()
+{
+    QMutexLocker locker(&m_mutex);
+    m_intensityMaskDirty = true;
+}
@@ -20,6 +20,7 @@
 #ifndef CUESTACK_H
 #define CUESTACK_H
 
+#include <QByteArray>
 #include <QObject>
 #include <QMutex>
 #include <QList>
@@ -248,11 +249,41 @@ public:
 private:
     int next();
     int previous();
-    void switchCue(int from, int to, const QList<Universe *> ua);
-    void insertStartValue(FadeChannel& fc, const QList<Universe*> ua);
+
+    /**
+     * Fade from cue $from to cue $to. Both cues are merged in a single pass
+     * over their sorted channels, and only the channels whose value changes
+     * get a new fade: intensity channels missing from $to fade out and the
+     * others fade in to their new values.
+     */
+    void switchCue(int from, int to);
+
+    /** Fade $channel to $target in $fadeTime ms */
+    void addFade(uint channel, uchar target, uint fadeTime, bool intensity);
+
+    /**
+     * Insert the starting value to $fc, either from m_fader or from the
+     * MasterTimer snapshot of the universes
+     */
+    void insertStartValue(FadeChannel& fc);
+    void insertStartValue(FadeChannel& fc, bool intensity);
+
+    /**
+     * Check if the channel at the absolute $address is an intensity channel.
+     * The answer is cached in m_intensityMask until the fixtures change.
+     */
+    bool isIntensity(uint address);
+
+private slots:
+    /** Forget the cached channel groups when fixtures are added, removed or changed */
+    void slotFixturesChanged();
 
 private:
     GenericFader* m_fader;
+    /** Group of the channels by absolute address, looked up only once */
+    QByteArray m_intensityMask;
+    /** Set when m_intensityMask must be cleared. Guarded by m_mutex. */
+    bool m_intensityMaskDirty;
     uint m_elapsed;
     bool m_previous;
     bool m_next;
@@ -17,6 +17,7 @@
   limitations under the License.
 */
 
+#include <QXmlStreamReader>
 #include <QStringList>
 #include <QString>
 #include <QDebug>
@@ -910,38 +911,7 @@ bool Doc::loadXML(const QDomElement& root)
     QDomNode node = root.firstChild();
     while (node.isNull() == false)
     {
-        QDomElement tag = node.toElement();
-
-        if (tag.tagName() == KXMLFixture)
-        {
-            Fixture::loader(tag, this);
-        }
-        else if (tag.tagName() == KXMLQLCFixtureGroup)
-        {
-            FixtureGroup::loader(tag, this);
-        }
-        else if (tag.tagName() == KXMLQLCChannelsGroup)
-        {
-            ChannelsGroup::loader(tag, this);
-        }
-        else if (tag.tagName() == KXMLQLCFunction)
-        {
-            Function::loader(tag, this);
-        }
-        else if (tag.tagName() == KXMLQLCBus)
-        {
-            /* LEGACY */
-            Bus::instance()->loadXML(tag);
-        }
-        else if (tag.tagName() == KXMLIOMap)
-        {
-            m_ioMap->loadXML(tag);
-        }
-        else
-        {
-            qWarning() << Q_FUNC_INFO << "Unknown engine tag:" << tag.tagName();
-        }
-
+        loadXMLElement(node.toElement());
         node = node.nextSibling();
     }
 
@@ -952,6 +922,76 @@ bool Doc::loadXML(const QDomElement& root)
     return true;
 }
 
+bool Doc::loadXML(QXmlStreamReader& reader)
+{
+    m_errorLog = "";
+
+    if (reader.isStartElement() == false || reader.name() != QLatin1String(KXMLQLCEngine))
+    {
+        qWarning() << Q_FUNC_INFO << "Engine node not found";
+        return false;
+    }
+
+    if (reader.attributes().hasAttribute(KXMLQLCStartupFunction))
+    {
+        quint32 sID = reader.attributes().value(KXMLQLCStartupFunction).toString().toUInt();
+        if (sID != Function::invalidId())
+            setStartupFunction(sID);
+    }
+
+    /* Only one element at a time is held in memory as a DOM */
+    while (reader.readNextStartElement() == true)
+    {
+        QDomDocument element = QLCFile::readXMLElement(reader);
+        loadXMLElement(element.documentElement());
+    }
+
+    if (reader.hasError() == true)
+    {
+        qWarning() << Q_FUNC_INFO << "Error loading engine:" << reader.errorString()
+                   << ", line:" << reader.lineNumber() << ", col:" << reader.columnNumber();
+    }
+
+    postLoad();
+
+    emit loaded();
+
+    return (reader.hasError() == false);
+}
+
+void Doc::loadXMLElement(const QDomElement& tag)
+{
+    if (tag.tagName() == KXMLFixture)
+    {
+        Fixture::loader(tag, this);
+    }
+    else if (tag.tagName() == KXMLQLCFixtureGroup)
+    {
+        FixtureGroup::loader(tag, this);
+    }
+    else if (tag.tagName() == KXMLQLCChannelsGroup)
+    {
+        ChannelsGroup::loader(tag, this);
+    }
+    else if (tag.tagName() == KXMLQLCFunction)
+    {
+        Function::loader(tag, this);
+    }
+    else if (tag.tagName() == KXMLQLCBus)
+    {
+        /* LEGACY */
+        Bus::instance()->loadXML(tag);
+    }
+    else if (tag.tagName() == KXMLIOMap)
+    {
+        m_ioMap->loadXML(tag);
+    }
+    else
+    {
+        qWarning() << Q_FUNC_INFO << "Unknown engine tag:" << tag.tagName();
+    }
+}
+
 bool Doc::saveXML(QDomDocument* doc, QDomElement* wksp_root)
 {
     QDomElement root;
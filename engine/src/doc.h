@@ -35,6 +35,7 @@
 #include "function.h"
 #include "fixture.h"
 
+class QXmlStreamReader;
 class QDomDocument;
 class AudioCapture;
 class QString;
@@ -43,6 +44,7 @@ class QString;
  * @{
  */
 
+#define KXMLQLCWorkspace "Workspace"
 #define KXMLQLCEngine "Engine"
 #define KXMLQLCStartupFunction "Autostart"
 
@@ -530,6 +532,18 @@ public:
      */
     bool loadXML(const QDomElement& root);
 
+    /**
+     * Load contents from an XML stream, without building the DOM of the
+     * whole document. Each Engine child, in document order, is read into
+     * a DOM of its own and loaded with the same loaders used by
+     * loadXML(QDomElement). Cross-references are resolved in postLoad().
+     *
+     * @param reader A stream reader positioned on the Engine start element.
+     *               On return, it is positioned on the Engine end element.
+     * @return true if successful, otherwise false
+     */
+    bool loadXML(QXmlStreamReader& reader);
+
     /**
      * Save contents to the given XML file.
      *
@@ -551,6 +565,9 @@ public:
     QString errorLog();
 
 private:
+    /** Load a single child element of the Engine node */
+    void loadXMLElement(const QDomElement& tag);
+
     /**
      * Calls postLoad() for each Function after everything has been loaded
      * to do post-load cleanup & mappings.
@@ -1001,7 +1001,7 @@ void EFX::write(MasterTimer* timer, QList<Universe*> universes)
             ready++;
     }
 
-    incrementElapsed();
+    incrementElapsed(tickLength(timer));
 
     /* Check for stop condition */
     if (ready == m_fixtures.count())
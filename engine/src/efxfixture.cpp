@@ -292,7 +292,8 @@ uint EFXFixture::timeOffset() const
 
 void EFXFixture::nextStep(MasterTimer* timer, QList<Universe *> universes)
 {
-    m_elapsed += MasterTimer::tick();
+    uint tick = m_parent->tickLength(timer);
+    m_elapsed += tick;
 
     // Bail out without doing anything if this fixture is ready (after single-shot)
     // or it has no pan&tilt channels (not valid).
@@ -346,7 +347,19 @@ void EFXFixture::nextStep(MasterTimer* timer, QList<Universe *> universes)
             stop(timer, universes);
         }
 
-        m_elapsed = 0;
+        // Beat-based EFX carry the time past the end of the round (up to
+        // one tick) over to the next round, so that they stay on the beat
+        if (m_parent->tempoType() == Function::Beats)
+        {
+            uint roundLength = m_parent->duration();
+            if (m_parent->propagationMode() == EFX::Serial)
+                roundLength += timeOffset();
+            m_elapsed = qMin(m_elapsed - qMin(m_elapsed, roundLength), tick);
+        }
+        else
+        {
+            m_elapsed = 0;
+        }
     }
 }
 
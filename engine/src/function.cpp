@@ -53,6 +53,9 @@ const QString KSingleShotString ( "SingleShot" );
 const QString KBackwardString   (   "Backward" );
 const QString KForwardString    (    "Forward" );
 
+const QString KTimeString       (       "Time" );
+const QString KBeatsString      (      "Beats" );
+
 /*****************************************************************************
  * Initialization
  *****************************************************************************/
@@ -70,6 +73,7 @@ Function::Function(Doc* doc, Type t)
     , m_overrideFadeInSpeed(defaultSpeed())
     , m_overrideFadeOutSpeed(defaultSpeed())
     , m_overrideDuration(defaultSpeed())
+    , m_tempoType(Time)
     , m_flashing(false)
     , m_elapsed(0)
     , m_stop(true)
@@ -105,6 +109,7 @@ bool Function::copyFrom(const Function* function)
     m_fadeInSpeed = function->fadeInSpeed();
     m_fadeOutSpeed = function->fadeOutSpeed();
     m_duration = function->duration();
+    m_tempoType = function->tempoType();
     m_path = function->path(true);
 
     emit changed(m_id);
@@ -549,6 +554,41 @@ void Function::tap()
 {
 }
 
+void Function::setTempoType(TempoType type)
+{
+    m_tempoType = type;
+    emit changed(m_id);
+}
+
+Function::TempoType Function::tempoType() const
+{
+    return m_tempoType;
+}
+
+QString Function::tempoTypeToString(TempoType type)
+{
+    if (type == Beats)
+        return KBeatsString;
+    else
+        return KTimeString;
+}
+
+Function::TempoType Function::stringToTempoType(const QString& str)
+{
+    if (str == KBeatsString)
+        return Beats;
+    else
+        return Time;
+}
+
+uint Function::tickLength(MasterTimer* timer) const
+{
+    if (m_tempoType == Beats && timer != NULL)
+        return timer->tempoClock()->tickDelta();
+    else
+        return MasterTimer::tick();
+}
+
 bool Function::loadXMLSpeed(const QDomElement& speedRoot)
 {
     if (speedRoot.tagName() != KXMLQLCFunctionSpeed)
@@ -557,6 +597,7 @@ bool Function::loadXMLSpeed(const QDomElement& speedRoot)
     m_fadeInSpeed = speedRoot.attribute(KXMLQLCFunctionSpeedFadeIn).toUInt();
     m_fadeOutSpeed = speedRoot.attribute(KXMLQLCFunctionSpeedFadeOut).toUInt();
     m_duration = speedRoot.attribute(KXMLQLCFunctionSpeedDuration).toUInt();
+    m_tempoType = stringToTempoType(speedRoot.attribute(KXMLQLCFunctionSpeedTempo));
 
     return true;
 }
@@ -569,6 +610,8 @@ bool Function::saveXMLSpeed(QDomDocument* doc, QDomElement* root) const
     tag.setAttribute(KXMLQLCFunctionSpeedFadeIn, QString::number(fadeInSpeed()));
     tag.setAttribute(KXMLQLCFunctionSpeedFadeOut, QString::number(fadeOutSpeed()));
     tag.setAttribute(KXMLQLCFunctionSpeedDuration, QString::number(duration()));
+    if (tempoType() != Time)
+        tag.setAttribute(KXMLQLCFunctionSpeedTempo, tempoTypeToString(tempoType()));
     root->appendChild(tag);
 
     return true;
@@ -730,6 +773,11 @@ void Function::postRun(MasterTimer* timer, QList<Universe *> universes)
     emit stopped(m_id);
 }
 
+bool Function::canWriteInParallel() const
+{
+    return false;
+}
+
 bool Function::isRunning() const
 {
     return m_running;
@@ -757,6 +805,15 @@ void Function::incrementElapsed()
         m_elapsed += MasterTimer::tick();
 }
 
+void Function::incrementElapsed(uint amount)
+{
+    // Saturate at UINT_MAX, the maximum fade/hold time
+    if (amount < UINT_MAX - m_elapsed)
+        m_elapsed += amount;
+    else
+        m_elapsed = UINT_MAX;
+}
+
 /*****************************************************************************
  * Start & Stop
  *****************************************************************************/
@@ -64,6 +64,7 @@ class Doc;
 #define KXMLQLCFunctionSpeedHold     "Hold"
 #define KXMLQLCFunctionSpeedFadeOut  "FadeOut"
 #define KXMLQLCFunctionSpeedDuration "Duration"
+#define KXMLQLCFunctionSpeedTempo    "Tempo"
 
 typedef struct
 {
@@ -380,6 +381,32 @@ public:
     /** Tell the function that it has been "tapped". Default implementation does nothing. */
     virtual void tap();
 
+    /** The unit of a function's duration */
+    enum TempoType
+    {
+        Time = 0,   //! Milliseconds
+        Beats       //! Thousandths of a beat of MasterTimer's TempoClock
+    };
+
+    /**
+     * Set the unit of the function's duration. Fade in/out times are always
+     * in milliseconds. Functions that don't follow the tempo ignore this.
+     */
+    void setTempoType(TempoType type);
+
+    /** Get the unit of the function's duration */
+    TempoType tempoType() const;
+
+    static QString tempoTypeToString(TempoType type);
+    static TempoType stringToTempoType(const QString& str);
+
+    /**
+     * Get the time that passes on the current tick of $timer, in the units
+     * of the function's tempo type: MasterTimer::tick() milliseconds, or
+     * the thousandths of a beat that the tempo clock advanced on this tick.
+     */
+    uint tickLength(MasterTimer* timer) const;
+
     static uint defaultSpeed();
     static uint infiniteSpeed();
 
@@ -405,6 +432,8 @@ private:
     uint m_overrideFadeOutSpeed;
     uint m_overrideDuration;
 
+    TempoType m_tempoType;
+
     /*********************************************************************
      * Fixtures
      *********************************************************************/
@@ -523,6 +552,18 @@ public:
      */
     virtual void postRun(MasterTimer* timer, QList<Universe*> universes);
 
+    /**
+     * Check if write() can be called from a MasterTimer worker thread, at
+     * the same time as write() of other functions. This is the case only if
+     * write() touches nothing but the function's own data and the universes
+     * (whose writes are then buffered), never starting or stopping other
+     * functions nor using MasterTimer's GenericFader. The first write()
+     * after preRun() is always made from the MasterTimer thread.
+     *
+     * @return true if write() is thread safe. The default is false.
+     */
+    virtual bool canWriteInParallel() const;
+
 signals:
     /**
      * Emitted when a function is started (i.e. added to MasterTimer's
@@ -559,6 +600,9 @@ protected:
     /** Increment the elapsed timer ticks by one */
     void incrementElapsed();
 
+    /** Increment the elapsed counter by $amount, e.g. a tickLength() */
+    void incrementElapsed(uint amount);
+
 private:
     quint32 m_elapsed;
 
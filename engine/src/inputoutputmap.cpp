@@ -23,6 +23,7 @@
 #   include <unistd.h>
 #endif
 
+#include <QElapsedTimer>
 #include <QDomElement>
 
 #include "inputoutputmap.h"
@@ -31,6 +32,8 @@
 #include "qlcioplugin.h"
 #include "outputpatch.h"
 #include "inputpatch.h"
+#include "mastertimer.h"
+#include "tickprofiler.h"
 #include "qlcconfig.h"
 #include "universe.h"
 #include "qlcfile.h"
@@ -218,8 +221,11 @@ void InputOutputMap::releaseUniverses(bool changed)
     m_universeMutex.unlock();
 }
 
-void InputOutputMap::dumpUniverses()
+void InputOutputMap::dumpUniverses(TickProfiler* profiler)
 {
+    /* Time spent by each plugin to write its universes */
+    QHash <QString, qint64> pluginTimes;
+
     m_universeMutex.lock();
     if (m_blackout == false)
     {
@@ -235,7 +241,17 @@ void InputOutputMap::dumpUniverses()
                     fprintf(stderr, "%d ", (unsigned char)postGM.at(d));
                 fprintf(stderr, " ----\n");
                 */
-                universe->outputPatch()->dump(universe->id(), postGM);
+                if (profiler == NULL)
+                {
+                    universe->outputPatch()->dump(universe->id(), postGM);
+                }
+                else
+                {
+                    QElapsedTimer elapsed;
+                    elapsed.start();
+                    universe->outputPatch()->dump(universe->id(), postGM);
+                    pluginTimes[universe->outputPatch()->pluginName()] += elapsed.nsecsElapsed();
+                }
 
                 m_universeMutex.unlock();
                 emit universesWritten(i, postGM);
@@ -244,6 +260,13 @@ void InputOutputMap::dumpUniverses()
         }
     }
     m_universeMutex.unlock();
+
+    QHashIterator <QString, qint64> it(pluginTimes);
+    while (it.hasNext() == true)
+    {
+        it.next();
+        profiler->addPluginSample(it.key(), it.value());
+    }
 }
 
 void InputOutputMap::resetUniverses()
@@ -342,8 +365,16 @@ bool InputOutputMap::setInputPatch(quint32 universe, const QString &pluginName,
     {
         InputPatch *ip = m_universeArray.at(universe)->inputPatch();
         if (ip != NULL)
+        {
             connect(ip, SIGNAL(inputValueChanged(quint32,quint32,uchar,const QString&)),
                     this, SIGNAL(inputValueChanged(quint32,quint32,uchar,const QString&)));
+            connect(ip, SIGNAL(beatClock(quint32,int)),
+                    this, SLOT(slotBeatClock(quint32,int)),
+                    Qt::ConnectionType(Qt::DirectConnection | Qt::UniqueConnection));
+            connect(ip, SIGNAL(timecode(quint32,quint32)),
+                    this, SLOT(slotTimecode(quint32,quint32)),
+                    Qt::ConnectionType(Qt::DirectConnection | Qt::UniqueConnection));
+        }
     }
     m_universeMutex.unlock();
     return true;
@@ -602,6 +633,36 @@ void InputOutputMap::slotPluginConfigurationChanged(QLCIOPlugin* plugin)
     emit pluginConfigurationChanged(plugin->name());
 }
 
+void InputOutputMap::slotBeatClock(quint32 universe, int event)
+{
+    TempoClock* clock = doc()->masterTimer()->tempoClock();
+    qint64 now = clock->now();
+
+    switch (event)
+    {
+    case QLCIOPlugin::BeatClockPulse:
+        clock->pulse(universe, now);
+        break;
+    case QLCIOPlugin::BeatClockStart:
+        clock->start(universe, now);
+        break;
+    case QLCIOPlugin::BeatClockContinue:
+        clock->resume(universe, now);
+        break;
+    case QLCIOPlugin::BeatClockStop:
+        clock->stop(universe, now);
+        break;
+    default:
+        break;
+    }
+}
+
+void InputOutputMap::slotTimecode(quint32 universe, quint32 msecs)
+{
+    TimecodeClock* clock = doc()->masterTimer()->midiTimecode();
+    clock->receive(universe, msecs, clock->now());
+}
+
 /*****************************************************************************
  * Profiles
  *****************************************************************************/
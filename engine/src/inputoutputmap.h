@@ -28,6 +28,7 @@
 #include "grandmaster.h"
 
 class QLCInputSource;
+class TickProfiler;
 class QLCIOPlugin;
 class OutputPatch;
 class InputPatch;
@@ -204,8 +205,11 @@ public:
     /**
      * Write current universe array data to plugins, each universe within
      * the array to its assigned plugin.
+     *
+     * @param profiler If not NULL, the time spent by each plugin is added
+     *                 to it
      */
-    void dumpUniverses();
+    void dumpUniverses(TickProfiler* profiler = NULL);
 
     /**
      * Reset all universes (useful when starting from scratch)
@@ -441,6 +445,18 @@ private slots:
    /** Slot that catches plugin configuration change notifications from UIPluginCache */
     void slotPluginConfigurationChanged(QLCIOPlugin* plugin);
 
+    /**
+     * Feed the beat clock messages of input patches to MasterTimer's tempo
+     * clock. Called directly from the plugins' input threads.
+     */
+    void slotBeatClock(quint32 universe, int event);
+
+    /**
+     * Feed the timecode messages of input patches to MasterTimer's MIDI
+     * timecode clock. Called directly from the plugins' input threads.
+     */
+    void slotTimecode(quint32 universe, quint32 msecs);
+
 signals:
     /** Notifies (OutputManager) of plugin configuration changes */
     void pluginConfigurationChanged(const QString& pluginName);
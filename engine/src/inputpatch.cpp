@@ -66,6 +66,10 @@ void InputPatch::set(QLCIOPlugin* plugin, quint32 input, QLCInputProfile* profil
     {
         disconnect(m_plugin, SIGNAL(valueChanged(quint32,quint32,uchar,QString)),
                    this, SLOT(slotValueChanged(quint32,quint32,uchar,QString)));
+        disconnect(m_plugin, SIGNAL(beatClock(quint32,int)),
+                   this, SLOT(slotBeatClock(quint32,int)));
+        disconnect(m_plugin, SIGNAL(timecode(quint32,quint32)),
+                   this, SLOT(slotTimecode(quint32,quint32)));
         m_plugin->closeInput(m_input);
     }
 
@@ -78,6 +82,11 @@ void InputPatch::set(QLCIOPlugin* plugin, quint32 input, QLCInputProfile* profil
     {
         connect(m_plugin, SIGNAL(valueChanged(quint32,quint32,uchar,QString)),
                 this, SLOT(slotValueChanged(quint32,quint32,uchar,QString)));
+        // Beat clock and timecode messages are handled in the plugin's input thread
+        connect(m_plugin, SIGNAL(beatClock(quint32,int)),
+                this, SLOT(slotBeatClock(quint32,int)), Qt::DirectConnection);
+        connect(m_plugin, SIGNAL(timecode(quint32,quint32)),
+                this, SLOT(slotTimecode(quint32,quint32)), Qt::DirectConnection);
         m_plugin->openInput(m_input);
 
         if (m_profile != NULL)
@@ -170,3 +179,15 @@ void InputPatch::slotValueChanged(quint32 input, quint32 channel, uchar value, c
     if (input == m_input)
         emit inputValueChanged(m_inputUniverse, channel, value, key);
 }
+
+void InputPatch::slotBeatClock(quint32 input, int event)
+{
+    if (input == m_input)
+        emit beatClock(m_inputUniverse, event);
+}
+
+void InputPatch::slotTimecode(quint32 input, quint32 msecs)
+{
+    if (input == m_input)
+        emit timecode(m_inputUniverse, msecs);
+}
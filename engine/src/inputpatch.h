@@ -103,8 +103,22 @@ public:
 signals:
     void inputValueChanged(quint32 inputUniverse, quint32 channel, uchar value, const QString& key = 0);
 
+    /**
+     * Forwards the plugin's beat clock messages of this patch's input line.
+     * Emitted from the plugin's input thread.
+     */
+    void beatClock(quint32 inputUniverse, int event);
+
+    /**
+     * Forwards the plugin's timecode messages of this patch's input line.
+     * Emitted from the plugin's input thread.
+     */
+    void timecode(quint32 inputUniverse, quint32 msecs);
+
 private slots:
     void slotValueChanged(quint32 input, quint32 channel, uchar value, const QString& key = 0);
+    void slotBeatClock(quint32 input, int event);
+    void slotTimecode(quint32 input, quint32 msecs);
 
 private:
     QLCIOPlugin* m_plugin;
@@ -18,6 +18,9 @@
 */
 
 #include <QDebug>
+#include <QRunnable>
+#include <QElapsedTimer>
+#include <QThreadPool>
 #include <QMutexLocker>
 
 #if defined(WIN32) || defined(Q_OS_WIN)
@@ -38,6 +41,7 @@
 #include "doc.h"
 
 #define MASTERTIMER_FREQUENCY "mastertimer/frequency"
+#define MASTERTIMER_PARALLEL "mastertimer/parallel"
 
 /** The timer tick frequency in Hertz */
 uint MasterTimer::s_frequency = 50;
@@ -50,6 +54,8 @@ uint MasterTimer::s_tick = 20;
 MasterTimer::MasterTimer(Doc* doc)
     : QObject(doc)
     , m_stopAllFunctions(false)
+    , m_parallelExecution(false)
+    , m_threadPool(new QThreadPool(this))
     , m_fader(new GenericFader(doc))
     , d_ptr(new MasterTimerPrivate(this))
 {
@@ -61,7 +67,14 @@ MasterTimer::MasterTimer(Doc* doc)
     if (var.isValid() == true)
         s_frequency = var.toUInt();
 
+    var = settings.value(MASTERTIMER_PARALLEL);
+    if (var.isValid() == true)
+        m_parallelExecution = var.toBool();
+
     s_tick = uint(double(1000) / double(s_frequency));
+
+    connect(doc, SIGNAL(functionRemoved(quint32)),
+            this, SLOT(slotFunctionRemoved(quint32)));
 }
 
 MasterTimer::~MasterTimer()
@@ -91,6 +104,9 @@ void MasterTimer::timerTick()
     Doc* doc = qobject_cast<Doc*> (parent());
     Q_ASSERT(doc != NULL);
 
+    m_tempoClock.tick(m_tempoClock.now());
+    timerTickScheduler(doc);
+
     QList<Universe *> universes = doc->inputOutputMap()->claimUniverses();
     for (int i = 0 ; i < universes.count(); i++)
     {
@@ -98,12 +114,35 @@ void MasterTimer::timerTick()
         universes[i]->zeroRelativeValues();
     }
 
+    if (m_profiler.isEnabled() == false)
+    {
+        timerTickFunctions(universes);
+        timerTickDMXSources(universes);
+        timerTickFader(universes);
+        m_snapshot.capture(universes);
+
+        doc->inputOutputMap()->releaseUniverses();
+        doc->inputOutputMap()->dumpUniverses();
+        return;
+    }
+
+    QElapsedTimer tickTimer;
+    QElapsedTimer stageTimer;
+    tickTimer.start();
+    stageTimer.start();
+
     timerTickFunctions(universes);
+    profileStage(TickProfiler::FunctionsStage, stageTimer);
     timerTickDMXSources(universes);
+    profileStage(TickProfiler::DMXSourcesStage, stageTimer);
     timerTickFader(universes);
+    profileStage(TickProfiler::FaderStage, stageTimer);
+    m_snapshot.capture(universes);
 
     doc->inputOutputMap()->releaseUniverses();
-    doc->inputOutputMap()->dumpUniverses();
+    doc->inputOutputMap()->dumpUniverses(&m_profiler);
+    profileStage(TickProfiler::OutputStage, stageTimer);
+    profileStage(TickProfiler::TickStage, tickTimer);
 }
 
 uint MasterTimer::frequency()
@@ -166,24 +205,26 @@ void MasterTimer::fadeAndStopAll(int timeout)
 
     QList<FadeChannel> fcList;
 
-    QList<Universe *> universes = doc->inputOutputMap()->claimUniverses();
-    for (int i = 0; i < universes.count(); i++)
+    // The snapshot is captured with the universes claimed
+    doc->inputOutputMap()->claimUniverses();
+    for (int i = 0; i < m_snapshot.universes(); i++)
     {
-        QHashIterator <int,uchar> it(universes[i]->intensityChannels());
-        while (it.hasNext() == true)
+        for (quint32 address = 0; address < UNIVERSE_SIZE; address++)
         {
-            it.next();
+            if (m_snapshot.isIntensity(i, address) == false)
+                continue;
 
-            Fixture* fxi = doc->fixture(doc->fixtureForAddress(it.key()));
+            quint32 absAddress = (i * UNIVERSE_SIZE) + address;
+            Fixture* fxi = doc->fixture(doc->fixtureForAddress(absAddress));
             if (fxi != NULL)
             {
-                uint ch = it.key() - fxi->universeAddress();
+                uint ch = absAddress - fxi->universeAddress();
                 if (fxi->channelCanFade(ch))
                 {
                     FadeChannel fc;
                     fc.setFixture(doc, fxi->id());
                     fc.setChannel(ch);
-                    fc.setStart(it.value());
+                    fc.setStart(m_snapshot.preGMValue(i, address));
                     fc.setTarget(0);
                     fc.setFadeTime(timeout);
                     fcList.append(fc);
@@ -207,14 +248,158 @@ int MasterTimer::runningFunctions() const
     return m_functionList.size();
 }
 
+void MasterTimer::setParallelExecution(bool enable)
+{
+    m_parallelExecution = enable;
+}
+
+bool MasterTimer::parallelExecution() const
+{
+    return m_parallelExecution;
+}
+
+/** Write $function, timing it with $profiler unless it's NULL */
+static inline void writeFunction(MasterTimer* timer, Function* function,
+                                 const QList<Universe *>& universes,
+                                 TickProfiler* profiler)
+{
+    if (profiler == NULL)
+    {
+        function->write(timer, universes);
+    }
+    else
+    {
+        QElapsedTimer elapsed;
+        elapsed.start();
+        function->write(timer, universes);
+        profiler->addFunctionSample(function->id(), elapsed.nsecsElapsed());
+    }
+}
+
+/**
+ * Writes a range of the functions to be written in parallel in a worker
+ * thread, capturing the universe writes of each function into its buffer.
+ * NULL functions are written serially by MasterTimer, or have been stopped,
+ * and are skipped.
+ */
+class FunctionWriter : public QRunnable
+{
+public:
+    FunctionWriter(MasterTimer* timer, TickProfiler* profiler,
+                   const QList<Universe *>& universes,
+                   Function* const* functions, UniverseWriteBuffer* buffers,
+                   int from, int to)
+        : m_timer(timer)
+        , m_profiler(profiler)
+        , m_universes(universes)
+        , m_functions(functions)
+        , m_buffers(buffers)
+        , m_from(from)
+        , m_to(to)
+    {
+    }
+
+    void run()
+    {
+        for (int i = m_from; i < m_to; i++)
+        {
+            if (m_functions[i] == NULL)
+                continue;
+
+            UniverseWriteBuffer::setCurrent(&m_buffers[i]);
+            writeFunction(m_timer, m_functions[i], m_universes, m_profiler);
+        }
+
+        UniverseWriteBuffer::setCurrent(NULL);
+    }
+
+private:
+    MasterTimer* m_timer;
+    TickProfiler* m_profiler;
+    const QList<Universe *> m_universes;
+    Function* const* m_functions;
+    UniverseWriteBuffer* m_buffers;
+    const int m_from;
+    const int m_to;
+};
+
+bool MasterTimer::prepareParallelWrite()
+{
+    int count = 0;
+
+    /* m_functionList is modified only by this thread, so it's safe
+       to go thru it here while the list mutex is locked by the caller */
+    m_parallelFunctions.fill(NULL, m_functionList.size());
+    if (m_writeBuffers.size() < m_functionList.size())
+        m_writeBuffers.resize(m_functionList.size());
+
+    for (int i = 0; i < m_functionList.size(); i++)
+    {
+        Function* function = m_functionList.at(i);
+
+        m_writeBuffers[i].clear();
+
+        // The first write after preRun() is made by the start queue, so
+        // elapsed() is zero only for functions that haven't been written yet
+        if (function != NULL && function->stopped() == false &&
+            function->elapsed() > 0 && function->canWriteInParallel() == true)
+        {
+            m_parallelFunctions[i] = function;
+            count++;
+        }
+    }
+
+    // Not worth the thread switches
+    if (count < 2)
+    {
+        m_parallelFunctions.fill(NULL);
+        return false;
+    }
+
+    return true;
+}
+
+void MasterTimer::writeFunctionsInParallel(QList<Universe *> universes)
+{
+    TickProfiler* profiler = m_profiler.isEnabled() ? &m_profiler : NULL;
+    int threads = qMax(1, m_threadPool->maxThreadCount());
+    int size = m_parallelFunctions.size();
+    int step = (size + threads - 1) / threads;
+
+    for (int from = 0; from < size; from += step)
+    {
+        m_threadPool->start(new FunctionWriter(this, profiler, universes,
+                                               m_parallelFunctions.constData(),
+                                               m_writeBuffers.data(),
+                                               from, qMin(from + step, size)));
+    }
+    m_threadPool->waitForDone();
+}
+
 void MasterTimer::timerTickFunctions(QList<Universe *> universes)
 {
     // List of m_functionList indices that should be removed at the end of this
     // function. The functions at the indices have been stopped.
     QList <int> removeList;
 
+    TickProfiler* profiler = m_profiler.isEnabled() ? &m_profiler : NULL;
+
     /* Lock before accessing the running functions list. */
     m_functionListMutex.lock();
+
+    // In parallel execution, the loop below only decides whether each function
+    // that can be written in parallel is written or post-run, at the same point
+    // as in serial execution. Those functions are then written together on the
+    // thread pool. The writes of all the functions are captured into their
+    // buffers and applied in the order of the list, so that the HTP/LTP
+    // results don't change.
+    bool parallel = false;
+    if (m_parallelExecution == true && m_stopAllFunctions == false)
+        parallel = prepareParallelWrite();
+
+    if (parallel == true)
+        UniverseWriteBuffer::setCaptureEnabled(true);
+
     for (int i = 0; i < m_functionList.size(); i++)
     {
         Function* function = m_functionList.at(i);
@@ -227,13 +412,29 @@ void MasterTimer::timerTickFunctions(QList<Universe *> universes)
             /* Run the function unless it's supposed to be stopped */
             if (function->stopped() == false && m_stopAllFunctions == false)
             {
-                function->write(this, universes);
+                if (parallel == false)
+                {
+                    writeFunction(this, function, universes, profiler);
+                }
+                else if (m_parallelFunctions.at(i) != function)
+                {
+                    UniverseWriteBuffer::setCurrent(&m_writeBuffers[i]);
+                    writeFunction(this, function, universes, profiler);
+                    UniverseWriteBuffer::setCurrent(NULL);
+                }
             }
             else
             {
                 /* Function should be stopped instead */
+                if (parallel == true)
+                    m_parallelFunctions[i] = NULL;
+
                 m_functionListMutex.lock();
+                if (parallel == true)
+                    UniverseWriteBuffer::setCurrent(&m_writeBuffers[i]);
                 function->postRun(this, universes);
+                if (parallel == true)
+                    UniverseWriteBuffer::setCurrent(NULL);
                 //qDebug() << "[MasterTimer] Add function (ID: " << function->id() << ") to remove list ";
                 removeList << i; // Don't remove the item from the list just yet.
                 m_functionListMutex.unlock();
@@ -245,6 +446,15 @@ void MasterTimer::timerTickFunctions(QList<Universe *> universes)
         m_functionListMutex.lock();
     }
 
+    if (parallel == true)
+    {
+        writeFunctionsInParallel(universes);
+        UniverseWriteBuffer::setCaptureEnabled(false);
+
+        for (int i = 0; i < m_parallelFunctions.size(); i++)
+            m_writeBuffers.at(i).apply();
+    }
+
     // Remove functions that need to be removed AFTER all functions have been run
     // for this round. This is done separately to prevent a case when a function
     // is first removed and then another is added (chaser, for example), keeping the
@@ -257,8 +467,14 @@ void MasterTimer::timerTickFunctions(QList<Universe *> universes)
     while (it.hasPrevious() == true)
         m_functionList.removeAt(it.previous());
 
-    foreach (Function* f, m_startQueue)
+    // Drain the start queue until it's empty, instead of iterating a copy of it.
+    // Functions started by other functions while those are being started (like
+    // nested collections starting their children) are then pre-run and written
+    // on this same tick, parents before children, instead of adding one tick of
+    // latency per nesting level.
+    while (m_startQueue.isEmpty() == false)
     {
+        Function* f = m_startQueue.first();
         //qDebug() << "[MasterTimer] Processing ID: " << f->id();
         if (m_functionList.contains(f) == false)
         {
@@ -266,7 +482,7 @@ void MasterTimer::timerTickFunctions(QList<Universe *> universes)
             m_functionListMutex.unlock();
             //qDebug() << "[MasterTimer] Starting up ID: " << f->id();
             f->preRun(this);
-            f->write(this, universes);
+            writeFunction(this, f, universes, profiler);
             emit functionListChanged();
             m_functionListMutex.lock();
         }
@@ -292,6 +508,7 @@ void MasterTimer::registerDMXSource(DMXSource* source, QString name)
             m_dmxSourceList.append(source);
         else
             m_dmxSourceList.insert(m_dmxSourceList.count() - 1, source);
+        m_dmxSourceNames[source] = name;
     }
 }
 
@@ -301,10 +518,15 @@ void MasterTimer::unregisterDMXSource(DMXSource* source)
 
     QMutexLocker lock(&m_dmxSourceListMutex);
     m_dmxSourceList.removeAll(source);
+    m_dmxSourceNames.remove(source);
 }
 
 void MasterTimer::timerTickDMXSources(QList<Universe *> universes)
 {
+    /* Time spent by the sources, by the name they were registered with */
+    QHash <QString, qint64> sourceTimes;
+    bool profile = m_profiler.isEnabled();
+
     /* Lock before accessing the DMX sources list. */
     m_dmxSourceListMutex.lock();
     for (int i = 0; i < m_dmxSourceList.size(); i++)
@@ -312,6 +534,20 @@ void MasterTimer::timerTickDMXSources(QList<Universe *> universes)
         DMXSource* source = m_dmxSourceList.at(i);
         Q_ASSERT(source != NULL);
 
+        if (profile == true)
+        {
+            QString name = m_dmxSourceNames.value(source);
+            m_dmxSourceListMutex.unlock();
+
+            QElapsedTimer elapsed;
+            elapsed.start();
+            source->writeDMX(this, universes);
+            sourceTimes[name] += elapsed.nsecsElapsed();
+
+            m_dmxSourceListMutex.lock();
+            continue;
+        }
+
         /* No need to access the list on this round anymore. */
         m_dmxSourceListMutex.unlock();
 
@@ -324,6 +560,13 @@ void MasterTimer::timerTickDMXSources(QList<Universe *> universes)
 
     /* No more sources. Get out and wait for next timer event. */
     m_dmxSourceListMutex.unlock();
+
+    QHashIterator <QString, qint64> it(sourceTimes);
+    while (it.hasNext() == true)
+    {
+        it.next();
+        m_profiler.addDMXSourceSample(it.key(), it.value());
+    }
 }
 
 /****************************************************************************
@@ -342,3 +585,76 @@ void MasterTimer::timerTickFader(QList<Universe *> universes)
 
     fader()->write(universes);
 }
+
+/****************************************************************************
+ * Profiling
+ ****************************************************************************/
+
+TickProfiler* MasterTimer::profiler()
+{
+    return &m_profiler;
+}
+
+void MasterTimer::profileStage(TickProfiler::Stage stage, QElapsedTimer& timer)
+{
+    m_profiler.addStageSample(stage, timer.nsecsElapsed());
+    timer.start();
+}
+
+void MasterTimer::slotFunctionRemoved(quint32 id)
+{
+    m_profiler.removeFunction(id);
+}
+
+/****************************************************************************
+ * Snapshot
+ ****************************************************************************/
+
+const UniverseSnapshot* MasterTimer::snapshot() const
+{
+    return &m_snapshot;
+}
+
+/****************************************************************************
+ * Tempo
+ ****************************************************************************/
+
+TempoClock* MasterTimer::tempoClock()
+{
+    return &m_tempoClock;
+}
+
+/****************************************************************************
+ * Timecode
+ ****************************************************************************/
+
+TimecodeClock* MasterTimer::midiTimecode()
+{
+    return &m_midiTimecode;
+}
+
+TimecodeClock* MasterTimer::linearTimecode()
+{
+    return &m_linearTimecode;
+}
+
+/****************************************************************************
+ * Scheduler
+ ****************************************************************************/
+
+Scheduler* MasterTimer::scheduler()
+{
+    return &m_scheduler;
+}
+
+void MasterTimer::timerTickScheduler(Doc* doc)
+{
+    QList<quint32> due = m_scheduler.poll(m_scheduler.now());
+
+    foreach (quint32 fid, due)
+    {
+        Function* function = doc->function(fid);
+        if (function != NULL)
+            function->start(this);
+    }
+}
@@ -21,12 +21,22 @@
 #define MASTERTIMER_H
 
 #include <QObject>
+#include <QVector>
 #include <QMutex>
 #include <QList>
 #include <QTime>
 
+#include "universewritebuffer.h"
+#include "universesnapshot.h"
+#include "tickprofiler.h"
+#include "timecodeclock.h"
+#include "scheduler.h"
+#include "tempoclock.h"
+
 class MasterTimerPrivate;
+class QElapsedTimer;
 class GenericFader;
+class QThreadPool;
 class DMXSource;
 class Function;
 class Universe;
@@ -85,7 +95,12 @@ private:
      * Functions
      *********************************************************************/
 public:
-    /** Start running the given function */
+    /**
+     * Start running the given function. The function is pre-run and
+     * written on the next tick. Functions started while a tick is being
+     * processed (e.g. by a collection or a chaser) are pre-run and written
+     * on that same tick, after the function that started them.
+     */
     virtual void startFunction(Function* function);
 
     /** Stop all functions. Doesn't affect registered DMX sources. */
@@ -97,6 +112,20 @@ public:
     /** Get the number of currently running functions */
     int runningFunctions() const;
 
+    /**
+     * Enable or disable parallel execution of functions. When enabled,
+     * running functions that support it (see Function::canWriteInParallel())
+     * are written on worker threads, each one into its own write buffer,
+     * after the other functions have been written. Whether each function
+     * is written or stopped is decided at the same point as in serial
+     * execution, and all the writes are applied to universes in the order
+     * the functions were started, so that the results are the same.
+     */
+    void setParallelExecution(bool enable);
+
+    /** Check if parallel execution of functions is enabled */
+    bool parallelExecution() const;
+
 signals:
     /** Tells that the list of running functions has changed */
     void functionListChanged();
@@ -105,6 +134,22 @@ private:
     /** Execute one timer tick for each registered Function */
     void timerTickFunctions(QList<Universe *> universes);
 
+    /**
+     * Prepare a parallel tick: clear m_writeBuffers and fill
+     * m_parallelFunctions with the running functions that can be written
+     * in parallel, at the same indices as in m_functionList, and NULL for
+     * the functions that must be written serially.
+     *
+     * @return true if enough functions can be written in parallel
+     */
+    bool prepareParallelWrite();
+
+    /**
+     * Write the functions in m_parallelFunctions into their buffers in
+     * m_writeBuffers, on the thread pool.
+     */
+    void writeFunctionsInParallel(QList<Universe *> universes);
+
 private:
     /** List of currently running functions */
     QList <Function*> m_functionList;
@@ -116,6 +161,18 @@ private:
     /** Flag for stopping all functions */
     bool m_stopAllFunctions;
 
+    /** Flag for parallel execution of functions */
+    bool m_parallelExecution;
+
+    /** Worker threads for parallel execution of functions */
+    QThreadPool* m_threadPool;
+
+    /** The functions written in parallel on this tick, by m_functionList index */
+    QVector <Function*> m_parallelFunctions;
+
+    /** The writes of each running function on a parallel tick, by m_functionList index */
+    QVector <UniverseWriteBuffer> m_writeBuffers;
+
     /*************************************************************************
      * DMX Sources
      *************************************************************************/
@@ -145,6 +202,9 @@ private:
     /** List of currently registered DMX sources */
     QList <DMXSource*> m_dmxSourceList;
 
+    /** The names that the DMX sources have been registered with */
+    QHash <DMXSource*, QString> m_dmxSourceNames;
+
     /** Mutex that guards access to m_dmxSourceList 
      *
      * In case both m_functionListMutex and m_dmxSourceListMutex are needed,
@@ -170,6 +230,87 @@ private:
 private:
     GenericFader* m_fader;
 
+    /*************************************************************************
+     * Profiling
+     *************************************************************************/
+public:
+    /**
+     * Get the profiler that collects the time spent in each tick stage,
+     * running function, DMX source and output plugin. The profiler is
+     * disabled by default.
+     */
+    TickProfiler* profiler();
+
+private:
+    /** Add a sample for $stage with the time elapsed on $timer and restart it */
+    void profileStage(TickProfiler::Stage stage, QElapsedTimer& timer);
+
+private slots:
+    /** Drop the samples of a function deleted from Doc */
+    void slotFunctionRemoved(quint32 id);
+
+private:
+    TickProfiler m_profiler;
+
+    /*************************************************************************
+     * Snapshot
+     *************************************************************************/
+public:
+    /**
+     * Get the values of all universes as of the end of the last tick.
+     * Functions use it to read the universes without claiming them, e.g.
+     * to get the starting values of their fades.
+     */
+    const UniverseSnapshot* snapshot() const;
+
+private:
+    UniverseSnapshot m_snapshot;
+
+    /*************************************************************************
+     * Tempo
+     *************************************************************************/
+public:
+    /**
+     * Get the engine tempo clock. Its beat position is sampled at the
+     * beginning of each tick, before running functions.
+     */
+    TempoClock* tempoClock();
+
+private:
+    TempoClock m_tempoClock;
+
+    /*************************************************************************
+     * Timecode
+     *************************************************************************/
+public:
+    /** Get the clock that chases the MIDI Time Code received on input universes */
+    TimecodeClock* midiTimecode();
+
+    /** Get the clock that chases the LTC decoded from the audio input */
+    TimecodeClock* linearTimecode();
+
+private:
+    TimecodeClock m_midiTimecode;
+    TimecodeClock m_linearTimecode;
+
+    /*************************************************************************
+     * Scheduler
+     *************************************************************************/
+public:
+    /**
+     * Get the scheduler that starts functions at given times of the day.
+     * It is polled at the beginning of each tick, so scheduled functions
+     * start running on the same tick.
+     */
+    Scheduler* scheduler();
+
+private:
+    /** Start the functions that the scheduler says are due */
+    void timerTickScheduler(Doc* doc);
+
+private:
+    Scheduler m_scheduler;
+
 private:
     MasterTimerPrivate* d_ptr;
 };
@@ -17,6 +17,7 @@
   limitations under the License.
 */
 
+#include <QXmlStreamReader>
 #include <QFile>
 #include <QtXml>
 
@@ -66,6 +67,65 @@ QDomDocument QLCFile::readXML(const QString& path)
     return doc;
 }
 
+QDomDocument QLCFile::readXMLElement(QXmlStreamReader& reader)
+{
+    QDomDocument doc;
+
+    if (reader.isStartElement() == false)
+        return doc;
+
+    QDomElement parent;
+    QString whitespace;
+    int depth = 0;
+
+    while (reader.hasError() == false)
+    {
+        switch (reader.tokenType())
+        {
+            case QXmlStreamReader::StartElement:
+            {
+                QDomElement tag = doc.createElement(reader.qualifiedName().toString());
+                foreach (QXmlStreamAttribute attr, reader.attributes())
+                    tag.setAttribute(attr.qualifiedName().toString(), attr.value().toString());
+                if (depth == 0)
+                    doc.appendChild(tag);
+                else
+                    parent.appendChild(tag);
+                parent = tag;
+                whitespace.clear();
+                depth++;
+            }
+            break;
+            case QXmlStreamReader::EndElement:
+                /* Keep whitespace only when it's the whole content of the
+                   element (e.g. a name made of spaces), not indentation */
+                if (whitespace.isEmpty() == false && parent.hasChildNodes() == false)
+                    parent.appendChild(doc.createTextNode(whitespace));
+                whitespace.clear();
+                parent = parent.parentNode().toElement();
+                depth--;
+            break;
+            case QXmlStreamReader::Characters:
+                if (reader.isCDATA() == true)
+                    parent.appendChild(doc.createCDATASection(reader.text().toString()));
+                else if (reader.isWhitespace() == true)
+                    whitespace += reader.text().toString();
+                else
+                    parent.appendChild(doc.createTextNode(reader.text().toString()));
+            break;
+            default:
+            break;
+        }
+
+        if (depth == 0)
+            break;
+
+        reader.readNext();
+    }
+
+    return doc;
+}
+
 QDomDocument QLCFile::getXMLHeader(const QString& content, const QString& author)
 {
     if (content.isEmpty() == true)
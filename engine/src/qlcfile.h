@@ -22,6 +22,7 @@
 
 #include <QFile>
 
+class QXmlStreamReader;
 class QDomDocument;
 class QDomElement;
 class QString;
@@ -34,6 +35,7 @@ class QString;
 #define KExtFixture      ".qxf" // 'Q'LC+ 'X'ml 'F'ixture
 #define KExtFixtureList  ".qxfl" // 'Q'LC+ 'X'ml 'F'ixture 'L'ist
 #define KExtWorkspace    ".qxw" // 'Q'LC+ 'X'ml 'W'orkspace
+#define KExtWorkspaceSnapshot ".qxs" // 'Q'LC+ workspace 'S'napshot (binary)
 #define KExtInputProfile ".qxi" // 'Q'LC+ 'X'ml 'I'nput profile
 #if defined(WIN32) || defined(Q_OS_WIN)
 #   define KExtPlugin    ".dll" // Dynamic-Link Library
@@ -66,6 +68,19 @@ public:
      */
     static QDomDocument readXML(const QString& path);
 
+    /**
+     * Read the element at the current position of a stream reader, with
+     * all its children, into a standalone QDomDocument whose document
+     * element is the read element. Tokens are turned into DOM nodes as
+     * they are read, so the element is parsed only once. As with
+     * readXML(), namespaces are not processed and indentation is dropped.
+     * On return, the reader is positioned on the element's end tag.
+     *
+     * @param reader A stream reader positioned on a start element
+     * @return QDomDocument (null doc if not on a start element)
+     */
+    static QDomDocument readXMLElement(QXmlStreamReader& reader);
+
     /**
      * Get a common XML file header as a QDomDocument
      *
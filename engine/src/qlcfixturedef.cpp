@@ -92,6 +92,11 @@ void QLCFixtureDef::setDefinitionSourceFile(const QString &absPath)
     m_isLoaded = false;
 }
 
+QString QLCFixtureDef::definitionSourceFile() const
+{
+    return m_defFileAbsolutePath;
+}
+
 /****************************************************************************
  * General properties
  ****************************************************************************/
@@ -143,6 +148,16 @@ QString QLCFixtureDef::author()
     return m_author;
 }
 
+bool QLCFixtureDef::isLoaded() const
+{
+    return (m_isLoaded == true || m_defFileAbsolutePath.isEmpty() == true);
+}
+
+void QLCFixtureDef::setLoaded()
+{
+    m_isLoaded = true;
+}
+
 void QLCFixtureDef::checkLoaded()
 {
     // Already loaded ? Nothing to do
@@ -159,10 +174,7 @@ void QLCFixtureDef::checkLoaded()
         qDebug() << "Loading fixture definition now... " << m_defFileAbsolutePath;
         bool error = loadXML(m_defFileAbsolutePath);
         if (error == false)
-        {
             m_isLoaded = true;
-            m_defFileAbsolutePath = QString();
-        }
     }
 }
 
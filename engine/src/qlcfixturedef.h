@@ -88,9 +88,16 @@ public:
      * Fixture information
      *********************************************************************/
 public:
-    /** Set the temporary definition file absolute path */
+    /**
+     * Set the absolute path of the file the definition comes from. Its
+     * contents are read from the file on first use, unless setLoaded()
+     * is called.
+     */
     void setDefinitionSourceFile(const QString& absPath);
 
+    /** Get the definition file absolute path (empty if not from a file) */
+    QString definitionSourceFile() const;
+
     /** Get the fixture's name string (=="manufacturer model") */
     QString name() const;
 
@@ -118,6 +125,19 @@ public:
     /** Get the definition's author */
     QString author();
 
+    /**
+     * Check if the definition contents are available in memory, i.e.
+     * they don't need to be read from the definition source file.
+     */
+    bool isLoaded() const;
+
+    /**
+     * Mark the definition contents as loaded, so that the definition
+     * source file is not read anymore. Used when channels and modes
+     * are filled from another source, like a workspace snapshot.
+     */
+    void setLoaded();
+
 private:
     void checkLoaded();
 
@@ -18,6 +18,12 @@
 */
 
 #include <QCoreApplication>
+#include <QDataStream>
+#include <QThreadPool>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QDateTime>
+#include <QVector>
 #include <QList>
 #include <QDebug>
 #include <QSet>
@@ -37,6 +43,107 @@
 #define FIXTURES_MAP_NAME "FixturesMap.xml"
 #define KXMLQLCFixtureMap "FixturesMap"
 
+#define FIXTURES_INDEX_NAME    "FixturesIndex.dat"
+#define FIXTURES_INDEX_MAGIC   0x514C4349 // "QLCI"
+#define FIXTURES_INDEX_VERSION 1
+
+/**
+ * An entry of the definition index: the manufacturer & model found in a
+ * definition file, valid as long as the file size & time don't change.
+ */
+struct FixtureIndexEntry
+{
+    qint64 size;
+    QDateTime modified;
+    QString manufacturer;
+    QString model;
+};
+
+/**
+ * Parses a QLC native fixture definition in a worker thread
+ */
+class FixtureDefParser : public QRunnable
+{
+public:
+    FixtureDefParser(const QString& path, QLCFixtureDef** result)
+        : m_path(path)
+        , m_result(result)
+    {
+    }
+
+    void run()
+    {
+        QLCFixtureDef* def = new QLCFixtureDef();
+        QFile::FileError error = def->loadXML(m_path);
+        if (error == QFile::NoError)
+        {
+            def->setDefinitionSourceFile(m_path);
+            def->setLoaded();
+            *m_result = def;
+        }
+        else
+        {
+            qWarning() << Q_FUNC_INFO << "Fixture definition loading from"
+                       << m_path << "failed:" << QLCFile::errorString(error);
+            delete def;
+        }
+    }
+
+private:
+    const QString m_path;
+    QLCFixtureDef** m_result;
+};
+
+static QHash <QString, FixtureIndexEntry> readIndex(const QString& path)
+{
+    QHash <QString, FixtureIndexEntry> index;
+
+    QFile file(path);
+    if (file.open(QIODevice::ReadOnly) == false)
+        return index;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_6);
+
+    quint32 magic = 0, version = 0, count = 0;
+    stream >> magic >> version >> count;
+    if (magic != FIXTURES_INDEX_MAGIC || version != FIXTURES_INDEX_VERSION)
+        return index;
+
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; i++)
+    {
+        QString fileName;
+        FixtureIndexEntry entry;
+        stream >> fileName >> entry.size >> entry.modified >> entry.manufacturer >> entry.model;
+        index[fileName] = entry;
+    }
+
+    if (stream.status() != QDataStream::Ok)
+        index.clear();
+
+    return index;
+}
+
+static void writeIndex(const QString& path, const QHash <QString, FixtureIndexEntry>& index)
+{
+    QFile file(path);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate) == false)
+        return;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_6);
+    stream << quint32(FIXTURES_INDEX_MAGIC) << quint32(FIXTURES_INDEX_VERSION)
+           << quint32(index.size());
+
+    QHashIterator <QString, FixtureIndexEntry> it(index);
+    while (it.hasNext() == true)
+    {
+        it.next();
+        stream << it.key() << it.value().size << it.value().modified
+               << it.value().manufacturer << it.value().model;
+    }
+}
+
 QLCFixtureDefCache::QLCFixtureDefCache()
 {
 }
@@ -49,51 +156,22 @@ QLCFixtureDefCache::~QLCFixtureDefCache()
 QLCFixtureDef* QLCFixtureDefCache::fixtureDef(
     const QString& manufacturer, const QString& model) const
 {
-    QListIterator <QLCFixtureDef*> it(m_defs);
-    while (it.hasNext() == true)
-    {
-        QLCFixtureDef* def = it.next();
-        if (def->manufacturer() == manufacturer && def->model() == model)
-            return def;
-    }
+    QHash <QString, QHash <QString, QLCFixtureDef*> >::const_iterator it =
+                                                    m_models.constFind(manufacturer);
+    if (it == m_models.constEnd())
+        return NULL;
 
-    return NULL;
+    return it.value().value(model, NULL);
 }
 
 QStringList QLCFixtureDefCache::manufacturers() const
 {
-    QSet <QString> makers;
-
-    // Gather a list of manufacturers
-    QListIterator <QLCFixtureDef*> it(m_defs);
-    while (it.hasNext() == true)
-        makers << it.next()->manufacturer();
-
-    // Bounce the QSet into a QStringList
-    QStringList list;
-    foreach (QString manuf, makers)
-        list << manuf;
-
-    return list;
+    return m_models.keys();
 }
 
 QStringList QLCFixtureDefCache::models(const QString& manufacturer) const
 {
-    QSet <QString> models;
-    QListIterator <QLCFixtureDef*> it(m_defs);
-    while (it.hasNext() == true)
-    {
-        QLCFixtureDef* def = it.next();
-        if (def->manufacturer() == manufacturer)
-            models << def->model();
-    }
-
-    // Bounce the QSet into a QStringList
-    QStringList list;
-    foreach (QString manuf, models)
-        list << manuf;
-
-    return list;
+    return m_models.value(manufacturer).keys();
 }
 
 bool QLCFixtureDefCache::addFixtureDef(QLCFixtureDef* fixtureDef)
@@ -101,9 +179,11 @@ bool QLCFixtureDefCache::addFixtureDef(QLCFixtureDef* fixtureDef)
     if (fixtureDef == NULL)
         return false;
 
-    if (models(fixtureDef->manufacturer()).contains(fixtureDef->model()) == false)
+    QHash <QString, QLCFixtureDef*>& models = m_models[fixtureDef->manufacturer()];
+    if (models.contains(fixtureDef->model()) == false)
     {
         m_defs << fixtureDef;
+        models[fixtureDef->model()] = fixtureDef;
         return true;
     }
     else
@@ -126,32 +206,97 @@ bool QLCFixtureDefCache::storeFixtureDef(QString filename, QString data)
     file.close();
 
     // reload user definitions
-    load(userDefinitionDirectory());
+    load(userDefinitionDirectory(), true);
 
     return true;
 }
 
-bool QLCFixtureDefCache::load(const QDir& dir)
+bool QLCFixtureDefCache::load(const QDir& dir, bool useIndex)
 {
     qDebug() << Q_FUNC_INFO << dir.path();
 
     if (dir.exists() == false || dir.isReadable() == false)
         return false;
 
+    QHash <QString, FixtureIndexEntry> index;
+    QHash <QString, FixtureIndexEntry> newIndex;
+    if (useIndex == true)
+        index = readIndex(indexPath(dir));
+
+    QStringList parsePaths;
+
     /* Attempt to read all specified files from the given directory */
     QStringListIterator it(dir.entryList());
     while (it.hasNext() == true)
     {
-        QString path(dir.absoluteFilePath(it.next()));
+        QString fileName(it.next());
+        QString path(dir.absoluteFilePath(fileName));
 
-        if (path.toLower().endsWith(KExtFixture) == true)
-            loadQXF(path);
+        if (fileName == FIXTURES_INDEX_NAME)
+        {
+            continue;
+        }
+        else if (path.toLower().endsWith(KExtFixture) == true)
+        {
+            QFileInfo info(path);
+            QHash <QString, FixtureIndexEntry>::const_iterator entry = index.constFind(fileName);
+            if (entry != index.constEnd() && entry.value().size == info.size() &&
+                entry.value().modified == info.lastModified())
+            {
+                /* Unchanged since it was indexed: parse it only when used */
+                QLCFixtureDef* fxi = new QLCFixtureDef();
+                fxi->setDefinitionSourceFile(path);
+                fxi->setManufacturer(entry.value().manufacturer);
+                fxi->setModel(entry.value().model);
+
+                /* Delete the def if it's a duplicate. */
+                if (addFixtureDef(fxi) == false)
+                    delete fxi;
+
+                newIndex[fileName] = entry.value();
+            }
+            else
+            {
+                parsePaths << path;
+            }
+        }
         else if (path.toLower().endsWith(KExtAvolitesFixture) == true)
+        {
             loadD4(path);
+        }
         else
+        {
             qWarning() << Q_FUNC_INFO << "Unrecognized fixture extension:" << path;
+        }
+    }
+
+    QList <QLCFixtureDef*> parsed = loadQXF(parsePaths);
+    for (int i = 0; i < parsed.size(); i++)
+    {
+        QLCFixtureDef* fxi = parsed.at(i);
+        if (fxi == NULL)
+            continue;
+
+        if (useIndex == true)
+        {
+            QFileInfo info(parsePaths.at(i));
+            FixtureIndexEntry entry;
+            entry.size = info.size();
+            entry.modified = info.lastModified();
+            entry.manufacturer = fxi->manufacturer();
+            entry.model = fxi->model();
+            newIndex[info.fileName()] = entry;
+        }
+
+        /* Delete the def if it's a duplicate. */
+        if (addFixtureDef(fxi) == false)
+            delete fxi;
     }
 
+    /* Rewrite the index only when some definition has changed */
+    if (useIndex == true && (parsePaths.isEmpty() == false || newIndex.size() != index.size()))
+        writeIndex(indexPath(dir), newIndex);
+
     return true;
 }
 
@@ -240,6 +385,7 @@ bool QLCFixtureDefCache::loadMap(const QDir &dir)
 
 void QLCFixtureDefCache::clear()
 {
+    m_models.clear();
     while (m_defs.isEmpty() == false)
         delete m_defs.takeFirst();
 }
@@ -297,26 +443,23 @@ QDir QLCFixtureDefCache::userDefinitionDirectory()
     return dir;
 }
 
-void QLCFixtureDefCache::loadQXF(const QString& path)
+QString QLCFixtureDefCache::indexPath(const QDir& dir)
 {
-    QLCFixtureDef* fxi = new QLCFixtureDef();
-    Q_ASSERT(fxi != NULL);
+    return dir.absoluteFilePath(FIXTURES_INDEX_NAME);
+}
 
-    QFile::FileError error = fxi->loadXML(path);
-    if (error == QFile::NoError)
-    {
-        /* Delete the def if it's a duplicate. */
-        if (addFixtureDef(fxi) == false)
-            delete fxi;
-        fxi = NULL;
-    }
-    else
-    {
-        qWarning() << Q_FUNC_INFO << "Fixture definition loading from"
-                   << path << "failed:" << QLCFile::errorString(error);
-        delete fxi;
-        fxi = NULL;
-    }
+QList <QLCFixtureDef*> QLCFixtureDefCache::loadQXF(const QStringList& paths) const
+{
+    QVector <QLCFixtureDef*> defs(paths.size(), NULL);
+
+    /* Parsing is independent for each file. Definitions are added to the
+       cache afterwards, in the calling thread and in directory order. */
+    QThreadPool pool;
+    for (int i = 0; i < paths.size(); i++)
+        pool.start(new FixtureDefParser(paths.at(i), &defs[i]));
+    pool.waitForDone();
+
+    return defs.toList();
 }
 
 void QLCFixtureDefCache::loadD4(const QString& path)
@@ -338,6 +481,8 @@ void QLCFixtureDefCache::loadD4(const QString& path)
         delete fxi;
         return;
     }
+    fxi->setDefinitionSourceFile(path);
+    fxi->setLoaded();
 
     /* Delete the def if it's a duplicate. */
     if (addFixtureDef(fxi) == false)
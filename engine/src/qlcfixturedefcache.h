@@ -22,7 +22,7 @@
 
 #include <QStringList>
 #include <QString>
-#include <QMap>
+#include <QHash>
 #include <QDir>
 
 class QLCFixtureDef;
@@ -37,11 +37,11 @@ class QLCFixtureDef;
  * manufacturer names with QLCFixturedefCache::manufacturers() and subsequently
  * all models for a particular manufacturer with QLCFixtureDefCache::models().
  *
- * The internal structure is a two-tier map (m_models), with the first tier
- * containing manufacturer names as the keys for the first map. The value of
- * each key is another map (the second-tier) whose keys are model names. The
- * value for each model name entry in the second-tier map is the actual
- * QLCFixtureDef instance.
+ * The internal structure is a two-tier hash (m_models), with the first tier
+ * containing manufacturer names as the keys for the first hash. The value of
+ * each key is another hash (the second-tier) whose keys are model names. The
+ * value for each model name entry in the second-tier hash is the actual
+ * QLCFixtureDef instance. The definitions themselves are owned by m_defs.
  *
  * Multiple manufacturer & model combinations are discarded.
  *
@@ -109,10 +109,17 @@ public:
      * Returns true even if $fixturePath doesn't contain any fixtures,
      * if it is still accessible (and exists).
      *
+     * QLC native definitions are parsed in parallel on a thread pool.
+     * When $useIndex is true, manufacturer & model of the definitions are
+     * also stored in an index file in $dir (if writable). On the next load,
+     * definitions that haven't changed since then are not parsed: they are
+     * added as placeholders that load their file when first used.
+     *
      * @param dir The directory to load definitions from.
+     * @param useIndex Use and update the definition index of $dir
      * @return true, if the path could be accessed, otherwise false.
      */
-    bool load(const QDir& dir);
+    bool load(const QDir& dir, bool useIndex = false);
 
     /**
      * Load a map of hardcoded fixture definitions that represent
@@ -147,15 +154,27 @@ public:
      */
     static QDir userDefinitionDirectory();
 
+    /** Get the path of the definition index file for $dir */
+    static QString indexPath(const QDir& dir);
+
 private:
-    /** Load a QLC native fixture definition from the file specified in $path */
-    void loadQXF(const QString& path);
+    /**
+     * Parse the QLC native fixture definitions in $paths on a thread pool.
+     *
+     * @return A list of definitions in the same order as $paths, with
+     *         NULL entries for files that could not be parsed
+     */
+    QList <QLCFixtureDef*> loadQXF(const QStringList& paths) const;
 
     /** Load an Avolites D4 fixture definition from the file specified in $path */
     void loadD4(const QString& path);
 
 private:
+    /** All the definitions in the cache, in the order they were added */
     QList <QLCFixtureDef*> m_defs;
+
+    /** Manufacturer -> model -> definition lookup of m_defs */
+    QHash <QString, QHash <QString, QLCFixtureDef*> > m_models;
 };
 
 /** @} */
@@ -23,6 +23,7 @@
 #include <QString>
 #include <QVector>
 #include <QSize>
+#include <cstring>
 
 class QDomDocument;
 class QDomElement;
@@ -33,7 +34,74 @@ class Doc;
  * @{
  */
 
-typedef QVector<QVector<uint> > RGBMap;
+/**
+ * RGBMap is a width x height map of RGB values, stored row after row in a
+ * single contiguous buffer. Rows are stride() pixels apart and map[y][x]
+ * gives the pixel at (x, y).
+ *
+ * The buffer only grows: resizing a map to a size that fits in it doesn't
+ * allocate, so one map can be reused to render every step of an RGBMatrix.
+ */
+class RGBMap
+{
+public:
+    RGBMap() : m_width(0), m_height(0) { }
+    RGBMap(int width, int height) : m_width(0), m_height(0) { resize(width, height); }
+
+    /** Resize the map to $width x $height. Pixel values are undefined afterwards. */
+    void resize(int width, int height)
+    {
+        m_width = qMax(0, width);
+        m_height = qMax(0, height);
+        if (m_data.size() < m_width * m_height)
+            m_data.resize(m_width * m_height);
+    }
+
+    /** Resize the map to 0 x 0, keeping its buffer */
+    void clear() { m_width = 0; m_height = 0; }
+
+    /** Set all the pixels to $rgb */
+    void fill(uint rgb)
+    {
+        uint* data = m_data.data();
+        for (int i = 0; i < m_width * m_height; i++)
+            data[i] = rgb;
+    }
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    QSize size() const { return QSize(m_width, m_height); }
+    bool isEmpty() const { return m_width == 0 || m_height == 0; }
+
+    /** Get the distance between the first pixels of two consecutive rows */
+    int stride() const { return m_width; }
+
+    /** Get the first pixel of row $y */
+    uint* scanLine(int y) { return m_data.data() + (y * stride()); }
+    const uint* constScanLine(int y) const { return m_data.constData() + (y * stride()); }
+
+    uint* operator[](int y) { return scanLine(y); }
+    const uint* operator[](int y) const { return constScanLine(y); }
+
+    bool operator==(const RGBMap& map) const
+    {
+        if (size() != map.size())
+            return false;
+        for (int y = 0; y < m_height; y++)
+        {
+            if (memcmp(constScanLine(y), map.constScanLine(y), m_width * sizeof(uint)) != 0)
+                return false;
+        }
+        return true;
+    }
+
+    bool operator!=(const RGBMap& map) const { return !(*this == map); }
+
+private:
+    QVector <uint> m_data;
+    int m_width;
+    int m_height;
+};
 
 #define KXMLQLCRGBAlgorithm "Algorithm"
 #define KXMLQLCRGBAlgorithmType "Type"
@@ -67,8 +135,12 @@ public:
     /** Maximum step count for rgbMap() function. */
     virtual int rgbMapStepCount(const QSize& size) = 0;
 
-    /** Get the RGBMap for the given step. */
-    virtual RGBMap rgbMap(const QSize& size, uint rgb, int step) = 0;
+    /**
+     * Render the given step into $map, resized to $size. The map is cleared
+     * if the step can't be rendered. Reusing the same map for every step
+     * avoids allocating a new one each time.
+     */
+    virtual void rgbMap(const QSize& size, uint rgb, int step, RGBMap& map) = 0;
 
     /** Get the name of the algorithm. */
     virtual QString name() const = 0;
@@ -20,7 +20,8 @@
 
 #include <QDomDocument>
 #include <QDomElement>
-#include <QPainter>
+#include <QImageReader>
+#include <QImage>
 #include <QDebug>
 
 #include "rgbimage.h"
@@ -36,6 +37,9 @@
 RGBImage::RGBImage(const Doc * doc)
     : RGBAlgorithm(doc)
     , m_filename("")
+    , m_frameWidth(0)
+    , m_frameHeight(0)
+    , m_frameCount(0)
     , m_animationStyle(Static)
     , m_xOffset(0)
     , m_yOffset(0)
@@ -45,11 +49,14 @@ RGBImage::RGBImage(const Doc * doc)
 RGBImage::RGBImage(const RGBImage& i)
     : RGBAlgorithm( i.doc())
     , m_filename(i.filename())
+    , m_atlas(i.m_atlas)
+    , m_frameWidth(i.m_frameWidth)
+    , m_frameHeight(i.m_frameHeight)
+    , m_frameCount(i.m_frameCount)
     , m_animationStyle(i.animationStyle())
     , m_xOffset(i.xOffset())
     , m_yOffset(i.yOffset())
 {
-    reloadImage();
 }
 
 RGBImage::~RGBImage()
@@ -79,17 +86,68 @@ QString RGBImage::filename() const
 
 void RGBImage::reloadImage()
 {
+    // Decode without holding the lock, so that a running matrix keeps
+    // rendering the old frames meanwhile
+    QVector <uint> atlas;
+    int frameWidth = 0;
+    int frameHeight = 0;
+    int frameCount = 0;
+
     if (m_filename.isEmpty())
     {
         qDebug() << "Empty image!";
-        return;
     }
-
-    if (!m_image.load(m_filename))
+    else
     {
-        qDebug() << "Load failed!";
-        return;
+        QImageReader reader(m_filename);
+        QImage image = reader.read();
+        if (image.isNull())
+        {
+            qDebug() << "Load failed!" << reader.errorString();
+        }
+        else
+        {
+            frameWidth = image.width();
+            frameHeight = image.height();
+            const int pixels = frameWidth * frameHeight;
+
+            forever
+            {
+                // All the frames take the size of the first one
+                if (image.size() != QSize(frameWidth, frameHeight))
+                    image = image.copy(0, 0, frameWidth, frameHeight);
+                image = image.convertToFormat(QImage::Format_ARGB32);
+
+                atlas.resize(pixels * (frameCount + 1));
+                uint* dst = atlas.data() + (pixels * frameCount);
+                for (int y = 0; y < frameHeight; y++)
+                {
+                    const QRgb* line = reinterpret_cast<const QRgb*> (image.constScanLine(y));
+                    for (int x = 0; x < frameWidth; x++)
+                        *dst++ = (qAlpha(line[x]) == 0) ? 0 : line[x];
+                }
+                frameCount++;
+
+                if (reader.supportsAnimation() == false || reader.canRead() == false)
+                    break;
+
+                image = reader.read();
+                if (image.isNull())
+                    break;
+            }
+        }
     }
+
+    QMutexLocker locker(&m_mutex);
+    m_atlas = atlas;
+    m_frameWidth = frameWidth;
+    m_frameHeight = frameHeight;
+    m_frameCount = frameCount;
+}
+
+const uint* RGBImage::frame(int index) const
+{
+    return m_atlas.constData() + (index * m_frameWidth * m_frameHeight);
 }
 
 /****************************************************************************
@@ -173,32 +231,40 @@ int RGBImage::yOffset() const
 
 int RGBImage::rgbMapStepCount(const QSize& size)
 {
+    QMutexLocker locker(&m_mutex);
     switch (animationStyle())
     {
     default:
     case Static:
         return 1;
     case Horizontal:
-        return m_image.width();
+        return m_frameWidth;
     case Vertical:
-        return m_image.height();
+        return m_frameHeight;
     case Animation:
-        qDebug() << m_image.width() << " " << size.width() << " " << (m_image.width() / size.width());
-        return MAX(1, m_image.width() / size.width());
+        // Animated images have a step per frame, still ones are sprite sheets
+        if (m_frameCount > 1)
+            return m_frameCount;
+        return MAX(1, m_frameWidth / size.width());
     }
 }
 
-RGBMap RGBImage::rgbMap(const QSize& size, uint rgb, int step)
+void RGBImage::rgbMap(const QSize& size, uint rgb, int step, RGBMap& map)
 {
     Q_UNUSED(rgb);
 
-    if (m_image.width() == 0 || m_image.height() == 0)
-        return RGBMap();
+    QMutexLocker locker(&m_mutex);
+    if (m_frameCount == 0 || m_frameWidth == 0 || m_frameHeight == 0)
+    {
+        map.clear();
+        return;
+    }
 
     int xOffs = xOffset();
     int yOffs = yOffset();
+    int frameIndex = 0;
 
-    switch(animationStyle()) 
+    switch(animationStyle())
     {
     default:
     case Static:
@@ -210,26 +276,38 @@ RGBMap RGBImage::rgbMap(const QSize& size, uint rgb, int step)
         yOffs += step;
         break;
     case Animation:
-        xOffs += step * size.width();
+        if (m_frameCount > 1)
+            frameIndex = qBound(0, step, m_frameCount - 1);
+        else
+            xOffs += step * size.width();
         break;
     }
 
-    RGBMap map(size.height());
+    const uint* pixels = frame(frameIndex);
+
+    map.resize(size.width(), size.height());
     for (int y = 0; y < size.height(); y++)
     {
-        map[y].resize(size.width());
-        for (int x = 0; x < size.width(); x++)
+        uint* dst = map[y];
+
+        // Negative coordinates are outside of the image
+        int y1 = (y + yOffs) % m_frameHeight;
+        if (y1 < 0)
         {
-            int x1 = (x + xOffs) % m_image.width();
-            int y1 = (y + yOffs) % m_image.height();
+            for (int x = 0; x < size.width(); x++)
+                dst[x] = 0;
+            continue;
+        }
 
-            map[y][x] = m_image.pixel(x1,y1);
-            if (qAlpha(map[y][x]) == 0)
-                map[y][x] = 0;
+        const uint* row = pixels + (y1 * m_frameWidth);
+        int x1 = (xOffs < 0) ? xOffs : (xOffs % m_frameWidth);
+        for (int x = 0; x < size.width(); x++, x1++)
+        {
+            if (x1 == m_frameWidth)
+                x1 = 0;
+            dst[x] = (x1 >= 0) ? row[x1] : 0;
         }
     }
-
-    return map;
 }
 
 QString RGBImage::name() const
@@ -21,8 +21,9 @@
 #ifndef RGBIMAGE_H
 #define RGBIMAGE_H
 
+#include <QVector>
 #include <QString>
-#include <QImage>
+#include <QMutex>
 
 #include "rgbalgorithm.h"
 
@@ -49,12 +50,33 @@ public:
     QString filename() const;
 
 private:
-
+    /**
+     * Decode the image file into m_atlas. All the frames of an
+     * animated image (e.g. GIF) are decoded once here.
+     */
     void reloadImage();
 
+    /** Get the first pixel of the frame at $index in m_atlas. Call with m_mutex held. */
+    const uint* frame(int index) const;
+
 private:
     QString m_filename;
-    QImage m_image;
+
+    /**
+     * The decoded frames, one after the other, as m_frameHeight rows of
+     * m_frameWidth ARGB pixels. Fully transparent pixels are stored as 0.
+     */
+    QVector <uint> m_atlas;
+    int m_frameWidth;
+    int m_frameHeight;
+    int m_frameCount;
+
+    /**
+     * Guards the decoded frames, which are replaced on the main thread
+     * when the file changes while the running matrix renders them on the
+     * MasterTimer thread
+     */
+    mutable QMutex m_mutex;
 
     /************************************************************************
      * Animation
@@ -88,7 +110,7 @@ public:
     int rgbMapStepCount(const QSize& size);
 
     /** @reimp */
-    RGBMap rgbMap(const QSize& size, uint rgb, int step);
+    void rgbMap(const QSize& size, uint rgb, int step, RGBMap& map);
 
     /** @reimp */
     QString name() const;
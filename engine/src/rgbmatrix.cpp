@@ -142,22 +142,28 @@ RGBAlgorithm* RGBMatrix::algorithm() const
     return m_algorithm;
 }
 
-QList <RGBMap> RGBMatrix::previewMaps()
+int RGBMatrix::stepsCount()
 {
-    QList <RGBMap> steps;
-
     if (m_algorithm == NULL)
-        return steps;
+        return 0;
+
+    FixtureGroup* grp = doc()->fixtureGroup(fixtureGroup());
+    if (grp == NULL)
+        return 0;
 
+    return qMax(0, m_algorithm->rgbMapStepCount(grp->size()));
+}
+
+void RGBMatrix::previewMap(int step, RGBMap& map)
+{
     FixtureGroup* grp = doc()->fixtureGroup(fixtureGroup());
-    if (grp != NULL)
+    if (m_algorithm == NULL || grp == NULL)
     {
-        int stepCount = m_algorithm->rgbMapStepCount(grp->size());
-        for (int i = 0; i < stepCount; i++)
-            steps << m_algorithm->rgbMap(grp->size(), m_stepColor.rgb(), i);
+        map.clear();
+        return;
     }
 
-    return steps;
+    m_algorithm->rgbMap(grp->size(), m_stepColor.rgb(), step, map);
 }
 
 /****************************************************************************
@@ -398,7 +404,6 @@ void RGBMatrix::preRun(MasterTimer* timer)
 
 void RGBMatrix::write(MasterTimer* timer, QList<Universe *> universes)
 {
-    Q_UNUSED(timer);
     Q_UNUSED(universes);
 
     FixtureGroup* grp = doc()->fixtureGroup(fixtureGroup());
@@ -421,19 +426,33 @@ void RGBMatrix::write(MasterTimer* timer, QList<Universe *> universes)
     if (elapsed() == 0)
     {
         qDebug() << "RGBMatrix stepColor:" << QString::number(m_stepColor.rgb(), 16);
-        RGBMap map = m_algorithm->rgbMap(grp->size(), m_stepColor.rgb(), m_step);
-        updateMapChannels(map, grp);
+        m_algorithm->rgbMap(grp->size(), m_stepColor.rgb(), m_step, m_stepMap);
+        updateMapChannels(m_stepMap, grp);
     }
 
     // Run the generic fader that takes care of fading in/out individual channels
     m_fader->write(universes);
 
     // Increment elapsed time
-    incrementElapsed();
+    uint tick = tickLength(timer);
+    incrementElapsed(tick);
 
     // Check if we need to change direction, stop completely or go to next step
     if (elapsed() >= duration())
+    {
+        // Beat-based matrices carry the time past the end of the step (up to
+        // one tick) over to the next step, so that steps stay on the beat
+        uint overshoot = (tempoType() == Beats) ? qMin(elapsed() - duration(), tick) : 0;
+
         roundCheck(grp->size());
+
+        if (overshoot > 0 && stopped() == false)
+        {
+            m_algorithm->rgbMap(grp->size(), m_stepColor.rgb(), m_step, m_stepMap);
+            updateMapChannels(m_stepMap, grp);
+            incrementElapsed(overshoot);
+        }
+    }
 }
 
 void RGBMatrix::postRun(MasterTimer* timer, QList<Universe *> universes)
@@ -532,9 +551,9 @@ void RGBMatrix::updateMapChannels(const RGBMap& map, const FixtureGroup* grp)
     quint32 mdFxi = Fixture::invalidId();
 
     // Create/modify fade channels for ALL pixels in the color map.
-    for (int y = 0; y < map.size(); y++)
+    for (int y = 0; y < map.height(); y++)
     {
-        for (int x = 0; x < map[y].size(); x++)
+        for (int x = 0; x < map.width(); x++)
         {
             QLCPoint pt(x, y);
             GroupHead grpHead(grp->head(pt));
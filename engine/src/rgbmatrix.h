@@ -82,8 +82,14 @@ public:
     /** Get the current RGB Algorithm. */
     RGBAlgorithm* algorithm() const;
 
-    /** Get a list of RGBMap steps for preview purposes, using the current algorithm. */
-    QList <RGBMap> previewMaps();
+    /** Get the number of steps of the current algorithm on the current fixture group */
+    int stepsCount();
+
+    /**
+     * Render $step into $map for preview purposes, using the current
+     * algorithm and step color. $map is cleared if there's nothing to render.
+     */
+    void previewMap(int step, RGBMap& map);
 
 private:
     RGBAlgorithm* m_algorithm;
@@ -150,6 +156,8 @@ private:
     QTime* m_roundTime;
     QColor m_stepColor;
     int m_crDelta, m_cgDelta, m_cbDelta;
+    /** The current step, rendered again into the same buffer on every step */
+    RGBMap m_stepMap;
 
     /*********************************************************************
      * Attributes
@@ -191,38 +191,41 @@ int RGBScript::rgbMapStepCount(const QSize& size)
         return -1;
 }
 
-RGBMap RGBScript::rgbMap(const QSize& size, uint rgb, int step)
+void RGBScript::rgbMap(const QSize& size, uint rgb, int step, RGBMap& map)
 {
-    RGBMap map;
-
     if (m_rgbMap.isValid() == false)
-        return map;
+    {
+        map.clear();
+        return;
+    }
 
     QScriptValueList args;
     args << size.width() << size.height() << rgb << step;
     QScriptValue yarray = m_rgbMap.call(QScriptValue(), args);
     if (yarray.isArray() == true)
     {
+        // Pixels missing from the returned arrays are black
+        map.resize(size.width(), size.height());
+        map.fill(0);
+
         int ylen = yarray.property("length").toInteger();
-        map = RGBMap(ylen);
         for (int y = 0; y < ylen && y < size.height(); y++)
         {
             QScriptValue xarray = yarray.property(QString::number(y));
             int xlen = xarray.property("length").toInteger();
-            map[y].resize(xlen);
+            uint* row = map[y];
             for (int x = 0; x < xlen && x < size.width(); x++)
             {
                 QScriptValue yx = xarray.property(QString::number(x));
-                map[y][x] = yx.toInteger();
+                row[x] = yx.toInteger();
             }
         }
     }
     else
     {
         qWarning() << "Returned value is not an array within an array!";
+        map.clear();
     }
-
-    return map;
 }
 
 QString RGBScript::name() const
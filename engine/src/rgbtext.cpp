@@ -38,6 +38,8 @@ RGBText::RGBText(const Doc * doc)
     , m_animationStyle(Horizontal)
     , m_xOffset(0)
     , m_yOffset(0)
+    , m_atlasWidth(0)
+    , m_atlasHeight(0)
 {
 }
 
@@ -48,6 +50,8 @@ RGBText::RGBText(const RGBText& t)
     , m_animationStyle(t.animationStyle())
     , m_xOffset(t.xOffset())
     , m_yOffset(t.yOffset())
+    , m_atlasWidth(0)
+    , m_atlasHeight(0)
 {
 }
 
@@ -67,7 +71,9 @@ RGBAlgorithm* RGBText::clone() const
 
 void RGBText::setText(const QString& str)
 {
+    QMutexLocker locker(&m_mutex);
     m_text = str;
+    invalidateAtlas();
 }
 
 QString RGBText::text() const
@@ -77,7 +83,9 @@ QString RGBText::text() const
 
 void RGBText::setFont(const QFont& font)
 {
+    QMutexLocker locker(&m_mutex);
     m_font = font;
+    invalidateAtlas();
 }
 
 QFont RGBText::font() const
@@ -91,10 +99,12 @@ QFont RGBText::font() const
 
 void RGBText::setAnimationStyle(RGBText::AnimationStyle ani)
 {
+    QMutexLocker locker(&m_mutex);
     if (ani >= StaticLetters && ani <= Vertical)
         m_animationStyle = ani;
     else
         m_animationStyle = StaticLetters;
+    invalidateAtlas();
 }
 
 RGBText::AnimationStyle RGBText::animationStyle() const
@@ -137,7 +147,9 @@ QStringList RGBText::animationStyles()
 
 void RGBText::setXOffset(int offset)
 {
+    QMutexLocker locker(&m_mutex);
     m_xOffset = offset;
+    invalidateAtlas();
 }
 
 int RGBText::xOffset() const
@@ -147,7 +159,9 @@ int RGBText::xOffset() const
 
 void RGBText::setYOffset(int offset)
 {
+    QMutexLocker locker(&m_mutex);
     m_yOffset = offset;
+    invalidateAtlas();
 }
 
 int RGBText::yOffset() const
@@ -164,22 +178,95 @@ int RGBText::scrollingTextStepCount() const
         return fm.width(m_text);
 }
 
-RGBMap RGBText::renderScrollingText(const QSize& size, uint rgb, int step) const
+void RGBText::renderScrollingText(const QSize& size, uint rgb, int step, RGBMap& map)
 {
+    updateAtlas(size);
+
+    // Treat the RGBMap as a "window" on top of the fully-drawn text and pick the
+    // correct pixels according to $step.
+    const uchar* atlas = m_atlas.constData();
+    map.resize(size.width(), size.height());
+    for (int y = 0; y < size.height(); y++)
+    {
+        uint* row = map[y];
+        for (int x = 0; x < size.width(); x++)
+        {
+            int ax = x, ay = y;
+            if (animationStyle() == Horizontal)
+                ax += step;
+            else
+                ay += step;
+
+            if (ax >= 0 && ax < m_atlasWidth && ay >= 0 && ay < m_atlasHeight)
+                row[x] = pixel(rgb, atlas[ay * m_atlasWidth + ax]);
+            else
+                row[x] = 0;
+        }
+    }
+}
+
+void RGBText::renderStaticLetters(const QSize& size, uint rgb, int step, RGBMap& map)
+{
+    updateAtlas(size);
+
+    // Steps without a letter are blank
+    const uchar* frame = NULL;
+    if (step >= 0 && step < m_text.length())
+        frame = m_atlas.constData() + (step * size.width() * size.height());
+
+    map.resize(size.width(), size.height());
+    for (int y = 0; y < size.height(); y++)
+    {
+        uint* row = map[y];
+        for (int x = 0; x < size.width(); x++)
+            row[x] = pixel(rgb, frame == NULL ? 0 : frame[y * size.width() + x]);
+    }
+}
+
+/****************************************************************************
+ * Atlas
+ ****************************************************************************/
+
+void RGBText::updateAtlas(const QSize& size)
+{
+    if (m_atlasSize == size)
+        return;
+
     QImage image;
-    if (animationStyle() == Horizontal)
+    if (animationStyle() == StaticLetters)
+        image = QImage(size.width(), size.height() * m_text.length(), QImage::Format_RGB32);
+    else if (animationStyle() == Horizontal)
         image = QImage(scrollingTextStepCount(), size.height(), QImage::Format_RGB32);
     else
         image = QImage(size.width(), scrollingTextStepCount(), QImage::Format_RGB32);
+
+    m_atlasWidth = image.width();
+    m_atlasHeight = image.height();
+    m_atlas.resize(m_atlasWidth * m_atlasHeight);
+    m_atlasSize = size;
+
+    if (image.isNull() == true)
+        return;
+
     image.fill(QRgb(0));
 
     QPainter p(&image);
     p.setRenderHint(QPainter::TextAntialiasing, false);
     p.setRenderHint(QPainter::Antialiasing, false);
     p.setFont(m_font);
-    p.setPen(QColor(rgb));
+    p.setPen(QColor(Qt::white));
 
-    if (animationStyle() == Vertical)
+    if (animationStyle() == StaticLetters)
+    {
+        // Draw one letter per frame
+        for (int i = 0; i < m_text.length(); i++)
+        {
+            QRect rect(xOffset(), yOffset() + (i * size.height()), size.width(), size.height());
+            p.setClipRect(0, i * size.height(), size.width(), size.height());
+            p.drawText(rect, Qt::AlignCenter, m_text.mid(i, 1));
+        }
+    }
+    else if (animationStyle() == Vertical)
     {
         QFontMetrics fm(m_font);
         QRect rect(0, 0, image.width(), image.height());
@@ -194,61 +281,36 @@ RGBMap RGBText::renderScrollingText(const QSize& size, uint rgb, int step) const
     }
     else
     {
-        // Draw the whole text each time
+        // Draw the whole text once
         QRect rect(xOffset(), yOffset(), image.width(), image.height());
         p.drawText(rect, Qt::AlignLeft | Qt::AlignVCenter, m_text);
     }
     p.end();
 
-    // Treat the RGBMap as a "window" on top of the fully-drawn text and pick the
-    // correct pixels according to $step.
-    RGBMap map(size.height());
-    for (int y = 0; y < size.height(); y++)
+    for (int y = 0; y < m_atlasHeight; y++)
     {
-        map[y].resize(size.width());
-        for (int x = 0; x < size.width(); x++)
-        {
-            if (animationStyle() == Horizontal)
-            {
-                if (step + x < image.width())
-                    map[y][x] = image.pixel(step + x, y);
-            }
-            else
-            {
-                if (step + y < image.height())
-                    map[y][x] = image.pixel(x, step + y);
-            }
-        }
+        const QRgb* line = reinterpret_cast<const QRgb*> (image.constScanLine(y));
+        uchar* row = m_atlas.data() + (y * m_atlasWidth);
+        for (int x = 0; x < m_atlasWidth; x++)
+            row[x] = qGray(line[x]);
     }
-
-    return map;
 }
 
-RGBMap RGBText::renderStaticLetters(const QSize& size, uint rgb, int step) const
+void RGBText::invalidateAtlas()
 {
-    QImage image(size, QImage::Format_RGB32);
-    image.fill(QRgb(0));
-
-    QPainter p(&image);
-    p.setRenderHint(QPainter::TextAntialiasing, false);
-    p.setRenderHint(QPainter::Antialiasing, false);
-    p.setFont(m_font);
-
-    p.setPen(QColor(rgb));
-    // Draw one letter at a time
-    QRect rect(xOffset(), yOffset(), size.width(), size.height());
-    p.drawText(rect, Qt::AlignCenter, m_text.mid(step, 1));
-    p.end();
-
-    RGBMap map(size.height());
-    for (int y = 0; y < size.height(); y++)
-    {
-        map[y].resize(size.width());
-        for (int x = 0; x < size.width(); x++)
-            map[y][x] = image.pixel(x, y);
-    }
+    m_atlasSize = QSize();
+}
 
-    return map;
+uint RGBText::pixel(uint rgb, uchar coverage)
+{
+    if (coverage == 0)
+        return QColor(Qt::black).rgb();
+    if (coverage == 255)
+        return QColor(rgb).rgb();
+
+    return qRgb((qRed(rgb) * coverage) / 255,
+                (qGreen(rgb) * coverage) / 255,
+                (qBlue(rgb) * coverage) / 255);
 }
 
 /****************************************************************************
@@ -258,18 +320,20 @@ RGBMap RGBText::renderStaticLetters(const QSize& size, uint rgb, int step) const
 int RGBText::rgbMapStepCount(const QSize& size)
 {
     Q_UNUSED(size);
+    QMutexLocker locker(&m_mutex);
     if (animationStyle() == StaticLetters)
         return m_text.length();
     else
         return scrollingTextStepCount();
 }
 
-RGBMap RGBText::rgbMap(const QSize& size, uint rgb, int step)
+void RGBText::rgbMap(const QSize& size, uint rgb, int step, RGBMap& map)
 {
+    QMutexLocker locker(&m_mutex);
     if (animationStyle() == StaticLetters)
-        return renderStaticLetters(size, rgb, step);
+        renderStaticLetters(size, rgb, step, map);
     else
-        return renderScrollingText(size, rgb, step);
+        renderScrollingText(size, rgb, step, map);
 }
 
 QString RGBText::name() const
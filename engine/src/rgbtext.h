@@ -20,8 +20,11 @@
 #ifndef RGBTEXT_H
 #define RGBTEXT_H
 
+#include <QVector>
 #include <QString>
+#include <QMutex>
 #include <QFont>
+#include <QSize>
 
 #include "rgbalgorithm.h"
 
@@ -82,14 +85,50 @@ public:
 
 private:
     int scrollingTextStepCount() const;
-    RGBMap renderScrollingText(const QSize& size, uint rgb, int step) const;
-    RGBMap renderStaticLetters(const QSize& size, uint rgb, int step) const;
+    void renderScrollingText(const QSize& size, uint rgb, int step, RGBMap& map);
+    void renderStaticLetters(const QSize& size, uint rgb, int step, RGBMap& map);
 
 private:
     AnimationStyle m_animationStyle;
     int m_xOffset;
     int m_yOffset;
 
+    /************************************************************************
+     * Atlas
+     ************************************************************************/
+private:
+    /**
+     * Render all the steps for $size into m_atlas, unless it's already done.
+     * Call with m_mutex held.
+     */
+    void updateAtlas(const QSize& size);
+
+    /** Forget the rendered steps, e.g. when the text changes. Call with m_mutex held. */
+    void invalidateAtlas();
+
+    /** Get $rgb with the brightness of $coverage, as QPainter would draw it */
+    static uint pixel(uint rgb, uchar coverage);
+
+private:
+    /**
+     * All the steps, rendered once in white as text coverage values. For
+     * scrolling text, each step is a window on one strip of
+     * m_atlasWidth x m_atlasHeight pixels. For static letters, the steps
+     * are frames of the map size, one after the other.
+     */
+    QVector <uchar> m_atlas;
+    int m_atlasWidth;
+    int m_atlasHeight;
+    /** The map size m_atlas was rendered for, invalid if it must be rendered again */
+    QSize m_atlasSize;
+
+    /**
+     * Guards the atlas and the properties it is rendered from, since maps
+     * are rendered both by the running matrix on the MasterTimer thread and
+     * by the editor previews on the main thread
+     */
+    mutable QMutex m_mutex;
+
     /************************************************************************
      * RGBAlgorithm
      ************************************************************************/
@@ -98,7 +137,7 @@ public:
     int rgbMapStepCount(const QSize& size);
 
     /** @reimp */
-    RGBMap rgbMap(const QSize& size, uint rgb, int step);
+    void rgbMap(const QSize& size, uint rgb, int step, RGBMap& map);
 
     /** @reimp */
     QString name() const;
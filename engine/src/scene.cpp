@@ -140,6 +140,26 @@ void Scene::setValue(quint32 fxi, quint32 ch, uchar value)
     setValue(SceneValue(fxi, ch, value));
 }
 
+void Scene::setValues(const QList <SceneValue>& values)
+{
+    // Sort once, instead of once per value
+    QList <SceneValue> sorted(values);
+    qStableSort(sorted.begin(), sorted.end());
+
+    m_valueListMutex.lock();
+    m_values.clear();
+    for (int i = 0; i < sorted.count(); i++)
+    {
+        if (m_values.isEmpty() == false && m_values.last() == sorted.at(i))
+            m_values.last() = sorted.at(i);
+        else
+            m_values.append(sorted.at(i));
+    }
+    m_valueListMutex.unlock();
+
+    emit changed(this->id());
+}
+
 void Scene::unsetValue(quint32 fxi, quint32 ch)
 {
     m_valueListMutex.lock();
@@ -592,7 +612,7 @@ void Scene::write(MasterTimer* timer, QList<Universe*> ua)
                 else
                     fc.setFadeTime(overrideFadeInSpeed());
             }
-            insertStartValue(fc, timer, ua);
+            insertStartValue(fc, timer);
             m_fader->add(fc);
         }
         m_valueListMutex.unlock();
@@ -650,8 +670,14 @@ void Scene::postRun(MasterTimer* timer, QList<Universe *> ua)
     Function::postRun(timer, ua);
 }
 
-void Scene::insertStartValue(FadeChannel& fc, const MasterTimer* timer,
-                             const QList<Universe*> ua)
+bool Scene::canWriteInParallel() const
+{
+    // After the first write() (that grabs the starting values from
+    // MasterTimer's fader), a scene only runs its own GenericFader
+    return true;
+}
+
+void Scene::insertStartValue(FadeChannel& fc, const MasterTimer* timer)
 {
     const QHash <FadeChannel,FadeChannel>& channels(timer->fader()->channels());
     if (channels.contains(fc) == true)
@@ -664,11 +690,10 @@ void Scene::insertStartValue(FadeChannel& fc, const MasterTimer* timer,
     }
     else
     {
-        // MasterTimer didn't have the channel. Grab the starting value from UniverseArray.
-        quint32 address = fc.address();
-        quint32 uni = fc.universe();
+        // MasterTimer didn't have the channel. Grab the starting value from
+        // the universes, as they were at the end of the previous tick.
         if (fc.group(doc()) != QLCChannel::Intensity)
-            fc.setStart(ua[uni]->preGMValues()[address]);
+            fc.setStart(timer->snapshot()->preGMValue(fc.universe(), fc.address()));
         else
             fc.setStart(0); // HTP channels must start at zero
         fc.setCurrent(fc.start());
@@ -103,6 +103,13 @@ public:
      */
     void setValue(quint32 fxi, quint32 ch, uchar value);
 
+    /**
+     * Replace all the values of the scene with $values at once. When
+     * $values has more than one value for a channel, the last one is kept.
+     * The scene must not be running.
+     */
+    void setValues(const QList <SceneValue>& values);
+
     /**
      * Clear the value of one fixture channel
      */
@@ -229,9 +236,12 @@ public:
     /** @reimpl */
     void postRun(MasterTimer* timer, QList<Universe*> ua);
 
+    /** @reimpl */
+    bool canWriteInParallel() const;
+
 private:
-    /** Insert starting values to $fc, either from $timer->fader() or $ua */
-    void insertStartValue(FadeChannel& fc, const MasterTimer* timer, const QList<Universe *> ua);
+    /** Insert starting values to $fc, either from $timer->fader() or $timer->snapshot() */
+    void insertStartValue(FadeChannel& fc, const MasterTimer* timer);
 
 private:
     GenericFader* m_fader;
@@ -0,0 +1,219 @@
+/*
+  Q Light Controller Plus
+  scheduler.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QMutexLocker>
+#include <QDateTime>
+#include <climits>
+
+#include "scheduler.h"
+
+Scheduler::Scheduler()
+    : m_latestId(0)
+    , m_graceTime(SCHEDULER_DEFAULT_GRACE)
+    , m_anchorNsecs(0)
+    , m_anchorWall(0)
+    , m_resyncNsecs(0)
+{
+    m_time.start();
+}
+
+Scheduler::~Scheduler()
+{
+}
+
+qint64 Scheduler::now() const
+{
+    return m_time.nsecsElapsed();
+}
+
+quint32 Scheduler::invalidId()
+{
+    return UINT_MAX;
+}
+
+/****************************************************************************
+ * Entries
+ ****************************************************************************/
+
+quint32 Scheduler::addEntry(quint32 functionID, const QTime& time, int days,
+                            CatchUp catchUp)
+{
+    if ((days & EveryDay) == 0 || time.isValid() == false)
+        return invalidId();
+
+    QMutexLocker locker(&m_mutex);
+
+    Entry entry;
+    entry.function = functionID;
+    entry.time = time;
+    entry.days = days & EveryDay;
+    entry.catchUp = catchUp;
+    entry.nextWall = -1;
+
+    quint32 id = m_latestId++;
+    m_entries.insert(id, entry);
+
+    // Schedule the new entry on the next poll
+    m_resyncNsecs = 0;
+
+    return id;
+}
+
+bool Scheduler::removeEntry(quint32 id)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_entries.remove(id) == 0)
+        return false;
+
+    // Deadlines of removed entries are dropped when they are reached
+    return true;
+}
+
+void Scheduler::clear()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_entries.clear();
+    m_deadlines.clear();
+}
+
+int Scheduler::entryCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_entries.count();
+}
+
+qint64 Scheduler::nextOccurrence(quint32 id) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    QMap<quint32,Entry>::const_iterator it = m_entries.find(id);
+    if (it == m_entries.end())
+        return -1;
+
+    return it->nextWall;
+}
+
+qint64 Scheduler::nextOccurrence(const QTime& time, int days, qint64 wallMsecs)
+{
+    if ((days & EveryDay) == 0 || time.isValid() == false)
+        return -1;
+
+    QDate today = QDateTime::fromMSecsSinceEpoch(wallMsecs).date();
+
+    // A week from today is the same day of the week as today, at a later time
+    for (int i = 0; i <= 7; i++)
+    {
+        QDate date = today.addDays(i);
+        if ((days & (1 << (date.dayOfWeek() - 1))) == 0)
+            continue;
+
+        qint64 msecs = QDateTime(date, time).toMSecsSinceEpoch();
+        if (msecs >= wallMsecs)
+            return msecs;
+    }
+
+    return -1;
+}
+
+/****************************************************************************
+ * Catch-up
+ ****************************************************************************/
+
+void Scheduler::setGraceTime(uint msecs)
+{
+    QMutexLocker locker(&m_mutex);
+    m_graceTime = msecs;
+}
+
+uint Scheduler::graceTime() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_graceTime;
+}
+
+/****************************************************************************
+ * Polling
+ ****************************************************************************/
+
+QList<quint32> Scheduler::poll(qint64 nsecs, qint64 wallMsecs)
+{
+    QList<quint32> functions;
+
+    QMutexLocker locker(&m_mutex);
+
+    if (nsecs >= m_resyncNsecs)
+    {
+        if (wallMsecs < 0)
+            wallMsecs = QDateTime::currentMSecsSinceEpoch();
+        resync(nsecs, wallMsecs);
+    }
+
+    const qint64 grace = qint64(m_graceTime) * 1000000;
+
+    while (m_deadlines.isEmpty() == false && m_deadlines.begin().key() <= nsecs)
+    {
+        QMultiMap<qint64,quint32>::iterator it = m_deadlines.begin();
+        qint64 deadline = it.key();
+        quint32 id = it.value();
+        m_deadlines.erase(it);
+
+        QMap<quint32,Entry>::iterator entry = m_entries.find(id);
+        if (entry == m_entries.end())
+            continue;
+
+        if (nsecs - deadline <= grace || entry->catchUp == FireMissed)
+            functions.append(entry->function);
+
+        // Missed occurrences in between are not fired more than once
+        qint64 wall = m_anchorWall + (nsecs - m_anchorNsecs) / 1000000;
+        entry->nextWall = nextOccurrence(entry->time, entry->days,
+                                         qMax(entry->nextWall + 1, wall));
+        enqueue(id, entry.value());
+    }
+
+    return functions;
+}
+
+void Scheduler::resync(qint64 nsecs, qint64 wallMsecs)
+{
+    m_anchorNsecs = nsecs;
+    m_anchorWall = wallMsecs;
+    m_resyncNsecs = nsecs + SCHEDULER_RESYNC_NS;
+
+    m_deadlines.clear();
+
+    QMap<quint32,Entry>::iterator it = m_entries.begin();
+    for (; it != m_entries.end(); ++it)
+    {
+        if (it->nextWall < 0)
+            it->nextWall = nextOccurrence(it->time, it->days, wallMsecs);
+        enqueue(it.key(), it.value());
+    }
+}
+
+void Scheduler::enqueue(quint32 id, const Entry& entry)
+{
+    if (entry.nextWall < 0)
+        return;
+
+    qint64 deadline = m_anchorNsecs + (entry.nextWall - m_anchorWall) * 1000000;
+    m_deadlines.insert(deadline, id);
+}
@@ -0,0 +1,188 @@
+/*
+  Q Light Controller Plus
+  scheduler.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QMultiMap>
+#include <QMutex>
+#include <QTime>
+#include <QList>
+#include <QMap>
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/** The wall clock is read, and the schedule realigned to it, this often */
+#define SCHEDULER_RESYNC_NS Q_INT64_C(1000000000)
+
+/** Default time (in ms) an occurrence can be late and still start its function */
+#define SCHEDULER_DEFAULT_GRACE 2000
+
+/**
+ * Scheduler starts functions at given times of the day.
+ *
+ * Each entry has a time of day and the days of the week it recurs on.
+ * The next occurrence of every entry is converted once to a deadline on
+ * the scheduler's monotonic time base and kept in a deadline-ordered queue,
+ * so that MasterTimer only has to compare the earliest deadline with the
+ * current time on each tick, and functions start on the first tick after
+ * their time instead of on the next GUI timer event.
+ *
+ * The wall clock is sampled once every SCHEDULER_RESYNC_NS to realign the
+ * deadlines, e.g. after the system time or the daylight saving time changes.
+ * Occurrences that are missed by more than graceTime() milliseconds, because
+ * the wall clock jumped forward or the engine wasn't running, are skipped
+ * unless the entry's catch-up policy is FireMissed.
+ *
+ * Entries may be added and removed from any thread.
+ */
+class Scheduler
+{
+public:
+    Scheduler();
+    ~Scheduler();
+
+    /** Get the current time on the scheduler's monotonic time base, in nanoseconds */
+    qint64 now() const;
+
+    /** Value for an invalid entry ID */
+    static quint32 invalidId();
+
+    /*********************************************************************
+     * Entries
+     *********************************************************************/
+public:
+    /** Days of the week an entry recurs on. Can be OR'ed. */
+    enum Day
+    {
+        Monday    = 1 << 0,
+        Tuesday   = 1 << 1,
+        Wednesday = 1 << 2,
+        Thursday  = 1 << 3,
+        Friday    = 1 << 4,
+        Saturday  = 1 << 5,
+        Sunday    = 1 << 6,
+        EveryDay  = 0x7F
+    };
+
+    /** What to do with an occurrence missed by more than graceTime() */
+    enum CatchUp
+    {
+        SkipMissed = 0, //! Wait for the next occurrence
+        FireMissed      //! Start the function once, as soon as possible
+    };
+
+    /**
+     * Add an entry that starts $functionID at $time on $days.
+     *
+     * @return The ID of the new entry, or invalidId() if $days is empty
+     */
+    quint32 addEntry(quint32 functionID, const QTime& time, int days = EveryDay,
+                     CatchUp catchUp = SkipMissed);
+
+    /** Remove the entry with the given $id */
+    bool removeEntry(quint32 id);
+
+    /** Remove all entries */
+    void clear();
+
+    /** Get the number of entries */
+    int entryCount() const;
+
+    /**
+     * Get the next occurrence of the entry with the given $id, in
+     * milliseconds since the epoch, or -1 if it's not known yet
+     * (before the first poll() after adding it)
+     */
+    qint64 nextOccurrence(quint32 id) const;
+
+    /**
+     * Get the first occurrence of $time on $days at, or after, $wallMsecs
+     * milliseconds since the epoch. Returns -1 if $days is empty.
+     */
+    static qint64 nextOccurrence(const QTime& time, int days, qint64 wallMsecs);
+
+    /*********************************************************************
+     * Catch-up
+     *********************************************************************/
+public:
+    /** Set how late (in ms) an occurrence can be and still start its function */
+    void setGraceTime(uint msecs);
+
+    /** Get how late (in ms) an occurrence can be and still start its function */
+    uint graceTime() const;
+
+    /*********************************************************************
+     * Polling
+     *********************************************************************/
+public:
+    /**
+     * Get the functions that are due at time $nsecs. MasterTimer calls
+     * this once per tick.
+     *
+     * @param nsecs The current time on the scheduler's time base
+     * @param wallMsecs The wall clock time at $nsecs, in milliseconds since
+     *                  the epoch. If negative, the system time is read when
+     *                  needed.
+     * @return The IDs of the functions to start
+     */
+    QList<quint32> poll(qint64 nsecs, qint64 wallMsecs = -1);
+
+private:
+    struct Entry
+    {
+        quint32 function;
+        QTime time;
+        int days;
+        CatchUp catchUp;
+        /** Next occurrence in ms since the epoch, -1 if unknown */
+        qint64 nextWall;
+    };
+
+    /** Realign all deadlines to the wall clock. Call with m_mutex held. */
+    void resync(qint64 nsecs, qint64 wallMsecs);
+
+    /** Queue $id's next occurrence. Call with m_mutex held. */
+    void enqueue(quint32 id, const Entry& entry);
+
+private:
+    mutable QMutex m_mutex;
+    QElapsedTimer m_time;
+
+    QMap <quint32,Entry> m_entries;
+    quint32 m_latestId;
+
+    /** Entry IDs by deadline, on the monotonic time base */
+    QMultiMap <qint64,quint32> m_deadlines;
+
+    uint m_graceTime;
+
+    /** The wall clock was m_anchorWall msecs at m_anchorNsecs */
+    qint64 m_anchorNsecs;
+    qint64 m_anchorWall;
+    /** Time of the next resync; anything earlier forces one on the next poll */
+    qint64 m_resyncNsecs;
+};
+
+/** @} */
+
+#endif
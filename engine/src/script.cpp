@@ -54,6 +54,15 @@ Script::Script(Doc* doc) : Function(doc, Function::Script)
     , m_fader(NULL)
 {
     setName(tr("New Script"));
+
+    m_resolved = false;
+
+    // Compiled instructions hold direct references to functions and fixtures
+    connect(doc, SIGNAL(functionAdded(quint32)), this, SLOT(slotDocContentsChanged(quint32)));
+    connect(doc, SIGNAL(functionRemoved(quint32)), this, SLOT(slotDocContentsChanged(quint32)));
+    connect(doc, SIGNAL(fixtureAdded(quint32)), this, SLOT(slotDocContentsChanged(quint32)));
+    connect(doc, SIGNAL(fixtureRemoved(quint32)), this, SLOT(slotDocContentsChanged(quint32)));
+    connect(doc, SIGNAL(fixtureChanged(quint32)), this, SLOT(slotDocContentsChanged(quint32)));
 }
 
 Script::~Script()
@@ -102,19 +111,19 @@ bool Script::setData(const QString& str)
     m_data = str;
 
     // Construct individual code lines from the data
-    m_lines.clear();
+    QList <QList<QStringList> > lines;
     if (m_data.isEmpty() == false)
     {
-        QStringList lines = m_data.split(QRegExp("(\r\n|\n\r|\r|\n)"), QString::KeepEmptyParts);
-        foreach (QString line, lines)
-            m_lines << tokenizeLine(line + QString("\n"));
+        QStringList list = m_data.split(QRegExp("(\r\n|\n\r|\r|\n)"), QString::KeepEmptyParts);
+        foreach (QString line, list)
+            lines << tokenizeLine(line + QString("\n"));
     }
 
     // Map all labels to their individual line numbers for fast jumps
     m_labels.clear();
-    for (int i = 0; i < m_lines.size(); i++)
+    for (int i = 0; i < lines.size(); i++)
     {
-        QList <QStringList> line = m_lines[i];
+        const QList <QStringList>& line = lines[i];
         if (line.isEmpty() == false &&
             line.first().size() == 2 && line.first()[0] == Script::labelCmd)
         {
@@ -122,6 +131,23 @@ bool Script::setData(const QString& str)
         }
     }
 
+    // Compile each line only once, so that running the script doesn't
+    // involve any string handling
+    m_program.clear();
+    m_program.resize(lines.size());
+    for (int i = 0; i < lines.size(); i++)
+    {
+        Instruction& instruction = m_program[i];
+        instruction.error = compileLine(lines[i], instruction);
+        if (instruction.error.isEmpty() == false)
+        {
+            instruction.opcode = Invalid;
+            qWarning() << QString("Script:%1, line:%2, error:%3").arg(name()).arg(i).arg(instruction.error);
+        }
+    }
+
+    m_resolved = false;
+
     return true;
 }
 
@@ -227,6 +253,9 @@ void Script::preRun(MasterTimer* timer)
     m_currentCommand = 0;
     m_startedFunctions.clear();
 
+    // Bind the compiled instructions to the current functions and fixtures
+    resolveReferences();
+
     Function::preRun(timer);
 }
 
@@ -239,7 +268,7 @@ void Script::write(MasterTimer* timer, QList<Universe *> universes)
         if (waiting() == false)
         {
             // Not currently waiting for anything. Free to proceed to next command.
-            while (m_currentCommand < m_lines.size() && stopped() == false)
+            while (m_currentCommand < m_program.size() && stopped() == false)
             {
                 bool continueLoop = executeCommand(m_currentCommand, timer, universes);
                 m_currentCommand++;
@@ -248,7 +277,7 @@ void Script::write(MasterTimer* timer, QList<Universe *> universes)
             }
 
             // In case wait() is the last command, don't stop the script prematurely
-            if (m_currentCommand >= m_lines.size() && m_waitCount == 0)
+            if (m_currentCommand >= m_program.size() && m_waitCount == 0)
                 stop();
         }
 
@@ -290,290 +319,274 @@ bool Script::waiting()
 
 bool Script::executeCommand(int index, MasterTimer* timer, QList<Universe *> universes)
 {
-    if (index < 0 || index >= m_lines.size())
+    Q_UNUSED(universes);
+
+    if (index < 0 || index >= m_program.size())
     {
         qWarning() << "Invalid command index:" << index;
         return false;
     }
 
-    QList <QStringList> tokens = m_lines[index];
-    if (tokens.isEmpty() == true)
-        return true; // Empty line
+    if (m_resolved == false)
+        resolveReferences();
 
-    bool continueLoop = true;
-    QString error;
-    if (tokens[0].size() < 2)
+    const Instruction& instruction = m_program[index];
+    switch (instruction.opcode)
     {
-        error = QString("Syntax error");
-    }
-    else if (tokens[0][0] == Script::startFunctionCmd)
-    {
-        error = handleStartFunction(tokens, timer);
-    }
-    else if (tokens[0][0] == Script::stopFunctionCmd)
-    {
-        error = handleStopFunction(tokens);
-    }
-    else if (tokens[0][0] == Script::waitCmd)
-    {
-        // Waiting should break out of the execution loop to prevent skipping
-        // straight to the next command. If there is no error in wait parsing,
-        // we must wait at least one cycle.
-        error = handleWait(tokens);
-        if (error.isEmpty() == true)
-            continueLoop = false;
-    }
-    else if (tokens[0][0] == Script::waitKeyCmd)
-    {
-        // Waiting for a key should break out of the execution loop to prevent
-        // skipping straight to the next command. If there is no error in waitkey
-        // parsing,we must wait at least one cycle.
-        error = handleWaitKey(tokens);
-        if (error.isEmpty() == true)
-            continueLoop = false;
-    }
-    else if (tokens[0][0] == Script::setFixtureCmd)
-    {
-        error = handleSetFixture(tokens, universes);
-    }
-    else if (tokens[0][0] == Script::labelCmd)
-    {
-        error = handleLabel(tokens);
-    }
-    else if (tokens[0][0] == Script::jumpCmd)
-    {
-        // Jumping can cause an infinite non-waiting loop, causing starvation
-        // among other functions. Therefore, the script must relinquish its
-        // time slot after each jump. If there is no error in jumping, the jump
-        // must have happened.
-        error = handleJump(tokens);
-        if (error.isEmpty() == true)
-            continueLoop = false;
-    }
-    else
-    {
-        error = QString("Unknown command: %1").arg(tokens[0][0]);
-    }
+        case StartFunction:
+        {
+            Function* function = instruction.function;
+            if (function == NULL)
+                break;
 
-    if (error.isEmpty() == false)
-        qWarning() << QString("Script:%1, line:%2, error:%3").arg(name()).arg(index).arg(error);
+            if (function->stopped() == true)
+                function->start(timer, true);
+            else
+                qWarning() << "Function (" << function->name() << ") is already running.";
 
-    return continueLoop;
-}
+            m_startedFunctions << function;
+        }
+        break;
 
-QString Script::handleStartFunction(const QList<QStringList>& tokens, MasterTimer* timer)
-{
-    qDebug() << Q_FUNC_INFO;
+        case StopFunction:
+        {
+            Function* function = instruction.function;
+            if (function == NULL)
+                break;
 
-    if (tokens.size() > 1)
-        return QString("Too many arguments");
+            if (function->stopped() == false)
+                function->stop();
+            else
+                qWarning() << "Function (" << function->name() << ") is not running.";
 
-    bool ok = false;
-    quint32 id = tokens[0][1].toUInt(&ok);
-    if (ok == false)
-        return QString("Invalid function ID: %1").arg(tokens[0][1]);
+            m_startedFunctions.removeAll(function);
+        }
+        break;
 
-    Doc* doc = qobject_cast<Doc*> (parent());
-    Q_ASSERT(doc != NULL);
+        case Wait:
+            // Waiting should break out of the execution loop to prevent skipping
+            // straight to the next command. We must wait at least one cycle.
+            m_waitCount = instruction.waitTicks;
+            return false;
 
-    Function* function = doc->function(id);
-    if (function != NULL)
-    {
-        if (function->stopped() == true)
-            function->start(timer, true);
-        else
-            qWarning() << "Function (" << function->name() << ") is already running.";
+        case WaitKey:
+            // Waiting for a key should break out of the execution loop to prevent
+            // skipping straight to the next command.
+            return false;
 
-        m_startedFunctions << function;
-        return QString();
-    }
-    else
-    {
-        return QString("No such function (ID %1)").arg(id);
-    }
-}
+        case SetFixture:
+            if (instruction.resolved == true)
+                executeSetFixture(instruction, timer);
+        break;
 
-QString Script::handleStopFunction(const QList <QStringList>& tokens)
-{
-    qDebug() << Q_FUNC_INFO;
+        case Jump:
+            // Jumping can cause an infinite non-waiting loop, causing starvation
+            // among other functions. Therefore, the script must relinquish its
+            // time slot after each jump.
+            m_currentCommand = instruction.jumpTarget;
+            return false;
 
-    if (tokens.size() > 1)
-        return QString("Too many arguments");
+        case NoOp:
+        case Invalid:
+        default:
+        break;
+    }
 
-    bool ok = false;
-    quint32 id = tokens[0][1].toUInt(&ok);
-    if (ok == false)
-        return QString("Invalid function ID: %1").arg(tokens[0][1]);
+    return true;
+}
 
-    Doc* doc = qobject_cast<Doc*> (parent());
-    Q_ASSERT(doc != NULL);
+void Script::executeSetFixture(const Instruction& instruction, const MasterTimer* timer)
+{
+    GenericFader* gf = fader();
+    Q_ASSERT(gf != NULL);
 
-    Function* function = doc->function(id);
-    if (function != NULL)
-    {
-        if (function->stopped() == false)
-            function->stop();
-        else
-            qWarning() << "Function (" << function->name() << ") is not running.";
+    FadeChannel fc(instruction.fadeChannel);
 
-        m_startedFunctions.removeAll(function);
-        return QString();
-    }
+    // If the script has used the channel previously, it might still be in
+    // the bowels of GenericFader so get the starting value from there.
+    // Otherwise get it from universes (HTP channels are always 0 then).
+    if (gf->channels().contains(fc) == true)
+        fc.setStart(gf->channels()[fc].current());
     else
-    {
-        return QString("No such function (ID %1)").arg(id);
-    }
+        fc.setStart(timer->snapshot()->preGMValue(fc.universe(), fc.address()));
+    fc.setCurrent(fc.start());
+
+    gf->add(fc);
 }
 
-QString Script::handleWait(const QList<QStringList>& tokens)
+/****************************************************************************
+ * Compilation
+ ****************************************************************************/
+
+QString Script::compileLine(const QList<QStringList>& tokens, Instruction& instruction)
 {
-    qDebug() << Q_FUNC_INFO;
+    instruction = Instruction();
 
-    if (tokens.size() > 2)
-        return QString("Too many arguments");
+    // Empty and commented lines
+    if (tokens.isEmpty() == true || tokens[0].isEmpty() == true)
+        return QString();
 
-    double time = 0;
+    if (tokens[0].size() < 2)
+        return QString("Syntax error");
+
+    const QString& command = tokens[0][0];
     bool ok = false;
 
-    time = tokens[0][1].toDouble(&ok);
-    if (ok == false)
-        return QString("Invalid wait time: %1").arg(tokens[0][1]);
+    if (command == Script::startFunctionCmd || command == Script::stopFunctionCmd)
+    {
+        if (tokens.size() > 1)
+            return QString("Too many arguments");
 
-    m_waitCount = time * MasterTimer::frequency();
+        instruction.id = tokens[0][1].toUInt(&ok);
+        if (ok == false)
+            return QString("Invalid function ID: %1").arg(tokens[0][1]);
 
-    return QString();
-}
+        if (command == Script::startFunctionCmd)
+            instruction.opcode = StartFunction;
+        else
+            instruction.opcode = StopFunction;
+    }
+    else if (command == Script::waitCmd)
+    {
+        if (tokens.size() > 2)
+            return QString("Too many arguments");
 
-QString Script::handleWaitKey(const QList<QStringList>& tokens)
-{
-    qDebug() << Q_FUNC_INFO << tokens;
+        double time = tokens[0][1].toDouble(&ok);
+        if (ok == false)
+            return QString("Invalid wait time: %1").arg(tokens[0][1]);
 
-    if (tokens.size() > 1)
-        return QString("Too many arguments");
+        instruction.opcode = Wait;
+        instruction.waitTicks = time * MasterTimer::frequency();
+    }
+    else if (command == Script::waitKeyCmd)
+    {
+        if (tokens.size() > 1)
+            return QString("Too many arguments");
 
-    QString key = QString(tokens[0][1]).remove("\"");
-    qDebug() << "Ought to wait for" << key;
+        instruction.opcode = WaitKey;
+    }
+    else if (command == Script::setFixtureCmd)
+    {
+        if (tokens.size() > 4)
+            return QString("Too many arguments");
 
-    return QString();
-}
+        instruction.id = tokens[0][1].toUInt(&ok);
+        if (ok == false)
+            return QString("Invalid fixture (ID: %1)").arg(tokens[0][1]);
 
-QString Script::handleSetFixture(const QList<QStringList>& tokens, QList<Universe *> universes)
-{
-    qDebug() << Q_FUNC_INFO;
+        double time = 0;
+        for (int i = 1; i < tokens.size(); i++)
+        {
+            QStringList list = tokens[i];
+            list[0] = list[0].toLower().trimmed();
+            if (list.size() == 2)
+            {
+                ok = false;
+                if (list[0] == "val" || list[0] == "value")
+                    instruction.value = uchar(list[1].toUInt(&ok));
+                else if (list[0] == "ch" || list[0] == "channel")
+                    instruction.channel = list[1].toUInt(&ok);
+                else if (list[0] == "time")
+                    time = list[1].toDouble(&ok);
+                else
+                    return QString("Unrecognized keyword: %1").arg(list[0]);
 
-    if (tokens.size() > 4)
-        return QString("Too many arguments");
+                if (ok == false)
+                    return QString("Invalid value (%1) for keyword: %2").arg(list[1]).arg(list[0]);
+            }
+        }
 
-    bool ok = false;
-    quint32 id = 0;
-    quint32 ch = 0;
-    uchar value = 0;
-    double time = 0;
+        instruction.opcode = SetFixture;
+        instruction.fadeTime = time;
+    }
+    else if (command == Script::labelCmd)
+    {
+        // A label just exists. Not much to do here.
+        if (tokens.size() > 1)
+            return QString("Too many arguments");
+    }
+    else if (command == Script::jumpCmd)
+    {
+        if (tokens.size() > 1)
+            return QString("Too many arguments");
 
-    id = tokens[0][1].toUInt(&ok);
-    if (ok == false)
-        return QString("Invalid fixture (ID: %1)").arg(tokens[0][1]);
+        if (m_labels.contains(tokens[0][1]) == false)
+            return QString("No such label: %1").arg(tokens[0][1]);
 
-    for (int i = 1; i < tokens.size(); i++)
+        instruction.opcode = Jump;
+        instruction.jumpTarget = m_labels[tokens[0][1]];
+    }
+    else
     {
-        QStringList list = tokens[i];
-        list[0] = list[0].toLower().trimmed();
-        if (list.size() == 2)
-        {
-            ok = false;
-            if (list[0] == "val" || list[0] == "value")
-                value = uchar(list[1].toUInt(&ok));
-            else if (list[0] == "ch" || list[0] == "channel")
-                ch = list[1].toUInt(&ok);
-            else if (list[0] == "time")
-                time = list[1].toDouble(&ok);
-            else
-                return QString("Unrecognized keyword: %1").arg(list[0]);
-
-            if (ok == false)
-                return QString("Invalid value (%1) for keyword: %2").arg(list[1]).arg(list[0]);
-        }
+        return QString("Unknown command: %1").arg(command);
     }
 
+    return QString();
+}
+
+void Script::resolveReferences()
+{
     Doc* doc = qobject_cast<Doc*> (parent());
     Q_ASSERT(doc != NULL);
 
-    Fixture* fxi = doc->fixture(id);
-    if (fxi != NULL)
+    for (int i = 0; i < m_program.size(); i++)
     {
-        if (ch < fxi->channels())
-        {
-            int address = fxi->address() + ch;
-            if (address < 512)
-            {
-                GenericFader* gf = fader();
-                Q_ASSERT(gf != NULL);
+        Instruction& instruction = m_program[i];
+        QString error;
 
-                FadeChannel fc;
-                fc.setFixture(doc, fxi->id());
-                fc.setChannel(ch);
-                fc.setTarget(value);
-                fc.setFadeTime(time);
-
-                // If the script has used the channel previously, it might still be in
-                // the bowels of GenericFader so get the starting value from there.
-                // Otherwise get it from universes (HTP channels are always 0 then).
-                quint32 uni = fc.universe();
-                if (gf->channels().contains(fc) == true)
-                    fc.setStart(gf->channels()[fc].current());
-                else
-                    fc.setStart(universes[uni]->preGMValues()[address]);
-                fc.setCurrent(fc.start());
-
-                gf->add(fc);
+        if (instruction.opcode == StartFunction || instruction.opcode == StopFunction)
+        {
+            instruction.function = doc->function(instruction.id);
+            if (instruction.function == NULL)
+                error = QString("No such function (ID %1)").arg(instruction.id);
+        }
+        else if (instruction.opcode == SetFixture)
+        {
+            instruction.resolved = false;
 
-                return QString();
+            Fixture* fxi = doc->fixture(instruction.id);
+            if (fxi == NULL)
+            {
+                error = QString("No such fixture (ID: %1)").arg(instruction.id);
+            }
+            else if (instruction.channel >= fxi->channels())
+            {
+                error = QString("Fixture (%1) has no channel number %2")
+                            .arg(fxi->name()).arg(instruction.channel);
+            }
+            else if (fxi->address() + instruction.channel >= 512)
+            {
+                error = QString("Invalid address: %1").arg(fxi->address() + instruction.channel);
             }
             else
             {
-                return QString("Invalid address: %1").arg(address);
+                FadeChannel fc;
+                fc.setFixture(doc, fxi->id());
+                fc.setChannel(instruction.channel);
+                fc.setTarget(instruction.value);
+                fc.setFadeTime(instruction.fadeTime);
+                instruction.fadeChannel = fc;
+                instruction.resolved = true;
             }
         }
         else
         {
-            return QString("Fixture (%1) has no channel number %2").arg(fxi->name()).arg(ch);
+            continue;
         }
-    }
-    else
-    {
-        return QString("No such fixture (ID: %1)").arg(id);
-    }
-}
 
-QString Script::handleLabel(const QList<QStringList>& tokens)
-{
-    // A label just exists. Not much to do here.
-    qDebug() << Q_FUNC_INFO;
-
-    if (tokens.size() > 1)
-        return QString("Too many arguments");
+        if (error.isEmpty() == false)
+            qWarning() << QString("Script:%1, line:%2, error:%3").arg(name()).arg(i).arg(error);
+        else
+            instruction.resolved = true;
+    }
 
-    return QString();
+    m_resolved = true;
 }
 
-QString Script::handleJump(const QList<QStringList>& tokens)
+void Script::slotDocContentsChanged(quint32 id)
 {
-    qDebug() << Q_FUNC_INFO;
-
-    if (tokens.size() > 1)
-        return QString("Too many arguments");
-
-    if (m_labels.contains(tokens[0][1]) == true)
-    {
-        int lineNumber = m_labels[tokens[0][1]];
-        Q_ASSERT(lineNumber >= 0 && lineNumber < m_lines.size());
-        m_currentCommand = lineNumber;
-        return QString();
-    }
-    else
-    {
-        return QString("No such label: %1").arg(tokens[0][1]);
-    }
+    Q_UNUSED(id);
+    m_resolved = false;
 }
 
 QList <QStringList> Script::tokenizeLine(const QString& str, bool* ok)
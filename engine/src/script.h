@@ -23,6 +23,9 @@
 #include <QStringList>
 #include <QObject>
 #include <QMap>
+#include <QVector>
+
+#include "fadechannel.h"
 #include "function.h"
 
 class GenericFader;
@@ -83,6 +86,73 @@ public:
 private:
     QString m_data;
 
+    /************************************************************************
+     * Compilation
+     ************************************************************************/
+private:
+    /** Operation codes of compiled script lines */
+    enum OpCode
+    {
+        NoOp = 0,       //! Empty line, comment or label
+        StartFunction,
+        StopFunction,
+        Wait,
+        WaitKey,
+        SetFixture,
+        Jump,
+        Invalid         //! Line that failed to compile
+    };
+
+    /**
+     * A script line compiled into an instruction that can be executed
+     * without any string handling. References to functions and fixtures
+     * are resolved by resolveReferences().
+     */
+    struct Instruction
+    {
+        Instruction()
+            : opcode(NoOp), id(0), channel(0), value(0), fadeTime(0)
+            , waitTicks(0), jumpTarget(-1), function(NULL), resolved(false) { }
+
+        OpCode opcode;
+        quint32 id;               //! Function or fixture ID
+        quint32 channel;          //! Fixture channel (setfixture)
+        uchar value;              //! Channel value (setfixture)
+        uint fadeTime;            //! Fade time (setfixture)
+        quint32 waitTicks;        //! Duration in MasterTimer ticks (wait)
+        int jumpTarget;           //! Line number of the target label (jump)
+        Function* function;       //! Resolved function (start/stopfunction)
+        FadeChannel fadeChannel;  //! Resolved channel template (setfixture)
+        bool resolved;            //! True if the references have been resolved
+        QString error;            //! Compilation or resolution error
+    };
+
+    /**
+     * Compile a tokenized script line into an instruction.
+     *
+     * @param tokens The line tokens, as returned by tokenizeLine()
+     * @param instruction The instruction to fill
+     * @return An empty string if successful. Otherwise an error string.
+     */
+    QString compileLine(const QList<QStringList>& tokens, Instruction& instruction);
+
+    /**
+     * Resolve function and fixture IDs into direct references. This is done
+     * at start and every time the functions or fixtures in Doc change.
+     */
+    void resolveReferences();
+
+private slots:
+    /** Invalidate the resolved references when Doc contents change */
+    void slotDocContentsChanged(quint32 id);
+
+private:
+    /** The compiled script lines */
+    QVector <Instruction> m_program;
+
+    /** Flag telling if m_program references need to be resolved again */
+    bool m_resolved;
+
     /************************************************************************
      * Load & Save
      ************************************************************************/
@@ -127,63 +197,12 @@ private:
     bool waiting();
 
     /**
-     * Handle "startfunction" command.
+     * Handle a compiled "setfixture" instruction.
      *
-     * @param command The first keyword:value pair
-     * @param timer The MasterTimer that should run the function
-     * @return An empty string if successful. Otherwise an error string.
-     */
-    QString handleStartFunction(const QList<QStringList>& tokens, MasterTimer* timer);
-
-    /**
-     * Handle "stopfunction" command.
-     *
-     * @param command The first keyword:value pair
-     * @return An empty string if successful. Otherwise an error string.
-     */
-    QString handleStopFunction(const QList<QStringList>& tokens);
-
-    /**
-     * Handle "wait" command.
-     *
-     * @param command The first keyword:value pair
-     * @return An empty string if successful. Otherwise an error string.
-     */
-    QString handleWait(const QList<QStringList>& tokens);
-
-    /**
-     * Handle "waitkey" command.
-     *
-     * @param command The first keyword:value pair
-     * @return An empty string if successful. Otherwise an error string.
-     */
-    QString handleWaitKey(const QList<QStringList>& tokens);
-
-    /**
-     * Handle "setfixture" command.
-     *
-     * @param command The first keyword:value pair
-     * @param tokens All keyword:value pairs (including the first one)
-     * @param universes The universe array to write DMX data
-     * @return An empty string if successful. Otherwise an error string.
-     */
-    QString handleSetFixture(const QList<QStringList>& tokens, QList<Universe*> universes);
-
-    /**
-     * Handle "label" command.
-     *
-     * @param command The first keyword:value pair
-     * @return An empty string if successful. Otherwise an error string.
-     */
-    QString handleLabel(const QList<QStringList>& tokens);
-
-    /**
-     * Handle "jump" command.
-     *
-     * @param command The first keyword:value pair
-     * @return An empty string if successful. Otherwise an error string.
+     * @param instruction The resolved instruction
+     * @param timer The MasterTimer whose snapshot has the current DMX data
      */
-    QString handleJump(const QList<QStringList>& tokens);
+    void executeSetFixture(const Instruction& instruction, const MasterTimer* timer);
 
     /**
      * Parse one line of script data into a list of token string lists
@@ -201,7 +220,6 @@ private:
 private:
     int m_currentCommand;        //! Current command line being handled
     quint32 m_waitCount;         //! Timer ticks to wait before executing the next line
-    QList <QList<QStringList> > m_lines; //! Raw data parsed into lines of tokens
     QMap <QString,int> m_labels; //! Labels and their line numbers
     QList <Function*> m_startedFunctions; //! Functions started by this script
 
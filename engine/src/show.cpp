@@ -26,6 +26,9 @@
 #include "qlcfile.h"
 #include "qlcmacros.h"
 
+#include "timecodeclock.h"
+#include "audiocapture.h"
+#include "mastertimer.h"
 #include "showrunner.h"
 #include "function.h"
 #include "chaser.h"
@@ -35,6 +38,10 @@
 #define KXMLQLCShowTimeDivision "TimeDivision"
 #define KXMLQLCShowTimeType "Type"
 #define KXMLQLCShowTimeBPM "BPM"
+#define KXMLQLCShowAudioSync "AudioSync"
+#define KXMLQLCShowTimecode "Timecode"
+#define KXMLQLCShowTimecodeSource "Source"
+#define KXMLQLCShowTimecodeOffset "Offset"
 
 /*****************************************************************************
  * Initialization
@@ -43,6 +50,10 @@
 Show::Show(Doc* doc) : Function(doc, Function::Show)
   , m_timeDivType(QString("Time"))
   , m_timeDivBPM(120)
+  , m_audioSync(false)
+  , m_timecodeSource(NoTimecode)
+  , m_timecodeOffset(0)
+  , m_timecodeCaptureAcquired(false)
   , m_latestTrackId(0)
   , m_runner(NULL)
 {
@@ -89,6 +100,9 @@ bool Show::copyFrom(const Function* function)
 
     m_timeDivType = show->m_timeDivType;
     m_timeDivBPM = show->m_timeDivBPM;
+    m_audioSync = show->m_audioSync;
+    m_timecodeSource = show->m_timecodeSource;
+    m_timecodeOffset = show->m_timecodeOffset;
     m_latestTrackId = show->m_latestTrackId;
 
     // create a copy of each track
@@ -140,6 +154,89 @@ int Show::getTimeDivisionBPM()
     return m_timeDivBPM;
 }
 
+/*********************************************************************
+ * Audio synchronization
+ *********************************************************************/
+
+void Show::setAudioSync(bool enable)
+{
+    m_audioSync = enable;
+}
+
+bool Show::audioSync() const
+{
+    return m_audioSync;
+}
+
+/*********************************************************************
+ * Timecode
+ *********************************************************************/
+
+void Show::setTimecodeSource(TimecodeSource source)
+{
+    m_timecodeSource = source;
+}
+
+Show::TimecodeSource Show::timecodeSource() const
+{
+    return m_timecodeSource;
+}
+
+QString Show::timecodeSourceToString(TimecodeSource source)
+{
+    switch (source)
+    {
+        case MIDITimecode: return QString("MTC");
+        case LinearTimecode: return QString("LTC");
+        default: return QString("None");
+    }
+}
+
+Show::TimecodeSource Show::stringToTimecodeSource(const QString& str)
+{
+    if (str == "MTC")
+        return MIDITimecode;
+    else if (str == "LTC")
+        return LinearTimecode;
+    else
+        return NoTimecode;
+}
+
+void Show::setTimecodeOffset(quint32 msecs)
+{
+    m_timecodeOffset = msecs;
+}
+
+quint32 Show::timecodeOffset() const
+{
+    return m_timecodeOffset;
+}
+
+void Show::slotEnableLinearTimecode(bool enable)
+{
+    AudioCapture *capture = doc()->audioInputCapture();
+    TimecodeClock *clock = doc()->masterTimer()->linearTimecode();
+
+    if (enable == true)
+    {
+        if (m_timecodeCaptureAcquired == true)
+            return;
+
+        if (capture->acquire(clock) == false)
+        {
+            qWarning() << Q_FUNC_INFO << "Cannot open the audio input to decode LTC";
+            return;
+        }
+        m_timecodeCaptureAcquired = true;
+    }
+    else
+    {
+        if (m_timecodeCaptureAcquired == true)
+            capture->release(clock);
+        m_timecodeCaptureAcquired = false;
+    }
+}
+
 /*****************************************************************************
  * Tracks
  *****************************************************************************/
@@ -277,6 +374,22 @@ bool Show::saveXML(QDomDocument* doc, QDomElement* wksp_root)
     td.setAttribute(KXMLQLCShowTimeBPM, m_timeDivBPM);
     root.appendChild(td);
 
+    if (m_audioSync == true)
+    {
+        QDomElement sync = doc->createElement(KXMLQLCShowAudioSync);
+        QDomText text = doc->createTextNode(KXMLQLCTrue);
+        sync.appendChild(text);
+        root.appendChild(sync);
+    }
+
+    if (m_timecodeSource != NoTimecode)
+    {
+        QDomElement tc = doc->createElement(KXMLQLCShowTimecode);
+        tc.setAttribute(KXMLQLCShowTimecodeSource, timecodeSourceToString(m_timecodeSource));
+        tc.setAttribute(KXMLQLCShowTimecodeOffset, m_timecodeOffset);
+        root.appendChild(tc);
+    }
+
     foreach(Track *track, m_tracks)
         track->saveXML(doc, &root);
 
@@ -308,6 +421,15 @@ bool Show::loadXML(const QDomElement& root)
             int bpm = (tag.attribute(KXMLQLCShowTimeBPM)).toInt();
             setTimeDivision(type, bpm);
         }
+        else if (tag.tagName() == KXMLQLCShowAudioSync)
+        {
+            setAudioSync(tag.text() == KXMLQLCTrue);
+        }
+        else if (tag.tagName() == KXMLQLCShowTimecode)
+        {
+            setTimecodeSource(stringToTimecodeSource(tag.attribute(KXMLQLCShowTimecodeSource)));
+            setTimecodeOffset(tag.attribute(KXMLQLCShowTimecodeOffset).toUInt());
+        }
         else if (tag.tagName() == KXMLQLCTrack)
         {
             Track *trk = new Track();
@@ -344,6 +466,21 @@ void Show::preRun(MasterTimer* timer)
     foreach(Track *track, m_tracks.values())
         m_runner->adjustIntensity(getAttributeValue(i++), track);
 
+    m_runner->setAudioSync(m_audioSync);
+
+    if (m_timecodeSource == MIDITimecode)
+    {
+        m_runner->setTimecode(timer->midiTimecode(), m_timecodeOffset);
+    }
+    else if (m_timecodeSource == LinearTimecode)
+    {
+        // Don't chase what was decoded the last time
+        timer->linearTimecode()->reset();
+        QMetaObject::invokeMethod(this, "slotEnableLinearTimecode", Qt::QueuedConnection,
+                                  Q_ARG(bool, true));
+        m_runner->setTimecode(timer->linearTimecode(), m_timecodeOffset);
+    }
+
     connect(m_runner, SIGNAL(timeChanged(quint32)), this, SIGNAL(timeChanged(quint32)));
     connect(m_runner, SIGNAL(showFinished()), this, SIGNAL(showFinished()));
     m_runner->start();
@@ -364,6 +501,9 @@ void Show::postRun(MasterTimer* timer, QList<Universe *> universes)
         delete m_runner;
         m_runner = NULL;
     }
+    // The timecode source may have changed while running
+    QMetaObject::invokeMethod(this, "slotEnableLinearTimecode", Qt::QueuedConnection,
+                              Q_ARG(bool, false));
     Function::postRun(timer, universes);
 }
 
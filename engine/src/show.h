@@ -69,6 +69,66 @@ private:
     QString m_timeDivType;
     int m_timeDivBPM;
 
+    /*********************************************************************
+     * Audio synchronization
+     *********************************************************************/
+public:
+    /**
+     * Set if the show timeline should follow the playback position
+     * of its Audio tracks instead of the MasterTimer ticks
+     */
+    void setAudioSync(bool enable);
+
+    /** Returns true if the show timeline follows the audio clock */
+    bool audioSync() const;
+
+private:
+    bool m_audioSync;
+
+    /*********************************************************************
+     * Timecode
+     *********************************************************************/
+public:
+    /** The external timecode a show timeline can chase */
+    enum TimecodeSource
+    {
+        NoTimecode = 0, //! Follow MasterTimer ticks (or the audio clock)
+        MIDITimecode,   //! MIDI Time Code received on any input universe
+        LinearTimecode  //! LTC decoded from the audio input
+    };
+
+    /** Set the external timecode that the show timeline chases */
+    void setTimecodeSource(TimecodeSource source);
+
+    /** Get the external timecode that the show timeline chases */
+    TimecodeSource timecodeSource() const;
+
+    static QString timecodeSourceToString(TimecodeSource source);
+    static TimecodeSource stringToTimecodeSource(const QString& str);
+
+    /**
+     * Set the timecode position (in ms) where the show starts, e.g.
+     * 3600000 for timecode starting at 01:00:00:00
+     */
+    void setTimecodeOffset(quint32 msecs);
+
+    /** Get the timecode position (in ms) where the show starts */
+    quint32 timecodeOffset() const;
+
+private slots:
+    /**
+     * Start/stop decoding LTC from the audio input, sharing the audio
+     * capture with its other users. The capture must be opened and closed
+     * on the main thread, so preRun() and postRun() queue this call.
+     */
+    void slotEnableLinearTimecode(bool enable);
+
+private:
+    TimecodeSource m_timecodeSource;
+    quint32 m_timecodeOffset;
+    /** The audio capture has been acquired by this show, to decode LTC */
+    bool m_timecodeCaptureAcquired;
+
     /*********************************************************************
      * Tracks
      *********************************************************************/
@@ -19,7 +19,10 @@
 
 #include <QMutex>
 #include <QDebug>
+#include <QHash>
+#include <climits>
 
+#include "timecodeclock.h"
 #include "showrunner.h"
 #include "chaserstep.h"
 #include "function.h"
@@ -31,32 +34,20 @@
 
 #define TIMER_INTERVAL 50
 
+static quint32 functionStartTime(const Function *f)
+{
+    if (f->type() == Function::Audio)
+        return (qobject_cast<const Audio*> (f))->getStartTime();
+    else
+        return (qobject_cast<const Chaser*> (f))->getStartTime();
+}
+
 static bool compareFunctions(const Function *f1, const Function *f2)
 {
     if (f1 == NULL || f2 == NULL)
         return false;
 
-    quint32 st1 = 0;
-    quint32 st2 = 0;
-    if (f1->type() == Function::Audio)
-    {
-        st1 = (qobject_cast<const Audio*> (f1))->getStartTime();
-    }
-    else
-    {
-        st1 = (qobject_cast<const Chaser*> (f1))->getStartTime();
-    }
-
-    if (f2->type() == Function::Audio)
-    {
-        st2 = (qobject_cast<const Audio*> (f2))->getStartTime();
-    }
-    else
-    {
-        st2 = (qobject_cast<const Chaser*> (f2))->getStartTime();
-    }
-
-    if (st1 < st2)
+    if (functionStartTime(f1) < functionStartTime(f2))
         return true;
     else
         return false;
@@ -68,6 +59,11 @@ ShowRunner::ShowRunner(const Doc* doc, quint32 showID, quint32 startTime)
     , m_elapsedTime(startTime)
     , m_totalRunTime(0)
     , m_currentFunctionIndex(0)
+    , m_audioSync(false)
+    , m_timecode(NULL)
+    , m_timecodeOffset(0)
+    , m_timecodeJumps(0)
+    , m_timecodeSynced(false)
 {
     Q_ASSERT(m_doc != NULL);
     Q_ASSERT(showID != Show::invalidId());
@@ -76,6 +72,8 @@ ShowRunner::ShowRunner(const Doc* doc, quint32 showID, quint32 startTime)
     if (m_show == NULL)
         return;
 
+    QHash <Function *, quint32> durations;
+
     foreach(Track *track, m_show->tracks())
     {
         // some sanity checks
@@ -87,7 +85,8 @@ ShowRunner::ShowRunner(const Doc* doc, quint32 showID, quint32 startTime)
         if (track->isMute())
             continue;
 
-        // get all the sequences of the track and append them to the runner queue
+        // get all the sequences of the track and append them to the runner queue.
+        // Those ending before startTime are needed too, in case of a seek.
         foreach (quint32 funcID, track->functionsID())
         {
             if (m_doc->function(funcID)->type() == Function::Chaser)
@@ -96,13 +95,11 @@ ShowRunner::ShowRunner(const Doc* doc, quint32 showID, quint32 startTime)
                 if (chaser == NULL)
                     continue;
                 quint32 seq_duration = chaser->getDuration();
-                if (chaser->getStartTime() + seq_duration <= startTime)
-                    continue;
                 m_functions.append(m_doc->function(funcID));
                 connect(chaser, SIGNAL(stopped(quint32)), this, SLOT(slotSequenceStopped(quint32)));
 
                 // offline calculation of the show
-                m_durations.append(seq_duration);
+                durations[chaser] = seq_duration;
                 if (chaser->getStartTime() + seq_duration > m_totalRunTime)
                     m_totalRunTime = chaser->getStartTime() + seq_duration;
             }
@@ -111,11 +108,9 @@ ShowRunner::ShowRunner(const Doc* doc, quint32 showID, quint32 startTime)
                 Audio *audio = qobject_cast<Audio*> (m_doc->function(funcID));
                 if (audio == NULL)
                     continue;
-                if (audio->getStartTime() + audio->getDuration() <= startTime)
-                    continue;
                 m_functions.append(m_doc->function(funcID));
                 connect(audio, SIGNAL(stopped(quint32)), this, SLOT(slotSequenceStopped(quint32)));
-                m_durations.append(audio->getDuration());
+                durations[audio] = audio->getDuration();
                 if (audio->getStartTime() + audio->getDuration() > m_totalRunTime)
                     m_totalRunTime = audio->getStartTime() + audio->getDuration();
             }
@@ -126,6 +121,8 @@ ShowRunner::ShowRunner(const Doc* doc, quint32 showID, quint32 startTime)
     }
 
     qSort(m_functions.begin(), m_functions.end(), compareFunctions);
+    foreach (Function *f, m_functions)
+        m_durations.append(durations.value(f));
 
     m_runningQueue.clear();
 
@@ -153,6 +150,37 @@ void ShowRunner::stop()
     qDebug() << "ShowRunner stopped";
 }
 
+void ShowRunner::setAudioSync(bool enable)
+{
+    m_audioSync = enable;
+}
+
+bool ShowRunner::audioSync() const
+{
+    return m_audioSync;
+}
+
+qint64 ShowRunner::audioClockTime()
+{
+    QMutexLocker locker(&m_runningQueueMutex);
+
+    foreach (Function *f, m_runningQueue)
+    {
+        if (f->type() != Function::Audio)
+            continue;
+
+        Audio *audio = qobject_cast<Audio*>(f);
+        if (audio == NULL)
+            continue;
+
+        qint64 pos = audio->playbackPosition();
+        if (pos >= 0)
+            return (qint64)audio->getStartTime() + pos;
+    }
+
+    return -1;
+}
+
 void ShowRunner::slotSequenceStopped(quint32 id)
 {
     m_runningQueueMutex.lock();
@@ -165,54 +193,143 @@ void ShowRunner::slotSequenceStopped(quint32 id)
 void ShowRunner::write()
 {
     //qDebug() << Q_FUNC_INFO << "elapsed:" << m_elapsedTime << ", total:" << m_totalRunTime;
-    if (m_currentFunctionIndex < m_functions.count())
+    if (m_timecode != NULL)
+        chaseTimecode();
+
+    startFunctions();
+
+    // end of the show. A show chasing timecode waits for it to move back instead.
+    if (m_elapsedTime >= m_totalRunTime && m_timecode == NULL)
     {
-        quint32 funcStartTime = 0;
-        quint32 functionTimeOffset = 0;
-        Function *f = m_functions.at(m_currentFunctionIndex);
-        if (f->type() == Function::Chaser)
-        {
-            Chaser *chaser = qobject_cast<Chaser*>(f);
-            funcStartTime = chaser->getStartTime();
-        }
-        else if (f->type() == Function::Audio)
-        {
-            Audio *audio = qobject_cast<Audio*>(f);
-            funcStartTime = audio->getStartTime();
-        }
-        // this should happen only when a Show is not started from 0
-        if (m_elapsedTime > funcStartTime)
+        if (m_show != NULL)
+            m_show->stop();
+        emit showFinished();
+        return;
+    }
+
+    if (m_timecode != NULL)
+    {
+        emit timeChanged(m_elapsedTime);
+        return;
+    }
+
+    if (m_audioSync == true)
+    {
+        qint64 audioTime = audioClockTime();
+        if (audioTime >= 0)
         {
-            functionTimeOffset = m_elapsedTime - funcStartTime;
-            funcStartTime = m_elapsedTime;
+            /* Follow the audio clock. The timeline never goes backwards:
+             * if the audio is late (e.g. the device is still filling its
+             * buffers) the timeline simply waits for it */
+            if (audioTime > (qint64)m_elapsedTime)
+                m_elapsedTime = audioTime;
+            emit timeChanged(m_elapsedTime);
+            return;
         }
-        if (m_elapsedTime == funcStartTime)
+    }
+
+    m_elapsedTime += MasterTimer::tick();
+    emit timeChanged(m_elapsedTime);
+}
+
+void ShowRunner::startFunctions()
+{
+    while (m_currentFunctionIndex < m_functions.count())
+    {
+        Function *f = m_functions.at(m_currentFunctionIndex);
+        quint32 funcStartTime = functionStartTime(f);
+        if (funcStartTime > m_elapsedTime)
+            break;
+
+        // Stopped by a seek, but not post-run by MasterTimer yet: it can
+        // be started again only on a later tick
+        if (f->isRunning() == true && f->stopped() == true)
+            break;
+
+        quint32 duration = m_durations.at(m_currentFunctionIndex);
+        m_currentFunctionIndex++;
+
+        // Already over. This happens when a Show is not started from 0.
+        if (funcStartTime + duration <= m_elapsedTime)
+            continue;
+
+        foreach (Track *track, m_show->tracks())
         {
-            foreach (Track *track, m_show->tracks())
+            if (track->functionsID().contains(f->id()))
             {
-                if (track->functionsID().contains(f->id()))
-                {
-                    f->adjustAttribute(m_intensityMap[track->id()], Function::Intensity);
-                    break;
-                }
+                f->adjustAttribute(m_intensityMap[track->id()], Function::Intensity);
+                break;
             }
-
-            f->start(m_doc->masterTimer(), true, functionTimeOffset);
-            m_runningQueue.append(f);
-            m_currentFunctionIndex++;
         }
+
+        // Functions that should have started already start at the
+        // position they would be at now
+        f->start(m_doc->masterTimer(), true, m_elapsedTime - funcStartTime);
+        m_runningQueueMutex.lock();
+        m_runningQueue.append(f);
+        m_runningQueueMutex.unlock();
     }
-    // end of the show
-    if (m_elapsedTime >= m_totalRunTime)
-    {
-        if (m_show != NULL)
-            m_show->stop();
-        emit showFinished();
+}
+
+/************************************************************************
+ * Timecode
+ ************************************************************************/
+
+void ShowRunner::setTimecode(TimecodeClock *clock, quint32 offset)
+{
+    m_timecode = clock;
+    m_timecodeOffset = offset;
+    m_timecodeSynced = false;
+}
+
+TimecodeClock *ShowRunner::timecode() const
+{
+    return m_timecode;
+}
+
+void ShowRunner::chaseTimecode()
+{
+    qint64 position = m_timecode->position(m_timecode->now());
+
+    // Hold until some timecode is received
+    if (position < 0)
         return;
+
+    // The show starts at m_timecodeOffset on the timecode
+    quint32 time = quint32(qBound(qint64(0), position - qint64(m_timecodeOffset),
+                                  qint64(UINT_MAX)));
+    quint32 jumps = m_timecode->jumps();
+
+    if (m_timecodeSynced == false || jumps != m_timecodeJumps)
+    {
+        m_timecodeSynced = true;
+        m_timecodeJumps = jumps;
+        if (time != m_elapsedTime)
+            seek(time);
+    }
+    else if (time > m_elapsedTime)
+    {
+        // Catch up. Small corrections backwards are absorbed by holding
+        // still, as for the audio clock.
+        m_elapsedTime = time;
     }
+}
 
-    m_elapsedTime += MasterTimer::tick();
-    emit timeChanged(m_elapsedTime);
+void ShowRunner::seek(quint32 time)
+{
+    qDebug() << Q_FUNC_INFO << "from" << m_elapsedTime << "to" << time;
+
+    // Rather than replaying the show from the start, every function is
+    // stopped and then the ones covering the new time are started again
+    // by startFunctions(), at the position they would be at
+    m_runningQueueMutex.lock();
+    foreach (Function *f, m_runningQueue)
+        f->stop();
+    m_runningQueue.clear();
+    m_runningQueueMutex.unlock();
+
+    m_elapsedTime = time;
+    m_currentFunctionIndex = 0;
 }
 
 /************************************************************************
@@ -24,6 +24,7 @@
 #include <QMutex>
 #include <QMap>
 
+class TimecodeClock;
 class Function;
 class Track;
 class Show;
@@ -49,6 +50,30 @@ public:
 
     void write();
 
+    /**
+     * Enable/disable the synchronization of the show timeline
+     * to the playback position of the running Audio functions.
+     * When no Audio function is playing, the timeline keeps on
+     * advancing with the MasterTimer ticks.
+     */
+    void setAudioSync(bool enable);
+
+    /** Returns true if the timeline is slaved to audio playback */
+    bool audioSync() const;
+
+private:
+    /**
+     * Start the functions whose start time has been reached. Functions
+     * that should have started earlier start at the right position.
+     */
+    void startFunctions();
+
+    /**
+     * Returns the show time (in milliseconds) reported by the first
+     * Audio function currently playing, or -1 if there's none.
+     */
+    qint64 audioClockTime();
+
 private:
     const Doc* m_doc;
 
@@ -58,7 +83,7 @@ private:
     /** The list of Functions of the show to play */
     QList <Function *> m_functions;
 
-    /** List of duration of each function */
+    /** List of duration of each function, in the same order as m_functions */
     QList <quint32> m_durations;
 
     /** Elapsed time since runner start. Used also to move the cursor in MultiTrackView */
@@ -74,6 +99,9 @@ private:
     /** Current step being played */
     int m_currentFunctionIndex;
 
+    /** Flag to follow the audio clock instead of MasterTimer ticks */
+    bool m_audioSync;
+
 private slots:
     void slotSequenceStopped(quint32);
 
@@ -81,6 +109,42 @@ signals:
     void timeChanged(quint32 time);
     void showFinished();
 
+    /************************************************************************
+     * Timecode
+     ************************************************************************/
+public:
+    /**
+     * Slave the show timeline to the external timecode chased by $clock,
+     * instead of the MasterTimer ticks. The show starts at $offset
+     * milliseconds on the timecode. NULL frees the timeline again.
+     *
+     * The timeline holds until timecode is received, follows its dropout
+     * freewheel, and seeks when the timecode jumps. At the end of the
+     * show, the runner waits for the timecode to move back.
+     */
+    void setTimecode(TimecodeClock *clock, quint32 offset);
+
+    /** Returns the timecode the timeline is slaved to, if any */
+    TimecodeClock *timecode() const;
+
+private:
+    /** Move the timeline to the timecode position. Called by write(). */
+    void chaseTimecode();
+
+    /**
+     * Move the timeline to $time, restarting all the functions that are
+     * running at the new time from their right position
+     */
+    void seek(quint32 time);
+
+private:
+    TimecodeClock *m_timecode;
+    quint32 m_timecodeOffset;
+    /** The timecode jumps seen so far */
+    quint32 m_timecodeJumps;
+    /** False until the timeline has been moved to the first timecode position */
+    bool m_timecodeSynced;
+
     /************************************************************************
      * Intensity
      ************************************************************************/
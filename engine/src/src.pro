@@ -51,13 +51,16 @@ HEADERS += audio/audio.h \
            audio/audiodecoder.h \
            audio/audiorenderer.h \
            audio/audioparameters.h \
-           audio/audiocapture.h
+           audio/audiocapture.h \
+           audio/audiopeakcache.h \
+           audio/ltcdecoder.h
 
 unix:!macx:HEADERS += audio/audiorenderer_alsa.h audio/audiocapture_alsa.h
 win32:HEADERS += audio/audiorenderer_waveout.h audio/audiocapture_wavein.h
 
 # Engine
 HEADERS += bus.h \
+           channelremap.h \
            channelsgroup.h \
            chaser.h \
            chaserrunner.h \
@@ -93,11 +96,18 @@ HEADERS += bus.h \
            rgbtext.h \
            scene.h \
            scenevalue.h \
+           scheduler.h \
            script.h \
            show.h \
            showrunner.h \
+           tempoclock.h \
+           tickprofiler.h \
+           timecodeclock.h \
            track.h \
-           universe.h
+           universe.h \
+           universesnapshot.h \
+           universewritebuffer.h \
+           workspacesnapshot.h
 
 win32:HEADERS += mastertimer-win32.h
 unix:HEADERS  += mastertimer-unix.h
@@ -121,7 +131,9 @@ SOURCES += audio/audio.cpp \
            audio/audiodecoder.cpp \
            audio/audiorenderer.cpp \
            audio/audioparameters.cpp \
-           audio/audiocapture.cpp
+           audio/audiocapture.cpp \
+           audio/audiopeakcache.cpp \
+           audio/ltcdecoder.cpp
 
 unix:!macx:SOURCES += audio/audiorenderer_alsa.cpp audio/audiocapture_alsa.cpp
 win32:SOURCES += audio/audiorenderer_waveout.cpp audio/audiocapture_wavein.cpp
@@ -140,6 +152,7 @@ macx {
 
 # Engine
 SOURCES += bus.cpp \
+           channelremap.cpp \
            channelsgroup.cpp \
            chaser.cpp \
            chaserrunner.cpp \
@@ -174,11 +187,18 @@ SOURCES += bus.cpp \
            rgbtext.cpp \
            scene.cpp \
            scenevalue.cpp \
+           scheduler.cpp \
            script.cpp \
            show.cpp \
            showrunner.cpp \
+           tempoclock.cpp \
+           tickprofiler.cpp \
+           timecodeclock.cpp \
            track.cpp \
-           universe.cpp
+           universe.cpp \
+           universesnapshot.cpp \
+           universewritebuffer.cpp \
+           workspacesnapshot.cpp
 
 win32:SOURCES += mastertimer-win32.cpp
 unix:SOURCES  += mastertimer-unix.cpp
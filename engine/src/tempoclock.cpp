@@ -0,0 +1,287 @@
+/*
+  Q Light Controller Plus
+  tempoclock.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QMutexLocker>
+#include <climits>
+#include <math.h>
+
+#include "tempoclock.h"
+
+/** Bandwidth of the delay-locked loop in Hz. Lower is smoother but slower to follow tempo changes. */
+#define DLL_BANDWIDTH 1.0
+
+#define NSECS_PER_MINUTE 60e9
+
+static qreal clampPeriod(qreal nsecs)
+{
+    const qreal minPeriod = NSECS_PER_MINUTE / TEMPOCLOCK_MAX_BPM / TEMPOCLOCK_PPQN;
+    const qreal maxPeriod = NSECS_PER_MINUTE / TEMPOCLOCK_MIN_BPM / TEMPOCLOCK_PPQN;
+    return qBound(minPeriod, nsecs, maxPeriod);
+}
+
+TempoClock::TempoClock()
+    : m_anchorNsecs(0)
+    , m_anchorBeats(0)
+    , m_beatNsecs(NSECS_PER_MINUTE / TEMPOCLOCK_DEFAULT_BPM)
+    , m_running(true)
+    , m_source(TempoClock::invalidSource())
+    , m_lastPulseNsecs(0)
+    , m_pulses(0)
+    , m_startPending(false)
+    , m_pulseNsecs(0)
+    , m_periodNsecs(0)
+    , m_pulseBeats(0)
+    , m_ticked(false)
+    , m_tickPosition(0)
+    , m_tickDelta(0)
+{
+    m_time.start();
+}
+
+TempoClock::~TempoClock()
+{
+}
+
+qint64 TempoClock::now() const
+{
+    return m_time.nsecsElapsed();
+}
+
+quint32 TempoClock::invalidSource()
+{
+    return UINT_MAX;
+}
+
+/****************************************************************************
+ * Tempo
+ ****************************************************************************/
+
+void TempoClock::setBpm(qreal bpm)
+{
+    QMutexLocker locker(&m_mutex);
+
+    reanchor(now());
+    m_beatNsecs = NSECS_PER_MINUTE / qBound(qreal(TEMPOCLOCK_MIN_BPM), bpm,
+                                            qreal(TEMPOCLOCK_MAX_BPM));
+}
+
+qreal TempoClock::bpm() const
+{
+    QMutexLocker locker(&m_mutex);
+    return NSECS_PER_MINUTE / m_beatNsecs;
+}
+
+qreal TempoClock::beats(qint64 nsecs) const
+{
+    QMutexLocker locker(&m_mutex);
+    return beatsLocked(nsecs);
+}
+
+qreal TempoClock::beatsLocked(qint64 nsecs) const
+{
+    if (m_running == false)
+        return m_anchorBeats;
+
+    return m_anchorBeats + qreal(nsecs - m_anchorNsecs) / m_beatNsecs;
+}
+
+void TempoClock::reanchor(qint64 nsecs)
+{
+    m_anchorBeats = beatsLocked(nsecs);
+    m_anchorNsecs = nsecs;
+}
+
+/****************************************************************************
+ * External clock
+ ****************************************************************************/
+
+bool TempoClock::acceptSource(quint32 source, qint64 nsecs) const
+{
+    if (source == m_source || m_source == invalidSource() || m_pulses == 0)
+        return true;
+
+    // Another source takes over only when the current one has gone silent
+    return (nsecs - m_lastPulseNsecs) > TEMPOCLOCK_TIMEOUT_NS;
+}
+
+void TempoClock::pulse(quint32 source, qint64 nsecs)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (acceptSource(source, nsecs) == false)
+        return;
+
+    bool acquire = (source != m_source || m_pulses == 0 ||
+                    (nsecs - m_lastPulseNsecs) > TEMPOCLOCK_TIMEOUT_NS);
+
+    if (acquire == true)
+    {
+        // Start tracking from the current tempo
+        m_source = source;
+        m_pulses = 1;
+        m_pulseNsecs = nsecs;
+        m_periodNsecs = m_beatNsecs / TEMPOCLOCK_PPQN;
+    }
+    else if (m_pulses == 1)
+    {
+        // The first period is measured as is
+        m_periodNsecs = clampPeriod(nsecs - m_lastPulseNsecs);
+        m_pulseNsecs = nsecs;
+        m_pulses++;
+    }
+    else
+    {
+        // Delay-locked loop: correct the predicted pulse time and the period
+        // by a fraction of the error, tuned by the loop bandwidth
+        qreal predicted = m_pulseNsecs + m_periodNsecs;
+        qreal error = qreal(nsecs) - predicted;
+        qreal omega = 2 * M_PI * DLL_BANDWIDTH * m_periodNsecs / 1e9;
+
+        m_pulseNsecs = predicted + M_SQRT2 * omega * error;
+        m_periodNsecs = clampPeriod(m_periodNsecs + omega * omega * error);
+        if (m_pulses < INT_MAX)
+            m_pulses++;
+    }
+
+    m_lastPulseNsecs = nsecs;
+
+    if (m_startPending == true)
+    {
+        m_startPending = false;
+        m_running = true;
+        m_pulseBeats = 0;
+    }
+    else if (acquire == true)
+    {
+        m_pulseBeats = beatsLocked(nsecs);
+    }
+    else if (m_running == true)
+    {
+        m_pulseBeats += 1.0 / TEMPOCLOCK_PPQN;
+    }
+
+    if (m_pulses >= 2)
+        m_beatNsecs = m_periodNsecs * TEMPOCLOCK_PPQN;
+
+    if (m_running == true)
+    {
+        m_anchorNsecs = qint64(m_pulseNsecs);
+        m_anchorBeats = m_pulseBeats;
+    }
+}
+
+void TempoClock::start(quint32 source, qint64 nsecs)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (acceptSource(source, nsecs) == false)
+        return;
+
+    if (source != m_source)
+        m_pulses = 0;
+    m_source = source;
+
+    // Hold at zero until the first pulse
+    m_running = false;
+    m_startPending = true;
+    m_anchorBeats = 0;
+    m_anchorNsecs = nsecs;
+}
+
+void TempoClock::resume(quint32 source, qint64 nsecs)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (acceptSource(source, nsecs) == false || m_running == true || m_startPending == true)
+        return;
+
+    m_anchorNsecs = nsecs;
+    m_pulseBeats = m_anchorBeats;
+    m_running = true;
+}
+
+void TempoClock::stop(quint32 source, qint64 nsecs)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (acceptSource(source, nsecs) == false)
+        return;
+
+    reanchor(nsecs);
+    m_running = false;
+    m_startPending = false;
+}
+
+bool TempoClock::isLocked(qint64 nsecs) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_source != invalidSource() && m_pulses >= 2 &&
+           (nsecs - m_lastPulseNsecs) <= TEMPOCLOCK_TIMEOUT_NS;
+}
+
+quint32 TempoClock::source() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_source;
+}
+
+/****************************************************************************
+ * MasterTimer tick
+ ****************************************************************************/
+
+void TempoClock::tick(qint64 nsecs)
+{
+    qreal position = beats(nsecs);
+    quint64 millibeats = (position > 0) ? quint64(qRound64(position * 1000)) : 0;
+
+    if (m_ticked == false)
+    {
+        // Nothing has elapsed before the first tick
+        m_ticked = true;
+        m_tickDelta = 0;
+        m_tickPosition = millibeats;
+    }
+    else if (millibeats >= m_tickPosition)
+    {
+        m_tickDelta = uint(qMin(millibeats - m_tickPosition, quint64(UINT_MAX)));
+        m_tickPosition = millibeats;
+    }
+    else if (m_tickPosition - millibeats > 1000)
+    {
+        // Restarted from the beginning
+        m_tickDelta = 0;
+        m_tickPosition = millibeats;
+    }
+    else
+    {
+        // Wait for a backwards correction to catch up
+        m_tickDelta = 0;
+    }
+}
+
+quint64 TempoClock::tickPosition() const
+{
+    return m_tickPosition;
+}
+
+uint TempoClock::tickDelta() const
+{
+    return m_tickDelta;
+}
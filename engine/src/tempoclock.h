@@ -0,0 +1,178 @@
+/*
+  Q Light Controller Plus
+  tempoclock.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef TEMPOCLOCK_H
+#define TEMPOCLOCK_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/** Clock pulses per beat (quarter note), as in MIDI beat clock */
+#define TEMPOCLOCK_PPQN 24
+
+#define TEMPOCLOCK_DEFAULT_BPM 120
+#define TEMPOCLOCK_MIN_BPM 20
+#define TEMPOCLOCK_MAX_BPM 400
+
+/** An external clock is considered lost when it doesn't pulse for this long */
+#define TEMPOCLOCK_TIMEOUT_NS Q_INT64_C(1000000000)
+
+/**
+ * TempoClock keeps the engine tempo (BPM) and beat position.
+ *
+ * The tempo can be set manually with setBpm() or follow an external clock
+ * like MIDI beat clock, which sends TEMPOCLOCK_PPQN pulses per beat. Pulse
+ * timestamps are smoothed by a second-order delay-locked loop, so that the
+ * beat position advances steadily even though pulses arrive with some jitter.
+ * Pulses may come from any thread: input plugins feed them directly from
+ * their input threads, without going thru the event loop.
+ *
+ * MasterTimer samples the beat position once per tick with tick(), so that
+ * all functions running on a tick see the same position. Functions whose
+ * tempo type is Function::Beats advance their elapsed counters by
+ * tickDelta() thousandths of a beat, instead of milliseconds.
+ *
+ * When the external clock stops pulsing, the beat position keeps advancing
+ * at the last known tempo. An explicit stop message freezes the position
+ * until the clock is started or continued again.
+ */
+class TempoClock
+{
+public:
+    TempoClock();
+    ~TempoClock();
+
+    /** Get the current time on the clock's monotonic time base, in nanoseconds */
+    qint64 now() const;
+
+    /** Value for an invalid clock source */
+    static quint32 invalidSource();
+
+    /*********************************************************************
+     * Tempo
+     *********************************************************************/
+public:
+    /**
+     * Set the tempo manually. The beat position continues from where it is.
+     * The tempo is overridden by an external clock while one is locked.
+     */
+    void setBpm(qreal bpm);
+
+    /** Get the current tempo in beats per minute */
+    qreal bpm() const;
+
+    /**
+     * Get the beat position at time $nsecs. The position is frozen while
+     * the clock is stopped.
+     */
+    qreal beats(qint64 nsecs) const;
+
+    /*********************************************************************
+     * External clock
+     *********************************************************************/
+public:
+    /**
+     * Process one clock pulse received at $nsecs from $source (e.g. an
+     * input universe). Pulses from other sources are ignored for as long
+     * as the current source keeps pulsing.
+     */
+    void pulse(quint32 source, qint64 nsecs);
+
+    /** Reset the beat position to zero on the next pulse from $source */
+    void start(quint32 source, qint64 nsecs);
+
+    /** Resume advancing the beat position at $nsecs, as told by $source */
+    void resume(quint32 source, qint64 nsecs);
+
+    /** Freeze the beat position until started or resumed by $source */
+    void stop(quint32 source, qint64 nsecs);
+
+    /** Check if an external clock has pulsed recently, as of $nsecs */
+    bool isLocked(qint64 nsecs) const;
+
+    /** Get the source of the current (or last) external clock */
+    quint32 source() const;
+
+private:
+    /** Check if pulses from $source should be processed. Call with m_mutex held. */
+    bool acceptSource(quint32 source, qint64 nsecs) const;
+
+    /** Get the beat position at $nsecs. Call with m_mutex held. */
+    qreal beatsLocked(qint64 nsecs) const;
+
+    /** Move the position anchor to $nsecs. Call with m_mutex held. */
+    void reanchor(qint64 nsecs);
+
+private:
+    mutable QMutex m_mutex;
+    QElapsedTimer m_time;
+
+    /** The beat position is m_anchorBeats at m_anchorNsecs ... */
+    qint64 m_anchorNsecs;
+    qreal m_anchorBeats;
+    /** ... and advances by one beat every m_beatNsecs nanoseconds */
+    qreal m_beatNsecs;
+    /** False when stopped by the external clock */
+    bool m_running;
+
+    quint32 m_source;
+    /** Raw timestamp of the last pulse, for lock detection */
+    qint64 m_lastPulseNsecs;
+    /** Number of pulses received since the current source was acquired */
+    int m_pulses;
+    /** A start message was received, the next pulse is beat zero */
+    bool m_startPending;
+
+    /** Delay-locked loop state: filtered pulse time & pulse period */
+    qreal m_pulseNsecs;
+    qreal m_periodNsecs;
+    /** Beat position at m_pulseNsecs */
+    qreal m_pulseBeats;
+
+    /*********************************************************************
+     * MasterTimer tick
+     *********************************************************************/
+public:
+    /** Sample the beat position for a MasterTimer tick at $nsecs */
+    void tick(qint64 nsecs);
+
+    /**
+     * Get the beat position of the last tick in thousandths of a beat. The
+     * position goes backwards only when the clock is restarted: small
+     * corrections of the external clock are absorbed by holding it still.
+     */
+    quint64 tickPosition() const;
+
+    /** Get the thousandths of a beat between the last two ticks */
+    uint tickDelta() const;
+
+private:
+    /** Accessed only from the MasterTimer thread */
+    bool m_ticked;
+    quint64 m_tickPosition;
+    uint m_tickDelta;
+};
+
+/** @} */
+
+#endif
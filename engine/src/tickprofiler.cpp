@@ -0,0 +1,207 @@
+/*
+  Q Light Controller Plus
+  tickprofiler.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QMutexLocker>
+#include <QtAlgorithms>
+
+#include "tickprofiler.h"
+
+TickProfiler::TickProfiler()
+    : m_enabled(false)
+{
+}
+
+TickProfiler::~TickProfiler()
+{
+}
+
+QString TickProfiler::stageToString(Stage stage)
+{
+    switch (stage)
+    {
+        case TickStage: return QString("Tick");
+        case FunctionsStage: return QString("Functions");
+        case DMXSourcesStage: return QString("DMX sources");
+        case FaderStage: return QString("Fader");
+        case OutputStage: return QString("Output");
+        default: return QString();
+    }
+}
+
+QString TickProfiler::itemTypeToString(ItemType type)
+{
+    switch (type)
+    {
+        case StageItem: return QString("Stage");
+        case FunctionItem: return QString("Function");
+        case DMXSourceItem: return QString("DMXSource");
+        case PluginItem: return QString("Plugin");
+        default: return QString();
+    }
+}
+
+/****************************************************************************
+ * Enable
+ ****************************************************************************/
+
+void TickProfiler::setEnabled(bool enable)
+{
+    m_enabled = enable;
+}
+
+void TickProfiler::reset()
+{
+    QMutexLocker locker(&m_mutex);
+
+    for (int i = 0; i < StageCount; i++)
+        m_stages[i] = Series();
+    m_functions.clear();
+    m_dmxSources.clear();
+    m_plugins.clear();
+}
+
+void TickProfiler::removeFunction(quint32 id)
+{
+    QMutexLocker locker(&m_mutex);
+    m_functions.remove(id);
+}
+
+/****************************************************************************
+ * Samples
+ ****************************************************************************/
+
+void TickProfiler::Series::add(qint64 nsecs)
+{
+    if (samples.isEmpty() == true)
+        samples.resize(TICKPROFILER_WINDOW);
+
+    samples[next] = nsecs;
+    next = (next + 1) % TICKPROFILER_WINDOW;
+    if (count < TICKPROFILER_WINDOW)
+        count++;
+}
+
+TickProfiler::Statistics TickProfiler::Series::statistics(ItemType type, const QString& name,
+                                                          quint32 id) const
+{
+    Statistics stats;
+    stats.type = type;
+    stats.name = name;
+    stats.id = id;
+    stats.samples = count;
+    stats.last = stats.mean = stats.p50 = stats.p95 = stats.p99 = stats.max = 0;
+
+    if (count == 0)
+        return stats;
+
+    QVector <qint64> sorted(samples.mid(0, count));
+    qSort(sorted.begin(), sorted.end());
+
+    qint64 sum = 0;
+    foreach (qint64 nsecs, sorted)
+        sum += nsecs;
+
+    stats.last = samples[(next + TICKPROFILER_WINDOW - 1) % TICKPROFILER_WINDOW] / 1000.0;
+    stats.mean = (sum / count) / 1000.0;
+    stats.p50 = sorted[(count - 1) * 50 / 100] / 1000.0;
+    stats.p95 = sorted[(count - 1) * 95 / 100] / 1000.0;
+    stats.p99 = sorted[(count - 1) * 99 / 100] / 1000.0;
+    stats.max = sorted[count - 1] / 1000.0;
+
+    return stats;
+}
+
+void TickProfiler::addStageSample(Stage stage, qint64 nsecs)
+{
+    Q_ASSERT(stage >= 0 && stage < StageCount);
+
+    QMutexLocker locker(&m_mutex);
+    m_stages[stage].add(nsecs);
+}
+
+void TickProfiler::addFunctionSample(quint32 id, qint64 nsecs)
+{
+    QMutexLocker locker(&m_mutex);
+    m_functions[id].add(nsecs);
+}
+
+void TickProfiler::addDMXSourceSample(const QString& name, qint64 nsecs)
+{
+    QMutexLocker locker(&m_mutex);
+    m_dmxSources[name].add(nsecs);
+}
+
+void TickProfiler::addPluginSample(const QString& name, qint64 nsecs)
+{
+    QMutexLocker locker(&m_mutex);
+    m_plugins[name].add(nsecs);
+}
+
+static bool higherP95(const TickProfiler::Statistics& s1, const TickProfiler::Statistics& s2)
+{
+    return s1.p95 > s2.p95;
+}
+
+void TickProfiler::appendSorted(QList <Statistics>& list, QList <Statistics> items)
+{
+    qSort(items.begin(), items.end(), higherP95);
+    list << items;
+}
+
+QList <TickProfiler::Statistics> TickProfiler::statistics() const
+{
+    QList <Statistics> list;
+    QList <Statistics> functions;
+    QList <Statistics> dmxSources;
+    QList <Statistics> plugins;
+
+    {
+        QMutexLocker locker(&m_mutex);
+
+        for (int i = 0; i < StageCount; i++)
+            list << m_stages[i].statistics(StageItem, stageToString(Stage(i)), 0);
+
+        QHashIterator <quint32, Series> fit(m_functions);
+        while (fit.hasNext() == true)
+        {
+            fit.next();
+            functions << fit.value().statistics(FunctionItem, QString::number(fit.key()), fit.key());
+        }
+
+        QHashIterator <QString, Series> sit(m_dmxSources);
+        while (sit.hasNext() == true)
+        {
+            sit.next();
+            dmxSources << sit.value().statistics(DMXSourceItem, sit.key(), 0);
+        }
+
+        QHashIterator <QString, Series> pit(m_plugins);
+        while (pit.hasNext() == true)
+        {
+            pit.next();
+            plugins << pit.value().statistics(PluginItem, pit.key(), 0);
+        }
+    }
+
+    appendSorted(list, functions);
+    appendSorted(list, dmxSources);
+    appendSorted(list, plugins);
+
+    return list;
+}
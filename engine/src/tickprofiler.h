@@ -0,0 +1,167 @@
+/*
+  Q Light Controller Plus
+  tickprofiler.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef TICKPROFILER_H
+#define TICKPROFILER_H
+
+#include <QVector>
+#include <QString>
+#include <QMutex>
+#include <QHash>
+#include <QList>
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/** Number of samples kept for each profiled item (10 seconds at 50Hz) */
+#define TICKPROFILER_WINDOW 500
+
+/**
+ * TickProfiler collects the time spent by MasterTimer in each stage of a
+ * timer tick and by each item of those stages: the write() of every running
+ * function, the writeDMX() of every DMX source (grouped by the name they were
+ * registered with) and the universe dump of every output plugin.
+ *
+ * The last TICKPROFILER_WINDOW samples of each item are kept, from which
+ * statistics() computes rolling percentiles. When the profiler is disabled
+ * (the default), MasterTimer doesn't even read the clock, so the only cost
+ * is a check of isEnabled() for each stage.
+ */
+class TickProfiler
+{
+public:
+    TickProfiler();
+    ~TickProfiler();
+
+    /** The stages of a MasterTimer tick */
+    enum Stage
+    {
+        TickStage = 0,      //! The whole tick
+        FunctionsStage,     //! All running functions
+        DMXSourcesStage,    //! All registered DMX sources
+        FaderStage,         //! MasterTimer's GenericFader
+        OutputStage,        //! Universe dump to output plugins
+        StageCount
+    };
+
+    /** The kind of item that statistics refer to */
+    enum ItemType
+    {
+        StageItem = 0,
+        FunctionItem,
+        DMXSourceItem,
+        PluginItem
+    };
+
+    /** Statistics of the samples of one profiled item. Times are in microseconds. */
+    struct Statistics
+    {
+        ItemType type;
+        /** Stage/DMX source/plugin name, or function ID as a string */
+        QString name;
+        /** Function ID for FunctionItem */
+        quint32 id;
+        int samples;
+        qreal last;
+        qreal mean;
+        qreal p50;
+        qreal p95;
+        qreal p99;
+        qreal max;
+    };
+
+    /** Get a name for $stage */
+    static QString stageToString(Stage stage);
+
+    /** Get a name for $type */
+    static QString itemTypeToString(ItemType type);
+
+    /*********************************************************************
+     * Enable
+     *********************************************************************/
+public:
+    /** Enable/disable sample collection. Disabling doesn't clear samples. */
+    void setEnabled(bool enable);
+
+    /** Check if samples are being collected */
+    bool isEnabled() const { return m_enabled; }
+
+    /** Clear all the collected samples */
+    void reset();
+
+    /** Clear the samples of function $id, e.g. when it's deleted */
+    void removeFunction(quint32 id);
+
+private:
+    bool m_enabled;
+
+    /*********************************************************************
+     * Samples
+     *********************************************************************/
+public:
+    /** Add a sample of $nsecs nanoseconds spent in $stage */
+    void addStageSample(Stage stage, qint64 nsecs);
+
+    /** Add a sample of $nsecs nanoseconds spent in the write() of function $id */
+    void addFunctionSample(quint32 id, qint64 nsecs);
+
+    /** Add a sample of $nsecs nanoseconds spent by the DMX sources named $name */
+    void addDMXSourceSample(const QString& name, qint64 nsecs);
+
+    /** Add a sample of $nsecs nanoseconds spent dumping universes to plugin $name */
+    void addPluginSample(const QString& name, qint64 nsecs);
+
+    /**
+     * Get the statistics of all profiled items: first the stages in their
+     * tick order, then functions, DMX sources and plugins, each sorted by
+     * descending 95th percentile.
+     */
+    QList <Statistics> statistics() const;
+
+private:
+    /** A ring buffer of samples */
+    struct Series
+    {
+        Series() : next(0), count(0) { }
+
+        void add(qint64 nsecs);
+        Statistics statistics(ItemType type, const QString& name, quint32 id) const;
+
+        QVector <qint64> samples;
+        int next;
+        int count;
+    };
+
+    /** Sort the statistics of one item type and append them to $list */
+    static void appendSorted(QList <Statistics>& list, QList <Statistics> items);
+
+private:
+    /** Guards all the series, since samples come from MasterTimer threads */
+    mutable QMutex m_mutex;
+
+    Series m_stages[StageCount];
+    QHash <quint32, Series> m_functions;
+    QHash <QString, Series> m_dmxSources;
+    QHash <QString, Series> m_plugins;
+};
+
+/** @} */
+
+#endif
@@ -0,0 +1,175 @@
+/*
+  Q Light Controller Plus
+  timecodeclock.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QMutexLocker>
+#include <climits>
+#include <qmath.h>
+
+#include "timecodeclock.h"
+
+/** Fraction of the error between the received and the expected position corrected at once */
+#define CORRECTION_GAIN 0.25
+
+TimecodeClock::TimecodeClock()
+    : m_freewheel(TIMECODECLOCK_DEFAULT_FREEWHEEL)
+    , m_source(TimecodeClock::invalidSource())
+    , m_valid(false)
+    , m_anchorNsecs(0)
+    , m_anchorMsecs(0)
+    , m_jumps(0)
+{
+    m_time.start();
+}
+
+TimecodeClock::~TimecodeClock()
+{
+}
+
+qint64 TimecodeClock::now() const
+{
+    return m_time.nsecsElapsed();
+}
+
+quint32 TimecodeClock::invalidSource()
+{
+    return UINT_MAX;
+}
+
+/****************************************************************************
+ * Freewheel
+ ****************************************************************************/
+
+void TimecodeClock::setFreewheel(uint msecs)
+{
+    QMutexLocker locker(&m_mutex);
+    m_freewheel = msecs;
+}
+
+uint TimecodeClock::freewheel() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_freewheel;
+}
+
+/****************************************************************************
+ * Input
+ ****************************************************************************/
+
+void TimecodeClock::receive(quint32 source, qint64 msecs, qint64 nsecs)
+{
+    QMutexLocker locker(&m_mutex);
+
+    bool locked = m_valid && (nsecs - m_anchorNsecs) <= TIMECODECLOCK_LOCK_NS;
+
+    // Another source takes over only when the current one has gone silent
+    if (source != m_source && locked == true)
+        return;
+
+    if (m_valid == false || source != m_source)
+    {
+        m_anchorMsecs = msecs;
+        m_jumps++;
+    }
+    else if (locked == true)
+    {
+        qreal expected = positionLocked(nsecs);
+        qreal error = qreal(msecs) - expected;
+
+        if (qAbs(error) > TIMECODECLOCK_JUMP_THRESHOLD)
+        {
+            m_anchorMsecs = msecs;
+            m_jumps++;
+        }
+        else
+        {
+            m_anchorMsecs = expected + CORRECTION_GAIN * error;
+        }
+    }
+    else
+    {
+        // Back from a pause or a dropout: nothing to smooth against. The
+        // timecode may have stood still or kept rolling meanwhile, so only
+        // positions outside of that range are jumps.
+        qreal paused = m_anchorMsecs;
+        qreal rolled = m_anchorMsecs + (nsecs - m_anchorNsecs) / 1e6;
+
+        if (msecs < paused - TIMECODECLOCK_JUMP_THRESHOLD ||
+            msecs > rolled + TIMECODECLOCK_JUMP_THRESHOLD)
+            m_jumps++;
+
+        m_anchorMsecs = msecs;
+    }
+
+    m_anchorNsecs = nsecs;
+    m_source = source;
+    m_valid = true;
+}
+
+void TimecodeClock::reset()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_valid = false;
+    m_source = invalidSource();
+}
+
+bool TimecodeClock::isLocked(qint64 nsecs) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_valid && (nsecs - m_anchorNsecs) <= TIMECODECLOCK_LOCK_NS;
+}
+
+bool TimecodeClock::isRunning(qint64 nsecs) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_valid && (nsecs - m_anchorNsecs) < qint64(m_freewheel) * 1000000;
+}
+
+quint32 TimecodeClock::source() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_source;
+}
+
+/****************************************************************************
+ * Position
+ ****************************************************************************/
+
+qint64 TimecodeClock::position(qint64 nsecs) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_valid == false)
+        return -1;
+
+    return qMax(qint64(0), qint64(qFloor(positionLocked(nsecs))));
+}
+
+qreal TimecodeClock::positionLocked(qint64 nsecs) const
+{
+    // Freewheel up to m_freewheel milliseconds after the last position, then hold
+    qint64 elapsed = qBound(qint64(0), nsecs - m_anchorNsecs, qint64(m_freewheel) * 1000000);
+    return m_anchorMsecs + elapsed / 1e6;
+}
+
+quint32 TimecodeClock::jumps() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_jumps;
+}
@@ -0,0 +1,140 @@
+/*
+  Q Light Controller Plus
+  timecodeclock.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef TIMECODECLOCK_H
+#define TIMECODECLOCK_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/** Timecode is considered locked while positions arrive at least this often */
+#define TIMECODECLOCK_LOCK_NS Q_INT64_C(250000000)
+
+/** Default time the position keeps advancing after the timecode drops out */
+#define TIMECODECLOCK_DEFAULT_FREEWHEEL 500
+
+/** A received position this far (in ms) from the expected one is a jump */
+#define TIMECODECLOCK_JUMP_THRESHOLD 200
+
+/**
+ * TimecodeClock chases an external timecode, like MIDI Time Code or LTC.
+ *
+ * Timecode positions may be received from any thread, each one with the
+ * time it was valid at, and are then extrapolated in real time so that the
+ * position can be sampled at any moment, e.g. by ShowRunner on every
+ * MasterTimer tick. Small differences between the received and the
+ * extrapolated positions (transport jitter) are smoothed out, while large
+ * ones are counted as jumps, so that a chasing timeline knows when it has
+ * to seek instead of just catching up.
+ *
+ * When the timecode drops out, the position freewheels at normal speed
+ * for freewheel() milliseconds and then holds, until timecode comes back.
+ * Timecode resuming after a pause or a dropout is not a jump, as long as
+ * it resumes between where it stopped and where it would be had it kept
+ * rolling.
+ */
+class TimecodeClock
+{
+public:
+    TimecodeClock();
+    ~TimecodeClock();
+
+    /** Get the current time on the clock's monotonic time base, in nanoseconds */
+    qint64 now() const;
+
+    /** Value for an invalid timecode source */
+    static quint32 invalidSource();
+
+    /*********************************************************************
+     * Freewheel
+     *********************************************************************/
+public:
+    /** Set how long (in ms) the position keeps advancing after a dropout */
+    void setFreewheel(uint msecs);
+
+    /** Get how long (in ms) the position keeps advancing after a dropout */
+    uint freewheel() const;
+
+    /*********************************************************************
+     * Input
+     *********************************************************************/
+public:
+    /**
+     * Process a timecode position of $msecs milliseconds, valid at time
+     * $nsecs, from $source (e.g. an input universe). Positions from other
+     * sources are ignored for as long as the current source is locked.
+     */
+    void receive(quint32 source, qint64 msecs, qint64 nsecs);
+
+    /** Forget the current position, as if no timecode was ever received */
+    void reset();
+
+    /** Check if timecode has been received recently, as of $nsecs */
+    bool isLocked(qint64 nsecs) const;
+
+    /** Check if the position is advancing at $nsecs: locked or freewheeling */
+    bool isRunning(qint64 nsecs) const;
+
+    /** Get the source of the current (or last) timecode */
+    quint32 source() const;
+
+    /*********************************************************************
+     * Position
+     *********************************************************************/
+public:
+    /**
+     * Get the timecode position in milliseconds at time $nsecs, or -1
+     * if no timecode has been received yet
+     */
+    qint64 position(qint64 nsecs) const;
+
+    /**
+     * Get the number of jumps of the timecode. The first position received
+     * after a reset is also a jump.
+     */
+    quint32 jumps() const;
+
+private:
+    /** Get the position at $nsecs. Call with m_mutex held. */
+    qreal positionLocked(qint64 nsecs) const;
+
+private:
+    mutable QMutex m_mutex;
+    QElapsedTimer m_time;
+
+    uint m_freewheel;
+
+    quint32 m_source;
+    /** False until a position is received */
+    bool m_valid;
+
+    /** The position is m_anchorMsecs at m_anchorNsecs and advances in real time */
+    qint64 m_anchorNsecs;
+    qreal m_anchorMsecs;
+
+    quint32 m_jumps;
+};
+
+/** @} */
+
+#endif
@@ -22,13 +22,13 @@
 #include <math.h>
 
 #include "universe.h"
+#include "universewritebuffer.h"
 #include "inputoutputmap.h"
 #include "inputpatch.h"
 #include "outputpatch.h"
 #include "grandmaster.h"
 #include "qlcmacros.h"
 
-#define UNIVERSE_SIZE 512
 #define RELATIVE_ZERO 127
 
 Universe::Universe(quint32 id, GrandMaster *gm, QObject *parent)
@@ -188,6 +188,11 @@ const QByteArray* Universe::postGMValues() const
     return m_postGMValues;
 }
 
+const QByteArray* Universe::channelsMask() const
+{
+    return m_channelsMask;
+}
+
 void Universe::zeroRelativeValues()
 {
     m_relativeValues.fill(0);
@@ -379,6 +384,14 @@ bool Universe::write(int channel, uchar value, bool forceLTP)
     if (channel >= UNIVERSE_SIZE)
         return false;
 
+    UniverseWriteBuffer* buffer = UniverseWriteBuffer::current();
+    if (buffer != NULL)
+    {
+        buffer->append(this, channel, value, forceLTP ? UniverseWriteBuffer::AbsoluteLTP
+                                                      : UniverseWriteBuffer::Absolute);
+        return true;
+    }
+
     //qDebug() << "Universe write channel" << channel << ", value:" << value;
 
     if (channel >= m_usedChannels)
@@ -414,6 +427,13 @@ bool Universe::writeRelative(int channel, uchar value)
     if (channel >= UNIVERSE_SIZE)
         return false;
 
+    UniverseWriteBuffer* buffer = UniverseWriteBuffer::current();
+    if (buffer != NULL)
+    {
+        buffer->append(this, channel, value, UniverseWriteBuffer::Relative);
+        return true;
+    }
+
     if (channel >= m_usedChannels)
         m_usedChannels = channel + 1;
 
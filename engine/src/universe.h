@@ -55,6 +55,9 @@ class InputPatch;
 #define KXMLQLCUniverseFeedbackPlugin "Plugin"
 #define KXMLQLCUniverseFeedbackLine "Line"
 
+/** Number of channels in a universe */
+#define UNIVERSE_SIZE 512
+
 /** Universe class contains input/output data for one DMX universe
  */
 class Universe: public QObject
@@ -251,6 +254,12 @@ public:
      */
     const QByteArray* postGMValues() const;
 
+    /**
+     * Get the capabilities of all channels, as ChannelType flags.
+     * Don't write to the returned array.
+     */
+    const QByteArray* channelsMask() const;
+
     /**
      * Get the current pre-Grand-Master values (used by functions and everyone
      * else INSIDE QLC). Don't write to the returned array to prevent copying.
@@ -294,7 +303,8 @@ protected:
 public:
     /**
      * Write a value to a DMX channel, taking Grand Master and HTP into
-     * account, if applicable.
+     * account, if applicable. If the calling thread has a current
+     * UniverseWriteBuffer, the write is stored there instead.
      *
      * @param channel The channel number to write to
      * @param value The value to write
@@ -305,7 +315,8 @@ public:
 
     /**
      * Write a relative value to a DMX channel, taking Grand Master and HTP into
-     * account, if applicable.
+     * account, if applicable. If the calling thread has a current
+     * UniverseWriteBuffer, the write is stored there instead.
      *
      * @param channel The channel number to write to
      * @param value The value to write
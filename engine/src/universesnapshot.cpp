@@ -0,0 +1,106 @@
+/*
+  Q Light Controller Plus
+  universesnapshot.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QByteArray>
+#include <cstring>
+
+#include "universesnapshot.h"
+#include "universe.h"
+
+UniverseSnapshot::UniverseSnapshot()
+    : m_universes(0)
+{
+}
+
+UniverseSnapshot::~UniverseSnapshot()
+{
+}
+
+void UniverseSnapshot::capture(const QList<Universe*>& universes)
+{
+    int size = universes.count() * UNIVERSE_SIZE;
+    if (m_preGMValues.size() != size)
+    {
+        m_preGMValues.resize(size);
+        m_postGMValues.resize(size);
+        m_channelsMask.resize(size);
+    }
+    m_universes = universes.count();
+
+    for (int i = 0; i < universes.count(); i++)
+    {
+        const Universe* universe = universes.at(i);
+        int offset = i * UNIVERSE_SIZE;
+
+        // A shallow copy: the values are copied only once, right below
+        const QByteArray preGM(universe->preGMValues());
+        const QByteArray* postGM = universe->postGMValues();
+        const QByteArray* mask = universe->channelsMask();
+
+        memcpy(m_preGMValues.data() + offset, preGM.constData(),
+               qMin(preGM.size(), UNIVERSE_SIZE));
+        memcpy(m_postGMValues.data() + offset, postGM->constData(),
+               qMin(postGM->size(), UNIVERSE_SIZE));
+        memcpy(m_channelsMask.data() + offset, mask->constData(),
+               qMin(mask->size(), UNIVERSE_SIZE));
+    }
+}
+
+int UniverseSnapshot::universes() const
+{
+    return m_universes;
+}
+
+uchar UniverseSnapshot::preGMValue(quint32 universe, quint32 address) const
+{
+    int i = index(universe, address);
+    return (i < 0) ? 0 : m_preGMValues.at(i);
+}
+
+uchar UniverseSnapshot::postGMValue(quint32 universe, quint32 address) const
+{
+    int i = index(universe, address);
+    return (i < 0) ? 0 : m_postGMValues.at(i);
+}
+
+const uchar* UniverseSnapshot::preGMValues(quint32 universe) const
+{
+    int i = index(universe, 0);
+    return (i < 0) ? NULL : m_preGMValues.constData() + i;
+}
+
+const uchar* UniverseSnapshot::postGMValues(quint32 universe) const
+{
+    int i = index(universe, 0);
+    return (i < 0) ? NULL : m_postGMValues.constData() + i;
+}
+
+bool UniverseSnapshot::isIntensity(quint32 universe, quint32 address) const
+{
+    int i = index(universe, address);
+    return (i < 0) ? false : (m_channelsMask.at(i) & Universe::Intensity) != 0;
+}
+
+int UniverseSnapshot::index(quint32 universe, quint32 address) const
+{
+    if (universe >= quint32(m_universes) || address >= UNIVERSE_SIZE)
+        return -1;
+
+    return universe * UNIVERSE_SIZE + address;
+}
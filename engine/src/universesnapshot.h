@@ -0,0 +1,81 @@
+/*
+  Q Light Controller Plus
+  universesnapshot.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef UNIVERSESNAPSHOT_H
+#define UNIVERSESNAPSHOT_H
+
+#include <QVector>
+#include <QList>
+
+class Universe;
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/**
+ * UniverseSnapshot is a read-only copy of the values of all universes.
+ *
+ * MasterTimer captures one at the end of each tick, so that functions can
+ * read the values of the previous tick (e.g. to start their fades from
+ * them) without copying universe contents or claiming the universes
+ * themselves. All values are kept in contiguous arrays that are reused
+ * from tick to tick: memory is allocated only when universes are added.
+ */
+class UniverseSnapshot
+{
+public:
+    UniverseSnapshot();
+    ~UniverseSnapshot();
+
+    /** Copy the current values and channel capabilities of $universes */
+    void capture(const QList<Universe*>& universes);
+
+    /** Get the number of captured universes */
+    int universes() const;
+
+    /** Get the pre-Grand Master value of $address in $universe, or 0 if not captured */
+    uchar preGMValue(quint32 universe, quint32 address) const;
+
+    /** Get the post-Grand Master value of $address in $universe, or 0 if not captured */
+    uchar postGMValue(quint32 universe, quint32 address) const;
+
+    /** Get the UNIVERSE_SIZE pre-Grand Master values of $universe, or NULL */
+    const uchar* preGMValues(quint32 universe) const;
+
+    /** Get the UNIVERSE_SIZE post-Grand Master values of $universe, or NULL */
+    const uchar* postGMValues(quint32 universe) const;
+
+    /** Check if $address in $universe is an intensity channel */
+    bool isIntensity(quint32 universe, quint32 address) const;
+
+private:
+    /** Get the index of $address in $universe in the arrays, or -1 */
+    int index(quint32 universe, quint32 address) const;
+
+private:
+    int m_universes;
+    QVector <uchar> m_preGMValues;
+    QVector <uchar> m_postGMValues;
+    QVector <uchar> m_channelsMask;
+};
+
+/** @} */
+
+#endif
@@ -0,0 +1,102 @@
+/*
+  Q Light Controller Plus
+  universewritebuffer.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QThreadStorage>
+
+#include "universewritebuffer.h"
+#include "universe.h"
+
+/**
+ * QThreadStorage deletes its (pointer) data when the thread exits, so the
+ * buffer pointer is wrapped in a small holder that the storage can own.
+ */
+struct CurrentWriteBuffer
+{
+    CurrentWriteBuffer() : buffer(NULL) { }
+    UniverseWriteBuffer* buffer;
+};
+
+static QThreadStorage <CurrentWriteBuffer*> s_currentBuffer;
+
+bool UniverseWriteBuffer::s_captureEnabled = false;
+
+UniverseWriteBuffer::UniverseWriteBuffer()
+{
+}
+
+void UniverseWriteBuffer::clear()
+{
+    // resize() keeps the allocated memory for the next tick
+    m_entries.resize(0);
+}
+
+int UniverseWriteBuffer::size() const
+{
+    return m_entries.size();
+}
+
+void UniverseWriteBuffer::append(Universe* universe, int channel, uchar value, WriteMode mode)
+{
+    Entry entry;
+    entry.universe = universe;
+    entry.channel = channel;
+    entry.value = value;
+    entry.mode = uchar(mode);
+    m_entries.append(entry);
+}
+
+void UniverseWriteBuffer::apply() const
+{
+    Q_ASSERT(current() == NULL);
+
+    const Entry* entry = m_entries.constData();
+    const Entry* end = entry + m_entries.size();
+    for (; entry != end; entry++)
+    {
+        if (entry->mode == Relative)
+            entry->universe->writeRelative(entry->channel, entry->value);
+        else
+            entry->universe->write(entry->channel, entry->value, entry->mode == AbsoluteLTP);
+    }
+}
+
+/****************************************************************************
+ * Thread capture
+ ****************************************************************************/
+
+UniverseWriteBuffer* UniverseWriteBuffer::current()
+{
+    if (s_captureEnabled == false || s_currentBuffer.hasLocalData() == false)
+        return NULL;
+
+    return s_currentBuffer.localData()->buffer;
+}
+
+void UniverseWriteBuffer::setCurrent(UniverseWriteBuffer* buffer)
+{
+    if (s_currentBuffer.hasLocalData() == false)
+        s_currentBuffer.setLocalData(new CurrentWriteBuffer);
+
+    s_currentBuffer.localData()->buffer = buffer;
+}
+
+void UniverseWriteBuffer::setCaptureEnabled(bool enable)
+{
+    s_captureEnabled = enable;
+}
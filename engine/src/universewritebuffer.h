@@ -0,0 +1,110 @@
+/*
+  Q Light Controller Plus
+  universewritebuffer.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef UNIVERSEWRITEBUFFER_H
+#define UNIVERSEWRITEBUFFER_H
+
+#include <QVector>
+
+class Universe;
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/**
+ * UniverseWriteBuffer is a sparse list of universe writes, that can be
+ * applied later on. When a buffer is set as the current buffer of a thread,
+ * Universe::write() and Universe::writeRelative() calls made by that thread
+ * are stored in the buffer instead of changing the universe contents.
+ *
+ * This is used by MasterTimer to run functions on worker threads: each
+ * function writes into its own buffer and the buffers are applied to the
+ * universes in the order the functions were started, so that HTP and LTP
+ * rules give the same results as when the functions write directly.
+ */
+class UniverseWriteBuffer
+{
+public:
+    enum WriteMode
+    {
+        Absolute = 0,   //! Universe::write()
+        AbsoluteLTP,    //! Universe::write() with forceLTP
+        Relative        //! Universe::writeRelative()
+    };
+
+    struct Entry
+    {
+        Universe* universe;
+        int channel;
+        uchar value;
+        uchar mode;
+    };
+
+    UniverseWriteBuffer();
+
+    /** Remove all the buffered writes */
+    void clear();
+
+    /** Get the number of buffered writes */
+    int size() const;
+
+    /** Store a write of $value to $channel of $universe */
+    void append(Universe* universe, int channel, uchar value, WriteMode mode);
+
+    /** Write all the buffered values to their universes, in the order they were stored */
+    void apply() const;
+
+private:
+    QVector <Entry> m_entries;
+
+    /*********************************************************************
+     * Thread capture
+     *********************************************************************/
+public:
+    /**
+     * Get the buffer that captures the universe writes of the calling
+     * thread.
+     *
+     * @return The current buffer or NULL if writes go directly to universes
+     */
+    static UniverseWriteBuffer* current();
+
+    /**
+     * Capture the universe writes of the calling thread into $buffer, or
+     * write directly to universes again if $buffer is NULL. Has no effect
+     * until capturing is enabled with setCaptureEnabled().
+     */
+    static void setCurrent(UniverseWriteBuffer* buffer);
+
+    /**
+     * Enable or disable capturing globally. When disabled (the default),
+     * current() returns NULL without looking up the calling thread's buffer,
+     * so that universe writes don't pay for the lookup. Must not be changed
+     * while other threads might be writing to universes.
+     */
+    static void setCaptureEnabled(bool enable);
+
+private:
+    static bool s_captureEnabled;
+};
+
+/** @} */
+
+#endif
@@ -0,0 +1,568 @@
+/*
+  Q Light Controller Plus
+  workspacesnapshot.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QXmlStreamReader>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QBuffer>
+#include <QDebug>
+#include <QColor>
+#include <QtXml>
+
+#include "qlcfixturedefcache.h"
+#include "workspacesnapshot.h"
+#include "qlcfixturemode.h"
+#include "qlcfixturehead.h"
+#include "qlcfixturedef.h"
+#include "qlccapability.h"
+#include "qlcphysical.h"
+#include "qlcchannel.h"
+#include "qlcfile.h"
+#include "fixture.h"
+#include "doc.h"
+
+#define SNAPSHOT_STREAM_VERSION QDataStream::Qt_4_6
+
+/****************************************************************************
+ * Snapshot file
+ ****************************************************************************/
+
+QString WorkspaceSnapshot::snapshotPath(const QString& workspacePath)
+{
+    QString path(workspacePath);
+    if (path.endsWith(KExtWorkspace, Qt::CaseInsensitive) == true)
+        path.chop(QString(KExtWorkspace).length());
+
+    return path + QString(KExtWorkspaceSnapshot);
+}
+
+bool WorkspaceSnapshot::isUpToDate(const QString& workspacePath)
+{
+    QFileInfo workspace(workspacePath);
+    QFileInfo snapshot(snapshotPath(workspacePath));
+
+    if (workspace.exists() == false || snapshot.exists() == false)
+        return false;
+
+    if (snapshot.lastModified() < workspace.lastModified())
+        return false;
+
+    QFile file(snapshot.absoluteFilePath());
+    if (file.open(QIODevice::ReadOnly) == false)
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(SNAPSHOT_STREAM_VERSION);
+
+    quint32 magic = 0, version = 0;
+    qint64 workspaceSize = 0;
+    stream >> magic >> version >> workspaceSize;
+
+    return (stream.status() == QDataStream::Ok &&
+            magic == WORKSPACE_SNAPSHOT_MAGIC &&
+            version == WORKSPACE_SNAPSHOT_VERSION &&
+            workspaceSize == workspace.size());
+}
+
+/****************************************************************************
+ * Save
+ ****************************************************************************/
+
+bool WorkspaceSnapshot::save(Doc* doc, const QString& workspacePath)
+{
+    Q_ASSERT(doc != NULL);
+
+    QFileInfo workspace(workspacePath);
+    if (workspace.exists() == false)
+        return false;
+
+    QFile file(snapshotPath(workspacePath));
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate) == false)
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to write" << file.fileName();
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(SNAPSHOT_STREAM_VERSION);
+
+    stream << quint32(WORKSPACE_SNAPSHOT_MAGIC) << quint32(WORKSPACE_SNAPSHOT_VERSION)
+           << qint64(workspace.size());
+
+    /* Fixture definitions used by the workspace. Generic dimmers and
+       RGB panels are created on the fly and don't need one. */
+    QList <QLCFixtureDef*> defs;
+    foreach (Fixture* fxi, doc->fixtures())
+    {
+        QLCFixtureDef* def = fxi->fixtureDef();
+        if (def == NULL || def->model() == KXMLFixtureGeneric ||
+            def->model() == KXMLFixtureRGBPanel || defs.contains(def) == true)
+            continue;
+        defs << def;
+    }
+
+    writeFixtureDefSources(stream, defs);
+
+    stream << quint32(defs.size());
+    foreach (QLCFixtureDef* def, defs)
+        writeFixtureDef(stream, def);
+
+    /* Fixture instances, resolved against the definitions above */
+    QList <Fixture*> fixtures = doc->fixtures();
+    stream << quint32(fixtures.size());
+    foreach (Fixture* fxi, fixtures)
+    {
+        QString manufacturer(KXMLFixtureGeneric);
+        QString model(KXMLFixtureGeneric);
+        QString mode(KXMLFixtureGeneric);
+
+        if (fxi->fixtureDef() != NULL)
+        {
+            manufacturer = fxi->fixtureDef()->manufacturer();
+            model = fxi->fixtureDef()->model();
+        }
+        if (fxi->fixtureMode() != NULL)
+            mode = fxi->fixtureMode()->name();
+
+        stream << fxi->id() << fxi->name() << fxi->universe() << fxi->address()
+               << fxi->channels() << manufacturer << model << mode
+               << fxi->excludeFadeChannels();
+    }
+
+    /* Everything else in the engine, without fixtures, as compact XML */
+    QDomDocument document;
+    QDomElement root = document.createElement(KXMLQLCWorkspace);
+    document.appendChild(root);
+    doc->saveXML(&document, &root);
+
+    QDomElement engine = root.firstChildElement(KXMLQLCEngine);
+    QDomElement tag = engine.firstChildElement(KXMLFixture);
+    while (tag.isNull() == false)
+    {
+        QDomElement next = tag.nextSiblingElement(KXMLFixture);
+        engine.removeChild(tag);
+        tag = next;
+    }
+
+    QByteArray xml = document.toByteArray(-1);
+    stream << quint32(xml.size());
+    stream.writeRawData(xml.constData(), xml.size());
+
+    if (stream.status() != QDataStream::Ok)
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to write" << file.fileName();
+        file.close();
+        file.remove();
+        return false;
+    }
+
+    return true;
+}
+
+void WorkspaceSnapshot::writeFixtureDefSources(QDataStream& stream,
+                                               const QList <QLCFixtureDef*>& defs)
+{
+    stream << quint32(defs.size());
+    foreach (QLCFixtureDef* def, defs)
+    {
+        QString path(def->definitionSourceFile());
+        QFileInfo info(path);
+        qint64 size = 0;
+        QDateTime modified;
+        if (path.isEmpty() == false && info.exists() == true)
+        {
+            size = info.size();
+            modified = info.lastModified();
+        }
+
+        stream << def->manufacturer() << def->model() << path << size << modified;
+    }
+}
+
+void WorkspaceSnapshot::writeFixtureDef(QDataStream& stream, QLCFixtureDef* def)
+{
+    Q_ASSERT(def != NULL);
+
+    stream << def->manufacturer() << def->model() << def->type() << def->author();
+
+    QList <QLCChannel*> channels = def->channels();
+    stream << quint32(channels.size());
+    foreach (QLCChannel* channel, channels)
+    {
+        stream << channel->name() << qint32(channel->group())
+               << qint32(channel->controlByte()) << qint32(channel->colour());
+
+        QList <QLCCapability*> caps = channel->capabilities();
+        stream << quint32(caps.size());
+        foreach (QLCCapability* cap, caps)
+        {
+            stream << quint8(cap->min()) << quint8(cap->max()) << cap->name()
+                   << cap->resourceName() << cap->resourceColor1() << cap->resourceColor2();
+        }
+    }
+
+    QList <QLCFixtureMode*> modes = def->modes();
+    stream << quint32(modes.size());
+    foreach (QLCFixtureMode* mode, modes)
+    {
+        stream << mode->name();
+
+        /* Mode channels are stored as indices of the definition channels */
+        QList <QLCChannel*> modeChannels = mode->channels();
+        stream << quint32(modeChannels.size());
+        foreach (QLCChannel* channel, modeChannels)
+            stream << qint32(channels.indexOf(channel));
+
+        QList <QLCFixtureHead> heads = mode->heads();
+        stream << quint32(heads.size());
+        foreach (QLCFixtureHead head, heads)
+        {
+            QList <quint32> headChannels = head.channels().toList();
+            qSort(headChannels);
+            stream << headChannels;
+        }
+
+        QLCPhysical phy = mode->physical();
+        stream << phy.bulbType() << qint32(phy.bulbLumens()) << qint32(phy.bulbColourTemperature())
+               << double(phy.weight()) << qint32(phy.width()) << qint32(phy.height())
+               << qint32(phy.depth()) << phy.lensName() << double(phy.lensDegreesMin())
+               << double(phy.lensDegreesMax()) << phy.focusType() << qint32(phy.focusPanMax())
+               << qint32(phy.focusTiltMax()) << qint32(phy.powerConsumption())
+               << phy.dmxConnector();
+    }
+}
+
+/****************************************************************************
+ * Load
+ ****************************************************************************/
+
+bool WorkspaceSnapshot::load(Doc* doc, const QString& workspacePath)
+{
+    Q_ASSERT(doc != NULL);
+
+    if (isUpToDate(workspacePath) == false)
+        return false;
+
+    QFile file(snapshotPath(workspacePath));
+    if (file.open(QIODevice::ReadOnly) == false)
+        return false;
+
+    /* Map the whole snapshot in memory. Fall back to reading it if the
+       file system doesn't support mapping. */
+    QByteArray data;
+    const uchar* mapped = file.map(0, file.size());
+    if (mapped != NULL)
+        data = QByteArray::fromRawData(reinterpret_cast<const char*> (mapped), int(file.size()));
+    else
+        data = file.readAll();
+
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::ReadOnly);
+    QDataStream stream(&buffer);
+    stream.setVersion(SNAPSHOT_STREAM_VERSION);
+
+    /* Header has been verified by isUpToDate() */
+    quint32 magic, version;
+    qint64 workspaceSize;
+    stream >> magic >> version >> workspaceSize;
+
+    /* Check all the definitions before changing anything in $doc */
+    if (checkFixtureDefSources(stream, doc->fixtureDefCache()) == false)
+    {
+        qDebug() << Q_FUNC_INFO << "Fixture definitions changed since" << file.fileName();
+        return false;
+    }
+
+    /* Read all the definitions before touching the cache, so that a
+       corrupted snapshot leaves its placeholders as they are */
+    QList <QLCFixtureDef*> defs;
+    quint32 defCount = 0;
+    stream >> defCount;
+    for (quint32 i = 0; i < defCount; i++)
+    {
+        QLCFixtureDef* def = readFixtureDef(stream);
+        if (def == NULL)
+        {
+            qWarning() << Q_FUNC_INFO << "Corrupted fixture definitions in" << file.fileName();
+            qDeleteAll(defs);
+            return false;
+        }
+        defs << def;
+    }
+
+    installFixtureDefs(defs, doc->fixtureDefCache());
+
+    if (readFixtures(stream, doc) == false)
+    {
+        qWarning() << Q_FUNC_INFO << "Corrupted fixtures in" << file.fileName();
+        doc->clearContents();
+        return false;
+    }
+
+    quint32 xmlSize = 0;
+    stream >> xmlSize;
+    qint64 xmlStart = buffer.pos();
+    if (stream.status() != QDataStream::Ok || xmlStart + xmlSize > data.size())
+    {
+        qWarning() << Q_FUNC_INFO << "Corrupted engine contents in" << file.fileName();
+        doc->clearContents();
+        return false;
+    }
+
+    /* Read the XML block in place, without copying it out of the mapping */
+    QXmlStreamReader reader(QByteArray::fromRawData(data.constData() + xmlStart, int(xmlSize)));
+    if (reader.readNextStartElement() == false || reader.readNextStartElement() == false ||
+        doc->loadXML(reader) == false)
+    {
+        qWarning() << Q_FUNC_INFO << "Corrupted engine contents in" << file.fileName();
+        doc->clearContents();
+        return false;
+    }
+
+    return true;
+}
+
+bool WorkspaceSnapshot::checkFixtureDefSources(QDataStream& stream, QLCFixtureDefCache* cache)
+{
+    Q_ASSERT(cache != NULL);
+
+    bool upToDate = true;
+    quint32 count = 0;
+    stream >> count;
+
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; i++)
+    {
+        QString manufacturer, model, path;
+        qint64 size;
+        QDateTime modified;
+        stream >> manufacturer >> model >> path >> size >> modified;
+
+        /* Definitions not installed on this machine come from the snapshot */
+        QLCFixtureDef* cached = cache->fixtureDef(manufacturer, model);
+        if (cached == NULL)
+            continue;
+
+        if (cached->definitionSourceFile() != path)
+        {
+            upToDate = false;
+        }
+        else if (path.isEmpty() == false)
+        {
+            QFileInfo info(path);
+            if (info.size() != size || info.lastModified() != modified)
+                upToDate = false;
+        }
+    }
+
+    return (upToDate == true && stream.status() == QDataStream::Ok);
+}
+
+QLCFixtureDef* WorkspaceSnapshot::readFixtureDef(QDataStream& stream)
+{
+    QLCFixtureDef* def = new QLCFixtureDef();
+    QString manufacturer, model, type, author;
+    stream >> manufacturer >> model >> type >> author;
+    def->setManufacturer(manufacturer);
+    def->setModel(model);
+    def->setType(type);
+    def->setAuthor(author);
+
+    quint32 channelCount = 0;
+    stream >> channelCount;
+    QList <QLCChannel*> channels;
+    for (quint32 i = 0; i < channelCount && stream.status() == QDataStream::Ok; i++)
+    {
+        QLCChannel* channel = new QLCChannel();
+        QString name;
+        qint32 group, controlByte, colour;
+        stream >> name >> group >> controlByte >> colour;
+        channel->setName(name);
+        channel->setGroup(QLCChannel::Group(group));
+        channel->setControlByte(QLCChannel::ControlByte(controlByte));
+        channel->setColour(QLCChannel::PrimaryColour(colour));
+
+        quint32 capCount = 0;
+        stream >> capCount;
+        for (quint32 c = 0; c < capCount && stream.status() == QDataStream::Ok; c++)
+        {
+            quint8 min, max;
+            QString capName, resource;
+            QColor color1, color2;
+            stream >> min >> max >> capName >> resource >> color1 >> color2;
+            QLCCapability* cap = new QLCCapability(min, max, capName, resource, color1, color2);
+            if (channel->addCapability(cap) == false)
+                delete cap;
+        }
+
+        def->addChannel(channel);
+        channels << channel;
+    }
+
+    quint32 modeCount = 0;
+    stream >> modeCount;
+    for (quint32 i = 0; i < modeCount && stream.status() == QDataStream::Ok; i++)
+    {
+        QLCFixtureMode* mode = new QLCFixtureMode(def);
+        QString name;
+        stream >> name;
+        mode->setName(name);
+
+        quint32 modeChannelCount = 0;
+        stream >> modeChannelCount;
+        for (quint32 c = 0; c < modeChannelCount && stream.status() == QDataStream::Ok; c++)
+        {
+            qint32 index;
+            stream >> index;
+            if (index >= 0 && index < channels.size())
+                mode->insertChannel(channels.at(index), mode->channels().size());
+        }
+
+        quint32 headCount = 0;
+        stream >> headCount;
+        for (quint32 h = 0; h < headCount && stream.status() == QDataStream::Ok; h++)
+        {
+            QList <quint32> headChannels;
+            stream >> headChannels;
+
+            QLCFixtureHead head;
+            foreach (quint32 channel, headChannels)
+                head.addChannel(channel);
+            mode->insertHead(-1, head);
+        }
+
+        QLCPhysical phy;
+        QString bulbType, lensName, focusType, dmxConnector;
+        qint32 lumens, colourTemp, width, height, depth, panMax, tiltMax, power;
+        double weight, degreesMin, degreesMax;
+        stream >> bulbType >> lumens >> colourTemp >> weight >> width >> height >> depth
+               >> lensName >> degreesMin >> degreesMax >> focusType >> panMax >> tiltMax
+               >> power >> dmxConnector;
+        phy.setBulbType(bulbType);
+        phy.setBulbLumens(lumens);
+        phy.setBulbColourTemperature(colourTemp);
+        phy.setWeight(weight);
+        phy.setWidth(width);
+        phy.setHeight(height);
+        phy.setDepth(depth);
+        phy.setLensName(lensName);
+        phy.setLensDegreesMin(degreesMin);
+        phy.setLensDegreesMax(degreesMax);
+        phy.setFocusType(focusType);
+        phy.setFocusPanMax(panMax);
+        phy.setFocusTiltMax(tiltMax);
+        phy.setPowerConsumption(power);
+        phy.setDmxConnector(dmxConnector);
+        mode->setPhysical(phy);
+
+        mode->cacheHeads();
+        def->addMode(mode);
+    }
+
+    def->setLoaded();
+
+    if (stream.status() != QDataStream::Ok)
+    {
+        delete def;
+        return NULL;
+    }
+
+    return def;
+}
+
+void WorkspaceSnapshot::installFixtureDefs(const QList <QLCFixtureDef*>& defs,
+                                           QLCFixtureDefCache* cache)
+{
+    Q_ASSERT(cache != NULL);
+
+    foreach (QLCFixtureDef* def, defs)
+    {
+        QLCFixtureDef* cached = cache->fixtureDef(def->manufacturer(), def->model());
+        if (cached == NULL)
+        {
+            /* Definition not installed on this machine: use the snapshot one */
+            if (cache->addFixtureDef(def) == false)
+                delete def;
+        }
+        else
+        {
+            /* Fill placeholders coming from the fixture map, so that their
+               definition files don't need to be parsed */
+            if (cached->isLoaded() == false)
+            {
+                *cached = *def;
+                cached->setLoaded();
+            }
+            delete def;
+        }
+    }
+}
+
+bool WorkspaceSnapshot::readFixtures(QDataStream& stream, Doc* doc)
+{
+    quint32 count = 0;
+    stream >> count;
+
+    for (quint32 i = 0; i < count; i++)
+    {
+        quint32 id, universe, address, channels;
+        QString name, manufacturer, model, modeName;
+        QList <int> excludeList;
+
+        stream >> id >> name >> universe >> address >> channels
+               >> manufacturer >> model >> modeName >> excludeList;
+        if (stream.status() != QDataStream::Ok)
+            return false;
+
+        Fixture* fxi = new Fixture(doc);
+        QLCFixtureDef* fixtureDef = NULL;
+        QLCFixtureMode* fixtureMode = NULL;
+
+        if (model == KXMLFixtureRGBPanel)
+        {
+            fixtureDef = fxi->genericRGBPanelDef(channels / 3);
+            fixtureMode = fxi->genericRGBPanelMode(fixtureDef);
+        }
+        else if (model != KXMLFixtureGeneric)
+        {
+            fixtureDef = doc->fixtureDefCache()->fixtureDef(manufacturer, model);
+            if (fixtureDef != NULL)
+                fixtureMode = fixtureDef->mode(modeName);
+        }
+
+        if (fixtureDef != NULL && fixtureMode != NULL)
+            fxi->setFixtureDefinition(fixtureDef, fixtureMode);
+        else
+            fxi->setChannels(channels);
+
+        fxi->setAddress(address);
+        fxi->setUniverse(universe);
+        fxi->setName(name);
+        fxi->setExcludeFadeChannels(excludeList);
+        fxi->setID(id);
+
+        if (doc->addFixture(fxi, id) == false)
+        {
+            qWarning() << Q_FUNC_INFO << "Fixture" << name << "cannot be created.";
+            delete fxi;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,119 @@
+/*
+  Q Light Controller Plus
+  workspacesnapshot.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef WORKSPACESNAPSHOT_H
+#define WORKSPACESNAPSHOT_H
+
+#include <QString>
+#include <QList>
+
+class QLCFixtureDefCache;
+class QLCFixtureDef;
+class QDataStream;
+class Doc;
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+#define WORKSPACE_SNAPSHOT_MAGIC   0x514C4353 // "QLCS"
+#define WORKSPACE_SNAPSHOT_VERSION 2
+
+/**
+ * WorkspaceSnapshot writes and reads a binary sidecar of a workspace file
+ * (.qxs next to the .qxw), holding the engine contents in a form that is
+ * fast to restore:
+ *
+ * - the fixture definitions used by the workspace, with all their channels
+ *   and modes, so that no definition file needs to be parsed on startup
+ * - the fixture instances, already resolved against those definitions
+ * - the rest of the engine contents (groups, functions, I/O map) as a
+ *   compact XML block loaded with the streaming Doc loader
+ *
+ * The snapshot is read thru a memory mapping of the file and it is used
+ * only when it is newer than its workspace file and was produced from a
+ * workspace file of the same size, with the same snapshot version. Each
+ * fixture definition is stored with the path, size and modification time
+ * of its source file: the snapshot is not used when an installed
+ * definition comes from another file or its file has changed since.
+ */
+class WorkspaceSnapshot
+{
+public:
+    /** Get the snapshot path for the workspace file $workspacePath */
+    static QString snapshotPath(const QString& workspacePath);
+
+    /** Check if the snapshot of $workspacePath can be used to load it */
+    static bool isUpToDate(const QString& workspacePath);
+
+    /**
+     * Save a snapshot of the engine contents of $doc, that has just been
+     * saved into $workspacePath.
+     *
+     * @return true if successful, otherwise false
+     */
+    static bool save(Doc* doc, const QString& workspacePath);
+
+    /**
+     * Load the engine contents of $workspacePath into $doc from its
+     * snapshot, if the snapshot is up to date. $doc is expected to be
+     * empty.
+     *
+     * @return true if the snapshot was loaded, otherwise false
+     */
+    static bool load(Doc* doc, const QString& workspacePath);
+
+private:
+    /** Write the source file path, size & modification time of $defs */
+    static void writeFixtureDefSources(QDataStream& stream, const QList <QLCFixtureDef*>& defs);
+
+    /**
+     * Read the definition sources written by writeFixtureDefSources() and
+     * check them against the definitions installed in $cache.
+     *
+     * @return false if an installed definition comes from another file
+     *         or its file has changed, otherwise true
+     */
+    static bool checkFixtureDefSources(QDataStream& stream, QLCFixtureDefCache* cache);
+
+    /** Write channels & modes of $def */
+    static void writeFixtureDef(QDataStream& stream, QLCFixtureDef* def);
+
+    /**
+     * Read a fixture definition written by writeFixtureDef().
+     *
+     * @return a new definition owned by the caller, or NULL if the
+     *         stream is corrupted
+     */
+    static QLCFixtureDef* readFixtureDef(QDataStream& stream);
+
+    /**
+     * Make $defs available in $cache, taking their ownership. Definitions
+     * already loaded in the cache are left untouched, placeholders from the
+     * fixture map are filled with the snapshot contents.
+     */
+    static void installFixtureDefs(const QList <QLCFixtureDef*>& defs, QLCFixtureDefCache* cache);
+
+    /** Read fixture instances and add them to $doc */
+    static bool readFixtures(QDataStream& stream, Doc* doc);
+};
+
+/** @} */
+
+#endif
@@ -0,0 +1,18 @@
+include(../../../variables.pri)
+include(../../../coverage.pri)
+TEMPLATE = app
+LANGUAGE = C++
+TARGET   = audiopeakcache_test
+
+QT      += testlib xml script
+CONFIG  -= app_bundle
+
+DEPENDPATH   += ../../src
+INCLUDEPATH  += ../../../plugins/interfaces
+INCLUDEPATH  += ../../src
+INCLUDEPATH  += ../../src/audio
+QMAKE_LIBDIR += ../../src
+LIBS         += -lqlcplusengine
+
+SOURCES += audiopeakcache_test.cpp
+HEADERS += audiopeakcache_test.h
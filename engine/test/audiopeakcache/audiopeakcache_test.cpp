@@ -0,0 +1,251 @@
+/*
+  Q Light Controller Plus - Unit test
+  audiopeakcache_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#include "audiopeakcache_test.h"
+#include "audiodecoder.h"
+
+#define TEST_SOURCE      "peakcache_test.wav"
+#define TEST_CACHE_DIR   "peakcache_test"
+#define TEST_SAMPLE_RATE 44100
+#define TEST_FRAMES      (TEST_SAMPLE_RATE * 2)
+/** Half period of the generated square wave, in frames */
+#define TEST_HALF_PERIOD 100
+
+/****************************************************************************
+ * Test decoder
+ ****************************************************************************/
+
+/**
+ * Decodes a 16 bit stereo square wave: full scale on the left channel,
+ * half scale on the right one
+ */
+class TestDecoder : public AudioDecoder
+{
+public:
+    TestDecoder()
+        : m_frame(0)
+    {
+    }
+
+    bool initialize()
+    {
+        configure(TEST_SAMPLE_RATE, 2, PCM_S16LE);
+        return true;
+    }
+
+    qint64 totalTime()
+    {
+        return (qint64(TEST_FRAMES) * 1000) / TEST_SAMPLE_RATE;
+    }
+
+    void seek(qint64 time)
+    {
+        m_frame = (time * TEST_SAMPLE_RATE) / 1000;
+    }
+
+    qint64 read(char *data, qint64 maxSize)
+    {
+        qint64 count = qMin(maxSize / 4, qint64(TEST_FRAMES) - m_frame);
+        for (qint64 i = 0; i < count; i++, m_frame++)
+        {
+            qint16 left = ((m_frame / TEST_HALF_PERIOD) % 2) ? -32767 : 32767;
+            qint16 right = left / 2;
+            data[i * 4] = char(left & 0xFF);
+            data[i * 4 + 1] = char((left >> 8) & 0xFF);
+            data[i * 4 + 2] = char(right & 0xFF);
+            data[i * 4 + 3] = char((right >> 8) & 0xFF);
+        }
+        return count * 4;
+    }
+
+    int bitrate()
+    {
+        return TEST_SAMPLE_RATE * 2 * 16 / 1000;
+    }
+
+private:
+    qint64 m_frame;
+};
+
+TestPeakCache::TestPeakCache(const QString& sourceFile, const QString& cacheDir)
+    : AudioPeakCache(sourceFile, cacheDir)
+    , m_decoders(0)
+{
+}
+
+TestPeakCache::~TestPeakCache()
+{
+    /* createDecoder() must not run once this part is destroyed */
+    wait();
+}
+
+AudioDecoder* TestPeakCache::createDecoder()
+{
+    m_decoders++;
+    TestDecoder* decoder = new TestDecoder();
+    decoder->initialize();
+    return decoder;
+}
+
+/****************************************************************************
+ * Tests
+ ****************************************************************************/
+
+void AudioPeakCache_Test::writeSource()
+{
+    QFile file(TEST_SOURCE);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate) == true);
+    file.write(QByteArray(1024, 'x'));
+    file.close();
+}
+
+void AudioPeakCache_Test::init()
+{
+    writeSource();
+    QDir().mkpath(TEST_CACHE_DIR);
+}
+
+void AudioPeakCache_Test::cleanup()
+{
+    QFile::remove(AudioPeakCache::cacheFilePath(TEST_SOURCE, TEST_CACHE_DIR));
+    QDir().rmdir(TEST_CACHE_DIR);
+    QFile::remove(TEST_SOURCE);
+}
+
+void AudioPeakCache_Test::generate()
+{
+    QString cacheFile = AudioPeakCache::cacheFilePath(TEST_SOURCE, TEST_CACHE_DIR);
+    QVERIFY(QFile::exists(cacheFile) == false);
+
+    TestPeakCache cache(TEST_SOURCE, TEST_CACHE_DIR);
+    QSignalSpy spy(&cache, SIGNAL(peaksReady()));
+    QVERIFY(cache.isReady() == false);
+
+    cache.load();
+    QVERIFY(cache.wait(10000) == true);
+
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(cache.m_decoders, 1);
+    QVERIFY(cache.isReady() == true);
+    QVERIFY(QFile::exists(cacheFile) == true);
+    QCOMPARE(cache.channels(), 2);
+    QCOMPARE(cache.duration(), qint64(2000));
+
+    AudioPeak peak;
+    QVERIFY(cache.peak(0, 0, 2000, peak) == true);
+    QVERIFY(qAbs(peak.min + 1.0) < 0.01);
+    QVERIFY(qAbs(peak.max - 1.0) < 0.01);
+    QVERIFY(qAbs(peak.rms - 1.0) < 0.01);
+
+    QVERIFY(cache.peak(1, 0, 2000, peak) == true);
+    QVERIFY(qAbs(peak.min + 0.5) < 0.01);
+    QVERIFY(qAbs(peak.max - 0.5) < 0.01);
+    QVERIFY(qAbs(peak.rms - 0.5) < 0.01);
+
+    // Out of range
+    QVERIFY(cache.peak(2, 0, 2000, peak) == false);
+    QVERIFY(cache.peak(0, 3000, 4000, peak) == false);
+    QVERIFY(cache.peak(0, 1000, 1000, peak) == false);
+}
+
+void AudioPeakCache_Test::reload()
+{
+    TestPeakCache first(TEST_SOURCE, TEST_CACHE_DIR);
+    first.load();
+    QVERIFY(first.wait(10000) == true);
+    QCOMPARE(first.m_decoders, 1);
+
+    // The summary comes from the disk cache, without decoding
+    TestPeakCache second(TEST_SOURCE, TEST_CACHE_DIR);
+    QSignalSpy spy(&second, SIGNAL(peaksReady()));
+    second.load();
+    QVERIFY(second.wait(10000) == true);
+
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(second.m_decoders, 0);
+    QVERIFY(second.isReady() == true);
+    QCOMPARE(second.channels(), first.channels());
+    QCOMPARE(second.duration(), first.duration());
+
+    for (int channel = 0; channel < 2; channel++)
+    {
+        for (qint64 start = 0; start < 2000; start += 150)
+        {
+            AudioPeak a, b;
+            QVERIFY(first.peak(channel, start, start + 3, a) == true);
+            QVERIFY(second.peak(channel, start, start + 3, b) == true);
+            QCOMPARE(b.min, a.min);
+            QCOMPARE(b.max, a.max);
+            QCOMPARE(b.rms, a.rms);
+
+            QVERIFY(first.peak(channel, start, 2000, a) == true);
+            QVERIFY(second.peak(channel, start, 2000, b) == true);
+            QCOMPARE(b.min, a.min);
+            QCOMPARE(b.max, a.max);
+            QCOMPARE(b.rms, a.rms);
+        }
+    }
+}
+
+void AudioPeakCache_Test::sourceModified()
+{
+    TestPeakCache first(TEST_SOURCE, TEST_CACHE_DIR);
+    first.load();
+    QVERIFY(first.wait(10000) == true);
+    QCOMPARE(first.m_decoders, 1);
+
+    // Same size, but written again later: the cache is stale
+    QTest::qSleep(1100);
+    writeSource();
+
+    TestPeakCache second(TEST_SOURCE, TEST_CACHE_DIR);
+    second.load();
+    QVERIFY(second.wait(10000) == true);
+    QCOMPARE(second.m_decoders, 1);
+    QVERIFY(second.isReady() == true);
+
+    // ...and it has been written again for the new source
+    TestPeakCache third(TEST_SOURCE, TEST_CACHE_DIR);
+    third.load();
+    QVERIFY(third.wait(10000) == true);
+    QCOMPARE(third.m_decoders, 0);
+}
+
+void AudioPeakCache_Test::corruptedCache()
+{
+    TestPeakCache first(TEST_SOURCE, TEST_CACHE_DIR);
+    first.load();
+    QVERIFY(first.wait(10000) == true);
+
+    // Cut the cache file in the middle of its levels
+    QFile file(AudioPeakCache::cacheFilePath(TEST_SOURCE, TEST_CACHE_DIR));
+    QVERIFY(file.size() > 100);
+    QVERIFY(file.resize(file.size() / 2) == true);
+
+    TestPeakCache second(TEST_SOURCE, TEST_CACHE_DIR);
+    second.load();
+    QVERIFY(second.wait(10000) == true);
+    QCOMPARE(second.m_decoders, 1);
+    QVERIFY(second.isReady() == true);
+    QCOMPARE(second.duration(), first.duration());
+}
+
+QTEST_APPLESS_MAIN(AudioPeakCache_Test)
@@ -0,0 +1,59 @@
+/*
+  Q Light Controller Plus - Unit test
+  audiopeakcache_test.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef AUDIOPEAKCACHE_TEST_H
+#define AUDIOPEAKCACHE_TEST_H
+
+#include <QObject>
+
+#include "audiopeakcache.h"
+
+/** A peak cache decoding a generated signal instead of its source file */
+class TestPeakCache : public AudioPeakCache
+{
+public:
+    TestPeakCache(const QString& sourceFile, const QString& cacheDir);
+    ~TestPeakCache();
+
+    /** Number of decoders created, i.e. times the signal was decoded */
+    int m_decoders;
+
+protected:
+    AudioDecoder* createDecoder();
+};
+
+class AudioPeakCache_Test : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void generate();
+    void reload();
+    void sourceModified();
+    void corruptedCache();
+
+private:
+    /** Write the (never decoded) source file */
+    void writeSource();
+};
+
+#endif
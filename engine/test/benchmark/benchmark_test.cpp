@@ -0,0 +1,374 @@
+/*
+  Q Light Controller Plus - Unit test
+  benchmark_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <new>
+
+#include <QElapsedTimer>
+#include <QtTest>
+
+#define private public
+#include "benchmark_test.h"
+#include "qlcfixturedefcache.h"
+#include "qlcfixturemode.h"
+#include "inputoutputmap.h"
+#include "ioplugincache.h"
+#include "qlcfixturedef.h"
+#include "fixturegroup.h"
+#include "tickprofiler.h"
+#include "mastertimer.h"
+#include "efxfixture.h"
+#include "chaserstep.h"
+#include "rgbscript.h"
+#include "rgbmatrix.h"
+#include "fixture.h"
+#include "qlcfile.h"
+#include "chaser.h"
+#include "scene.h"
+#include "efx.h"
+#include "doc.h"
+#undef private
+
+#define INTERNAL_SCRIPTDIR "../../../rgbscripts/"
+#define INTERNAL_FIXTUREDIR "../../../fixtures/"
+#define TESTPLUGINDIR "../iopluginstub"
+
+#define MAX_UNIVERSES 16
+
+/** Ticks run before measuring, so that all functions are up and running */
+#define WARMUP_TICKS 10
+
+/** Ticks measured for the latency distribution */
+#define MEASURED_TICKS 250
+
+/****************************************************************************
+ * Allocation counter
+ *
+ * On glibc, malloc() & co. are interposed so that allocations made by Qt
+ * containers in the engine library are counted too. Elsewhere only
+ * operator new is counted.
+ ****************************************************************************/
+
+static QBasicAtomicInt s_allocations = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+#if defined(__GLIBC__)
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+
+extern "C" void* malloc(size_t size)
+{
+    s_allocations.ref();
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size)
+{
+    s_allocations.ref();
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size)
+{
+    s_allocations.ref();
+    return __libc_realloc(ptr, size);
+}
+#else
+void* operator new(size_t size)
+{
+    s_allocations.ref();
+    void* ptr = malloc(size);
+    if (ptr == NULL)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) throw()
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr) throw()
+{
+    free(ptr);
+}
+#endif
+
+static int allocations()
+{
+    return s_allocations.fetchAndAddRelaxed(0);
+}
+
+/****************************************************************************
+ * Setup
+ ****************************************************************************/
+
+void Benchmark_Test::initTestCase()
+{
+    m_doc = new Doc(this, MAX_UNIVERSES);
+
+    QDir fxiDir(INTERNAL_FIXTUREDIR);
+    fxiDir.setFilter(QDir::Files);
+    fxiDir.setNameFilters(QStringList() << QString("*%1").arg(KExtFixture));
+    QVERIFY(m_doc->fixtureDefCache()->load(fxiDir) == true);
+
+    QDir pluginDir(TESTPLUGINDIR);
+    pluginDir.setFilter(QDir::Files);
+    pluginDir.setNameFilters(QStringList() << QString("*%1").arg(KExtPlugin));
+    m_doc->ioPluginCache()->load(pluginDir);
+    QVERIFY(m_doc->ioPluginCache()->plugins().size() != 0);
+
+    /* The stub has 4 outputs, shared by all universes */
+    for (quint32 i = 0; i < MAX_UNIVERSES; i++)
+        QVERIFY(m_doc->inputOutputMap()->setOutputPatch(i, "I/O Plugin Stub", i % 4) == true);
+
+    RGBScript::setCustomScriptDirectory(INTERNAL_SCRIPTDIR);
+    QVERIFY(RGBScript::scripts(m_doc).size() != 0);
+}
+
+void Benchmark_Test::cleanupTestCase()
+{
+    delete m_doc;
+}
+
+void Benchmark_Test::cleanup()
+{
+    MasterTimer* mt = m_doc->masterTimer();
+    mt->setParallelExecution(false);
+
+    /* Let all the functions finish and their fixtures fade out */
+    foreach (Function* function, m_doc->functions())
+        function->stop();
+    for (int i = 0; i < 5 && mt->runningFunctions() > 0; i++)
+        mt->timerTick();
+    mt->fader()->removeAll();
+
+    m_doc->clearContents();
+    m_doc->inputOutputMap()->resetUniverses();
+}
+
+bool Benchmark_Test::buildRig(int universes, int fixtures, int scenes, int chasers,
+                              int efxs, int matrices)
+{
+    QLCFixtureDef* rgbDef = m_doc->fixtureDefCache()->fixtureDef("Stairville", "LED PAR56");
+    QLCFixtureDef* headDef = m_doc->fixtureDefCache()->fixtureDef("Martin", "MAC250+");
+    if (rgbDef == NULL || headDef == NULL)
+        return false;
+
+    /* Alternate RGB pars and moving heads, packing them into the universes */
+    QList <Fixture*> rgbFixtures;
+    QList <Fixture*> headFixtures;
+    QList <Fixture*> allFixtures;
+    quint32 universe = 0;
+    quint32 address = 0;
+    for (int i = 0; i < fixtures; i++)
+    {
+        bool rgb = (i % 2 == 0);
+        QLCFixtureDef* def = rgb ? rgbDef : headDef;
+        QLCFixtureMode* mode = def->modes().first();
+
+        if (address + mode->channels().size() > 512)
+        {
+            universe++;
+            address = 0;
+        }
+        if (universe >= quint32(universes))
+            return false;
+
+        Fixture* fxi = new Fixture(m_doc);
+        fxi->setFixtureDefinition(def, mode);
+        fxi->setUniverse(universe);
+        fxi->setAddress(address);
+        m_doc->addFixture(fxi);
+        address += fxi->channels();
+
+        allFixtures << fxi;
+        if (rgb == true)
+            rgbFixtures << fxi;
+        else
+            headFixtures << fxi;
+    }
+
+    QList <Function*> functions;
+
+    /* Scenes with a long fade, to keep all their channels busy */
+    for (int s = 0; s < scenes; s++)
+    {
+        Scene* scene = new Scene(m_doc);
+        scene->setFadeInSpeed(60000);
+        for (int i = s; i < allFixtures.size(); i += scenes)
+        {
+            Fixture* fxi = allFixtures.at(i);
+            for (quint32 ch = 0; ch < fxi->channels(); ch++)
+                scene->setValue(fxi->id(), ch, uchar((ch * 13 + s * 29) % 256));
+        }
+        m_doc->addFunction(scene);
+        functions << scene;
+    }
+
+    /* Chasers thru 4 steps, each over a few fixtures */
+    for (int c = 0; c < chasers; c++)
+    {
+        Chaser* chaser = new Chaser(m_doc);
+        chaser->setFadeInSpeed(100);
+        chaser->setDuration(200);
+        m_doc->addFunction(chaser);
+
+        for (int step = 0; step < 4; step++)
+        {
+            Scene* scene = new Scene(m_doc);
+            for (int i = (c + step) % allFixtures.size(); i < allFixtures.size(); i += chasers * 4)
+            {
+                Fixture* fxi = allFixtures.at(i);
+                for (quint32 ch = 0; ch < fxi->channels(); ch++)
+                    scene->setValue(fxi->id(), ch, uchar((ch * 7 + step * 61) % 256));
+            }
+            m_doc->addFunction(scene);
+            chaser->addStep(ChaserStep(scene->id()));
+        }
+        functions << chaser;
+    }
+
+    /* EFX over the moving heads */
+    for (int e = 0; e < efxs && headFixtures.isEmpty() == false; e++)
+    {
+        EFX* efx = new EFX(m_doc);
+        efx->setAlgorithm(EFX::Algorithm(e % 2));
+        efx->setDuration(2000);
+        for (int i = e; i < headFixtures.size(); i += efxs)
+        {
+            EFXFixture* ef = new EFXFixture(efx);
+            ef->setHead(GroupHead(headFixtures.at(i)->id(), 0));
+            efx->addFixture(ef);
+        }
+        m_doc->addFunction(efx);
+        functions << efx;
+    }
+
+    /* RGB matrices over groups of RGB pars */
+    for (int m = 0; m < matrices && rgbFixtures.isEmpty() == false; m++)
+    {
+        FixtureGroup* grp = new FixtureGroup(m_doc);
+        grp->setSize(QSize(qMax(1, rgbFixtures.size() / matrices), 1));
+        m_doc->addFixtureGroup(grp);
+        for (int i = m; i < rgbFixtures.size(); i += matrices)
+            grp->assignFixture(rgbFixtures.at(i)->id());
+
+        RGBMatrix* mtx = new RGBMatrix(m_doc);
+        mtx->setFixtureGroup(grp->id());
+        mtx->setAlgorithm(RGBAlgorithm::algorithm(m_doc, "Full Columns"));
+        mtx->setDuration(500);
+        m_doc->addFunction(mtx);
+        functions << mtx;
+    }
+
+    foreach (Function* function, functions)
+        function->start(m_doc->masterTimer());
+
+    return true;
+}
+
+/****************************************************************************
+ * Benchmarks
+ ****************************************************************************/
+
+void Benchmark_Test::tick_data()
+{
+    QTest::addColumn<int>("universes");
+    QTest::addColumn<int>("fixtures");
+    QTest::addColumn<int>("scenes");
+    QTest::addColumn<int>("chasers");
+    QTest::addColumn<int>("efxs");
+    QTest::addColumn<int>("matrices");
+    QTest::addColumn<bool>("parallel");
+
+    QTest::newRow("1 universe") << 1 << 24 << 8 << 2 << 1 << 1 << false;
+    QTest::newRow("4 universes") << 4 << 96 << 32 << 8 << 4 << 4 << false;
+    QTest::newRow("16 universes") << 16 << 384 << 128 << 32 << 16 << 16 << false;
+    QTest::newRow("16 universes, parallel") << 16 << 384 << 128 << 32 << 16 << 16 << true;
+}
+
+void Benchmark_Test::tick()
+{
+    QFETCH(int, universes);
+    QFETCH(int, fixtures);
+    QFETCH(int, scenes);
+    QFETCH(int, chasers);
+    QFETCH(int, efxs);
+    QFETCH(int, matrices);
+    QFETCH(bool, parallel);
+
+    MasterTimer* mt = m_doc->masterTimer();
+    mt->setParallelExecution(parallel);
+
+    QVERIFY(buildRig(universes, fixtures, scenes, chasers, efxs, matrices) == true);
+
+    for (int i = 0; i < WARMUP_TICKS; i++)
+        mt->timerTick();
+    QVERIFY(mt->runningFunctions() >= scenes + chasers + efxs + matrices);
+
+    /* Latency distribution, allocations and stage breakdown */
+    QVector <qint64> latencies(MEASURED_TICKS);
+    QElapsedTimer total;
+    QElapsedTimer elapsed;
+
+    mt->profiler()->reset();
+    mt->profiler()->setEnabled(true);
+    int allocationsBefore = allocations();
+    total.start();
+    for (int i = 0; i < MEASURED_TICKS; i++)
+    {
+        elapsed.start();
+        mt->timerTick();
+        latencies[i] = elapsed.nsecsElapsed();
+    }
+    qint64 totalNsecs = total.nsecsElapsed();
+    int allocated = allocations() - allocationsBefore;
+    mt->profiler()->setEnabled(false);
+
+    qSort(latencies.begin(), latencies.end());
+    qDebug() << QString("%1: %2 ticks/s, latency us p50 %3 p95 %4 p99 %5 max %6, %7 allocations/tick")
+                .arg(QTest::currentDataTag())
+                .arg(qreal(MEASURED_TICKS) * 1e9 / qMax(qint64(1), totalNsecs), 0, 'f', 0)
+                .arg(latencies[MEASURED_TICKS * 50 / 100] / 1000.0, 0, 'f', 1)
+                .arg(latencies[MEASURED_TICKS * 95 / 100] / 1000.0, 0, 'f', 1)
+                .arg(latencies[MEASURED_TICKS * 99 / 100] / 1000.0, 0, 'f', 1)
+                .arg(latencies[MEASURED_TICKS - 1] / 1000.0, 0, 'f', 1)
+                .arg(qreal(allocated) / MEASURED_TICKS, 0, 'f', 1);
+
+    foreach (TickProfiler::Statistics st, mt->profiler()->statistics())
+    {
+        if (st.type != TickProfiler::StageItem)
+            break;
+        qDebug() << QString("  %1: p50 %2 us, p95 %3 us")
+                    .arg(st.name).arg(st.p50, 0, 'f', 1).arg(st.p95, 0, 'f', 1);
+    }
+
+    QBENCHMARK
+    {
+        mt->timerTick();
+    }
+}
+
+QTEST_MAIN(Benchmark_Test)
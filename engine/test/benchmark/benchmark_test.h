@@ -0,0 +1,55 @@
+/*
+  Q Light Controller Plus - Unit test
+  benchmark_test.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef BENCHMARK_TEST_H
+#define BENCHMARK_TEST_H
+
+#include <QObject>
+
+class Doc;
+
+/**
+ * Engine throughput benchmarks. Each data row builds a synthetic rig of
+ * fixtures spread over a number of universes patched to the I/O plugin
+ * stub, starts scenes, chasers, EFX and RGB matrices on it and measures
+ * MasterTimer ticks: QBENCHMARK time per tick, ticks per second, the
+ * per-tick latency distribution and heap allocations per tick.
+ */
+class Benchmark_Test : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void cleanup();
+
+    void tick_data();
+    void tick();
+
+private:
+    /** Build a rig in m_doc and start its functions. Returns false on failure. */
+    bool buildRig(int universes, int fixtures, int scenes, int chasers,
+                  int efxs, int matrices);
+
+private:
+    Doc* m_doc;
+};
+
+#endif
@@ -0,0 +1,181 @@
+/*
+  Q Light Controller Plus - Unit test
+  channelremap_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#include "channelremap_test.h"
+#include "qlcfixturedef.h"
+#include "channelremap.h"
+#include "qlcchannel.h"
+#include "chaserstep.h"
+#include "fixture.h"
+#include "qlcfile.h"
+#include "chaser.h"
+#include "scene.h"
+#include "doc.h"
+
+#define INTERNAL_FIXTUREDIR "../../../fixtures/"
+
+void ChannelRemap_Test::initTestCase()
+{
+    m_doc = new Doc(this);
+
+    QDir dir(INTERNAL_FIXTUREDIR);
+    dir.setFilter(QDir::Files);
+    dir.setNameFilters(QStringList() << QString("*%1").arg(KExtFixture));
+    QVERIFY(m_doc->fixtureDefCache()->load(dir) == true);
+}
+
+void ChannelRemap_Test::cleanupTestCase()
+{
+    delete m_doc;
+}
+
+void ChannelRemap_Test::init()
+{
+    m_doc->clearContents();
+}
+
+void ChannelRemap_Test::initial()
+{
+    ChannelRemap remap(m_doc);
+    QCOMPARE(remap.count(), 0);
+    QCOMPARE(remap.remap(QList <SceneValue>() << SceneValue(1, 2, 3)).count(), 0);
+    QCOMPARE(remap.positionTargets(1).count(), 0);
+}
+
+void ChannelRemap_Test::remap()
+{
+    ChannelRemap remap(m_doc);
+    remap.add(SceneValue(1, 0), SceneValue(10, 3));
+    remap.add(SceneValue(1, 1), SceneValue(12, 0));
+    remap.add(SceneValue(1, 1), SceneValue(11, 0));
+    QCOMPARE(remap.count(), 3);
+
+    QList <SceneValue> values;
+    values << SceneValue(2, 0, 7) << SceneValue(1, 1, 50) << SceneValue(1, 0, 100);
+
+    // Unmapped channels are dropped, the others keep their values
+    QList <SceneValue> remapped = remap.remap(values);
+    QCOMPARE(remapped.count(), 3);
+    QCOMPARE(remapped[0].fxi, quint32(10));
+    QCOMPARE(remapped[0].channel, quint32(3));
+    QCOMPARE(remapped[0].value, uchar(100));
+    QCOMPARE(remapped[1].fxi, quint32(11));
+    QCOMPARE(remapped[1].channel, quint32(0));
+    QCOMPARE(remapped[1].value, uchar(50));
+    QCOMPARE(remapped[2].fxi, quint32(12));
+    QCOMPARE(remapped[2].channel, quint32(0));
+    QCOMPARE(remapped[2].value, uchar(50));
+
+    remap.clear();
+    QCOMPARE(remap.count(), 0);
+    QCOMPARE(remap.remap(values).count(), 0);
+}
+
+void ChannelRemap_Test::positionTargets()
+{
+    QLCFixtureDef* def = m_doc->fixtureDefCache()->fixtureDef("Martin", "MAC250+");
+    QVERIFY(def != NULL);
+    QLCFixtureMode* mode = def->mode("Mode 4");
+    QVERIFY(mode != NULL);
+
+    Fixture* scanner = new Fixture(m_doc);
+    scanner->setFixtureDefinition(def, mode);
+    m_doc->addFixture(scanner);
+
+    Fixture* dimmer = new Fixture(m_doc);
+    dimmer->setChannels(4);
+    dimmer->setAddress(100);
+    m_doc->addFixture(dimmer);
+
+    quint32 pan = scanner->channel("", Qt::CaseInsensitive, QLCChannel::Pan);
+    quint32 tilt = scanner->channel("", Qt::CaseInsensitive, QLCChannel::Tilt);
+    QVERIFY(pan != QLCChannel::invalid());
+    QVERIFY(tilt != QLCChannel::invalid());
+
+    ChannelRemap remap(m_doc);
+    remap.add(SceneValue(42, 0), SceneValue(scanner->id(), pan));
+    remap.add(SceneValue(42, 1), SceneValue(scanner->id(), tilt));
+    remap.add(SceneValue(42, 2), SceneValue(dimmer->id(), 0));
+    remap.add(SceneValue(43, 0), SceneValue(dimmer->id(), 1));
+
+    // Once per target fixture, even with both pan and tilt remapped
+    QCOMPARE(remap.positionTargets(42), QList <quint32>() << scanner->id());
+    QCOMPARE(remap.positionTargets(43).count(), 0);
+
+    remap.add(SceneValue(43, 1), SceneValue(scanner->id(), pan));
+    QCOMPARE(remap.positionTargets(43), QList <quint32>() << scanner->id());
+}
+
+void ChannelRemap_Test::remapDoc()
+{
+    Scene* scene = new Scene(m_doc);
+    scene->setValue(1, 0, 100);
+    scene->setValue(1, 1, 50);
+    scene->setValue(2, 0, 7);
+    QVERIFY(m_doc->addFunction(scene) == true);
+
+    Chaser* chaser = new Chaser(m_doc);
+    chaser->enableSequenceMode(scene->id());
+    ChaserStep step(scene->id());
+    step.values << SceneValue(1, 1, 20) << SceneValue(2, 0, 30);
+    chaser->addStep(step);
+    QVERIFY(m_doc->addFunction(chaser) == true);
+
+    ChannelRemap remap(m_doc);
+    remap.add(SceneValue(1, 0), SceneValue(3, 1));
+    remap.add(SceneValue(1, 1), SceneValue(3, 0));
+
+    QSignalSpy spy(&remap, SIGNAL(progressChanged(int)));
+    QVERIFY(remap.remapDoc() == true);
+    QVERIFY(spy.count() > 0);
+    QCOMPARE(spy.last()[0].toInt(), 100);
+
+    QList <SceneValue> values = scene->values();
+    QCOMPARE(values.count(), 2);
+    QCOMPARE(values[0], SceneValue(3, 0));
+    QCOMPARE(values[0].value, uchar(50));
+    QCOMPARE(values[1], SceneValue(3, 1));
+    QCOMPARE(values[1].value, uchar(100));
+
+    values = chaser->stepAt(0).values;
+    QCOMPARE(values.count(), 1);
+    QCOMPARE(values[0], SceneValue(3, 0));
+    QCOMPARE(values[0].value, uchar(20));
+}
+
+void ChannelRemap_Test::cancel()
+{
+    Scene* scene = new Scene(m_doc);
+    scene->setValue(1, 0, 100);
+    QVERIFY(m_doc->addFunction(scene) == true);
+
+    ChannelRemap remap(m_doc);
+    remap.add(SceneValue(1, 0), SceneValue(3, 1));
+
+    // Cancel as soon as the remap starts
+    connect(&remap, SIGNAL(progressChanged(int)), &remap, SLOT(cancel()));
+    QVERIFY(remap.remapDoc() == false);
+
+    QCOMPARE(scene->values().count(), 1);
+    QCOMPARE(scene->values()[0], SceneValue(1, 0));
+}
+
+QTEST_APPLESS_MAIN(ChannelRemap_Test)
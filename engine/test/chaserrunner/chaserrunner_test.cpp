@@ -30,6 +30,7 @@
 #include "genericfader.h"
 #include "fadechannel.h"
 #include "chaserstep.h"
+#include "tempoclock.h"
 #include "universe.h"
 #include "qlcfile.h"
 #include "fixture.h"
@@ -353,6 +354,46 @@ void ChaserRunner_Test::currentDuration()
     QCOMPARE(cr.currentDuration(), uint(1234));
 }
 
+void ChaserRunner_Test::tap()
+{
+    m_chaser->setDuration(1000);
+
+    ChaserRunner cr(m_doc, m_chaser);
+
+    // A quarter of the step duration must pass before a tap steps forward
+    cr.tap();
+    QCOMPARE(cr.m_next, false);
+
+    QTest::qSleep(100);
+    cr.tap();
+    QCOMPARE(cr.m_next, false);
+
+    QTest::qSleep(200);
+    cr.tap();
+    QCOMPARE(cr.m_next, true);
+}
+
+void ChaserRunner_Test::tapBeats()
+{
+    TempoClock* clock = m_doc->masterTimer()->tempoClock();
+    clock->setBpm(400);
+
+    // One beat is 150ms at 400 BPM
+    m_chaser->setTempoType(Function::Beats);
+    m_chaser->setDuration(1000);
+
+    ChaserRunner cr(m_doc, m_chaser);
+
+    cr.tap();
+    QCOMPARE(cr.m_next, false);
+
+    QTest::qSleep(100);
+    cr.tap();
+    QCOMPARE(cr.m_next, true);
+
+    clock->setBpm(TEMPOCLOCK_DEFAULT_BPM);
+}
+
 void ChaserRunner_Test::roundCheckSingleShotForward()
 {
     m_chaser->setDirection(Function::Forward);
@@ -42,6 +42,8 @@ private slots:
     void currentFadeIn();
     void currentFadeOut();
     void currentDuration();
+    void tap();
+    void tapBeats();
 
     void roundCheckSingleShotForward();
     void roundCheckSingleShotBackward();
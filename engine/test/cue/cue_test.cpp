@@ -84,6 +84,49 @@ void Cue_Test::value()
     QCOMPARE(cue.value(UINT_MAX), uchar(42));
 }
 
+void Cue_Test::channels()
+{
+    Cue cue;
+    QCOMPARE(cue.channels().size(), 0);
+    QCOMPARE(cue.channelValues().size(), 0);
+
+    cue.setValue(42, 1);
+    cue.setValue(5, 2);
+    cue.setValue(512, 3);
+    cue.setValue(0, 4);
+    cue.setValue(42, 5);
+
+    /* Kept in ascending channel order */
+    QCOMPARE(cue.channels().size(), 4);
+    QCOMPARE(cue.channels().at(0), uint(0));
+    QCOMPARE(cue.channels().at(1), uint(5));
+    QCOMPARE(cue.channels().at(2), uint(42));
+    QCOMPARE(cue.channels().at(3), uint(512));
+    QCOMPARE(cue.channelValues().size(), 4);
+    QCOMPARE(cue.channelValues().at(0), uchar(4));
+    QCOMPARE(cue.channelValues().at(1), uchar(2));
+    QCOMPARE(cue.channelValues().at(2), uchar(5));
+    QCOMPARE(cue.channelValues().at(3), uchar(3));
+
+    cue.unsetValue(5);
+    QCOMPARE(cue.channels().size(), 3);
+    QCOMPARE(cue.channels().at(1), uint(42));
+    QCOMPARE(cue.channelValues().at(1), uchar(5));
+
+    QHash <uint,uchar> values;
+    values[300] = 1;
+    values[3] = 2;
+    values[30] = 3;
+    Cue cue2(values);
+    QCOMPARE(cue2.channels().size(), 3);
+    QCOMPARE(cue2.channels().at(0), uint(3));
+    QCOMPARE(cue2.channels().at(1), uint(30));
+    QCOMPARE(cue2.channels().at(2), uint(300));
+    QCOMPARE(cue2.channelValues().at(0), uchar(2));
+    QCOMPARE(cue2.channelValues().at(1), uchar(3));
+    QCOMPARE(cue2.channelValues().at(2), uchar(1));
+}
+
 void Cue_Test::copy()
 {
     Cue cue1("Foo");
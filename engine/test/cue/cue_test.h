@@ -30,6 +30,7 @@ private slots:
     void initial();
     void name();
     void value();
+    void channels();
     void copy();
     void save();
     void load();
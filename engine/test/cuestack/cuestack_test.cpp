@@ -639,7 +639,7 @@ void CueStack_Test::insertStartValue()
     cs.m_fader->add(fc);
 
     fc.setTarget(64);
-    cs.insertStartValue(fc, ua);
+    cs.insertStartValue(fc);
     QCOMPARE(fc.start(), uchar(127));
     QCOMPARE(fc.current(), uchar(127));
 
@@ -647,7 +647,7 @@ void CueStack_Test::insertStartValue()
 
     // HTP channel in universes
     ua[0]->write(0, 192);
-    cs.insertStartValue(fc, ua);
+    cs.insertStartValue(fc);
     QCOMPARE(fc.start(), uchar(0));
     QCOMPARE(fc.current(), uchar(0));
 
@@ -664,9 +664,10 @@ void CueStack_Test::insertStartValue()
     fxi->setUniverse(0);
     m_doc->addFixture(fxi);
 
-    // LTP channel (Pan) in universes
+    // LTP channel (Pan) in universes, as of the last tick
     ua[0]->write(0, 192);
-    cs.insertStartValue(fc, ua);
+    m_doc->masterTimer()->m_snapshot.capture(ua);
+    cs.insertStartValue(fc);
     QCOMPARE(fc.start(), uchar(192));
     QCOMPARE(fc.current(), uchar(192));
 
@@ -689,8 +690,6 @@ void CueStack_Test::switchCue()
     fxi->setUniverse(0);
     m_doc->addFixture(fxi);
 
-    QList<Universe*> ua;
-    ua.append(new Universe(0, new GrandMaster()));
     CueStack cs(m_doc);
     cs.setFadeInSpeed(100);
     cs.setFadeOutSpeed(200);
@@ -721,13 +720,13 @@ void CueStack_Test::switchCue()
     cs.preRun();
 
     // Do nothing with invalid cue indices
-    cs.switchCue(-1, -1, ua);
+    cs.switchCue(-1, -1);
     QCOMPARE(cs.m_fader->channels().size(), 0);
-    cs.switchCue(-1, 3, ua);
+    cs.switchCue(-1, 3);
     QCOMPARE(cs.m_fader->channels().size(), 0);
 
     // Switch to cue one
-    cs.switchCue(3, 0, ua);
+    cs.switchCue(3, 0);
     QCOMPARE(cs.m_fader->channels().size(), 5);
 
     FadeChannel fc;
@@ -783,7 +782,7 @@ void CueStack_Test::switchCue()
     cs.m_fader->m_channels[fc].setCurrent(127);
 
     // Switch to cue two
-    cs.switchCue(0, 1, ua);
+    cs.switchCue(0, 1);
     QCOMPARE(cs.m_fader->channels().size(), 7);
 
     fc.setChannel(0);
@@ -800,19 +799,20 @@ void CueStack_Test::switchCue()
     QCOMPARE(cs.m_fader->channels()[fc].channel(), uint(1));
     QCOMPARE(cs.m_fader->channels()[fc].fadeTime(), uint(40));
 
+    // Channels with the same value in both cues keep fading as they were
     fc.setChannel(11); // LTP channel also in the next cue
-    QCOMPARE(cs.m_fader->channels()[fc].start(), uchar(127));
+    QCOMPARE(cs.m_fader->channels()[fc].start(), uchar(0));
     QCOMPARE(cs.m_fader->channels()[fc].current(), uchar(127));
     QCOMPARE(cs.m_fader->channels()[fc].target(), uchar(255));
     QCOMPARE(cs.m_fader->channels()[fc].channel(), uint(11));
-    QCOMPARE(cs.m_fader->channels()[fc].fadeTime(), uint(60));
+    QCOMPARE(cs.m_fader->channels()[fc].fadeTime(), uint(20));
 
     fc.setChannel(500);
-    QCOMPARE(cs.m_fader->channels()[fc].start(), uchar(127));
+    QCOMPARE(cs.m_fader->channels()[fc].start(), uchar(0));
     QCOMPARE(cs.m_fader->channels()[fc].current(), uchar(127));
     QCOMPARE(cs.m_fader->channels()[fc].target(), uchar(255));
     QCOMPARE(cs.m_fader->channels()[fc].channel(), uint(500));
-    QCOMPARE(cs.m_fader->channels()[fc].fadeTime(), uint(60));
+    QCOMPARE(cs.m_fader->channels()[fc].fadeTime(), uint(20));
 
     fc.setChannel(3);
     QCOMPARE(cs.m_fader->channels()[fc].start(), uchar(0));
@@ -829,7 +829,7 @@ void CueStack_Test::switchCue()
     QCOMPARE(cs.m_fader->channels()[fc].fadeTime(), uint(60));
 
     // Stop
-    cs.switchCue(1, -1, ua);
+    cs.switchCue(1, -1);
     QCOMPARE(cs.m_fader->channels().size(), 7);
 
     MasterTimer mt(m_doc);
@@ -852,8 +852,6 @@ void CueStack_Test::postRun()
     m_doc->addFixture(fxi);
 
     MasterTimer mt(m_doc);
-    QList<Universe*> ua;
-    ua.append(new Universe(0, new GrandMaster()));
     CueStack cs(m_doc);
     cs.setFadeInSpeed(100);
     cs.setFadeOutSpeed(200);
@@ -880,7 +878,7 @@ void CueStack_Test::postRun()
     cs.preRun();
 
     // Switch to cue one
-    cs.switchCue(-1, 0, ua);
+    cs.switchCue(-1, 0);
     QCOMPARE(cs.m_fader->channels().size(), 5);
 
     QSignalSpy cueSpy(&cs, SIGNAL(currentCueChanged(int)));
@@ -634,6 +634,179 @@ void Doc_Test::loadWrongRoot()
     QVERIFY(m_doc->loadXML(root) == false);
 }
 
+void Doc_Test::loadStream()
+{
+    QDomDocument document;
+    QDomElement root = document.createElement("Engine");
+    document.appendChild(root);
+
+    root.appendChild(createFixtureNode(document, 0));
+    root.appendChild(createFixtureNode(document, 72));
+    root.appendChild(createFixtureNode(document, 15));
+
+    root.appendChild(createFixtureGroupNode(document, 0));
+    root.appendChild(createFixtureGroupNode(document, 42));
+    root.appendChild(createFixtureGroupNode(document, 72));
+
+    root.appendChild(createCollectionNode(document, 5));
+    root.appendChild(createCollectionNode(document, 9));
+    root.appendChild(createCollectionNode(document, 1));
+    root.appendChild(createCollectionNode(document, 7));
+
+    root.appendChild(createBusNode(document, 0, 1));
+    root.appendChild(createBusNode(document, 7, 2));
+    root.appendChild(createBusNode(document, 12, 3));
+    root.appendChild(createBusNode(document, 29, 4));
+    root.appendChild(createBusNode(document, 31, 500));
+
+    root.appendChild(document.createElement("ExtraTag"));
+
+    QXmlStreamReader reader(document.toString());
+    QVERIFY(reader.readNextStartElement() == true);
+
+    QVERIFY(m_doc->fixtures().size() == 0);
+    QVERIFY(m_doc->functions().size() == 0);
+    QVERIFY(m_doc->loadXML(reader) == true);
+    QVERIFY(reader.isEndElement() == true);
+    QVERIFY(reader.name() == QLatin1String("Engine"));
+    QVERIFY(m_doc->fixtures().size() == 3);
+    QVERIFY(m_doc->functions().size() == 4);
+    QVERIFY(m_doc->fixtureGroups().size() == 3);
+    QVERIFY(m_doc->function(5) != NULL);
+    QVERIFY(m_doc->function(5)->type() == Function::Collection);
+    QVERIFY(m_doc->function(7) != NULL);
+    QVERIFY(Bus::instance()->value(0) == 1);
+    QVERIFY(Bus::instance()->value(7) == 2);
+    QVERIFY(Bus::instance()->value(12) == 3);
+    QVERIFY(Bus::instance()->value(29) == 4);
+    QVERIFY(Bus::instance()->value(31) == 500);
+}
+
+void Doc_Test::loadStreamWrongRoot()
+{
+    QDomDocument document;
+    QDomElement root = document.createElement("Enjine");
+    document.appendChild(root);
+
+    root.appendChild(createFixtureNode(document, 0));
+    root.appendChild(createCollectionNode(document, 5));
+
+    QXmlStreamReader reader(document.toString());
+    QVERIFY(reader.readNextStartElement() == true);
+    QVERIFY(m_doc->loadXML(reader) == false);
+    QVERIFY(m_doc->fixtures().size() == 0);
+    QVERIFY(m_doc->functions().size() == 0);
+}
+
+QString Doc_Test::createLargeEngineXML()
+{
+    /* A large engine with many scenes */
+    Fixture* fxi = new Fixture(m_doc);
+    fxi->setChannels(24);
+    m_doc->addFixture(fxi);
+
+    for (int i = 0; i < 2000; i++)
+    {
+        Scene* s = new Scene(m_doc);
+        s->setName(QString("Scene %1").arg(i));
+        for (quint32 ch = 0; ch < 24; ch++)
+            s->setValue(SceneValue(fxi->id(), ch, uchar(i + ch)));
+        m_doc->addFunction(s);
+    }
+
+    QDomDocument document;
+    QDomElement root = document.createElement("Workspace");
+    document.appendChild(root);
+    m_doc->saveXML(&document, &root);
+    m_doc->clearContents();
+
+    return document.toString();
+}
+
+void Doc_Test::loadStreamLarge()
+{
+    /* The DOM loader and the streaming loader build the same functions */
+    QString xml = createLargeEngineXML();
+
+    QDomDocument dom;
+    QVERIFY(dom.setContent(xml) == true);
+    QVERIFY(m_doc->loadXML(dom.documentElement().firstChildElement("Engine")) == true);
+    QCOMPARE(m_doc->functions().size(), 2000);
+
+    /* What the DOM loader built is the reference for the stream loader */
+    QMap <quint32, QString> domFunctions;
+    foreach (Function* function, m_doc->functions())
+    {
+        Scene* s = qobject_cast<Scene*> (function);
+        QVERIFY(s != NULL);
+        QStringList values;
+        foreach (SceneValue scv, s->values())
+            values << QString("%1:%2:%3").arg(scv.fxi).arg(scv.channel).arg(scv.value);
+        domFunctions[s->id()] = s->name() + "|" + values.join(",");
+    }
+    m_doc->clearContents();
+
+    QXmlStreamReader reader(xml);
+    QVERIFY(reader.readNextStartElement() == true);
+    QVERIFY(reader.readNextStartElement() == true);
+    QVERIFY(m_doc->loadXML(reader) == true);
+    QCOMPARE(m_doc->functions().size(), 2000);
+    QCOMPARE(m_doc->fixtures().size(), 1);
+
+    foreach (Function* function, m_doc->functions())
+    {
+        Scene* s = qobject_cast<Scene*> (function);
+        QVERIFY(s != NULL);
+        QStringList values;
+        foreach (SceneValue scv, s->values())
+            values << QString("%1:%2:%3").arg(scv.fxi).arg(scv.channel).arg(scv.value);
+        QCOMPARE(s->name() + "|" + values.join(","), domFunctions.value(s->id()));
+    }
+
+    Scene* s = qobject_cast<Scene*> (m_doc->function(1234));
+    QVERIFY(s != NULL);
+    QCOMPARE(s->name(), QString("Scene 1234"));
+    QCOMPARE(s->values().size(), 24);
+}
+
+void Doc_Test::loadBenchmark_data()
+{
+    QTest::addColumn<bool>("stream");
+
+    QTest::newRow("DOM") << false;
+    QTest::newRow("stream") << true;
+}
+
+void Doc_Test::loadBenchmark()
+{
+    /* Run with e.g. -tickcounter to compare the two loaders. Each
+       iteration parses the whole engine, including the file contents. */
+    QFETCH(bool, stream);
+
+    QString xml = createLargeEngineXML();
+
+    QBENCHMARK
+    {
+        m_doc->clearContents();
+        if (stream == true)
+        {
+            QXmlStreamReader reader(xml);
+            reader.readNextStartElement();
+            reader.readNextStartElement();
+            m_doc->loadXML(reader);
+        }
+        else
+        {
+            QDomDocument dom;
+            dom.setContent(xml);
+            m_doc->loadXML(dom.documentElement().firstChildElement("Engine"));
+        }
+    }
+
+    QCOMPARE(m_doc->functions().size(), 2000);
+    QCOMPARE(m_doc->fixtures().size(), 1);
+}
+
 void Doc_Test::save()
 {
     Scene* s = new Scene(m_doc);
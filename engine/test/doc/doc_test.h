@@ -54,6 +54,11 @@ private slots:
 
     void load();
     void loadWrongRoot();
+    void loadStream();
+    void loadStreamWrongRoot();
+    void loadStreamLarge();
+    void loadBenchmark_data();
+    void loadBenchmark();
     void save();
 
 private:
@@ -61,6 +66,7 @@ private:
     QDomElement createFixtureGroupNode(QDomDocument& doc, quint32 id);
     QDomElement createCollectionNode(QDomDocument& doc, quint32 id);
     QDomElement createBusNode(QDomDocument& doc, quint32 id, quint32 value);
+    QString createLargeEngineXML();
 
 private:
     Doc* m_doc;
@@ -0,0 +1,18 @@
+include(../../../variables.pri)
+include(../../../coverage.pri)
+TEMPLATE = app
+LANGUAGE = C++
+TARGET   = enginerunner_test
+
+QT      += testlib xml script network
+CONFIG  -= app_bundle
+
+DEPENDPATH   += ../../src
+INCLUDEPATH  += ../../../plugins/interfaces
+INCLUDEPATH  += ../../src
+INCLUDEPATH  += ../../headless
+QMAKE_LIBDIR += ../../src
+LIBS         += -lqlcplusengine
+
+SOURCES += enginerunner_test.cpp ../../headless/enginerunner.cpp
+HEADERS += enginerunner_test.h ../../headless/enginerunner.h
@@ -0,0 +1,157 @@
+/*
+  Q Light Controller Plus - Unit test
+  enginerunner_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#define private public
+#include "enginerunner_test.h"
+#include "enginerunner.h"
+#include "mastertimer.h"
+#include "scene.h"
+#include "doc.h"
+#undef private
+
+void EngineRunner_Test::init()
+{
+    /* A bare Doc, without plugins and with MasterTimer stopped, so that
+       started functions stay in the start queue */
+    m_runner = new EngineRunner(this);
+    m_runner->m_doc = new Doc(m_runner);
+}
+
+void EngineRunner_Test::cleanup()
+{
+    delete m_runner;
+    m_runner = NULL;
+}
+
+void EngineRunner_Test::empty()
+{
+    QCOMPARE(m_runner->executeCommand(""), QString());
+    QCOMPARE(m_runner->executeCommand("   "), QString());
+}
+
+void EngineRunner_Test::unknown()
+{
+    QCOMPARE(m_runner->executeCommand("foo 1"), QString("ERROR Unknown command: foo"));
+}
+
+void EngineRunner_Test::listEmpty()
+{
+    QString reply = m_runner->executeCommand("list");
+    QCOMPARE(reply, QString("OK 0"));
+    QVERIFY(reply.split("\n").contains(QString()) == false);
+}
+
+void EngineRunner_Test::list()
+{
+    Doc* doc = m_runner->doc();
+
+    Scene* s1 = new Scene(doc);
+    s1->setName("First");
+    QVERIFY(doc->addFunction(s1) == true);
+
+    Scene* s2 = new Scene(doc);
+    s2->setName("Second\nscene");
+    QVERIFY(doc->addFunction(s2) == true);
+
+    QStringList lines = m_runner->executeCommand(" LIST ").split("\n");
+    QCOMPARE(lines.size(), 3);
+    QCOMPARE(lines[0], QString("OK 2"));
+    QVERIFY(lines.contains(QString("%1 Scene stopped First").arg(s1->id())) == true);
+    QVERIFY(lines.contains(QString("%1 Scene stopped Second scene").arg(s2->id())) == true);
+}
+
+void EngineRunner_Test::syntax()
+{
+    QCOMPARE(m_runner->executeCommand("start"), QString("ERROR Syntax: start <id>"));
+    QCOMPARE(m_runner->executeCommand("stop 1 2"), QString("ERROR Syntax: stop <id>"));
+    QCOMPARE(m_runner->executeCommand("Status"), QString("ERROR Syntax: status <id>"));
+}
+
+void EngineRunner_Test::noSuchFunction()
+{
+    QCOMPARE(m_runner->executeCommand("start 42"), QString("ERROR No such function: 42"));
+    QCOMPARE(m_runner->executeCommand("status abc"), QString("ERROR No such function: abc"));
+    QCOMPARE(m_runner->executeCommand("stop -1"), QString("ERROR No such function: -1"));
+}
+
+void EngineRunner_Test::startStop()
+{
+    Doc* doc = m_runner->doc();
+    MasterTimer* timer = doc->masterTimer();
+
+    Scene* s1 = new Scene(doc);
+    QVERIFY(doc->addFunction(s1) == true);
+    QString id = QString::number(s1->id());
+
+    QCOMPARE(m_runner->executeCommand("status " + id), QString("stopped"));
+
+    QCOMPARE(m_runner->executeCommand("start " + id), QString("OK"));
+    QCOMPARE(timer->m_startQueue.size(), 1);
+    QVERIFY(timer->m_startQueue.first() == s1);
+
+    /* What MasterTimer would do on its next tick */
+    s1->preRun(timer);
+    QCOMPARE(m_runner->executeCommand("status " + id), QString("running"));
+
+    QCOMPARE(m_runner->executeCommand("stop " + id), QString("OK"));
+    QVERIFY(s1->stopped() == true);
+    QCOMPARE(m_runner->executeCommand("status " + id), QString("stopped"));
+
+    /* Stopping a stopped function is not an error */
+    QCOMPARE(m_runner->executeCommand("stop " + id), QString("OK"));
+
+    timer->m_startQueue.clear();
+}
+
+void EngineRunner_Test::stopAll()
+{
+    QCOMPARE(m_runner->executeCommand("stopall"), QString("OK"));
+}
+
+void EngineRunner_Test::needsGuiApplication()
+{
+    QString path("enginerunner_test.qxw");
+    QString workspace("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                      "<Workspace><Engine>"
+                      "<Function ID=\"0\" Type=\"EFX\" Name=\"EFX\"><Algorithm>Circle</Algorithm></Function>"
+                      "<Function ID=\"1\" Type=\"RGBMatrix\" Name=\"Matrix\">"
+                      "<Algorithm Type=\"%1\"/>"
+                      "</Function>"
+                      "</Engine></Workspace>\n");
+
+    QStringList types;
+    types << "Script" << "Text" << "Image";
+    foreach (QString type, types)
+    {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate) == true);
+        file.write(workspace.arg(type).toUtf8());
+        file.close();
+
+        /* Only text and images need fonts and image plugins */
+        QCOMPARE(EngineRunner::needsGuiApplication(path), type != "Script");
+    }
+
+    QFile::remove(path);
+    QCOMPARE(EngineRunner::needsGuiApplication(path), false);
+}
+
+QTEST_APPLESS_MAIN(EngineRunner_Test)
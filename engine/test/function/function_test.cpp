@@ -714,8 +714,40 @@ void Function_Test::speedXML()
     QCOMPARE(stub.fadeInSpeed(), uint(500));
     QCOMPARE(stub.fadeOutSpeed(), uint(1000));
     QCOMPARE(stub.duration(), uint(1500));
+    QCOMPARE(stub.tempoType(), Function::Time);
 
     QVERIFY(stub.loadXMLSpeed(root) == false);
 }
 
+void Function_Test::tempoXML()
+{
+    Doc d(this);
+    Function_Stub stub(&d);
+    QCOMPARE(stub.tempoType(), Function::Time);
+    QCOMPARE(Function::tempoTypeToString(Function::Beats), QString("Beats"));
+    QCOMPARE(Function::stringToTempoType("Beats"), Function::Beats);
+    QCOMPARE(Function::stringToTempoType("Foo"), Function::Time);
+
+    /* Time is the default and is not saved */
+    QDomDocument doc;
+    QDomElement root = doc.createElement("Foo");
+    QVERIFY(stub.saveXMLSpeed(&doc, &root) == true);
+    QVERIFY(root.firstChild().toElement().hasAttribute("Tempo") == false);
+
+    stub.setTempoType(Function::Beats);
+    stub.setDuration(2000);
+    root = doc.createElement("Foo");
+    QVERIFY(stub.saveXMLSpeed(&doc, &root) == true);
+    QCOMPARE(root.firstChild().toElement().attribute("Tempo"), QString("Beats"));
+
+    Function_Stub stub2(&d);
+    QVERIFY(stub2.loadXMLSpeed(root.firstChild().toElement()) == true);
+    QCOMPARE(stub2.tempoType(), Function::Beats);
+    QCOMPARE(stub2.duration(), uint(2000));
+
+    Function_Stub stub3(&d);
+    QVERIFY(stub3.copyFrom(&stub2) == true);
+    QCOMPARE(stub3.tempoType(), Function::Beats);
+}
+
 QTEST_APPLESS_MAIN(Function_Test)
@@ -57,6 +57,7 @@ private slots:
     void runOrderXML();
     void directionXML();
     void speedXML();
+    void tempoXML();
 };
 
 #endif
@@ -0,0 +1,216 @@
+/*
+  Q Light Controller Plus - Unit test
+  ltcdecoder_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+#include <QVector>
+
+#include "ltcdecoder_test.h"
+#include "ltcdecoder.h"
+
+#define SAMPLE_RATE 44100
+#define BUFFER_SIZE 512
+
+/** Biphase mark encoder of LTC frames, writing on the first of $channels channels */
+class LTCEncoder
+{
+public:
+    LTCEncoder(int channels, qreal fps)
+        : m_channels(channels)
+        , m_bitLength(SAMPLE_RATE / (LTC_FRAME_BITS * fps))
+        , m_position(0)
+        , m_level(12000)
+    {
+    }
+
+    /** Append the frame hh:mm:ss:ff */
+    void frame(int hh, int mm, int ss, int ff, bool drop = false)
+    {
+        quint64 low = 0;
+
+        low |= quint64(ff % 10) | quint64(ff / 10) << 8;
+        low |= quint64(drop ? 1 : 0) << 10;
+        low |= quint64(ss % 10) << 16 | quint64(ss / 10) << 24;
+        low |= quint64(mm % 10) << 32 | quint64(mm / 10) << 40;
+        low |= quint64(hh % 10) << 48 | quint64(hh / 10) << 56;
+
+        for (int i = 0; i < LTC_FRAME_BITS; i++)
+        {
+            bool bit = (i < 64) ? ((low >> i) & 0x01) : ((LTC_SYNC_WORD >> (i - 64)) & 0x01);
+
+            // Polarity changes at every bit boundary, and mid-bit for ones
+            m_level = -m_level;
+            fill(m_position + m_bitLength / 2);
+            if (bit == true)
+                m_level = -m_level;
+            m_position += m_bitLength;
+            fill(m_position);
+        }
+    }
+
+    /** Append the first half bit of the next frame, whose first edge ends the last bit */
+    void finish()
+    {
+        m_level = -m_level;
+        m_position += m_bitLength / 2;
+        fill(m_position);
+    }
+
+    /** Append $count silent samples */
+    void silence(int count)
+    {
+        m_level = 0;
+        m_position += count;
+        fill(m_position);
+    }
+
+    qreal bitLength() const { return m_bitLength; }
+
+    QVector <qint16> signal;
+
+private:
+    void fill(qreal until)
+    {
+        while (signal.size() / m_channels < until)
+            for (int c = 0; c < m_channels; c++)
+                signal.append(c == 0 ? m_level : 0);
+    }
+
+private:
+    int m_channels;
+    qreal m_bitLength;
+    qreal m_position;
+    qint16 m_level;
+};
+
+/** Feed $signal to $decoder in buffers and count the decoded frames */
+static int decodeSignal(LTCDecoder& decoder, const QVector <qint16>& signal, int channels)
+{
+    int count = 0;
+    int samples = signal.size() / channels;
+    for (int i = 0; i < samples; i += BUFFER_SIZE)
+    {
+        int length = qMin(BUFFER_SIZE, samples - i);
+        if (decoder.decode(signal.constData() + i * channels, length, channels) == true)
+            count++;
+    }
+
+    return count;
+}
+
+void LTCDecoder_Test::initial()
+{
+    LTCDecoder decoder;
+    QCOMPARE(decoder.sampleRate(), uint(44100));
+    QCOMPARE(decoder.fps(), 25);
+
+    decoder.setSampleRate(48000);
+    QCOMPARE(decoder.sampleRate(), uint(48000));
+    decoder.setSampleRate(0);
+    QCOMPARE(decoder.sampleRate(), uint(48000));
+}
+
+void LTCDecoder_Test::decode_data()
+{
+    QTest::addColumn<qreal>("fps");
+    QTest::addColumn<int>("expectedFps");
+
+    QTest::newRow("24fps") << qreal(24) << 24;
+    QTest::newRow("25fps") << qreal(25) << 25;
+    QTest::newRow("29.97fps") << qreal(29.97) << 30;
+    QTest::newRow("30fps") << qreal(30) << 30;
+}
+
+void LTCDecoder_Test::decode()
+{
+    QFETCH(qreal, fps);
+    QFETCH(int, expectedFps);
+
+    LTCDecoder decoder;
+    decoder.setSampleRate(SAMPLE_RATE);
+
+    LTCEncoder encoder(1, fps);
+    for (int f = 0; f < 2 * expectedFps; f++)
+        encoder.frame(10, 59, 58 + f / expectedFps, f % expectedFps);
+    encoder.finish();
+
+    /* The first frame is needed to synchronize */
+    int count = decodeSignal(decoder, encoder.signal, 1);
+    QVERIFY(count >= 2 * expectedFps - 2);
+
+    QCOMPARE(decoder.fps(), expectedFps);
+    QCOMPARE(decoder.hours(), 10);
+    QCOMPARE(decoder.minutes(), 59);
+    QCOMPARE(decoder.seconds(), 59);
+    QCOMPARE(decoder.frames(), expectedFps - 1);
+    QVERIFY(decoder.dropFrame() == false);
+
+    /* The last frame ended half a bit before the end of the signal */
+    QVERIFY(decoder.samplesSinceFrame() <= encoder.bitLength());
+    QCOMPARE(decoder.msecs(), quint32((10 * 3600 + 60 * 60) * 1000));
+}
+
+void LTCDecoder_Test::dropFrame()
+{
+    LTCDecoder decoder;
+    decoder.setSampleRate(SAMPLE_RATE);
+
+    LTCEncoder encoder(1, 29.97);
+    for (int f = 2; f < 10; f++)
+        encoder.frame(0, 1, 0, f, true);
+    encoder.finish();
+
+    QVERIFY(decodeSignal(decoder, encoder.signal, 1) > 0);
+    QVERIFY(decoder.dropFrame() == true);
+    QCOMPARE(decoder.fps(), 30);
+    QCOMPARE(decoder.frames(), 9);
+}
+
+void LTCDecoder_Test::stereo()
+{
+    LTCDecoder decoder;
+    decoder.setSampleRate(SAMPLE_RATE);
+
+    LTCEncoder encoder(2, 25);
+    for (int f = 0; f < 10; f++)
+        encoder.frame(1, 0, 0, f);
+    encoder.finish();
+
+    /* Some silence after the last frame */
+    encoder.silence(100);
+
+    QVERIFY(decodeSignal(decoder, encoder.signal, 2) > 0);
+    QCOMPARE(decoder.frames(), 9);
+    QCOMPARE(decoder.msecs(), quint32(3600000 + 400));
+    QVERIFY(decoder.samplesSinceFrame() >= 100);
+}
+
+void LTCDecoder_Test::silence()
+{
+    LTCDecoder decoder;
+    decoder.setSampleRate(SAMPLE_RATE);
+
+    /* Silence and low level noise */
+    QVector <qint16> signal(SAMPLE_RATE);
+    for (int i = 0; i < signal.size(); i++)
+        signal[i] = ((i * 7919) % 401) - 200;
+
+    QCOMPARE(decodeSignal(decoder, signal, 1), 0);
+}
+
+QTEST_APPLESS_MAIN(LTCDecoder_Test)
@@ -24,7 +24,16 @@
 #include "dmxsource_stub.h"
 #include "function_stub.h"
 #include "mastertimer.h"
+#include "collection.h"
+#include "chaserstep.h"
+#include "chaser.h"
+#include "qlcfixturedefcache.h"
+#include "qlcfixturedef.h"
+#include "fixture.h"
+#include "scene.h"
 #include "qlcchannel.h"
+#include "universewritebuffer.h"
+#include "tickprofiler.h"
 #include "universe.h"
 #include "qlcfile.h"
 #include "doc.h"
@@ -268,6 +277,336 @@ void MasterTimer_Test::runMultipleFunctions()
     QVERIFY(mt->runningFunctions() == 0);
 }
 
+void MasterTimer_Test::nestedStartSameTick()
+{
+    MasterTimer* mt = m_doc->masterTimer();
+
+    Fixture* fxi = new Fixture(m_doc);
+    fxi->setChannels(4);
+    fxi->setAddress(0);
+    m_doc->addFixture(fxi);
+
+    Scene* s = new Scene(m_doc);
+    s->setValue(fxi->id(), 0, 200);
+    s->setValue(fxi->id(), 3, 100);
+    m_doc->addFunction(s);
+
+    /* Three levels of collections: c1 -> c2 -> c3 -> scene */
+    Collection* c3 = new Collection(m_doc);
+    m_doc->addFunction(c3);
+    QVERIFY(c3->addFunction(s->id()) == true);
+
+    Collection* c2 = new Collection(m_doc);
+    m_doc->addFunction(c2);
+    QVERIFY(c2->addFunction(c3->id()) == true);
+
+    Collection* c1 = new Collection(m_doc);
+    m_doc->addFunction(c1);
+    QVERIFY(c1->addFunction(c2->id()) == true);
+
+    /* GO: everything must be written on the very first tick */
+    c1->start(mt);
+    mt->timerTick();
+
+    QCOMPARE(mt->runningFunctions(), 4);
+    QVERIFY(c1->stopped() == false);
+    QVERIFY(c2->stopped() == false);
+    QVERIFY(c3->stopped() == false);
+    QVERIFY(s->stopped() == false);
+    QCOMPARE(mt->m_startQueue.size(), 0);
+
+    QList<Universe*> ua = m_doc->inputOutputMap()->claimUniverses();
+    QCOMPARE(uchar(ua[0]->preGMValues()[0]), uchar(200));
+    QCOMPARE(uchar(ua[0]->preGMValues()[3]), uchar(100));
+    m_doc->inputOutputMap()->releaseUniverses(false);
+
+    c1->stop();
+    mt->timerTick();
+    mt->timerTick();
+    mt->timerTick();
+    QCOMPARE(mt->runningFunctions(), 0);
+}
+
+void MasterTimer_Test::writeBuffer()
+{
+    QList<Universe*> ua = m_doc->inputOutputMap()->claimUniverses();
+    ua[0]->reset();
+
+    UniverseWriteBuffer buffer;
+    QVERIFY(UniverseWriteBuffer::current() == NULL);
+
+    /* Not captured until capturing is enabled */
+    UniverseWriteBuffer::setCurrent(&buffer);
+    QVERIFY(UniverseWriteBuffer::current() == NULL);
+
+    UniverseWriteBuffer::setCaptureEnabled(true);
+    QVERIFY(UniverseWriteBuffer::current() == &buffer);
+    ua[0]->write(0, 10, true);
+    ua[0]->write(0, 20, true);
+    ua[0]->writeRelative(1, 130);
+    QCOMPARE(buffer.size(), 3);
+    QCOMPARE(uchar(ua[0]->preGMValues()[0]), uchar(0));
+    QCOMPARE(uchar(ua[0]->postGMValues()->at(1)), uchar(0));
+
+    UniverseWriteBuffer::setCurrent(NULL);
+    QVERIFY(UniverseWriteBuffer::current() == NULL);
+
+    /* Writes are applied in the order they were made: the last LTP wins */
+    buffer.apply();
+    UniverseWriteBuffer::setCaptureEnabled(false);
+    QCOMPARE(uchar(ua[0]->preGMValues()[0]), uchar(20));
+    QCOMPARE(uchar(ua[0]->postGMValues()->at(1)), uchar(3));
+
+    buffer.clear();
+    QCOMPARE(buffer.size(), 0);
+
+    ua[0]->zeroRelativeValues();
+    ua[0]->reset();
+    m_doc->inputOutputMap()->releaseUniverses(false);
+}
+
+void MasterTimer_Test::parallelExecution()
+{
+    MasterTimer* mt = m_doc->masterTimer();
+    QVERIFY(mt->parallelExecution() == false);
+
+    Fixture* fxi = new Fixture(m_doc);
+    fxi->setChannels(8);
+    fxi->setAddress(0);
+    m_doc->addFixture(fxi);
+
+    /* Overlapping scenes, all fading in */
+    QList <Scene*> scenes;
+    for (int i = 0; i < 6; i++)
+    {
+        Scene* s = new Scene(m_doc);
+        s->setFadeInSpeed(1000);
+        for (quint32 ch = 0; ch < 8; ch++)
+            s->setValue(fxi->id(), ch, uchar((ch * 31 + i * 47) % 256));
+        m_doc->addFunction(s);
+        scenes << s;
+    }
+
+    QList <QByteArray> serial;
+    QList <QByteArray> parallel;
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        mt->setParallelExecution(pass == 1);
+
+        foreach (Scene* s, scenes)
+            s->start(mt);
+
+        for (int tick = 0; tick < 10; tick++)
+        {
+            mt->timerTick();
+
+            QList<Universe*> ua = m_doc->inputOutputMap()->claimUniverses();
+            if (pass == 0)
+                serial << ua[0]->preGMValues().left(8);
+            else
+                parallel << ua[0]->preGMValues().left(8);
+            m_doc->inputOutputMap()->releaseUniverses(false);
+        }
+
+        QCOMPARE(mt->runningFunctions(), scenes.size());
+        if (pass == 1)
+        {
+            /* All scenes have been written by the thread pool */
+            foreach (Scene* s, scenes)
+                QVERIFY(mt->m_parallelFunctions.contains(s) == true);
+        }
+
+        foreach (Scene* s, scenes)
+            s->stop();
+        mt->timerTick();
+        QCOMPARE(mt->runningFunctions(), 0);
+
+        /* Wait for the fade out of the HTP channels */
+        for (int tick = 0; tick < 100; tick++)
+            mt->timerTick();
+    }
+
+    QCOMPARE(parallel, serial);
+    mt->setParallelExecution(false);
+}
+
+Fixture* MasterTimer_Test::addScanner()
+{
+    QLCFixtureDef* def = m_doc->fixtureDefCache()->fixtureDef("Futurelight", "DJScan250");
+    Q_ASSERT(def != NULL);
+
+    Fixture* fxi = new Fixture(m_doc);
+    fxi->setFixtureDefinition(def, def->mode("Mode 1"));
+    fxi->setAddress(0);
+    m_doc->addFixture(fxi);
+
+    return fxi;
+}
+
+QList <QByteArray> MasterTimer_Test::runTicks(const QList <Function*>& functions, bool parallel,
+                                              int ticks, int* parallelTicks)
+{
+    MasterTimer* mt = m_doc->masterTimer();
+    QList <QByteArray> values;
+
+    mt->setParallelExecution(parallel);
+    *parallelTicks = 0;
+
+    foreach (Function* function, functions)
+        function->start(mt);
+
+    for (int tick = 0; tick < ticks; tick++)
+    {
+        mt->timerTick();
+
+        if (mt->m_parallelFunctions.count(NULL) < mt->m_parallelFunctions.size())
+            (*parallelTicks)++;
+
+        QList<Universe*> ua = m_doc->inputOutputMap()->claimUniverses();
+        values << ua[0]->preGMValues().left(16);
+        m_doc->inputOutputMap()->releaseUniverses(false);
+    }
+
+    foreach (Function* function, functions)
+        function->stop();
+    for (int tick = 0; tick < 10 && mt->runningFunctions() > 0; tick++)
+        mt->timerTick();
+
+    /* Start the next run from scratch, LTP channels included */
+    mt->fader()->removeAll();
+    QList<Universe*> ua = m_doc->inputOutputMap()->claimUniverses();
+    ua[0]->reset();
+    m_doc->inputOutputMap()->releaseUniverses(false);
+
+    mt->setParallelExecution(false);
+
+    return values;
+}
+
+void MasterTimer_Test::parallelExecutionLTP()
+{
+    Fixture* fxi = addScanner();
+
+    /* Find a LTP channel */
+    int ltp = -1;
+    for (quint32 ch = 0; ch < fxi->channels() && ltp < 0; ch++)
+    {
+        if (fxi->channel(ch)->group() != QLCChannel::Intensity)
+            ltp = int(ch);
+    }
+    QVERIFY(ltp >= 0);
+
+    /* Overlapping scenes on the same LTP channels: the last one wins */
+    QList <Function*> scenes;
+    for (int i = 0; i < 4; i++)
+    {
+        Scene* s = new Scene(m_doc);
+        s->setFadeInSpeed(200);
+        for (quint32 ch = 0; ch < fxi->channels(); ch++)
+            s->setValue(fxi->id(), ch, uchar((ch * 29 + i * 61) % 256));
+        m_doc->addFunction(s);
+        scenes << s;
+    }
+
+    int parallelTicks = 0;
+    QList <QByteArray> serial = runTicks(scenes, false, 20, &parallelTicks);
+    QCOMPARE(parallelTicks, 0);
+    QList <QByteArray> parallel = runTicks(scenes, true, 20, &parallelTicks);
+    QVERIFY(parallelTicks > 0);
+
+    QCOMPARE(parallel, serial);
+
+    Scene* last = qobject_cast<Scene*> (scenes.last());
+    QCOMPARE(uchar(parallel.last().at(ltp)), last->value(fxi->id(), ltp));
+}
+
+void MasterTimer_Test::parallelExecutionChaser()
+{
+    Fixture* fxi = addScanner();
+
+    QList <Function*> functions;
+
+    /* Two background scenes, written in parallel with the chaser steps */
+    for (int i = 0; i < 2; i++)
+    {
+        Scene* s = new Scene(m_doc);
+        for (quint32 ch = 0; ch < fxi->channels(); ch++)
+            s->setValue(fxi->id(), ch, uchar(50 + i * 20 + ch));
+        m_doc->addFunction(s);
+        functions << s;
+    }
+
+    Chaser* chaser = new Chaser(m_doc);
+    chaser->setFadeInMode(Chaser::Common);
+    chaser->setFadeInSpeed(MasterTimer::tick() * 3);
+    chaser->setDurationMode(Chaser::Common);
+    chaser->setDuration(MasterTimer::tick() * 5);
+    for (int i = 0; i < 3; i++)
+    {
+        Scene* s = new Scene(m_doc);
+        for (quint32 ch = 0; ch < fxi->channels(); ch++)
+            s->setValue(fxi->id(), ch, uchar((ch * 37 + i * 83) % 256));
+        m_doc->addFunction(s);
+        chaser->addStep(ChaserStep(s->id()));
+    }
+    m_doc->addFunction(chaser);
+    functions << chaser;
+
+    /* The chaser stops a step while it's running on the thread pool: the
+       step must be post-run on the same tick as in serial execution */
+    int parallelTicks = 0;
+    QList <QByteArray> serial = runTicks(functions, false, 40, &parallelTicks);
+    QList <QByteArray> parallel = runTicks(functions, true, 40, &parallelTicks);
+    QVERIFY(parallelTicks > 0);
+
+    QCOMPARE(parallel, serial);
+}
+
+void MasterTimer_Test::profiler()
+{
+    MasterTimer* mt = m_doc->masterTimer();
+    TickProfiler* prof = mt->profiler();
+    QVERIFY(prof != NULL);
+    QVERIFY(prof->isEnabled() == false);
+
+    Fixture* fxi = new Fixture(m_doc);
+    fxi->setChannels(2);
+    fxi->setAddress(0);
+    m_doc->addFixture(fxi);
+
+    Scene* s = new Scene(m_doc);
+    s->setValue(fxi->id(), 0, 100);
+    m_doc->addFunction(s);
+    s->start(mt);
+
+    /* Nothing is collected while disabled */
+    mt->timerTick();
+    QCOMPARE(prof->statistics().size(), int(TickProfiler::StageCount));
+    QCOMPARE(prof->statistics().at(TickProfiler::TickStage).samples, 0);
+
+    prof->setEnabled(true);
+    mt->timerTick();
+    mt->timerTick();
+    mt->timerTick();
+
+    QList <TickProfiler::Statistics> stats = prof->statistics();
+    for (int i = 0; i < TickProfiler::StageCount; i++)
+        QCOMPARE(stats[i].samples, 3);
+
+    QCOMPARE(stats.size(), int(TickProfiler::StageCount) + 1);
+    QCOMPARE(stats.last().type, TickProfiler::FunctionItem);
+    QCOMPARE(stats.last().id, s->id());
+    QCOMPARE(stats.last().samples, 3);
+
+    prof->setEnabled(false);
+    prof->reset();
+
+    s->stop();
+    mt->timerTick();
+    QCOMPARE(mt->runningFunctions(), 0);
+}
+
 void MasterTimer_Test::stopAllFunctions()
 {
     MasterTimer* mt = m_doc->masterTimer();
@@ -20,8 +20,12 @@
 #ifndef MASTERTIMER_TEST_H
 #define MASTERTIMER_TEST_H
 
+#include <QByteArray>
 #include <QObject>
+#include <QList>
 
+class Function;
+class Fixture;
 class Doc;
 class MasterTimer_Test : public QObject
 {
@@ -40,10 +44,29 @@ private slots:
     void interval();
     void functionInitiatedStop();
     void runMultipleFunctions();
+    void nestedStartSameTick();
+    void writeBuffer();
+    void parallelExecution();
+    void parallelExecutionLTP();
+    void parallelExecutionChaser();
+    void profiler();
     void stopAllFunctions();
     void stop();
     void restart();
 
+private:
+    /**
+     * Start $functions and run $ticks timer ticks, serially or in parallel,
+     * returning the first universe's values after each tick. Then stop the
+     * functions and reset the universe. $parallelTicks is set to the number
+     * of ticks on which some functions were written in parallel.
+     */
+    QList <QByteArray> runTicks(const QList <Function*>& functions, bool parallel,
+                                int ticks, int* parallelTicks);
+
+    /** Add a Futurelight DJScan250 at address 0 */
+    Fixture* addScanner();
+
 private:
     Doc* m_doc;
 };
@@ -17,6 +17,7 @@
   limitations under the License.
 */
 
+#include <QXmlStreamReader>
 #include <QtTest>
 #include <QtXml>
 
@@ -60,6 +61,45 @@ void QLCFile_Test::readXML()
     QCOMPARE(doc.firstChild().firstChild().toElement().tagName(), QString("Creator"));
 }
 
+void QLCFile_Test::readXMLElement()
+{
+    QXmlStreamReader reader(QString(
+        "<Workspace>\n"
+        "  <Engine Attr=\"1\">\n"
+        "    <Name>  </Name>\n"
+        "    <Text>Foo &amp; bar</Text>\n"
+        "    <Data><![CDATA[<raw>]]></Data>\n"
+        "    <Empty/>\n"
+        "  </Engine>\n"
+        "  <Next/>\n"
+        "</Workspace>\n"));
+
+    /* Not on a start element */
+    QVERIFY(QLCFile::readXMLElement(reader).isNull() == true);
+
+    QVERIFY(reader.readNextStartElement() == true);
+    QVERIFY(reader.readNextStartElement() == true);
+    QDomDocument doc = QLCFile::readXMLElement(reader);
+
+    /* The reader stops on the element's end tag */
+    QVERIFY(reader.isEndElement() == true);
+    QCOMPARE(reader.name().toString(), QString("Engine"));
+    QVERIFY(reader.readNextStartElement() == true);
+    QCOMPARE(reader.name().toString(), QString("Next"));
+
+    QDomElement root = doc.documentElement();
+    QCOMPARE(root.tagName(), QString("Engine"));
+    QCOMPARE(root.attribute("Attr"), QString("1"));
+
+    /* Indentation is dropped, whitespace-only content is kept */
+    QCOMPARE(root.childNodes().count(), 4);
+    QCOMPARE(root.firstChildElement("Name").text(), QString("  "));
+    QCOMPARE(root.firstChildElement("Text").text(), QString("Foo & bar"));
+    QVERIFY(root.firstChildElement("Data").firstChild().isCDATASection() == true);
+    QCOMPARE(root.firstChildElement("Data").text(), QString("<raw>"));
+    QVERIFY(root.firstChildElement("Empty").hasChildNodes() == false);
+}
+
 void QLCFile_Test::getXMLHeader()
 {
     bool insideCreatorTag = false, author = false, appname = false,
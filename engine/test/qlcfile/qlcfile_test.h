@@ -28,6 +28,7 @@ class QLCFile_Test : public QObject
 
 private slots:
     void readXML();
+    void readXMLElement();
     void getXMLHeader();
     void errorString();
 };
@@ -17,6 +17,7 @@
   limitations under the License.
 */
 
+#include <QTemporaryDir>
 #include <QtTest>
 #include <QtXml>
 
@@ -30,6 +31,7 @@
 #include "qlcfile.h"
 
 #define INTERNAL_FIXTUREDIR "../../../fixtures/"
+#define INDEX_TESTDIR "indextest"
 
 void QLCFixtureDefCache_Test::init()
 {
@@ -179,6 +181,129 @@ void QLCFixtureDefCache_Test::load()
     QVERIFY(cache.manufacturers().contains("SGM") == true);
 }
 
+void QLCFixtureDefCache_Test::loadIndex()
+{
+    QDir src(INTERNAL_FIXTUREDIR);
+    QVERIFY(QDir().mkpath(INDEX_TESTDIR) == true);
+    QDir dir(INDEX_TESTDIR);
+    dir.setFilter(QDir::Files);
+    dir.setNameFilters(QStringList() << QString("*%1").arg(KExtFixture));
+
+    QStringList files;
+    files << "Futurelight-DJScan250.qxf" << "Martin-MAC250plus.qxf";
+    foreach (QString file, files)
+        QVERIFY(QFile::copy(src.absoluteFilePath(file), dir.absoluteFilePath(file)) == true);
+    QFile::remove(QLCFixtureDefCache::indexPath(dir));
+
+    /* Cold load: every definition is parsed and the index is written */
+    QLCFixtureDefCache cold;
+    QVERIFY(cold.load(dir, true) == true);
+    QVERIFY(QFile::exists(QLCFixtureDefCache::indexPath(dir)) == true);
+    QLCFixtureDef* coldDef = cold.fixtureDef("Futurelight", "DJScan250");
+    QVERIFY(coldDef != NULL);
+    QVERIFY(coldDef->isLoaded() == true);
+    QVERIFY(cold.fixtureDef("Martin", "MAC250+") != NULL);
+
+    /* Warm load: definitions come from the index and are parsed when used */
+    QLCFixtureDefCache warm;
+    QVERIFY(warm.load(dir, true) == true);
+    QCOMPARE(warm.manufacturers().size(), 2);
+    QLCFixtureDef* warmDef = warm.fixtureDef("Futurelight", "DJScan250");
+    QVERIFY(warmDef != NULL);
+    QVERIFY(warmDef->isLoaded() == false);
+    QCOMPARE(warmDef->modes().size(), coldDef->modes().size());
+    QVERIFY(warmDef->isLoaded() == true);
+    QCOMPARE(warmDef->channels().size(), coldDef->channels().size());
+
+    /* A changed file is parsed again */
+    QFile file(dir.absoluteFilePath(files.first()));
+    QVERIFY(file.open(QIODevice::Append) == true);
+    file.write("\n");
+    file.close();
+
+    QLCFixtureDefCache changed;
+    QVERIFY(changed.load(dir, true) == true);
+    QVERIFY(changed.fixtureDef("Futurelight", "DJScan250")->isLoaded() == true);
+    QVERIFY(changed.fixtureDef("Martin", "MAC250+")->isLoaded() == false);
+
+    /* Without index, everything is parsed */
+    QLCFixtureDefCache noIndex;
+    QVERIFY(noIndex.load(dir) == true);
+    QVERIFY(noIndex.fixtureDef("Martin", "MAC250+")->isLoaded() == true);
+
+    foreach (QString file, files)
+        QFile::remove(dir.absoluteFilePath(file));
+    QFile::remove(QLCFixtureDefCache::indexPath(dir));
+    QVERIFY(QDir().rmdir(INDEX_TESTDIR) == true);
+}
+
+void QLCFixtureDefCache_Test::loadBenchmark()
+{
+    /* Work on a copy of the definitions, so that the index is not
+       written into the source tree */
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid() == true);
+
+    QDir src(INTERNAL_FIXTUREDIR);
+    src.setFilter(QDir::Files);
+    src.setNameFilters(QStringList() << QString("*%1").arg(KExtFixture));
+    QDir dir(tempDir.path());
+    dir.setFilter(QDir::Files);
+    dir.setNameFilters(QStringList() << QString("*%1").arg(KExtFixture));
+    foreach (QString file, src.entryList())
+        QVERIFY(QFile::copy(src.absoluteFilePath(file), dir.absoluteFilePath(file)) == true);
+
+    QElapsedTimer timer;
+
+    timer.start();
+    QLCFixtureDefCache cold;
+    QVERIFY(cold.load(dir, true) == true);
+    qint64 coldTime = timer.elapsed();
+
+    QFileInfo index(QLCFixtureDefCache::indexPath(dir));
+    QVERIFY(index.exists() == true);
+    QDateTime indexModified = index.lastModified();
+
+    timer.restart();
+    QLCFixtureDefCache warm;
+    QVERIFY(warm.load(dir, true) == true);
+    qint64 warmTime = timer.elapsed();
+
+    /* Unchanged definitions don't rewrite the index */
+    index.refresh();
+    QCOMPARE(index.lastModified(), indexModified);
+
+    /* Every definition comes back from the index, unparsed, and parses
+       to the same contents when used */
+    QCOMPARE(warm.m_defs.size(), cold.m_defs.size());
+    QCOMPARE(warm.manufacturers().size(), cold.manufacturers().size());
+    foreach (QLCFixtureDef* coldDef, cold.m_defs)
+    {
+        QLCFixtureDef* warmDef = warm.fixtureDef(coldDef->manufacturer(), coldDef->model());
+        QVERIFY(warmDef != NULL);
+        QVERIFY(warmDef->isLoaded() == false);
+        QCOMPARE(warmDef->definitionSourceFile(), coldDef->definitionSourceFile());
+        QCOMPARE(warmDef->channels().size(), coldDef->channels().size());
+        QCOMPARE(warmDef->modes().size(), coldDef->modes().size());
+    }
+
+    timer.restart();
+    int found = 0;
+    for (int i = 0; i < 100; i++)
+    {
+        foreach (QLCFixtureDef* def, cold.m_defs)
+        {
+            if (cold.fixtureDef(def->manufacturer(), def->model()) == def)
+                found++;
+        }
+    }
+    qint64 lookupTime = timer.elapsed();
+    QCOMPARE(found, cold.m_defs.size() * 100);
+
+    qDebug() << cold.m_defs.size() << "definitions, cold load:" << coldTime
+             << "ms, warm load:" << warmTime << "ms, lookups:" << lookupTime << "ms";
+}
+
 void QLCFixtureDefCache_Test::defDirectories()
 {
     QDir dir = QLCFixtureDefCache::systemDefinitionDirectory();
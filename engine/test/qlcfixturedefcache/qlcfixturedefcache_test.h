@@ -35,6 +35,8 @@ private slots:
     void add();
     void fixtureDef();
 	void load();
+    void loadIndex();
+    void loadBenchmark();
     void defDirectories();
 
 private:
@@ -0,0 +1,167 @@
+/*
+  Q Light Controller Plus - Unit test
+  rgbimage_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QThread>
+#include <QtTest>
+
+#define private public
+#include "rgbimage_test.h"
+#include "rgbimage.h"
+#undef private
+
+#include "doc.h"
+
+/* 8x4 GIF with 4 frames. The pixel at (x, y) of frame k takes the
+   palette entry (x + y + k) % 4 */
+#define TEST_IMAGE "animated.gif"
+#define FRAME_COUNT 4
+
+static const uint palette[] = { 0xFF0000, 0x00FF00, 0x0000FF, 0xFFFFFF };
+
+/** Renders all the frames like a running matrix does on the MasterTimer
+    thread, comparing them with the maps rendered beforehand */
+class RenderThread : public QThread
+{
+public:
+    RenderThread(RGBImage* image, const QList <QSize>& sizes,
+                 const QList <RGBMap>& expected)
+        : m_image(image)
+        , m_sizes(sizes)
+        , m_expected(expected)
+        , m_ok(true)
+    {
+    }
+
+    bool isOk() const { return m_ok; }
+
+protected:
+    void run()
+    {
+        RGBMap map;
+        for (int i = 0; i < 200 && m_ok == true; i++)
+        {
+            for (int s = 0; s < m_sizes.size(); s++)
+            {
+                for (int step = 0; step < FRAME_COUNT; step++)
+                {
+                    m_image->rgbMap(m_sizes.at(s), QRgb(0xFFFFFFFF), step, map);
+                    if (map != m_expected.at((s * FRAME_COUNT) + step))
+                        m_ok = false;
+                }
+            }
+        }
+    }
+
+private:
+    RGBImage* m_image;
+    QList <QSize> m_sizes;
+    QList <RGBMap> m_expected;
+    bool m_ok;
+};
+
+void RGBImage_Test::initTestCase()
+{
+    m_doc = new Doc(this);
+}
+
+void RGBImage_Test::cleanupTestCase()
+{
+    delete m_doc;
+}
+
+void RGBImage_Test::animatedFrames()
+{
+    RGBImage image(m_doc);
+    image.setAnimationStyle(RGBImage::Animation);
+    image.setFilename(TEST_IMAGE);
+
+    QCOMPARE(image.m_frameCount, FRAME_COUNT);
+    QCOMPARE(image.m_frameWidth, 8);
+    QCOMPARE(image.m_frameHeight, 4);
+    QCOMPARE(image.rgbMapStepCount(QSize(8, 4)), FRAME_COUNT);
+
+    RGBMap map;
+    for (int step = 0; step < FRAME_COUNT; step++)
+    {
+        image.rgbMap(QSize(8, 4), QRgb(0xFFFFFFFF), step, map);
+        QCOMPARE(map.size(), QSize(8, 4));
+        for (int y = 0; y < 4; y++)
+        {
+            for (int x = 0; x < 8; x++)
+                QCOMPARE(map[y][x] & 0x00FFFFFF, palette[(x + y + step) % 4]);
+        }
+    }
+
+    // Steps past the last frame stay on it
+    RGBMap last;
+    image.rgbMap(QSize(8, 4), QRgb(0xFFFFFFFF), FRAME_COUNT + 2, last);
+    QVERIFY(last == map);
+}
+
+void RGBImage_Test::concurrentRender()
+{
+    RGBImage image(m_doc);
+    image.setAnimationStyle(RGBImage::Animation);
+    image.setFilename(TEST_IMAGE);
+
+    // Serial reference, one map per size and frame
+    QList <QSize> sizes;
+    sizes << QSize(8, 4) << QSize(5, 3) << QSize(12, 6);
+    QList <RGBMap> expected;
+    foreach (QSize size, sizes)
+    {
+        for (int step = 0; step < FRAME_COUNT; step++)
+        {
+            RGBMap map;
+            image.rgbMap(size, QRgb(0xFFFFFFFF), step, map);
+            QCOMPARE(map.size(), size);
+            expected << map;
+        }
+    }
+
+    QList <RenderThread*> threads;
+    for (int i = 0; i < 4; i++)
+        threads << new RenderThread(&image, sizes, expected);
+    foreach (RenderThread* thread, threads)
+        thread->start();
+
+    // Reload the same file while the threads render: they must only ever
+    // see the complete old atlas or the complete new one
+    bool running = true;
+    for (int i = 0; i < 200 && running == true; i++)
+    {
+        image.setFilename(TEST_IMAGE);
+        running = false;
+        foreach (RenderThread* thread, threads)
+            running = running || thread->isRunning();
+    }
+
+    bool finished = true;
+    bool ok = true;
+    foreach (RenderThread* thread, threads)
+    {
+        finished = thread->wait(10000) && finished;
+        ok = thread->isOk() && ok;
+    }
+    QVERIFY(finished == true);
+    qDeleteAll(threads);
+    QVERIFY(ok == true);
+}
+
+QTEST_MAIN(RGBImage_Test)
@@ -0,0 +1,4 @@
+#!/bin/bash
+export LD_LIBRARY_PATH=$LD_LIBRARY_PATH:../../src
+export DYLD_FALLBACK_LIBRARY_PATH=../../src
+./rgbimage_test
@@ -136,28 +136,31 @@ void RGBMatrix_Test::copy()
     QCOMPARE(copyMtx->algorithm()->name(), QString("Full Columns"));
 }
 
-void RGBMatrix_Test::previewMaps()
+void RGBMatrix_Test::previewMap()
 {
     RGBMatrix mtx(m_doc);
     QVERIFY(mtx.algorithm() != NULL);
     QCOMPARE(mtx.algorithm()->name(), QString("Full Columns"));
 
-    QList <RGBMap> maps = mtx.previewMaps();
-    QCOMPARE(maps.size(), 0); // No fixture group
+    RGBMap map;
+    QCOMPARE(mtx.stepsCount(), 0); // No fixture group
+    mtx.previewMap(0, map);
+    QCOMPARE(map.width(), 0);
+    QCOMPARE(map.height(), 0);
 
     mtx.setFixtureGroup(0);
-    maps = mtx.previewMaps();
-    QCOMPARE(maps.size(), 5);
+    QCOMPARE(mtx.stepsCount(), 5);
     for (int z = 0; z < 5; z++)
     {
+        mtx.previewMap(z, map);
         for (int y = 0; y < 5; y++)
         {
             for (int x = 0; x < 5; x++)
             {
                 if (x == z)
-                    QCOMPARE(maps[z][y][x], QColor(Qt::black).rgb());
+                    QCOMPARE(map[y][x], QColor(Qt::black).rgb());
                 else
-                    QCOMPARE(maps[z][y][x], uint(0));
+                    QCOMPARE(map[y][x], uint(0));
             }
         }
     }
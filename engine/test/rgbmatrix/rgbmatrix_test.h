@@ -37,7 +37,7 @@ private slots:
     void group();
     void color();
     void copy();
-    void previewMaps();
+    void previewMap();
     void loadSave();
 
 private:
@@ -138,7 +138,9 @@ void RGBScript_Test::evaluateNoRgbMapFunction()
     RGBScript s(m_doc);
     s.m_contents = code;
     QCOMPARE(s.evaluate(), false);
-    QCOMPARE(s.rgbMap(QSize(5, 5), 1, 0), RGBMap());
+    RGBMap map(5, 5);
+    s.rgbMap(QSize(5, 5), 1, 0, map);
+    QVERIFY(map.isEmpty() == true);
 }
 
 void RGBScript_Test::evaluateNoRgbMapStepCountFunction()
@@ -169,11 +171,15 @@ void RGBScript_Test::rgbMapStepCount()
 void RGBScript_Test::rgbMap()
 {
     RGBScript s = RGBScript::script(m_doc, "Full Rows");
-    QVERIFY(s.rgbMap(QSize(3, 4), 0, 0).isEmpty() == false);
+    RGBMap map;
+    s.rgbMap(QSize(3, 4), 0, 0, map);
+    QVERIFY(map.isEmpty() == false);
+    QCOMPARE(map.width(), 3);
+    QCOMPARE(map.height(), 4);
 
     for (int z = 0; z < 5; z++)
     {
-        RGBMap map = s.rgbMap(QSize(5, 5), QColor(Qt::red).rgb(), z);
+        s.rgbMap(QSize(5, 5), QColor(Qt::red).rgb(), z, map);
         for (int y = 0; y < 5; y++)
         {
             for (int x = 0; x < 5; x++)
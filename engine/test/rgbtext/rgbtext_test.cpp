@@ -20,6 +20,7 @@
 #include <QDomDocument>
 #include <QFontMetrics>
 #include <QDomElement>
+#include <QThread>
 #include <QtTest>
 
 #define private public
@@ -29,6 +30,24 @@
 
 #include "doc.h"
 
+/** Renders maps like a running matrix does on the MasterTimer thread */
+class RenderThread : public QThread
+{
+public:
+    RenderThread(RGBText* text) : m_text(text) { }
+
+protected:
+    void run()
+    {
+        RGBMap map;
+        for (int i = 0; i < 500; i++)
+            m_text->rgbMap(QSize(10, 10), QRgb(0xFFFFFFFF), i % 10, map);
+    }
+
+private:
+    RGBText* m_text;
+};
+
 void RGBText_Test::initTestCase()
 {
     m_doc = new Doc(this);
@@ -276,27 +295,25 @@ void RGBText_Test::staticLetters()
     // these tests are here only to check that nothing crashes. The end result is
     // more or less OS, platform, HW and SW dependent and testing individual pixels
     // would thus be rather pointless.
-    RGBMap map = text.rgbMap(QSize(10, 10), color, 0);
-    QCOMPARE(map.size(), 10);
-    for (int i = 0; i < 10; i++)
-        QCOMPARE(map[i].size(), 10);
+    RGBMap map;
+    text.rgbMap(QSize(10, 10), color, 0, map);
+    QCOMPARE(map.height(), 10);
+    QCOMPARE(map.width(), 10);
 
-    map = text.rgbMap(QSize(10, 10), color, 1);
-    QCOMPARE(map.size(), 10);
-    for (int i = 0; i < 10; i++)
-        QCOMPARE(map[i].size(), 10);
+    text.rgbMap(QSize(10, 10), color, 1, map);
+    QCOMPARE(map.height(), 10);
+    QCOMPARE(map.width(), 10);
 
-    map = text.rgbMap(QSize(10, 10), color, 2);
-    QCOMPARE(map.size(), 10);
-    for (int i = 0; i < 10; i++)
-        QCOMPARE(map[i].size(), 10);
+    text.rgbMap(QSize(10, 10), color, 2, map);
+    QCOMPARE(map.height(), 10);
+    QCOMPARE(map.width(), 10);
 
     // Invalid step
-    map = text.rgbMap(QSize(10, 10), color, 3);
-    QCOMPARE(map.size(), 10);
+    text.rgbMap(QSize(10, 10), color, 3, map);
+    QCOMPARE(map.height(), 10);
+    QCOMPARE(map.width(), 10);
     for (int i = 0; i < 10; i++)
     {
-        QCOMPARE(map[i].size(), 10);
         for (int j = 0; j < 10; j++)
         {
             QCOMPARE(map[i][j], QColor(Qt::black).rgb());
@@ -319,18 +336,19 @@ void RGBText_Test::horizontalScroll()
     // would thus be rather pointless.
     for (int i = 0; i < fm.width("QLC"); i++)
     {
-        RGBMap map = text.rgbMap(QSize(10, 10), QRgb(0xFFFFFFFF), i);
-        QCOMPARE(map.size(), 10);
-        for (int y = 0; y < 10; y++)
-            QCOMPARE(map[y].size(), 10);
+        RGBMap map;
+        text.rgbMap(QSize(10, 10), QRgb(0xFFFFFFFF), i, map);
+        QCOMPARE(map.height(), 10);
+        QCOMPARE(map.width(), 10);
     }
 
     // Invalid step
-    RGBMap map = text.rgbMap(QSize(10, 10), QRgb(0xFFFFFFFF), fm.width("QLC"));
-    QCOMPARE(map.size(), 10);
+    RGBMap map;
+    text.rgbMap(QSize(10, 10), QRgb(0xFFFFFFFF), fm.width("QLC"), map);
+    QCOMPARE(map.height(), 10);
+    QCOMPARE(map.width(), 10);
     for (int i = 0; i < 10; i++)
     {
-        QCOMPARE(map[i].size(), 10);
         for (int j = 0; j < 10; j++)
         {
             QCOMPARE(map[i][j], QRgb(0));
@@ -353,18 +371,19 @@ void RGBText_Test::verticalScroll()
     // would thus be rather pointless.
     for (int i = 0; i < fm.ascent() * 3; i++)
     {
-        RGBMap map = text.rgbMap(QSize(10, 10), QRgb(0xFFFFFFFF), i);
-        QCOMPARE(map.size(), 10);
-        for (int y = 0; y < 10; y++)
-            QCOMPARE(map[y].size(), 10);
+        RGBMap map;
+        text.rgbMap(QSize(10, 10), QRgb(0xFFFFFFFF), i, map);
+        QCOMPARE(map.height(), 10);
+        QCOMPARE(map.width(), 10);
     }
 
     // Invalid step
-    RGBMap map = text.rgbMap(QSize(10, 10), QRgb(0xFFFFFFFF), fm.ascent() * 4);
-    QCOMPARE(map.size(), 10);
+    RGBMap map;
+    text.rgbMap(QSize(10, 10), QRgb(0xFFFFFFFF), fm.ascent() * 4, map);
+    QCOMPARE(map.height(), 10);
+    QCOMPARE(map.width(), 10);
     for (int i = 0; i < 10; i++)
     {
-        QCOMPARE(map[i].size(), 10);
         for (int j = 0; j < 10; j++)
         {
             QCOMPARE(map[i][j], QRgb(0));
@@ -372,4 +391,67 @@ void RGBText_Test::verticalScroll()
     }
 }
 
+void RGBText_Test::atlas()
+{
+    RGBText text(m_doc);
+    text.setText("QLC");
+    text.setAnimationStyle(RGBText::Horizontal);
+
+    // The steps are rendered once, without any color. Black text is black.
+    RGBMap map;
+    text.rgbMap(QSize(10, 10), QRgb(0xFFFFFFFF), 0, map);
+    text.rgbMap(QSize(10, 10), QColor(Qt::black).rgb(), 0, map);
+    QCOMPARE(map.height(), 10);
+    QCOMPARE(map.width(), 10);
+    for (int i = 0; i < 10; i++)
+    {
+        for (int j = 0; j < 10; j++)
+            QCOMPARE(map[i][j], QColor(Qt::black).rgb());
+    }
+
+    // A new size renders the steps again
+    text.rgbMap(QSize(5, 3), QRgb(0xFFFFFFFF), 0, map);
+    QCOMPARE(map.height(), 3);
+    QCOMPARE(map.width(), 5);
+
+    // So does a new text
+    text.setText(QString());
+    QCOMPARE(text.rgbMapStepCount(QSize()), 0);
+    text.rgbMap(QSize(5, 3), QRgb(0xFFFFFFFF), 0, map);
+    QCOMPARE(map.height(), 3);
+    QCOMPARE(map.width(), 5);
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 5; j++)
+            QCOMPARE(map[i][j], QRgb(0));
+    }
+}
+
+void RGBText_Test::concurrentRender()
+{
+    RGBText text(m_doc);
+    text.setAnimationStyle(RGBText::Horizontal);
+
+    // The atlas is rendered again while the other thread reads it
+    RenderThread thread(&text);
+    thread.start();
+    for (int i = 0; i < 500 && thread.isRunning() == true; i++)
+    {
+        text.setText(QString("QLC+ %1").arg(i));
+        RGBMap preview;
+        text.rgbMap(QSize(4, 4), QRgb(0xFFFFFFFF), 0, preview);
+    }
+    QVERIFY(thread.wait(10000) == true);
+
+    // The result is the same as a fresh render
+    RGBText fresh(m_doc);
+    fresh.setAnimationStyle(RGBText::Horizontal);
+    fresh.setText(text.text());
+
+    RGBMap map, freshMap;
+    text.rgbMap(QSize(10, 10), QRgb(0xFFFFFFFF), 3, map);
+    fresh.rgbMap(QSize(10, 10), QRgb(0xFFFFFFFF), 3, freshMap);
+    QVERIFY(map == freshMap);
+}
+
 QTEST_MAIN(RGBText_Test)
@@ -42,6 +42,8 @@ private slots:
     void staticLetters();
     void horizontalScroll();
     void verticalScroll();
+    void atlas();
+    void concurrentRender();
 
 private:
    Doc * m_doc;
@@ -0,0 +1,159 @@
+/*
+  Q Light Controller Plus - Unit test
+  scheduler_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QDateTime>
+#include <QtTest>
+
+#include "scheduler_test.h"
+#include "scheduler.h"
+
+#define NSECS_PER_MSEC Q_INT64_C(1000000)
+
+/* Monday, 1st of January 2024, local time */
+static qint64 wallTime(int day, int hh, int mm, int ss)
+{
+    return QDateTime(QDate(2024, 1, day), QTime(hh, mm, ss)).toMSecsSinceEpoch();
+}
+
+void Scheduler_Test::initial()
+{
+    Scheduler scheduler;
+    QCOMPARE(scheduler.entryCount(), 0);
+    QCOMPARE(scheduler.graceTime(), uint(SCHEDULER_DEFAULT_GRACE));
+    QVERIFY(scheduler.poll(0, wallTime(1, 10, 0, 0)).isEmpty() == true);
+
+    /* Entries without days or times are refused */
+    QCOMPARE(scheduler.addEntry(1, QTime(10, 0, 0), 0), Scheduler::invalidId());
+    QCOMPARE(scheduler.addEntry(1, QTime()), Scheduler::invalidId());
+    QCOMPARE(scheduler.entryCount(), 0);
+}
+
+void Scheduler_Test::nextOccurrence()
+{
+    QTime time(10, 0, 0);
+
+    QCOMPARE(Scheduler::nextOccurrence(time, Scheduler::EveryDay, wallTime(1, 9, 0, 0)),
+             wallTime(1, 10, 0, 0));
+    QCOMPARE(Scheduler::nextOccurrence(time, Scheduler::EveryDay, wallTime(1, 10, 0, 0)),
+             wallTime(1, 10, 0, 0));
+    QCOMPARE(Scheduler::nextOccurrence(time, Scheduler::EveryDay, wallTime(1, 10, 0, 1)),
+             wallTime(2, 10, 0, 0));
+
+    QCOMPARE(Scheduler::nextOccurrence(time, Scheduler::Friday, wallTime(1, 9, 0, 0)),
+             wallTime(5, 10, 0, 0));
+    QCOMPARE(Scheduler::nextOccurrence(time, Scheduler::Monday, wallTime(1, 11, 0, 0)),
+             wallTime(8, 10, 0, 0));
+    QCOMPARE(Scheduler::nextOccurrence(time, 0, wallTime(1, 9, 0, 0)), qint64(-1));
+}
+
+void Scheduler_Test::poll()
+{
+    Scheduler scheduler;
+    quint32 id = scheduler.addEntry(42, QTime(10, 0, 5));
+    QVERIFY(id != Scheduler::invalidId());
+    QCOMPARE(scheduler.entryCount(), 1);
+    QCOMPARE(scheduler.nextOccurrence(id), qint64(-1));
+
+    QVERIFY(scheduler.poll(0, wallTime(1, 10, 0, 0)).isEmpty() == true);
+    QCOMPARE(scheduler.nextOccurrence(id), wallTime(1, 10, 0, 5));
+
+    /* Ticks of 20ms: the function is due on the first tick at or after 5s */
+    QVERIFY(scheduler.poll(4980 * NSECS_PER_MSEC, wallTime(1, 10, 0, 4) + 980).isEmpty() == true);
+    QList<quint32> due = scheduler.poll(5000 * NSECS_PER_MSEC, wallTime(1, 10, 0, 5));
+    QCOMPARE(due.count(), 1);
+    QCOMPARE(due.first(), quint32(42));
+
+    /* Only once */
+    QVERIFY(scheduler.poll(5020 * NSECS_PER_MSEC, wallTime(1, 10, 0, 5)).isEmpty() == true);
+    QCOMPARE(scheduler.nextOccurrence(id), wallTime(2, 10, 0, 5));
+}
+
+void Scheduler_Test::days()
+{
+    Scheduler scheduler;
+    quint32 id = scheduler.addEntry(1, QTime(10, 0, 0),
+                                    Scheduler::Saturday | Scheduler::Sunday);
+
+    scheduler.poll(0, wallTime(1, 9, 0, 0));
+    QCOMPARE(scheduler.nextOccurrence(id), wallTime(6, 10, 0, 0));
+
+    /* An hour later, on Monday: nothing to do */
+    qint64 nsecs = 3600 * 1000 * NSECS_PER_MSEC;
+    QVERIFY(scheduler.poll(nsecs, wallTime(1, 10, 0, 0)).isEmpty() == true);
+    QCOMPARE(scheduler.nextOccurrence(id), wallTime(6, 10, 0, 0));
+}
+
+void Scheduler_Test::catchUp()
+{
+    Scheduler scheduler;
+    quint32 skipId = scheduler.addEntry(1, QTime(10, 0, 5));
+    quint32 fireId = scheduler.addEntry(2, QTime(10, 0, 5), Scheduler::EveryDay,
+                                        Scheduler::FireMissed);
+
+    scheduler.poll(0, wallTime(1, 10, 0, 0));
+
+    /* The system time jumps ten minutes forward */
+    QList<quint32> due = scheduler.poll(2000 * NSECS_PER_MSEC, wallTime(1, 10, 10, 0));
+    QCOMPARE(due.count(), 1);
+    QCOMPARE(due.first(), quint32(2));
+
+    QCOMPARE(scheduler.nextOccurrence(skipId), wallTime(2, 10, 0, 5));
+    QCOMPARE(scheduler.nextOccurrence(fireId), wallTime(2, 10, 0, 5));
+
+    /* The system time jumps back: the deadlines follow */
+    scheduler.poll(4000 * NSECS_PER_MSEC, wallTime(1, 10, 0, 0));
+    QVERIFY(scheduler.poll(9000 * NSECS_PER_MSEC, wallTime(1, 10, 0, 5)).isEmpty() == true);
+}
+
+void Scheduler_Test::grace()
+{
+    Scheduler scheduler;
+    scheduler.setGraceTime(3000);
+    QCOMPARE(scheduler.graceTime(), uint(3000));
+
+    scheduler.addEntry(1, QTime(10, 0, 5));
+    scheduler.poll(0, wallTime(1, 10, 0, 0));
+
+    /* The engine was busy for a while: 2 seconds late is still on time */
+    QList<quint32> due = scheduler.poll(7000 * NSECS_PER_MSEC, wallTime(1, 10, 0, 7));
+    QCOMPARE(due.count(), 1);
+    QCOMPARE(due.first(), quint32(1));
+}
+
+void Scheduler_Test::removeEntry()
+{
+    Scheduler scheduler;
+    quint32 id = scheduler.addEntry(1, QTime(10, 0, 5));
+    scheduler.addEntry(2, QTime(10, 0, 5));
+    scheduler.poll(0, wallTime(1, 10, 0, 0));
+
+    QVERIFY(scheduler.removeEntry(id) == true);
+    QVERIFY(scheduler.removeEntry(id) == false);
+    QCOMPARE(scheduler.entryCount(), 1);
+    QCOMPARE(scheduler.nextOccurrence(id), qint64(-1));
+
+    QList<quint32> due = scheduler.poll(5000 * NSECS_PER_MSEC, wallTime(1, 10, 0, 5));
+    QCOMPARE(due.count(), 1);
+    QCOMPARE(due.first(), quint32(2));
+
+    scheduler.clear();
+    QCOMPARE(scheduler.entryCount(), 0);
+}
+
+QTEST_APPLESS_MAIN(Scheduler_Test)
@@ -62,4 +62,51 @@ void Script_Test::initial()
         scr.executeCommand(i, doc.masterTimer(), ua);
 }
 
+void Script_Test::compile()
+{
+    Doc doc(this);
+
+    Script scr(&doc);
+    scr.setData(QString("label:top\n"
+                        "// Comment\n"
+                        "wait:0.5\n"
+                        "startfunction:3\n"
+                        "setfixture:2 ch:4 val:100 time:200\n"
+                        "jump:top\n"
+                        "jump:nowhere\n"
+                        "bogus:1\n"));
+
+    QCOMPARE(scr.m_program.size(), 9);
+    QCOMPARE(scr.m_program[0].opcode, Script::NoOp);
+    QCOMPARE(scr.m_program[1].opcode, Script::NoOp);
+    QCOMPARE(scr.m_program[2].opcode, Script::Wait);
+    QCOMPARE(scr.m_program[2].waitTicks, quint32(0.5 * MasterTimer::frequency()));
+    QCOMPARE(scr.m_program[3].opcode, Script::StartFunction);
+    QCOMPARE(scr.m_program[3].id, quint32(3));
+    QCOMPARE(scr.m_program[4].opcode, Script::SetFixture);
+    QCOMPARE(scr.m_program[4].id, quint32(2));
+    QCOMPARE(scr.m_program[4].channel, quint32(4));
+    QCOMPARE(scr.m_program[4].value, uchar(100));
+    QCOMPARE(scr.m_program[4].fadeTime, uint(200));
+    QCOMPARE(scr.m_program[5].opcode, Script::Jump);
+    QCOMPARE(scr.m_program[5].jumpTarget, 0);
+    QCOMPARE(scr.m_program[6].opcode, Script::Invalid);
+    QCOMPARE(scr.m_program[7].opcode, Script::Invalid);
+    QCOMPARE(scr.m_program[8].opcode, Script::NoOp);
+
+    // Unresolved references are skipped without breaking the loop
+    QVERIFY(scr.m_resolved == false);
+    QVERIFY(scr.executeCommand(3, doc.masterTimer(), QList<Universe*>()) == true);
+    QVERIFY(scr.m_resolved == true);
+    QVERIFY(scr.m_program[3].function == NULL);
+
+    // Jumps return control to MasterTimer
+    QVERIFY(scr.executeCommand(5, doc.masterTimer(), QList<Universe*>()) == false);
+    QCOMPARE(scr.m_currentCommand, 0);
+
+    // Doc changes invalidate the resolved references
+    scr.slotDocContentsChanged(3);
+    QVERIFY(scr.m_resolved == false);
+}
+
 QTEST_APPLESS_MAIN(Script_Test)
@@ -0,0 +1,108 @@
+/*
+  Q Light Controller Plus - Unit test
+  show_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+#include <QtXml>
+
+#include "show_test.h"
+#include "show.h"
+#include "doc.h"
+
+void Show_Test::initTestCase()
+{
+    m_doc = new Doc(this);
+}
+
+void Show_Test::cleanupTestCase()
+{
+    delete m_doc;
+}
+
+void Show_Test::initial()
+{
+    Show s(m_doc);
+    QCOMPARE(s.type(), Function::Show);
+    QCOMPARE(s.audioSync(), false);
+}
+
+void Show_Test::audioSync()
+{
+    Show s(m_doc);
+    s.setAudioSync(true);
+    QCOMPARE(s.audioSync(), true);
+    s.setAudioSync(false);
+    QCOMPARE(s.audioSync(), false);
+}
+
+void Show_Test::copy()
+{
+    Show s(m_doc);
+    s.setAudioSync(true);
+
+    Show copy(m_doc);
+    QVERIFY(copy.copyFrom(&s) == true);
+    QCOMPARE(copy.audioSync(), true);
+}
+
+void Show_Test::save()
+{
+    Show s(m_doc);
+
+    QDomDocument doc;
+    QDomElement root = doc.createElement("TestRoot");
+
+    // Not synced: no tag at all, as in older workspaces
+    QVERIFY(s.saveXML(&doc, &root) == true);
+    QDomElement func = root.firstChild().toElement();
+    QCOMPARE(func.tagName(), QString("Function"));
+    QCOMPARE(func.attribute("Type"), QString("Show"));
+    QVERIFY(func.firstChildElement("AudioSync").isNull() == true);
+
+    s.setAudioSync(true);
+    QDomElement root2 = doc.createElement("TestRoot");
+    QVERIFY(s.saveXML(&doc, &root2) == true);
+    QDomElement sync = root2.firstChild().firstChildElement("AudioSync");
+    QVERIFY(sync.isNull() == false);
+    QCOMPARE(sync.text(), QString("True"));
+}
+
+void Show_Test::load()
+{
+    Show s(m_doc);
+    s.setAudioSync(true);
+
+    QDomDocument doc;
+    QDomElement root = doc.createElement("TestRoot");
+    QVERIFY(s.saveXML(&doc, &root) == true);
+
+    Show loaded(m_doc);
+    QVERIFY(loaded.loadXML(root.firstChild().toElement()) == true);
+    QCOMPARE(loaded.audioSync(), true);
+
+    // A workspace without the tag loads as not synced
+    Show plain(m_doc);
+    QDomElement root2 = doc.createElement("TestRoot");
+    QVERIFY(plain.saveXML(&doc, &root2) == true);
+
+    Show loaded2(m_doc);
+    QVERIFY(loaded2.loadXML(root2.firstChild().toElement()) == true);
+    QCOMPARE(loaded2.audioSync(), false);
+}
+
+QTEST_MAIN(Show_Test)
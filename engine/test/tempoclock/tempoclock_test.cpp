@@ -0,0 +1,199 @@
+/*
+  Q Light Controller Plus - Unit test
+  tempoclock_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#include "tempoclock_test.h"
+#include "tempoclock.h"
+
+#define NSECS_PER_SECOND Q_INT64_C(1000000000)
+
+/** Get the time of the $i-th pulse at $bpm, with up to 1ms of jitter */
+static qint64 pulseTime(qint64 origin, qreal bpm, int i)
+{
+    qreal period = 60e9 / bpm / TEMPOCLOCK_PPQN;
+    qint64 jitter = ((i * 7) % 5 - 2) * 500000;
+    return origin + qint64(i * period) + jitter;
+}
+
+void TempoClock_Test::initial()
+{
+    TempoClock clock;
+    QCOMPARE(clock.bpm(), qreal(TEMPOCLOCK_DEFAULT_BPM));
+    QCOMPARE(clock.source(), TempoClock::invalidSource());
+    QVERIFY(clock.isLocked(0) == false);
+    QCOMPARE(clock.tickPosition(), quint64(0));
+    QCOMPARE(clock.tickDelta(), uint(0));
+
+    /* Free running at the default tempo */
+    QCOMPARE(clock.beats(NSECS_PER_SECOND / 2), qreal(1));
+    QCOMPARE(clock.beats(NSECS_PER_SECOND * 2), qreal(4));
+}
+
+void TempoClock_Test::setBpm()
+{
+    TempoClock clock;
+    clock.setBpm(140);
+    QCOMPARE(clock.bpm(), qreal(140));
+
+    clock.setBpm(1000);
+    QCOMPARE(clock.bpm(), qreal(TEMPOCLOCK_MAX_BPM));
+
+    clock.setBpm(1);
+    QCOMPARE(clock.bpm(), qreal(TEMPOCLOCK_MIN_BPM));
+}
+
+void TempoClock_Test::lock()
+{
+    TempoClock clock;
+    qint64 origin = NSECS_PER_SECOND;
+
+    clock.pulse(3, pulseTime(origin, 140, 0));
+    QCOMPARE(clock.source(), quint32(3));
+    QVERIFY(clock.isLocked(origin) == false);
+
+    for (int i = 1; i <= 8 * TEMPOCLOCK_PPQN; i++)
+        clock.pulse(3, pulseTime(origin, 140, i));
+
+    qint64 last = pulseTime(origin, 140, 8 * TEMPOCLOCK_PPQN);
+    QVERIFY(clock.isLocked(last) == true);
+    QVERIFY(qAbs(clock.bpm() - 140) < 0.5);
+
+    /* One beat per 24 pulses */
+    qreal before = clock.beats(last);
+    for (int i = 1; i <= 4 * TEMPOCLOCK_PPQN; i++)
+        clock.pulse(3, pulseTime(origin, 140, 8 * TEMPOCLOCK_PPQN + i));
+    last = pulseTime(origin, 140, 12 * TEMPOCLOCK_PPQN);
+    QVERIFY(qAbs(clock.beats(last) - before - 4) < 0.02);
+
+    /* Follows a tempo change */
+    origin = last;
+    for (int i = 1; i <= 16 * TEMPOCLOCK_PPQN; i++)
+        clock.pulse(3, pulseTime(origin, 128, i));
+    QVERIFY(qAbs(clock.bpm() - 128) < 0.5);
+}
+
+void TempoClock_Test::otherSource()
+{
+    TempoClock clock;
+    qint64 origin = NSECS_PER_SECOND;
+
+    for (int i = 0; i <= 2 * TEMPOCLOCK_PPQN; i++)
+    {
+        clock.pulse(1, pulseTime(origin, 120, i));
+        clock.pulse(2, pulseTime(origin, 90, i));
+    }
+    QCOMPARE(clock.source(), quint32(1));
+    QVERIFY(qAbs(clock.bpm() - 120) < 0.5);
+
+    /* Source 2 takes over when source 1 goes silent */
+    origin = pulseTime(origin, 120, 2 * TEMPOCLOCK_PPQN) + 2 * NSECS_PER_SECOND;
+    for (int i = 0; i <= 8 * TEMPOCLOCK_PPQN; i++)
+        clock.pulse(2, pulseTime(origin, 90, i));
+    QCOMPARE(clock.source(), quint32(2));
+    QVERIFY(qAbs(clock.bpm() - 90) < 0.5);
+}
+
+void TempoClock_Test::timeout()
+{
+    TempoClock clock;
+    qint64 origin = NSECS_PER_SECOND;
+
+    for (int i = 0; i <= 4 * TEMPOCLOCK_PPQN; i++)
+        clock.pulse(1, pulseTime(origin, 150, i));
+    qint64 last = pulseTime(origin, 150, 4 * TEMPOCLOCK_PPQN);
+    QVERIFY(clock.isLocked(last) == true);
+    QVERIFY(clock.isLocked(last + 2 * NSECS_PER_SECOND) == false);
+
+    /* The position keeps advancing at the last tempo */
+    qreal beats = clock.beats(last);
+    QVERIFY(qAbs(clock.beats(last + 2 * NSECS_PER_SECOND) - beats - 5) < 0.05);
+}
+
+void TempoClock_Test::startStop()
+{
+    TempoClock clock;
+    qint64 origin = NSECS_PER_SECOND;
+
+    for (int i = 0; i <= 4 * TEMPOCLOCK_PPQN; i++)
+        clock.pulse(1, pulseTime(origin, 120, i));
+    qint64 last = pulseTime(origin, 120, 4 * TEMPOCLOCK_PPQN);
+
+    /* Position is held at zero until the first pulse after start */
+    clock.start(1, last + 1000);
+    QCOMPARE(clock.beats(last + 5000000), qreal(0));
+    QCOMPARE(clock.beats(last + 10000000), qreal(0));
+
+    origin = pulseTime(origin, 120, 4 * TEMPOCLOCK_PPQN + 1);
+    for (int i = 0; i <= 2 * TEMPOCLOCK_PPQN; i++)
+        clock.pulse(1, pulseTime(origin, 120, i));
+    last = pulseTime(origin, 120, 2 * TEMPOCLOCK_PPQN);
+    QVERIFY(qAbs(clock.beats(last) - 2) < 0.02);
+
+    /* Stop freezes the position, even though pulses keep coming */
+    clock.stop(1, last + 1000);
+    qreal frozen = clock.beats(last + 1000);
+    for (int i = 1; i <= TEMPOCLOCK_PPQN; i++)
+        clock.pulse(1, pulseTime(last, 120, i));
+    last = pulseTime(last, 120, TEMPOCLOCK_PPQN);
+    QCOMPARE(clock.beats(last), frozen);
+    QVERIFY(clock.isLocked(last) == true);
+
+    /* Continue resumes from the frozen position */
+    clock.resume(1, last + 1000);
+    for (int i = 1; i <= TEMPOCLOCK_PPQN; i++)
+        clock.pulse(1, pulseTime(last, 120, i));
+    last = pulseTime(last, 120, TEMPOCLOCK_PPQN);
+    QVERIFY(qAbs(clock.beats(last) - frozen - 1) < 0.05);
+}
+
+void TempoClock_Test::tick()
+{
+    TempoClock clock;
+
+    /* Nothing elapses before the first tick */
+    clock.tick(NSECS_PER_SECOND);
+    QCOMPARE(clock.tickPosition(), quint64(2000));
+    QCOMPARE(clock.tickDelta(), uint(0));
+
+    /* 20ms ticks at 120BPM */
+    uint total = 0;
+    for (int i = 1; i <= 50; i++)
+    {
+        clock.tick(NSECS_PER_SECOND + i * 20000000);
+        QCOMPARE(clock.tickDelta(), uint(40));
+        total += clock.tickDelta();
+    }
+    QCOMPARE(total, uint(2000));
+    QCOMPARE(clock.tickPosition(), quint64(4000));
+
+    /* Frozen position doesn't elapse */
+    clock.stop(1, 2 * NSECS_PER_SECOND);
+    clock.tick(2 * NSECS_PER_SECOND + 20000000);
+    QCOMPARE(clock.tickDelta(), uint(0));
+    QCOMPARE(clock.tickPosition(), quint64(4000));
+
+    /* Restarting rewinds the position without elapsing */
+    clock.start(1, 3 * NSECS_PER_SECOND);
+    clock.tick(3 * NSECS_PER_SECOND + 20000000);
+    QCOMPARE(clock.tickDelta(), uint(0));
+    QCOMPARE(clock.tickPosition(), quint64(0));
+}
+
+QTEST_APPLESS_MAIN(TempoClock_Test)
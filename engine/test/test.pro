@@ -1,6 +1,9 @@
 TEMPLATE = subdirs
 CONFIG  += ordered
+SUBDIRS += audiopeakcache
+SUBDIRS += benchmark
 SUBDIRS += bus
+SUBDIRS += channelremap
 SUBDIRS += chaser
 SUBDIRS += chaserrunner
 SUBDIRS += chaserstep
@@ -10,6 +13,7 @@ SUBDIRS += cuestack
 SUBDIRS += doc
 SUBDIRS += efx
 SUBDIRS += efxfixture
+SUBDIRS += enginerunner
 SUBDIRS += fadechannel
 SUBDIRS += fixture
 SUBDIRS += fixturegroup
@@ -18,6 +22,7 @@ SUBDIRS += genericfader
 SUBDIRS += grandmaster
 #SUBDIRS += inputmap
 SUBDIRS += inputpatch
+SUBDIRS += ltcdecoder
 SUBDIRS += mastertimer
 #SUBDIRS += outputmap
 SUBDIRS += outputpatch
@@ -35,13 +40,21 @@ SUBDIRS += qlcmacros
 SUBDIRS += qlcphysical
 SUBDIRS += qlcpoint
 SUBDIRS += rgbalgorithm
+SUBDIRS += rgbimage
 SUBDIRS += rgbmatrix
 SUBDIRS += rgbscript
 SUBDIRS += rgbtext
 SUBDIRS += scene
 SUBDIRS += scenevalue
+SUBDIRS += scheduler
 SUBDIRS += script
+SUBDIRS += show
+SUBDIRS += tempoclock
+SUBDIRS += tickprofiler
+SUBDIRS += timecodeclock
 SUBDIRS += universe
+SUBDIRS += universesnapshot
+SUBDIRS += workspacesnapshot
 
 # Stubs
 SUBDIRS += iopluginstub
@@ -0,0 +1,159 @@
+/*
+  Q Light Controller Plus - Unit test
+  tickprofiler_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#include "tickprofiler_test.h"
+#include "tickprofiler.h"
+#include "mastertimer.h"
+#include "scene.h"
+#include "doc.h"
+
+void TickProfiler_Test::initial()
+{
+    TickProfiler prof;
+    QVERIFY(prof.isEnabled() == false);
+
+    /* Only the stages, without samples */
+    QList <TickProfiler::Statistics> stats = prof.statistics();
+    QCOMPARE(stats.size(), int(TickProfiler::StageCount));
+    for (int i = 0; i < stats.size(); i++)
+    {
+        QCOMPARE(stats[i].type, TickProfiler::StageItem);
+        QCOMPARE(stats[i].name, TickProfiler::stageToString(TickProfiler::Stage(i)));
+        QCOMPARE(stats[i].samples, 0);
+        QCOMPARE(stats[i].max, qreal(0));
+    }
+
+    prof.setEnabled(true);
+    QVERIFY(prof.isEnabled() == true);
+    prof.setEnabled(false);
+    QVERIFY(prof.isEnabled() == false);
+}
+
+void TickProfiler_Test::percentiles()
+{
+    TickProfiler prof;
+
+    /* 1..100 microseconds, shuffled */
+    for (int i = 0; i < 100; i++)
+        prof.addStageSample(TickProfiler::FaderStage, qint64(((i * 37) % 100) + 1) * 1000);
+
+    TickProfiler::Statistics st = prof.statistics().at(TickProfiler::FaderStage);
+    QCOMPARE(st.samples, 100);
+    QCOMPARE(st.last, qreal(((99 * 37) % 100) + 1));
+    QCOMPARE(st.p50, qreal(50));
+    QCOMPARE(st.p95, qreal(95));
+    QCOMPARE(st.p99, qreal(99));
+    QCOMPARE(st.max, qreal(100));
+    QCOMPARE(st.mean, qreal(50.5));
+}
+
+void TickProfiler_Test::window()
+{
+    TickProfiler prof;
+
+    for (int i = 0; i < TICKPROFILER_WINDOW; i++)
+        prof.addFunctionSample(7, 1000000);
+
+    TickProfiler::Statistics st = prof.statistics().at(TickProfiler::StageCount);
+    QCOMPARE(st.type, TickProfiler::FunctionItem);
+    QCOMPARE(st.id, quint32(7));
+    QCOMPARE(st.max, qreal(1000));
+
+    /* Old samples roll out of the window */
+    for (int i = 0; i < TICKPROFILER_WINDOW; i++)
+        prof.addFunctionSample(7, 2000);
+
+    st = prof.statistics().at(TickProfiler::StageCount);
+    QCOMPARE(st.samples, int(TICKPROFILER_WINDOW));
+    QCOMPARE(st.max, qreal(2));
+    QCOMPARE(st.p50, qreal(2));
+}
+
+void TickProfiler_Test::ordering()
+{
+    TickProfiler prof;
+
+    prof.addPluginSample("DMX USB", 5000);
+    prof.addDMXSourceSample("Slider", 1000);
+    prof.addFunctionSample(1, 1000);
+    prof.addFunctionSample(2, 3000);
+    prof.addFunctionSample(3, 2000);
+
+    QList <TickProfiler::Statistics> stats = prof.statistics();
+    QCOMPARE(stats.size(), int(TickProfiler::StageCount) + 5);
+
+    /* Stages, then functions by descending p95, then sources & plugins */
+    int i = TickProfiler::StageCount;
+    QCOMPARE(stats[i].id, quint32(2));
+    QCOMPARE(stats[i + 1].id, quint32(3));
+    QCOMPARE(stats[i + 2].id, quint32(1));
+    QCOMPARE(stats[i + 2].name, QString("1"));
+    QCOMPARE(stats[i + 3].type, TickProfiler::DMXSourceItem);
+    QCOMPARE(stats[i + 3].name, QString("Slider"));
+    QCOMPARE(stats[i + 4].type, TickProfiler::PluginItem);
+    QCOMPARE(stats[i + 4].name, QString("DMX USB"));
+    QCOMPARE(stats[i + 4].p95, qreal(5));
+}
+
+void TickProfiler_Test::reset()
+{
+    TickProfiler prof;
+    prof.setEnabled(true);
+    prof.addStageSample(TickProfiler::TickStage, 1000);
+    prof.addFunctionSample(1, 1000);
+    prof.addDMXSourceSample("Slider", 1000);
+    prof.addPluginSample("DMX USB", 1000);
+    QCOMPARE(prof.statistics().size(), int(TickProfiler::StageCount) + 3);
+
+    prof.reset();
+    QVERIFY(prof.isEnabled() == true);
+
+    QList <TickProfiler::Statistics> stats = prof.statistics();
+    QCOMPARE(stats.size(), int(TickProfiler::StageCount));
+    QCOMPARE(stats[TickProfiler::TickStage].samples, 0);
+}
+
+void TickProfiler_Test::removeFunction()
+{
+    TickProfiler prof;
+    prof.addFunctionSample(1, 1000);
+    prof.addFunctionSample(2, 1000);
+    QCOMPARE(prof.statistics().size(), int(TickProfiler::StageCount) + 2);
+
+    prof.removeFunction(1);
+    prof.removeFunction(42);
+    QList <TickProfiler::Statistics> stats = prof.statistics();
+    QCOMPARE(stats.size(), int(TickProfiler::StageCount) + 1);
+    QCOMPARE(stats.last().id, quint32(2));
+
+    /* Deleted functions disappear from MasterTimer's profiler */
+    Doc doc(this);
+    Scene* s = new Scene(&doc);
+    QVERIFY(doc.addFunction(s) == true);
+    TickProfiler* mtProf = doc.masterTimer()->profiler();
+    mtProf->addFunctionSample(s->id(), 1000);
+    QCOMPARE(mtProf->statistics().size(), int(TickProfiler::StageCount) + 1);
+
+    QVERIFY(doc.deleteFunction(s->id()) == true);
+    QCOMPARE(mtProf->statistics().size(), int(TickProfiler::StageCount));
+}
+
+QTEST_APPLESS_MAIN(TickProfiler_Test)
@@ -0,0 +1,190 @@
+/*
+  Q Light Controller Plus - Unit test
+  timecodeclock_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#include "timecodeclock_test.h"
+#include "timecodeclock.h"
+
+#define NSECS_PER_MSEC Q_INT64_C(1000000)
+
+void TimecodeClock_Test::initial()
+{
+    TimecodeClock clock;
+    QCOMPARE(clock.freewheel(), uint(TIMECODECLOCK_DEFAULT_FREEWHEEL));
+    QCOMPARE(clock.source(), TimecodeClock::invalidSource());
+    QCOMPARE(clock.position(0), qint64(-1));
+    QCOMPARE(clock.jumps(), quint32(0));
+    QVERIFY(clock.isLocked(0) == false);
+    QVERIFY(clock.isRunning(0) == false);
+}
+
+void TimecodeClock_Test::receive()
+{
+    TimecodeClock clock;
+
+    /* The first position is a jump */
+    clock.receive(2, 60000, 1000 * NSECS_PER_MSEC);
+    QCOMPARE(clock.source(), quint32(2));
+    QCOMPARE(clock.jumps(), quint32(1));
+    QCOMPARE(clock.position(1000 * NSECS_PER_MSEC), qint64(60000));
+
+    /* Extrapolated in real time */
+    QCOMPARE(clock.position(1100 * NSECS_PER_MSEC), qint64(60100));
+    QVERIFY(clock.isLocked(1100 * NSECS_PER_MSEC) == true);
+    QVERIFY(clock.isRunning(1100 * NSECS_PER_MSEC) == true);
+
+    /* Not before the position was received */
+    QCOMPARE(clock.position(900 * NSECS_PER_MSEC), qint64(60000));
+
+    /* Positions as expected are not jumps */
+    clock.receive(2, 60080, 1080 * NSECS_PER_MSEC);
+    clock.receive(2, 60160, 1160 * NSECS_PER_MSEC);
+    QCOMPARE(clock.jumps(), quint32(1));
+    QCOMPARE(clock.position(1200 * NSECS_PER_MSEC), qint64(60200));
+}
+
+void TimecodeClock_Test::jitter()
+{
+    TimecodeClock clock;
+    clock.receive(0, 0, 0);
+
+    /* Positions arriving up to 10ms late or early */
+    for (int i = 1; i <= 100; i++)
+    {
+        qint64 jitter = ((i * 7) % 5 - 2) * 5;
+        clock.receive(0, i * 40, (i * 40 + jitter) * NSECS_PER_MSEC);
+    }
+
+    QCOMPARE(clock.jumps(), quint32(1));
+
+    /* The error is smoothed out */
+    qint64 pos = clock.position(4000 * NSECS_PER_MSEC);
+    QVERIFY(qAbs(pos - 4000) <= 10);
+}
+
+void TimecodeClock_Test::jump()
+{
+    TimecodeClock clock;
+    clock.receive(0, 10000, 0);
+    clock.receive(0, 10040, 40 * NSECS_PER_MSEC);
+    QCOMPARE(clock.jumps(), quint32(1));
+
+    /* Forward */
+    clock.receive(0, 20000, 80 * NSECS_PER_MSEC);
+    QCOMPARE(clock.jumps(), quint32(2));
+    QCOMPARE(clock.position(80 * NSECS_PER_MSEC), qint64(20000));
+
+    /* Backward */
+    clock.receive(0, 5000, 120 * NSECS_PER_MSEC);
+    QCOMPARE(clock.jumps(), quint32(3));
+    QCOMPARE(clock.position(120 * NSECS_PER_MSEC), qint64(5000));
+
+    /* Within the threshold */
+    clock.receive(0, 5040 + TIMECODECLOCK_JUMP_THRESHOLD / 2, 160 * NSECS_PER_MSEC);
+    QCOMPARE(clock.jumps(), quint32(3));
+}
+
+void TimecodeClock_Test::freewheel()
+{
+    TimecodeClock clock;
+    clock.setFreewheel(300);
+    QCOMPARE(clock.freewheel(), uint(300));
+
+    clock.receive(0, 1000, 0);
+
+    /* Dropout: locked for a while, then freewheeling */
+    QVERIFY(clock.isLocked(200 * NSECS_PER_MSEC) == true);
+    QVERIFY(clock.isLocked(280 * NSECS_PER_MSEC) == false);
+    QVERIFY(clock.isRunning(280 * NSECS_PER_MSEC) == true);
+    QCOMPARE(clock.position(280 * NSECS_PER_MSEC), qint64(1280));
+
+    /* Then holding */
+    QVERIFY(clock.isRunning(300 * NSECS_PER_MSEC) == false);
+    QCOMPARE(clock.position(300 * NSECS_PER_MSEC), qint64(1300));
+    QCOMPARE(clock.position(5000 * NSECS_PER_MSEC), qint64(1300));
+
+    /* Timecode comes back where it stopped */
+    clock.receive(0, 1350, 5000 * NSECS_PER_MSEC);
+    QCOMPARE(clock.jumps(), quint32(1));
+    QCOMPARE(clock.position(5000 * NSECS_PER_MSEC), qint64(1350));
+    QVERIFY(clock.isRunning(5000 * NSECS_PER_MSEC) == true);
+
+    /* Timecode comes back somewhere else */
+    clock.receive(0, 20000, 10000 * NSECS_PER_MSEC);
+    QCOMPARE(clock.jumps(), quint32(2));
+}
+
+void TimecodeClock_Test::pauseResume()
+{
+    TimecodeClock clock;
+    for (int i = 0; i <= 25; i++)
+        clock.receive(0, 10000 + i * 40, i * 40 * NSECS_PER_MSEC);
+    QCOMPARE(clock.jumps(), quint32(1));
+
+    /* Paused at 11000: freewheeling past it, then holding */
+    QCOMPARE(clock.position(3000 * NSECS_PER_MSEC), qint64(11500));
+
+    /* Resumed where it was paused */
+    clock.receive(0, 11040, 3000 * NSECS_PER_MSEC);
+    QCOMPARE(clock.jumps(), quint32(1));
+    QCOMPARE(clock.position(3000 * NSECS_PER_MSEC), qint64(11040));
+    clock.receive(0, 11080, 3040 * NSECS_PER_MSEC);
+    QCOMPARE(clock.jumps(), quint32(1));
+    QCOMPARE(clock.position(3040 * NSECS_PER_MSEC), qint64(11080));
+
+    /* Paused again and located backwards before resuming */
+    clock.receive(0, 9000, 6000 * NSECS_PER_MSEC);
+    QCOMPARE(clock.jumps(), quint32(2));
+    QCOMPARE(clock.position(6000 * NSECS_PER_MSEC), qint64(9000));
+}
+
+void TimecodeClock_Test::otherSource()
+{
+    TimecodeClock clock;
+    clock.receive(1, 1000, 0);
+
+    /* Ignored while the current source is locked */
+    clock.receive(2, 50000, 100 * NSECS_PER_MSEC);
+    QCOMPARE(clock.source(), quint32(1));
+    QCOMPARE(clock.position(100 * NSECS_PER_MSEC), qint64(1100));
+
+    /* Taken over when the current source is silent */
+    clock.receive(2, 50000, 1000 * NSECS_PER_MSEC);
+    QCOMPARE(clock.source(), quint32(2));
+    QCOMPARE(clock.jumps(), quint32(2));
+    QCOMPARE(clock.position(1000 * NSECS_PER_MSEC), qint64(50000));
+}
+
+void TimecodeClock_Test::reset()
+{
+    TimecodeClock clock;
+    clock.receive(1, 1000, 0);
+    clock.reset();
+
+    QCOMPARE(clock.position(0), qint64(-1));
+    QCOMPARE(clock.source(), TimecodeClock::invalidSource());
+    QVERIFY(clock.isLocked(0) == false);
+
+    /* The next position is a jump */
+    clock.receive(1, 1000, 0);
+    QCOMPARE(clock.jumps(), quint32(2));
+}
+
+QTEST_APPLESS_MAIN(TimecodeClock_Test)
@@ -0,0 +1,113 @@
+/*
+  Q Light Controller Plus - Unit test
+  universesnapshot_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#include "universesnapshot_test.h"
+#include "universesnapshot.h"
+#include "grandmaster.h"
+#include "universe.h"
+
+void UniverseSnapshot_Test::initial()
+{
+    UniverseSnapshot snapshot;
+    QCOMPARE(snapshot.universes(), 0);
+    QCOMPARE(snapshot.preGMValue(0, 0), uchar(0));
+    QCOMPARE(snapshot.postGMValue(0, 0), uchar(0));
+    QVERIFY(snapshot.preGMValues(0) == NULL);
+    QVERIFY(snapshot.postGMValues(0) == NULL);
+    QVERIFY(snapshot.isIntensity(0, 0) == false);
+}
+
+void UniverseSnapshot_Test::capture()
+{
+    GrandMaster gm;
+    gm.setValue(127);
+
+    QList<Universe*> ua;
+    ua.append(new Universe(0, &gm));
+    ua.append(new Universe(1, &gm));
+    ua[0]->setChannelCapability(0, QLCChannel::Intensity);
+    ua[0]->setChannelCapability(1, QLCChannel::Pan);
+    ua[1]->setChannelCapability(511, QLCChannel::Intensity);
+
+    ua[0]->write(0, 255);
+    ua[0]->write(1, 200);
+    ua[1]->write(511, 100);
+
+    UniverseSnapshot snapshot;
+    snapshot.capture(ua);
+    QCOMPARE(snapshot.universes(), 2);
+
+    QCOMPARE(snapshot.preGMValue(0, 0), uchar(255));
+    QCOMPARE(snapshot.preGMValue(0, 1), uchar(200));
+    QCOMPARE(snapshot.preGMValue(1, 511), uchar(100));
+    QCOMPARE(snapshot.preGMValues(1)[511], uchar(100));
+
+    /* Grand Master affects only the post-GM values of intensity channels */
+    QCOMPARE(snapshot.postGMValue(0, 0), uchar(ua[0]->postGMValues()->at(0)));
+    QVERIFY(snapshot.postGMValue(0, 0) < uchar(255));
+    QCOMPARE(snapshot.postGMValue(0, 1), uchar(200));
+    QCOMPARE(snapshot.postGMValues(0)[1], uchar(200));
+
+    QVERIFY(snapshot.isIntensity(0, 0) == true);
+    QVERIFY(snapshot.isIntensity(0, 1) == false);
+    QVERIFY(snapshot.isIntensity(1, 511) == true);
+
+    /* Out of range */
+    QCOMPARE(snapshot.preGMValue(0, 512), uchar(0));
+    QCOMPARE(snapshot.preGMValue(2, 0), uchar(0));
+    QVERIFY(snapshot.preGMValues(2) == NULL);
+    QVERIFY(snapshot.isIntensity(1, 512) == false);
+
+    /* Later writes are not in the snapshot until it's captured again */
+    ua[0]->write(1, 10);
+    QCOMPARE(snapshot.preGMValue(0, 1), uchar(200));
+    snapshot.capture(ua);
+    QCOMPARE(snapshot.preGMValue(0, 1), uchar(10));
+
+    qDeleteAll(ua);
+}
+
+void UniverseSnapshot_Test::recapture()
+{
+    GrandMaster gm;
+
+    QList<Universe*> ua;
+    ua.append(new Universe(0, &gm));
+    ua.append(new Universe(1, &gm));
+    ua[1]->write(5, 50);
+
+    UniverseSnapshot snapshot;
+    snapshot.capture(ua);
+    QCOMPARE(snapshot.universes(), 2);
+    QCOMPARE(snapshot.preGMValue(1, 5), uchar(50));
+
+    /* Fewer universes */
+    snapshot.capture(ua.mid(0, 1));
+    QCOMPARE(snapshot.universes(), 1);
+    QCOMPARE(snapshot.preGMValue(1, 5), uchar(0));
+
+    snapshot.capture(QList<Universe*>());
+    QCOMPARE(snapshot.universes(), 0);
+
+    qDeleteAll(ua);
+}
+
+QTEST_APPLESS_MAIN(UniverseSnapshot_Test)
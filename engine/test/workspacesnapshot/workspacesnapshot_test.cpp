@@ -0,0 +1,321 @@
+/*
+  Q Light Controller Plus - Unit test
+  workspacesnapshot_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#include "workspacesnapshot_test.h"
+#include "workspacesnapshot.h"
+#include "qlcfixturedefcache.h"
+#include "qlcfixturemode.h"
+#include "qlcfixturehead.h"
+#include "qlcfixturedef.h"
+#include "fixturegroup.h"
+#include "qlcfile.h"
+#include "fixture.h"
+#include "scene.h"
+#include "doc.h"
+
+#define INTERNAL_FIXTUREDIR "../../../fixtures/"
+#define TEST_WORKSPACE "snapshot_test.qxw"
+#define TEST_DEFINITION "snapshot_test.qxf"
+
+void WorkspaceSnapshot_Test::initTestCase()
+{
+    m_doc = new Doc(this);
+
+    QDir dir(INTERNAL_FIXTUREDIR);
+    dir.setFilter(QDir::Files);
+    dir.setNameFilters(QStringList() << QString("*%1").arg(KExtFixture));
+    QVERIFY(m_doc->fixtureDefCache()->load(dir) == true);
+}
+
+void WorkspaceSnapshot_Test::cleanupTestCase()
+{
+    delete m_doc;
+}
+
+void WorkspaceSnapshot_Test::init()
+{
+    QFile file(TEST_WORKSPACE);
+    QVERIFY(file.open(QIODevice::WriteOnly) == true);
+    file.write("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<Workspace/>\n");
+    file.close();
+}
+
+void WorkspaceSnapshot_Test::cleanup()
+{
+    m_doc->clearContents();
+    QFile::remove(TEST_WORKSPACE);
+    QFile::remove(WorkspaceSnapshot::snapshotPath(TEST_WORKSPACE));
+}
+
+void WorkspaceSnapshot_Test::createSnapshot()
+{
+    QLCFixtureDef* def = m_doc->fixtureDefCache()->fixtureDef("Futurelight", "DJScan250");
+    QVERIFY(def != NULL);
+    QLCFixtureMode* mode = def->modes().first();
+    QVERIFY(mode != NULL);
+
+    Fixture* fxi = new Fixture(m_doc);
+    fxi->setName("Scanner");
+    fxi->setFixtureDefinition(def, mode);
+    fxi->setUniverse(1);
+    fxi->setAddress(10);
+    fxi->setExcludeFadeChannels(QList<int>() << 1 << 3);
+    m_doc->addFixture(fxi);
+
+    Fixture* dimmer = new Fixture(m_doc);
+    dimmer->setName("Dimmers");
+    dimmer->setChannels(6);
+    dimmer->setAddress(100);
+    m_doc->addFixture(dimmer);
+
+    FixtureGroup* grp = new FixtureGroup(m_doc);
+    grp->setName("Group");
+    m_doc->addFixtureGroup(grp);
+
+    Scene* s = new Scene(m_doc);
+    s->setName("Look");
+    s->setValue(fxi->id(), 0, 127);
+    s->setValue(dimmer->id(), 5, 255);
+    m_doc->addFunction(s);
+
+    QVERIFY(WorkspaceSnapshot::save(m_doc, TEST_WORKSPACE) == true);
+}
+
+void WorkspaceSnapshot_Test::snapshotPath()
+{
+    QCOMPARE(WorkspaceSnapshot::snapshotPath("/foo/bar.qxw"), QString("/foo/bar.qxs"));
+    QCOMPARE(WorkspaceSnapshot::snapshotPath("/foo/bar.QXW"), QString("/foo/bar.qxs"));
+    QCOMPARE(WorkspaceSnapshot::snapshotPath("/foo/bar"), QString("/foo/bar.qxs"));
+}
+
+void WorkspaceSnapshot_Test::missing()
+{
+    QVERIFY(WorkspaceSnapshot::isUpToDate(TEST_WORKSPACE) == false);
+    QVERIFY(WorkspaceSnapshot::load(m_doc, TEST_WORKSPACE) == false);
+    QVERIFY(WorkspaceSnapshot::save(m_doc, "nonexistent.qxw") == false);
+}
+
+void WorkspaceSnapshot_Test::saveLoad()
+{
+    createSnapshot();
+    QVERIFY(WorkspaceSnapshot::isUpToDate(TEST_WORKSPACE) == true);
+
+    /* No fixture definitions loaded: they come from the snapshot */
+    Doc doc(this);
+    QVERIFY(WorkspaceSnapshot::load(&doc, TEST_WORKSPACE) == true);
+
+    QCOMPARE(doc.fixtures().size(), 2);
+    QCOMPARE(doc.fixtureGroups().size(), 1);
+    QCOMPARE(doc.functions().size(), 1);
+
+    Fixture* orig = m_doc->fixtures().at(0);
+    Fixture* fxi = doc.fixture(orig->id());
+    QVERIFY(fxi != NULL);
+    QCOMPARE(fxi->name(), QString("Scanner"));
+    QCOMPARE(fxi->universe(), quint32(1));
+    QCOMPARE(fxi->address(), quint32(10));
+    QCOMPARE(fxi->channels(), orig->channels());
+    QCOMPARE(fxi->excludeFadeChannels(), QList<int>() << 1 << 3);
+    QVERIFY(fxi->fixtureDef() != NULL);
+    QCOMPARE(fxi->fixtureDef()->manufacturer(), QString("Futurelight"));
+    QCOMPARE(fxi->fixtureDef()->model(), QString("DJScan250"));
+    QCOMPARE(fxi->fixtureDef()->type(), orig->fixtureDef()->type());
+    QCOMPARE(fxi->fixtureDef()->modes().size(), orig->fixtureDef()->modes().size());
+    QCOMPARE(fxi->fixtureMode()->name(), orig->fixtureMode()->name());
+    QCOMPARE(fxi->fixtureMode()->heads().size(), orig->fixtureMode()->heads().size());
+    for (quint32 i = 0; i < fxi->channels(); i++)
+    {
+        QCOMPARE(fxi->channel(i)->name(), orig->channel(i)->name());
+        QCOMPARE(fxi->channel(i)->group(), orig->channel(i)->group());
+        QCOMPARE(fxi->channel(i)->capabilities().size(), orig->channel(i)->capabilities().size());
+    }
+    QCOMPARE(fxi->panMsbChannel(), orig->panMsbChannel());
+    QCOMPARE(fxi->tiltMsbChannel(), orig->tiltMsbChannel());
+    QCOMPARE(fxi->masterIntensityChannel(), orig->masterIntensityChannel());
+
+    Fixture* dimmer = doc.fixture(m_doc->fixtures().at(1)->id());
+    QVERIFY(dimmer != NULL);
+    QVERIFY(dimmer->fixtureDef() == NULL);
+    QCOMPARE(dimmer->channels(), quint32(6));
+    QCOMPARE(dimmer->address(), quint32(100));
+
+    Scene* s = qobject_cast<Scene*> (doc.functions().first());
+    QVERIFY(s != NULL);
+    QCOMPARE(s->name(), QString("Look"));
+    QCOMPARE(s->values().size(), 2);
+}
+
+void WorkspaceSnapshot_Test::fillPlaceholder()
+{
+    createSnapshot();
+
+    /* A definition coming from the fixture map is only a placeholder
+       until its file is parsed. The snapshot fills it instead. */
+    QString path = m_doc->fixtures().at(0)->fixtureDef()->definitionSourceFile();
+    QVERIFY(path.isEmpty() == false);
+
+    Doc doc(this);
+    QLCFixtureDef* placeholder = new QLCFixtureDef();
+    placeholder->setManufacturer("Futurelight");
+    placeholder->setModel("DJScan250");
+    placeholder->setDefinitionSourceFile(path);
+    QVERIFY(doc.fixtureDefCache()->addFixtureDef(placeholder) == true);
+    QVERIFY(placeholder->isLoaded() == false);
+
+    QVERIFY(WorkspaceSnapshot::load(&doc, TEST_WORKSPACE) == true);
+    QVERIFY(placeholder->isLoaded() == true);
+    QVERIFY(placeholder->modes().isEmpty() == false);
+
+    Fixture* fxi = doc.fixture(m_doc->fixtures().at(0)->id());
+    QVERIFY(fxi != NULL);
+    QVERIFY(fxi->fixtureDef() == placeholder);
+    QCOMPARE(fxi->channels(), m_doc->fixtures().at(0)->channels());
+}
+
+void WorkspaceSnapshot_Test::outdated()
+{
+    createSnapshot();
+    QVERIFY(WorkspaceSnapshot::isUpToDate(TEST_WORKSPACE) == true);
+
+    /* The workspace has been changed by something else */
+    QFile file(TEST_WORKSPACE);
+    QVERIFY(file.open(QIODevice::Append) == true);
+    file.write("<!-- edited -->\n");
+    file.close();
+
+    QVERIFY(WorkspaceSnapshot::isUpToDate(TEST_WORKSPACE) == false);
+
+    Doc doc(this);
+    QVERIFY(WorkspaceSnapshot::load(&doc, TEST_WORKSPACE) == false);
+    QCOMPARE(doc.fixtures().size(), 0);
+    QCOMPARE(doc.functions().size(), 0);
+}
+
+void WorkspaceSnapshot_Test::otherDefinitionFile()
+{
+    createSnapshot();
+
+    /* The installed definition doesn't come from the file in the snapshot */
+    Doc doc(this);
+    QLCFixtureDef* placeholder = new QLCFixtureDef();
+    placeholder->setManufacturer("Futurelight");
+    placeholder->setModel("DJScan250");
+    placeholder->setDefinitionSourceFile("/nonexistent/Futurelight-DJScan250.qxf");
+    QVERIFY(doc.fixtureDefCache()->addFixtureDef(placeholder) == true);
+
+    QVERIFY(WorkspaceSnapshot::load(&doc, TEST_WORKSPACE) == false);
+    QVERIFY(placeholder->isLoaded() == false);
+    QCOMPARE(doc.fixtures().size(), 0);
+    QCOMPARE(doc.functions().size(), 0);
+}
+
+void WorkspaceSnapshot_Test::changedDefinitionFile()
+{
+    QFile::remove(TEST_DEFINITION);
+    QVERIFY(QFile::copy(INTERNAL_FIXTUREDIR "Futurelight-DJScan250.qxf", TEST_DEFINITION) == true);
+    QString path = QFileInfo(TEST_DEFINITION).absoluteFilePath();
+
+    /* Snapshot of a workspace using the copied definition */
+    Doc source(this);
+    QLCFixtureDef* def = new QLCFixtureDef();
+    QVERIFY(def->loadXML(path) == QFile::NoError);
+    def->setDefinitionSourceFile(path);
+    def->setLoaded();
+    QVERIFY(source.fixtureDefCache()->addFixtureDef(def) == true);
+
+    Fixture* fxi = new Fixture(&source);
+    fxi->setFixtureDefinition(def, def->modes().first());
+    source.addFixture(fxi);
+    QVERIFY(WorkspaceSnapshot::save(&source, TEST_WORKSPACE) == true);
+
+    /* Same file, unchanged: the snapshot is used */
+    Doc doc(this);
+    QLCFixtureDef* placeholder = new QLCFixtureDef();
+    placeholder->setManufacturer("Futurelight");
+    placeholder->setModel("DJScan250");
+    placeholder->setDefinitionSourceFile(path);
+    QVERIFY(doc.fixtureDefCache()->addFixtureDef(placeholder) == true);
+    QVERIFY(WorkspaceSnapshot::load(&doc, TEST_WORKSPACE) == true);
+    QCOMPARE(doc.fixtures().size(), 1);
+
+    /* The definition file has been edited after the snapshot */
+    QFile file(TEST_DEFINITION);
+    QVERIFY(file.open(QIODevice::Append) == true);
+    file.write("<!-- edited -->\n");
+    file.close();
+
+    Doc changed(this);
+    placeholder = new QLCFixtureDef();
+    placeholder->setManufacturer("Futurelight");
+    placeholder->setModel("DJScan250");
+    placeholder->setDefinitionSourceFile(path);
+    QVERIFY(changed.fixtureDefCache()->addFixtureDef(placeholder) == true);
+    QVERIFY(WorkspaceSnapshot::load(&changed, TEST_WORKSPACE) == false);
+    QVERIFY(placeholder->isLoaded() == false);
+    QCOMPARE(changed.fixtures().size(), 0);
+
+    QFile::remove(TEST_DEFINITION);
+}
+
+void WorkspaceSnapshot_Test::corruptedDefinitions()
+{
+    createSnapshot();
+
+    /* Add a second definition, written after the first one */
+    QLCFixtureDef* def = m_doc->fixtureDefCache()->fixtureDef("American DJ", "Accu Spot 250 II");
+    QVERIFY(def != NULL);
+    Fixture* fxi = new Fixture(m_doc);
+    fxi->setFixtureDefinition(def, def->modes().first());
+    fxi->setAddress(200);
+    m_doc->addFixture(fxi);
+    QVERIFY(WorkspaceSnapshot::save(m_doc, TEST_WORKSPACE) == true);
+
+    /* Cut the snapshot in the middle of the second definition. Its model
+       name appears once in the sources and once in the definitions. */
+    QFile file(WorkspaceSnapshot::snapshotPath(TEST_WORKSPACE));
+    QVERIFY(file.open(QIODevice::ReadWrite) == true);
+    QByteArray data = file.readAll();
+    QString model("Accu Spot 250 II");
+    QByteArray encoded;
+    foreach (QChar ch, model)
+        encoded.append(char(ch.unicode() >> 8)).append(char(ch.unicode() & 0xFF));
+    int pos = data.lastIndexOf(encoded);
+    QVERIFY(pos > data.indexOf(encoded));
+    QVERIFY(file.resize(pos + encoded.size() + 64) == true);
+    file.close();
+    QVERIFY(WorkspaceSnapshot::isUpToDate(TEST_WORKSPACE) == true);
+
+    QString path = m_doc->fixtures().at(0)->fixtureDef()->definitionSourceFile();
+    Doc doc(this);
+    QLCFixtureDef* placeholder = new QLCFixtureDef();
+    placeholder->setManufacturer("Futurelight");
+    placeholder->setModel("DJScan250");
+    placeholder->setDefinitionSourceFile(path);
+    QVERIFY(doc.fixtureDefCache()->addFixtureDef(placeholder) == true);
+
+    /* The first definition was read fine, but is not used */
+    QVERIFY(WorkspaceSnapshot::load(&doc, TEST_WORKSPACE) == false);
+    QVERIFY(placeholder->isLoaded() == false);
+    QVERIFY(doc.fixtureDefCache()->fixtureDef("American DJ", "Accu Spot 250 II") == NULL);
+    QCOMPARE(doc.fixtures().size(), 0);
+}
+
+QTEST_APPLESS_MAIN(WorkspaceSnapshot_Test)
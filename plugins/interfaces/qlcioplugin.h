@@ -222,6 +222,15 @@ public:
      */
     virtual void sendFeedBack(quint32 inputLine, quint32 channel, uchar value, const QString& key = 0) = 0;
 
+    /** Tempo messages, like MIDI beat clock, that an input line can receive */
+    enum BeatClockEvent
+    {
+        BeatClockPulse = 0, //! One clock pulse. MIDI sends 24 pulses per beat.
+        BeatClockStart,     //! Start from the beginning on the next pulse
+        BeatClockContinue,  //! Continue from the current position
+        BeatClockStop       //! Stop
+    };
+
 signals:
     /**
      * Tells that the value of a channel in an input line has changed and needs
@@ -234,6 +243,28 @@ signals:
      */
     void valueChanged(quint32 input, quint32 channel, uchar value, const QString& key = 0);
 
+    /**
+     * Tells that a tempo message has been received on an input line. Unlike
+     * valueChanged(), this signal must be emitted as soon as the message is
+     * received, from the thread that receives it, so that its timing is not
+     * affected by the event loop. Receivers connect with Qt::DirectConnection.
+     *
+     * @param input The input line that received the message
+     * @param event The received BeatClockEvent
+     */
+    void beatClock(quint32 input, int event);
+
+    /**
+     * Tells that a timecode position (like MIDI Time Code) has been received
+     * on an input line. As with beatClock(), this signal is emitted from the
+     * thread that receives the message and receivers connect with
+     * Qt::DirectConnection.
+     *
+     * @param input The input line that received the timecode
+     * @param msecs The timecode position in milliseconds, as of now
+     */
+    void timecode(quint32 input, quint32 msecs);
+
     /*************************************************************************
      * Configure
      *************************************************************************/
@@ -223,7 +223,20 @@ void AlsaMidiInputThread::readEvent()
 
         //qDebug() << "ALSA MIDI event received !" << ev->type;
 
-        if (snd_seq_ev_is_control_type(ev))
+        if (ev->type == SND_SEQ_EVENT_QFRAME)
+        {
+            // MIDI Time Code goes to the engine only
+            device->processTimeCode(ev->data.control.value);
+            snd_seq_free_event(ev);
+            continue;
+        }
+        else if (ev->type == SND_SEQ_EVENT_SYSEX)
+        {
+            device->processSysEx((const uchar*)ev->data.ext.ptr, ev->data.ext.len);
+            snd_seq_free_event(ev);
+            continue;
+        }
+        else if (snd_seq_ev_is_control_type(ev))
         {
             if (ev->type == SND_SEQ_EVENT_PGMCHANGE)
             {
@@ -251,8 +264,6 @@ void AlsaMidiInputThread::readEvent()
         }
         else if (snd_seq_ev_is_queue_type(ev))
         {
-            if (device->processMBC(ev->type) == false)
-                continue;
             if (ev->type == SND_SEQ_EVENT_START)
                 cmd = MIDI_BEAT_START;
             else if(ev->type == SND_SEQ_EVENT_STOP)
@@ -262,6 +273,12 @@ void AlsaMidiInputThread::readEvent()
             else if(ev->type == SND_SEQ_EVENT_CLOCK)
                 cmd = MIDI_BEAT_CLOCK;
 
+            // The engine tempo clock gets every message right away,
+            // input channels only one pulse per beat
+            device->emitBeatClock(cmd);
+            if (device->processMBC(ev->type) == false)
+                continue;
+
             qDebug()  << "MIDI clock: " << cmd;
         }
 
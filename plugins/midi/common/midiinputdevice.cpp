@@ -18,11 +18,17 @@
 */
 
 #include <QDebug>
+#include <string.h>
+
 #include "midiinputdevice.h"
+#include "midiprotocol.h"
+#include "qlcioplugin.h"
 
 MidiInputDevice::MidiInputDevice(const QVariant& uid, const QString& name, QObject* parent)
     : MidiDevice(uid, name, parent)
+    , m_mtcNextPiece(0)
 {
+    memset(m_mtcPieces, 0, sizeof(m_mtcPieces));
     //qDebug() << Q_FUNC_INFO;
 }
 
@@ -35,3 +41,85 @@ void MidiInputDevice::emitValueChanged(uint channel, uchar value)
 {
     emit valueChanged(uid(), channel, value);
 }
+
+void MidiInputDevice::emitBeatClock(uchar cmd)
+{
+    switch (cmd)
+    {
+    case MIDI_BEAT_CLOCK:
+        emit beatClock(uid(), QLCIOPlugin::BeatClockPulse);
+        break;
+    case MIDI_BEAT_START:
+        emit beatClock(uid(), QLCIOPlugin::BeatClockStart);
+        break;
+    case MIDI_BEAT_CONTINUE:
+        emit beatClock(uid(), QLCIOPlugin::BeatClockContinue);
+        break;
+    case MIDI_BEAT_STOP:
+        emit beatClock(uid(), QLCIOPlugin::BeatClockStop);
+        break;
+    default:
+        break;
+    }
+}
+
+/*****************************************************************************
+ * MIDI Time Code
+ *****************************************************************************/
+
+void MidiInputDevice::processTimeCode(uchar data)
+{
+    int piece = (data >> 4) & 0x07;
+
+    // Pieces must come in order, from 0 to 7. Anything else (e.g. timecode
+    // running backwards) restarts the assembly.
+    if (piece != m_mtcNextPiece)
+    {
+        m_mtcNextPiece = 0;
+        if (piece != 0)
+            return;
+    }
+
+    m_mtcPieces[piece] = data & 0x0F;
+    m_mtcNextPiece = (piece + 1) % 8;
+
+    if (piece != 7)
+        return;
+
+    // The position is the one of the frame where piece 0 was sent,
+    // 7 quarter frames ago
+    emitTimeCode((m_mtcPieces[7] & 0x01) << 4 | m_mtcPieces[6],
+                 m_mtcPieces[5] << 4 | m_mtcPieces[4],
+                 m_mtcPieces[3] << 4 | m_mtcPieces[2],
+                 m_mtcPieces[1] << 4 | m_mtcPieces[0],
+                 (m_mtcPieces[7] >> 1) & 0x03, 7);
+}
+
+void MidiInputDevice::processSysEx(const uchar* data, int length)
+{
+    // Full frame: F0 7F <device> 01 01 hr mn sc fr F7
+    if (data == NULL || length < 10 || data[0] != MIDI_SYSEX ||
+        data[1] != 0x7F || data[3] != 0x01 || data[4] != 0x01)
+        return;
+
+    // A full frame is sent when locating: quarter frames start over
+    m_mtcNextPiece = 0;
+
+    emitTimeCode(data[5] & 0x1F, data[6] & 0x3F, data[7] & 0x3F, data[8] & 0x1F,
+                 (data[5] >> 5) & 0x03, 0);
+}
+
+void MidiInputDevice::emitTimeCode(int hours, int minutes, int seconds, int frames,
+                                   int rate, int quarterFrames)
+{
+    // 0: 24fps, 1: 25fps, 2: 29.97fps drop frame, 3: 30fps
+    static const int fps[] = { 24, 25, 30, 30 };
+
+    if (hours >= 24 || minutes >= 60 || seconds >= 60 || frames >= fps[rate])
+        return;
+
+    quint32 msecs = ((hours * 60 + minutes) * 60 + seconds) * 1000;
+    msecs += (frames * 4 + quarterFrames) * 250 / fps[rate];
+
+    emit timecode(uid(), msecs);
+}
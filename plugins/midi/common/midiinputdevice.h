@@ -32,8 +32,47 @@ public:
 
     void emitValueChanged(uint channel, uchar value);
 
+    /**
+     * Emit beatClock() for a MIDI beat clock message $cmd (MIDI_BEAT_CLOCK,
+     * MIDI_BEAT_START, MIDI_BEAT_CONTINUE or MIDI_BEAT_STOP). Called from
+     * the input thread for every message, including the clock pulses that
+     * are not passed on as input values.
+     */
+    void emitBeatClock(uchar cmd);
+
+    /**
+     * Process the data byte of a MIDI Time Code quarter frame message.
+     * Emits timecode() each time the eight pieces of a position have been
+     * received in order. Called from the input thread.
+     */
+    void processTimeCode(uchar data);
+
+    /**
+     * Process a system exclusive message of $length bytes, starting with
+     * MIDI_SYSEX. Emits timecode() for MIDI Time Code full frame messages.
+     * Called from the input thread.
+     */
+    void processSysEx(const uchar* data, int length);
+
+private:
+    /** Emit timecode() for the given SMPTE position and MTC rate code */
+    void emitTimeCode(int hours, int minutes, int seconds, int frames,
+                      int rate, int quarterFrames);
+
+private:
+    /** The pieces of the MTC position being received thru quarter frames */
+    uchar m_mtcPieces[8];
+    /** The next expected quarter frame piece */
+    int m_mtcNextPiece;
+
 signals:
     void valueChanged(const QVariant& uid, ushort channel, uchar value);
+
+    /** @see QLCIOPlugin::beatClock() */
+    void beatClock(const QVariant& uid, int event);
+
+    /** @see QLCIOPlugin::timecode() */
+    void timecode(const QVariant& uid, quint32 msecs);
 };
 
 #endif
@@ -203,6 +203,10 @@ void MidiPlugin::openInput(quint32 input)
         dev->open();
         connect(dev, SIGNAL(valueChanged(QVariant,ushort,uchar)),
                 this, SLOT(slotValueChanged(QVariant,ushort,uchar)));
+        connect(dev, SIGNAL(beatClock(QVariant,int)),
+                this, SLOT(slotBeatClock(QVariant,int)), Qt::DirectConnection);
+        connect(dev, SIGNAL(timecode(QVariant,quint32)),
+                this, SLOT(slotTimecode(QVariant,quint32)), Qt::DirectConnection);
     }
 }
 
@@ -216,6 +220,10 @@ void MidiPlugin::closeInput(quint32 input)
         dev->close();
         disconnect(dev, SIGNAL(valueChanged(QVariant,ushort,uchar)),
                    this, SLOT(slotValueChanged(QVariant,ushort,uchar)));
+        disconnect(dev, SIGNAL(beatClock(QVariant,int)),
+                   this, SLOT(slotBeatClock(QVariant,int)));
+        disconnect(dev, SIGNAL(timecode(QVariant,quint32)),
+                   this, SLOT(slotTimecode(QVariant,quint32)));
     }
 }
 
@@ -324,6 +332,30 @@ void MidiPlugin::slotValueChanged(const QVariant& uid, ushort channel, uchar val
     }
 }
 
+void MidiPlugin::slotBeatClock(const QVariant& uid, int event)
+{
+    for (int i = 0; i < m_enumerator->inputDevices().size(); i++)
+    {
+        if (m_enumerator->inputDevices().at(i)->uid() == uid)
+        {
+            emit beatClock(i, event);
+            break;
+        }
+    }
+}
+
+void MidiPlugin::slotTimecode(const QVariant& uid, quint32 msecs)
+{
+    for (int i = 0; i < m_enumerator->inputDevices().size(); i++)
+    {
+        if (m_enumerator->inputDevices().at(i)->uid() == uid)
+        {
+            emit timecode(i, msecs);
+            break;
+        }
+    }
+}
+
 /*****************************************************************************
  * Configuration
  *****************************************************************************/
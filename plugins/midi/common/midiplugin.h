@@ -120,6 +120,12 @@ private slots:
     /** Catch MIDI input device valueChanged signals */
     void slotValueChanged(const QVariant& uid, ushort channel, uchar value);
 
+    /** Catch MIDI input device beatClock signals, in the input thread */
+    void slotBeatClock(const QVariant& uid, int event);
+
+    /** Catch MIDI input device timecode signals, in the input thread */
+    void slotTimecode(const QVariant& uid, quint32 msecs);
+
     /*************************************************************************
      * Configuration
      *************************************************************************/
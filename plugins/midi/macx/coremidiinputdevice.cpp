@@ -53,7 +53,11 @@ static void MidiInProc(const MIDIPacketList* pktList, void* readProcRefCon,
             if (!MIDI_IS_CMD(cmd))
                 continue; // Not a MIDI command. Skip to the next byte.
             if (cmd == MIDI_SYSEX)
-                break; // Sysex reserves the whole packet. Not interested.
+            {
+                // Sysex reserves the whole packet. Only MTC full frames are interesting.
+                self->processSysEx(packet->data, packet->length);
+                break;
+            }
 
             // 1 or 2 MIDI Data bytes
             if (packet->length > (i + 1) && !MIDI_IS_CMD(packet->data[i + 1]))
@@ -63,8 +67,15 @@ static void MidiInProc(const MIDIPacketList* pktList, void* readProcRefCon,
                     data2 = packet->data[++i];
             }
 
+            if (cmd == MIDI_TIME_CODE)
+            {
+                self->processTimeCode(data1);
+                continue;
+            }
+
             if (cmd >= MIDI_BEAT_CLOCK && cmd <= MIDI_BEAT_STOP)
             {
+                self->emitBeatClock(cmd);
                 if (self->processMBC(cmd) == false)
                     continue;
             }
@@ -38,8 +38,15 @@ static void CALLBACK MidiInProc(HMIDIIN hMidiIn, UINT wMsg,
         BYTE data1 = (dwParam1 & 0xFF00) >> 8;
         BYTE data2 = (dwParam1 & 0xFF0000) >> 16;
 
+        if (cmd == MIDI_TIME_CODE)
+        {
+            self->processTimeCode(data1);
+            return;
+        }
+
         if (cmd >= MIDI_BEAT_CLOCK && cmd <= MIDI_BEAT_STOP)
         {
+            self->emitBeatClock(cmd);
             if (self->processMBC(cmd) == false)
                 return;
         }
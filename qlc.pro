@@ -6,6 +6,7 @@ SUBDIRS      += hotplugmonitor
 SUBDIRS      += engine
 SUBDIRS      += ui
 SUBDIRS      += webaccess
+SUBDIRS      += webaccess/test
 SUBDIRS      += main
 SUBDIRS      += fixtures
 SUBDIRS      += gobos
@@ -36,6 +36,7 @@
 #include "functionselection.h"
 #include "functionmanager.h"
 #include "inputoutputmap.h"
+#include "tickprofilerview.h"
 #include "virtualconsole.h"
 #include "fixturemanager.h"
 #include "dmxdumpfactory.h"
@@ -53,11 +54,13 @@
 #include "qlcfixturedefcache.h"
 #include "qlcfixturedef.h"
 #include "qlcconfig.h"
+#include "workspacesnapshot.h"
 #include "qlcfile.h"
 
 #define SETTINGS_GEOMETRY "workspace/geometry"
 #define SETTINGS_WORKINGPATH "workspace/workingpath"
 #define SETTINGS_RECENTFILE "workspace/recent"
+#define SETTINGS_WORKSPACE_SNAPSHOT "workspace/snapshot"
 #define KXMLQLCWorkspaceWindow "CurrentWindow"
 
 #define MAX_RECENT_FILES    10
@@ -84,6 +87,7 @@ App::App()
     , m_modeToggleAction(NULL)
     , m_controlMonitorAction(NULL)
     , m_addressToolAction(NULL)
+    , m_tickProfilerAction(NULL)
     , m_controlFullScreenAction(NULL)
     , m_controlBlackoutAction(NULL)
     , m_controlPanicAction(NULL)
@@ -397,7 +401,7 @@ void App::initDoc()
     connect(m_doc, SIGNAL(modeChanged(Doc::Mode)), this, SLOT(slotModeChanged(Doc::Mode)));
 
     /* Load user fixtures first so that they override system fixtures */
-    m_doc->fixtureDefCache()->load(QLCFixtureDefCache::userDefinitionDirectory());
+    m_doc->fixtureDefCache()->load(QLCFixtureDefCache::userDefinitionDirectory(), true);
     //m_doc->fixtureDefCache()->load(QLCFixtureDefCache::systemDefinitionDirectory());
     m_doc->fixtureDefCache()->loadMap(QLCFixtureDefCache::systemDefinitionDirectory());
 
@@ -564,6 +568,9 @@ void App::initActions()
     m_addressToolAction = new QAction(QIcon(":/diptool.png"), tr("Address Tool"), this);
     connect(m_addressToolAction, SIGNAL(triggered()), this, SLOT(slotAddressTool()));
 
+    m_tickProfilerAction = new QAction(QIcon(":/speed.png"), tr("Tick Profiler"), this);
+    connect(m_tickProfilerAction, SIGNAL(triggered()), this, SLOT(slotTickProfiler()));
+
     m_controlBlackoutAction = new QAction(QIcon(":/blackout.png"), tr("Toggle &Blackout"), this);
     m_controlBlackoutAction->setCheckable(true);
     connect(m_controlBlackoutAction, SIGNAL(triggered(bool)), this, SLOT(slotControlBlackout()));
@@ -633,6 +640,7 @@ void App::initToolBar()
     m_toolbar->addSeparator();
     m_toolbar->addAction(m_controlMonitorAction);
     m_toolbar->addAction(m_addressToolAction);
+    m_toolbar->addAction(m_tickProfilerAction);
     m_toolbar->addSeparator();
     m_toolbar->addAction(m_controlFullScreenAction);
     m_toolbar->addAction(m_helpIndexAction);
@@ -963,6 +971,11 @@ void App::slotAddressTool()
     at.exec();
 }
 
+void App::slotTickProfiler()
+{
+    TickProfilerView::createAndShow(this, m_doc);
+}
+
 void App::slotControlBlackout()
 {
     m_doc->inputOutputMap()->setBlackout(!m_doc->inputOutputMap()->blackout());
@@ -1151,56 +1164,84 @@ QString App::fileName() const
 
 QFile::FileError App::loadXML(const QString& fileName)
 {
-    QFile::FileError retval = QFile::NoError;
+    QFile file(fileName);
+    if (file.open(QIODevice::ReadOnly) == false)
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to open file:" << fileName;
+        return file.error();
+    }
 
-    QDomDocument doc(QLCFile::readXML(fileName));
-    if (doc.isNull() == false)
+    /* Stream the file instead of building the DOM of the whole workspace */
+    QXmlStreamReader reader(&file);
+
+    /* Check the document type before loading anything. As with the DOM
+       loader, a file without the Workspace doctype is not a workspace. */
+    bool workspace = false;
+    while (reader.atEnd() == false && reader.isStartElement() == false)
     {
-        if (doc.doctype().name() == KXMLQLCWorkspace)
-        {
-            if (loadXML(doc) == false)
-            {
-                retval = QFile::ReadError;
-            }
-            else
-            {
-                setFileName(fileName);
-                m_doc->resetModified();
-                retval = QFile::NoError;
-            }
-        }
-        else
-        {
-            retval = QFile::ReadError;
-        }
+        reader.readNext();
+        if (reader.isDTD() == true)
+            workspace = (reader.dtdName() == QLatin1String(KXMLQLCWorkspace));
     }
 
-    return retval;
+    if (workspace == false)
+        return QFile::ReadError;
+
+    /* Restore the engine from the binary snapshot when it's up to date,
+       so that only the user interface parts are read from the XML */
+    bool snapshot = false;
+    QSettings settings;
+    if (settings.value(SETTINGS_WORKSPACE_SNAPSHOT, true).toBool() == true)
+        snapshot = WorkspaceSnapshot::load(m_doc, fileName);
+
+    if (loadXML(reader, false, !snapshot) == false)
+        return QFile::ReadError;
+
+    setFileName(fileName);
+    m_doc->resetModified();
+
+    return QFile::NoError;
 }
 
-bool App::loadXML(const QDomDocument& doc, bool goToConsole)
+bool App::loadXML(QXmlStreamReader& reader, bool goToConsole, bool loadEngine)
 {
     Q_ASSERT(m_doc != NULL);
 
-    QDomElement root = doc.documentElement();
-    if (root.tagName() != KXMLQLCWorkspace)
+    if (reader.isStartElement() == false && reader.readNextStartElement() == false)
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to read workspace:" << reader.errorString();
+        return false;
+    }
+
+    if (reader.name() != QLatin1String(KXMLQLCWorkspace))
     {
         qWarning() << Q_FUNC_INFO << "Workspace node not found";
         return false;
     }
 
-    QString activeWindowName = root.attribute(KXMLQLCWorkspaceWindow);
+    QString activeWindowName = reader.attributes().value(KXMLQLCWorkspaceWindow).toString();
 
-    QDomNode node = root.firstChild();
-    while (node.isNull() == false)
+    while (reader.readNextStartElement() == true)
     {
-        QDomElement tag = node.toElement();
-
-        if (tag.tagName() == KXMLQLCEngine)
+        if (reader.name() == QLatin1String(KXMLQLCEngine))
         {
-            m_doc->loadXML(tag);
+            if (loadEngine == true)
+                m_doc->loadXML(reader);
+            else
+                reader.skipCurrentElement();
+            continue;
         }
-        else if (tag.tagName() == KXMLQLCVirtualConsole)
+        else if (reader.name() == QLatin1String(KXMLQLCCreator))
+        {
+            /* Ignore creator information */
+            reader.skipCurrentElement();
+            continue;
+        }
+
+        QDomDocument element = QLCFile::readXMLElement(reader);
+        QDomElement tag = element.documentElement();
+
+        if (tag.tagName() == KXMLQLCVirtualConsole)
         {
             VirtualConsole::instance()->loadXML(tag);
         }
@@ -1218,16 +1259,17 @@ bool App::loadXML(const QDomDocument& doc, bool goToConsole)
             /* Legacy support code, nowadays in Doc */
             Function::loader(tag, m_doc);
         }
-        else if (tag.tagName() == KXMLQLCCreator)
-        {
-            /* Ignore creator information */
-        }
         else
         {
             qWarning() << Q_FUNC_INFO << "Unknown Workspace tag:" << tag.tagName();
         }
+    }
 
-        node = node.nextSibling();
+    if (reader.hasError() == true)
+    {
+        qWarning() << Q_FUNC_INFO << "Error loading workspace:" << reader.errorString()
+                   << ", line:" << reader.lineNumber() << ", col:" << reader.columnNumber();
+        return false;
     }
 
     if (goToConsole == true)
@@ -1305,6 +1347,12 @@ QFile::FileError App::saveXML(const QString& fileName)
 
     file.close();
 
+    /* Write the binary snapshot after the workspace file, so that it's newer */
+    QSettings settings;
+    if (retval == QFile::NoError &&
+        settings.value(SETTINGS_WORKSPACE_SNAPSHOT, true).toBool() == true)
+        WorkspaceSnapshot::save(m_doc, fileName);
+
     return retval;
 }
 
@@ -1316,9 +1364,8 @@ void App::slotLoadDocFromMemory(QString xmlData)
     /* Clear existing document data */
     clearDocument();
 
-    QDomDocument doc;
-    doc.setContent(xmlData);
-    loadXML(doc, true);
+    QXmlStreamReader reader(xmlData);
+    loadXML(reader, true);
 }
 
 void App::slotSaveAutostart(QString fileName)
@@ -29,6 +29,7 @@
 #include "qlcfixturedefcache.h"
 #include "doc.h"
 
+class QXmlStreamReader;
 class QProgressDialog;
 class QDomDocument;
 class QDomElement;
@@ -47,8 +48,6 @@ class App;
  * @{
  */
 
-#define KXMLQLCWorkspace "Workspace"
-
 class App : public QMainWindow
 {
     Q_OBJECT
@@ -130,6 +129,7 @@ public slots:
 
     void slotControlMonitor();
     void slotAddressTool();
+    void slotTickProfiler();
     void slotControlFullScreen();
     void slotControlFullScreen(bool usingGeometry);
     void slotControlBlackout();
@@ -154,6 +154,7 @@ private:
     QAction* m_modeToggleAction;
     QAction* m_controlMonitorAction;
     QAction* m_addressToolAction;
+    QAction* m_tickProfilerAction;
     QAction* m_controlFullScreenAction;
     QAction* m_controlBlackoutAction;
     QAction* m_controlPanicAction;
@@ -202,11 +203,17 @@ public:
     QFile::FileError loadXML(const QString& fileName);
 
     /**
-     * Load workspace contents from the given XML document.
+     * Load workspace contents from the given XML stream. Only the element
+     * currently being loaded is kept in memory as a DOM fragment.
      *
-     * @param doc The XML document to load from.
+     * @param reader The XML stream to load from, positioned before or on
+     *               the Workspace start element.
+     * @param goToConsole Force the Virtual Console as the active window
+     * @param loadEngine false to skip the Engine contents, when they have
+     *                   already been loaded from a workspace snapshot
      */
-    bool loadXML(const QDomDocument& doc, bool goToConsole = false);
+    bool loadXML(QXmlStreamReader& reader, bool goToConsole = false,
+                 bool loadEngine = true);
 
     /**
      * Save workspace contents to a file with the given name. Changes the
@@ -146,13 +146,13 @@ VCWidget * AudioBar::widget()
     return m_widget;
 }
 
-void AudioBar::checkFunctionThresholds(Doc *doc)
+void AudioBar::checkFunctionThresholds(Doc *doc, uchar value)
 {
     if (m_function == NULL)
         return;
-    if (m_value >= m_maxThreshold && m_function->isRunning() == false)
+    if (value >= m_maxThreshold && m_function->isRunning() == false)
         m_function->start(doc->masterTimer());
-    else if (m_value < m_minThreshold && m_function->isRunning() == true)
+    else if (value < m_minThreshold && m_function->isRunning() == true)
         m_function->stop();
 }
 
@@ -73,7 +73,8 @@ public:
     /** Get widget, sets m_widget to proper value if necessary */
     VCWidget * widget();
 
-    void checkFunctionThresholds(Doc *doc);
+    /** Start or stop the attached Function when $value crosses the thresholds */
+    void checkFunctionThresholds(Doc *doc, uchar value);
     void checkWidgetFunctionality();
 
     void debugInfo();
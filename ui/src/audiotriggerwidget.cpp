@@ -73,9 +73,13 @@ void AudioTriggerWidget::displaySpectrum(double *spectrumData, double maxMagnitu
 {
     m_volumeBarHeight = (power * m_spectrumHeight) / 0x7FFF;
     for (int i = 0; i < m_barsNumber; i++)
-        m_spectrumBands[i] =  (m_volumeBarHeight * spectrumData[i]) / maxMagnitude;
+    {
+        if (maxMagnitude == 0)
+            m_spectrumBands[i] = 0;
+        else
+            m_spectrumBands[i] = (m_volumeBarHeight * spectrumData[i]) / maxMagnitude;
+    }
 
-    qDebug() << "[displaySpectrum] power: " << power << ", first bar: " << m_spectrumBands[0];
     update();
 }
 
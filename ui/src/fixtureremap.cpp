@@ -27,6 +27,7 @@
 #include "qlcfixturemode.h"
 #include "qlcfixturedef.h"
 #include "channelsgroup.h"
+#include "channelremap.h"
 #include "fixtureremap.h"
 #include "remapwidget.h"
 #include "qlcchannel.h"
@@ -77,8 +78,8 @@ FixtureRemap::FixtureRemap(Doc *doc, QWidget *parent)
 
     m_targetDoc = new Doc(this);
     /* Load user fixtures first so that they override system fixtures */
-    m_targetDoc->fixtureDefCache()->load(QLCFixtureDefCache::userDefinitionDirectory());
-    m_targetDoc->fixtureDefCache()->load(QLCFixtureDefCache::systemDefinitionDirectory());
+    m_targetDoc->fixtureDefCache()->load(QLCFixtureDefCache::userDefinitionDirectory(), true);
+    m_targetDoc->fixtureDefCache()->loadMap(QLCFixtureDefCache::systemDefinitionDirectory());
 
     m_sourceTree->setIconSize(QSize(24, 24));
     m_sourceTree->setAllColumnsShowFocus(true);
@@ -576,27 +577,6 @@ void FixtureRemap::slotSourceSelectionChanged()
         m_cloneButton->setEnabled(false);
 }
 
-QList<SceneValue> FixtureRemap::remapSceneValues(QList<SceneValue> funcList,
-                                    QList<SceneValue> &srcList,
-                                    QList<SceneValue> &tgtList)
-{
-    QList <SceneValue> newValuesList;
-    foreach(SceneValue val, funcList)
-    {
-        for( int v = 0; v < srcList.count(); v++)
-        {
-            if (val == srcList.at(v))
-            {
-                SceneValue tgtVal = tgtList.at(v);
-                //qDebug() << "[Scene] Remapping" << val.fxi << val.channel << " to " << tgtVal.fxi << tgtVal.channel;
-                newValuesList.append(SceneValue(tgtVal.fxi, tgtVal.channel, val.value));
-            }
-        }
-    }
-    qSort(newValuesList.begin(), newValuesList.end());
-    return newValuesList;
-}
-
 QList<VCWidget *> FixtureRemap::getVCChildren(VCWidget *obj)
 {
     QList<VCWidget *> list;
@@ -618,8 +598,7 @@ void FixtureRemap::accept()
     /* **********************************************************************
      * 1 - create a map of SceneValues from the fixtures channel associations
      * ********************************************************************** */
-    QList<SceneValue> sourceList;
-    QList<SceneValue> targetList;
+    ChannelRemap remap(m_doc);
 
     foreach (RemapInfo info, m_remapList)
     {
@@ -629,10 +608,7 @@ void FixtureRemap::accept()
         quint32 tgtFxiID = info.target->text(KColumnID).toUInt();
         quint32 tgtChIdx = info.target->text(KColumnChIdx).toUInt();
 
-        SceneValue srcVal(srcFxiID, srcChIdx);
-        SceneValue tgtVal(tgtFxiID, tgtChIdx);
-        sourceList.append(srcVal);
-        targetList.append(tgtVal);
+        remap.add(SceneValue(srcFxiID, srcChIdx), SceneValue(tgtFxiID, tgtChIdx));
     }
 
     /* **********************************************************************
@@ -640,6 +616,8 @@ void FixtureRemap::accept()
      * ********************************************************************** */
     QProgressDialog progress(tr("This might take a while..."), tr("Cancel"), 0, 100, this);
     progress.setWindowModality(Qt::WindowModal);
+    connect(&remap, SIGNAL(progressChanged(int)), &progress, SLOT(setValue(int)));
+    connect(&progress, SIGNAL(canceled()), &remap, SLOT(cancel()));
     progress.show();
 
     /* **********************************************************************
@@ -648,110 +626,12 @@ void FixtureRemap::accept()
     m_doc->replaceFixtures(m_targetDoc->fixtures());
 
     /* **********************************************************************
-     * 4 - remap channel groups
+     * 4 - remap channel groups and project functions
      * ********************************************************************** */
-    foreach (ChannelsGroup *grp, m_doc->channelsGroups())
-    {
-        QList<SceneValue> grpChannels = grp->getChannels();
-        // this is crucial: here all the "unmapped" channels will be lost forever !
-        grp->resetChannels();
-        QList <SceneValue> newList = remapSceneValues(grpChannels, sourceList, targetList);
-        foreach (SceneValue val, newList)
-            grp->addChannel(val.fxi, val.channel);
-    }
+    remap.remapDoc();
 
     /* **********************************************************************
-     * 5 - scan project functions and perform remapping
-     * ********************************************************************** */
-    int funcNum = m_doc->functions().count();
-    int f = 0;
-    foreach (Function *func, m_doc->functions())
-    {
-        switch (func->type())
-        {
-            case Function::Scene:
-            {
-                Scene *s = qobject_cast<Scene*>(func);
-                qDebug() << "Analyzing Scene #" << s->id();
-                QList <SceneValue> newList = remapSceneValues(s->values(), sourceList, targetList);
-                // this is crucial: here all the "unmapped" channels will be lost forever !
-                s->clear();
-                for (int i = 0; i < newList.count(); i++)
-                    s->setValue(newList.at(i));
-            }
-            break;
-            case Function::Chaser:
-            {
-                Chaser *c = qobject_cast<Chaser*>(func);
-                if (c->isSequence() == true)
-                {
-                    for (int idx = 0; idx < c->stepsCount(); idx++)
-                    {
-                        ChaserStep cs = c->stepAt(idx);
-                        QList <SceneValue> newList = remapSceneValues(cs.values, sourceList, targetList);
-                        //qDebug() << "Step" << idx << "remapped" << cs.values.count() << "to" << newList.count();
-                        // this is crucial: here all the "unmapped" channels will be lost forever !
-                        cs.values.clear();
-                        cs.values = newList;
-                        c->replaceStep(cs, idx);
-                    }
-                }
-            }
-            break;
-            case Function::EFX:
-            {
-                EFX *e = qobject_cast<EFX*>(func);
-                // make a copy of this EFX fixtures list
-                QList <EFXFixture*> fixListCopy;
-                foreach(EFXFixture *efxFix, e->fixtures())
-                {
-                    EFXFixture* ef = new EFXFixture(e);
-                    ef->copyFrom(efxFix);
-                    fixListCopy.append(ef);
-                }
-                // this is crucial: here all the "unmapped" fixtures will be lost forever !
-                e->removeAllFixtures();
-
-                foreach( EFXFixture *efxFix, fixListCopy)
-                {
-                    quint32 fxID = efxFix->head().fxi;
-                    for (int i = 0; i < sourceList.count(); i++)
-                    {
-                        SceneValue val = sourceList.at(i);
-                        if (val.fxi == fxID)
-                        {
-                            SceneValue tgtVal = targetList.at(i);
-                            Fixture *docFix = m_doc->fixture(tgtVal.fxi);
-                            quint32 fxCh = tgtVal.channel;
-                            const QLCChannel *chan = docFix->channel(fxCh);
-                            if (chan->group() == QLCChannel::Pan ||
-                                chan->group() == QLCChannel::Tilt)
-                            {
-                                EFXFixture* ef = new EFXFixture(e);
-                                ef->copyFrom(efxFix);
-                                ef->setHead(GroupHead(tgtVal.fxi)); // TODO!!! head!!!
-                                if (e->addFixture(ef) == false)
-                                    delete ef;
-                                qDebug() << "EFX remap" << val.fxi << "to" << tgtVal.fxi;
-                            }
-                        }
-                    }
-                }
-                fixListCopy.clear();
-            }
-            break;
-            default:
-            break;
-        }
-        if(progress.wasCanceled())
-            break;
-        f++;
-        progress.setValue((f * 100) / funcNum);
-        QApplication::processEvents();
-    }
-
-    /* **********************************************************************
-     * 6 - remap Virtual Console widgets
+     * 5 - remap Virtual Console widgets
      * ********************************************************************** */
     VCFrame* contents = VirtualConsole::instance()->contents();
     QList<VCWidget *> widgetsList = getVCChildren((VCWidget *)contents);
@@ -764,20 +644,11 @@ void FixtureRemap::accept()
             VCSlider *slider = (VCSlider *)object;
             if (slider->sliderMode() == VCSlider::Level)
             {
-                QList <VCSlider::LevelChannel> slChannels = slider->levelChannels();
-                QList <SceneValue> newChannels;
+                QList <SceneValue> slChannels;
+                foreach (VCSlider::LevelChannel chan, slider->levelChannels())
+                    slChannels.append(SceneValue(chan.fixture, chan.channel));
 
-                foreach (VCSlider::LevelChannel chan, slChannels)
-                {
-                    for( int v = 0; v < sourceList.count(); v++)
-                    {
-                        SceneValue val = sourceList.at(v);
-                        if (val.fxi == chan.fixture && val.channel == chan.channel)
-                        {
-                            newChannels.append(SceneValue(targetList.at(v).fxi, targetList.at(v).channel));
-                        }
-                    }
-                }
+                QList <SceneValue> newChannels = remap.remap(slChannels);
                 // this is crucial: here all the "unmapped" channels will be lost forever !
                 slider->clearLevelChannels();
                 foreach (SceneValue rmpChan, newChannels)
@@ -791,7 +662,7 @@ void FixtureRemap::accept()
             {
                 if (bar->m_type == AudioBar::DMXBar)
                 {
-                    QList <SceneValue> newList = remapSceneValues(bar->m_dmxChannels, sourceList, targetList);
+                    QList <SceneValue> newList = remap.remap(bar->m_dmxChannels);
                     // this is crucial: here all the "unmapped" channels will be lost forever !
                     bar->attachDmxChannels(m_doc, newList);
                 }
@@ -804,24 +675,12 @@ void FixtureRemap::accept()
             foreach (VCXYPadFixture fix, xypad->fixtures())
             {
                 quint32 srxFxID = fix.head().fxi; // TODO: heads !!
-                for (int i = 0; i < sourceList.count(); i++)
+                foreach (quint32 tgtFxID, remap.positionTargets(srxFxID))
                 {
-                    SceneValue val = sourceList.at(i);
-                    if (val.fxi == srxFxID)
-                    {
-                        SceneValue tgtVal = targetList.at(i);
-                        Fixture *docFix = m_doc->fixture(tgtVal.fxi);
-                        quint32 fxCh = tgtVal.channel;
-                        const QLCChannel *chan = docFix->channel(fxCh);
-                        if (chan->group() == QLCChannel::Pan ||
-                            chan->group() == QLCChannel::Tilt)
-                        {
-                            VCXYPadFixture tgtFix(m_doc);
-                            GroupHead head(tgtVal.fxi, 0);
-                            tgtFix.setHead(head);
-                            copyFixtures.append(tgtFix);
-                        }
-                    }
+                    VCXYPadFixture tgtFix(m_doc);
+                    GroupHead head(tgtFxID, 0);
+                    tgtFix.setHead(head);
+                    copyFixtures.append(tgtFix);
                 }
             }
             // this is crucial: here all the "unmapped" fixtures will be lost forever !
@@ -832,7 +691,7 @@ void FixtureRemap::accept()
     }
 
     /* **********************************************************************
-     * 7 - save the remapped project into a new file
+     * 6 - save the remapped project into a new file
      * ********************************************************************** */
     App *mainApp = (App *)m_doc->parent();
     mainApp->setFileName(m_targetProjectLabel->text());
@@ -60,10 +60,6 @@ protected:
 
     void fillFixturesTree(Doc *doc, QTreeWidget *tree);
 
-    QList<SceneValue> remapSceneValues(QList<SceneValue> funcList,
-                                       QList<SceneValue> &srcList,
-                                       QList<SceneValue> &tgtList);
-
     QList<VCWidget *> getVCChildren(VCWidget *obj);
 
 protected slots:
@@ -24,6 +24,9 @@
 #include <QSpacerItem>
 #include <QByteArray>
 #include <QToolBar>
+#include <QSpinBox>
+#include <QTimer>
+#include <QLabel>
 #include <QAction>
 #include <QFont>
 #include <QIcon>
@@ -32,6 +35,7 @@
 #include "monitorfixture.h"
 #include "monitorlayout.h"
 #include "monitor.h"
+#include "qlcmacros.h"
 #include "apputil.h"
 #include "doc.h"
 
@@ -41,6 +45,10 @@
 #define SETTINGS_FONT "monitor/font"
 #define SETTINGS_VALUESTYLE "monitor/valuestyle"
 #define SETTINGS_CHANNELSTYLE "monitor/channelstyle"
+#define SETTINGS_UPDATERATE "monitor/updaterate"
+
+#define DEFAULT_UPDATE_RATE 20
+#define MAX_UPDATE_RATE 50
 
 Monitor* Monitor::s_instance = NULL;
 
@@ -51,6 +59,8 @@ Monitor* Monitor::s_instance = NULL;
 Monitor::Monitor(QWidget* parent, Doc* doc, Qt::WindowFlags f)
     : QWidget(parent, f)
     , m_doc(doc)
+    , m_updateTimer(NULL)
+    , m_updateRate(DEFAULT_UPDATE_RATE)
 {
     Q_ASSERT(doc != NULL);
 
@@ -95,14 +105,26 @@ Monitor::Monitor(QWidget* parent, Doc* doc, Qt::WindowFlags f)
     connect(m_doc, SIGNAL(fixtureRemoved(quint32)),
             this, SLOT(slotFixtureRemoved(quint32)));
 
+    /* Universe values are only stored when written and displayed at
+       the update rate */
     connect(m_doc->inputOutputMap(), SIGNAL(universesWritten(int, const QByteArray&)),
-            this, SLOT(slotUniversesWritten(int, const QByteArray&)));
+            this, SLOT(slotUniversesWritten(int, const QByteArray&)),
+            Qt::DirectConnection);
+
+    m_updateTimer = new QTimer(this);
+    connect(m_updateTimer, SIGNAL(timeout()), this, SLOT(slotUpdateTimeout()));
+    m_updateTimer->start(1000 / m_updateRate);
 }
 
 Monitor::~Monitor()
 {
-    disconnect(m_doc->inputOutputMap(), SIGNAL(universesWritten(const QByteArray&)),
-               this, SLOT(slotUniversesWritten(const QByteArray&)));
+    disconnect(m_doc->inputOutputMap(), SIGNAL(universesWritten(int, const QByteArray&)),
+               this, SLOT(slotUniversesWritten(int, const QByteArray&)));
+
+    /* Wait for a snapshot update possibly in progress */
+    m_snapshotMutex.lock();
+    m_snapshot.clear();
+    m_snapshotMutex.unlock();
 
     while (m_monitorFixtures.isEmpty() == false)
         delete m_monitorFixtures.takeFirst();
@@ -146,6 +168,13 @@ void Monitor::loadSettings()
         m_valueStyle = ValueStyle(var.toInt());
     else
         m_valueStyle = DMXValues;
+
+    // Load update rate
+    var = settings.value(SETTINGS_UPDATERATE);
+    if (var.isValid() == true)
+        m_updateRate = CLAMP(var.toInt(), 1, MAX_UPDATE_RATE);
+    else
+        m_updateRate = DEFAULT_UPDATE_RATE;
 }
 
 void Monitor::saveSettings()
@@ -155,6 +184,7 @@ void Monitor::saveSettings()
     settings.setValue(SETTINGS_FONT, m_monitorWidget->font().toString());
     settings.setValue(SETTINGS_VALUESTYLE, valueStyle());
     settings.setValue(SETTINGS_CHANNELSTYLE, channelStyle());
+    settings.setValue(SETTINGS_UPDATERATE, m_updateRate);
 }
 
 void Monitor::createAndShow(QWidget* parent, Doc* doc)
@@ -277,6 +307,19 @@ void Monitor::initToolBar()
     group->addAction(action);
     if (valueStyle() == PercentageValues)
         action->setChecked(true);
+
+    toolBar->addSeparator();
+
+    /* Display update rate */
+    toolBar->addWidget(new QLabel(tr("Update rate"), toolBar));
+    QSpinBox* rateSpin = new QSpinBox(toolBar);
+    rateSpin->setRange(1, MAX_UPDATE_RATE);
+    rateSpin->setSuffix(tr(" Hz"));
+    rateSpin->setToolTip(tr("Number of times per second the values are refreshed"));
+    rateSpin->setValue(m_updateRate);
+    connect(rateSpin, SIGNAL(valueChanged(int)),
+            this, SLOT(slotUpdateRateChanged(int)));
+    toolBar->addWidget(rateSpin);
 }
 
 void Monitor::slotChooseFont()
@@ -297,6 +340,13 @@ void Monitor::slotChannelStyleTriggered()
     emit channelStyleChanged(channelStyle());
 }
 
+void Monitor::slotUpdateRateChanged(int rate)
+{
+    m_updateRate = CLAMP(rate, 1, MAX_UPDATE_RATE);
+    if (m_updateTimer != NULL)
+        m_updateTimer->start(1000 / m_updateRate);
+}
+
 void Monitor::slotValueStyleTriggered()
 {
     QAction* action = qobject_cast<QAction*> (QObject::sender());
@@ -375,7 +425,27 @@ void Monitor::slotFixtureRemoved(quint32 fxi_id)
 
 void Monitor::slotUniversesWritten(int index, const QByteArray& ua)
 {
-    QListIterator <MonitorFixture*> it(m_monitorFixtures);
-    while (it.hasNext() == true)
-        it.next()->updateValues(index, ua);
+    /* QByteArray is implicitly shared, so this doesn't copy any data */
+    QMutexLocker locker(&m_snapshotMutex);
+    m_snapshot[index] = ua;
+}
+
+void Monitor::slotUpdateTimeout()
+{
+    QHash <int, QByteArray> snapshot;
+
+    m_snapshotMutex.lock();
+    snapshot = m_snapshot;
+    m_snapshot.clear();
+    m_snapshotMutex.unlock();
+
+    QHashIterator <int, QByteArray> uit(snapshot);
+    while (uit.hasNext() == true)
+    {
+        uit.next();
+
+        QListIterator <MonitorFixture*> it(m_monitorFixtures);
+        while (it.hasNext() == true)
+            it.next()->updateValues(uit.key(), uit.value());
+    }
 }
@@ -20,7 +20,9 @@
 #ifndef MONITOR_H
 #define MONITOR_H
 
+#include <QByteArray>
 #include <QWidget>
+#include <QMutex>
 #include <QHash>
 #include <QList>
 
@@ -104,6 +106,9 @@ protected slots:
     /** Menu action slot for value style selection */
     void slotValueStyleTriggered();
 
+    /** Tool bar slot for display update rate changes */
+    void slotUpdateRateChanged(int rate);
+
     /********************************************************************
      * Monitor Fixtures
      ********************************************************************/
@@ -125,9 +130,16 @@ protected slots:
     /** Slot for fixture removals (to remove the fixture from layout) */
     void slotFixtureRemoved(quint32 fxi_id);
 
-    /** Slot for getting the latest values from OutputMap */
+    /**
+     * Slot for getting the latest values from InputOutputMap. This is
+     * called directly from the MasterTimer thread and only stores the
+     * values in a snapshot that is displayed by slotUpdateTimeout().
+     */
     void slotUniversesWritten(int index, const QByteArray& ua);
 
+    /** Display the universe values written since the last update */
+    void slotUpdateTimeout();
+
 signals:
     void channelStyleChanged(Monitor::ChannelStyle style);
     void valueStyleChanged(Monitor::ValueStyle style);
@@ -137,6 +149,14 @@ protected:
     QWidget* m_monitorWidget;
     MonitorLayout* m_monitorLayout;
     QList <MonitorFixture*> m_monitorFixtures;
+
+    /** Timer that refreshes the displayed values at m_updateRate Hz */
+    QTimer* m_updateTimer;
+    int m_updateRate;
+
+    /** Latest universe values not yet displayed, by universe index */
+    QHash <int, QByteArray> m_snapshot;
+    QMutex m_snapshotMutex;
 };
 
 /** @} */
@@ -0,0 +1,212 @@
+/*
+  Q Light Controller Plus
+  monitorchannelgrid.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QFontMetrics>
+#include <QPaintEvent>
+#include <QPainter>
+#include <QEvent>
+#include <cmath>
+
+#include "monitorchannelgrid.h"
+#include "qlcmacros.h"
+
+#define CELL_MARGIN 3
+
+MonitorChannelGrid::MonitorChannelGrid(QWidget* parent)
+    : QWidget(parent)
+    , m_firstChannelNumber(1)
+    , m_valueStyle(Monitor::DMXValues)
+{
+    setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
+}
+
+MonitorChannelGrid::~MonitorChannelGrid()
+{
+}
+
+/****************************************************************************
+ * Channels
+ ****************************************************************************/
+
+void MonitorChannelGrid::setChannelCount(int count)
+{
+    m_values.fill(0, qMax(0, count));
+    updateGeometry();
+    update();
+}
+
+int MonitorChannelGrid::channelCount() const
+{
+    return m_values.size();
+}
+
+void MonitorChannelGrid::setFirstChannelNumber(int number)
+{
+    if (number == m_firstChannelNumber)
+        return;
+
+    m_firstChannelNumber = number;
+    update(0, 0, width(), cellSize().height());
+}
+
+int MonitorChannelGrid::firstChannelNumber() const
+{
+    return m_firstChannelNumber;
+}
+
+QString MonitorChannelGrid::channelText(int channel) const
+{
+    QString str;
+    return str.sprintf("%.3d", m_firstChannelNumber + channel);
+}
+
+/****************************************************************************
+ * Values
+ ****************************************************************************/
+
+int MonitorChannelGrid::setValues(const QByteArray& universe, int address)
+{
+    int changed = 0;
+    int count = qMin(m_values.size(), universe.size() - address);
+    const char* src = universe.constData() + address;
+    char* dst = m_values.data();
+
+    for (int i = 0; i < count; i++)
+    {
+        if (dst[i] == src[i])
+            continue;
+
+        dst[i] = src[i];
+        update(valueRect(i));
+        changed++;
+    }
+
+    return changed;
+}
+
+uchar MonitorChannelGrid::value(int channel) const
+{
+    if (channel < 0 || channel >= m_values.size())
+        return 0;
+
+    return uchar(m_values.at(channel));
+}
+
+QString MonitorChannelGrid::valueText(int channel) const
+{
+    QString str;
+    uchar val = value(channel);
+
+    if (m_valueStyle == Monitor::DMXValues)
+        return str.sprintf("%.3d", val);
+    else
+        return str.sprintf("%.3d", int(ceil(SCALE(qreal(val),
+                                                  qreal(0), qreal(UCHAR_MAX),
+                                                  qreal(0), qreal(100)))));
+}
+
+void MonitorChannelGrid::setValueStyle(Monitor::ValueStyle style)
+{
+    if (style == m_valueStyle)
+        return;
+
+    m_valueStyle = style;
+    QSize cell = cellSize();
+    update(0, cell.height(), width(), cell.height());
+}
+
+Monitor::ValueStyle MonitorChannelGrid::valueStyle() const
+{
+    return m_valueStyle;
+}
+
+/****************************************************************************
+ * Painting
+ ****************************************************************************/
+
+QSize MonitorChannelGrid::cellSize() const
+{
+    QFont bold(font());
+    bold.setBold(true);
+    QFontMetrics fm(bold);
+
+    return QSize(fm.width("000") + 2 * CELL_MARGIN, fm.height() + CELL_MARGIN);
+}
+
+QRect MonitorChannelGrid::valueRect(int channel) const
+{
+    QSize cell = cellSize();
+    return QRect(channel * cell.width(), cell.height(), cell.width(), cell.height());
+}
+
+QSize MonitorChannelGrid::sizeHint() const
+{
+    QSize cell = cellSize();
+    return QSize(cell.width() * m_values.size(), cell.height() * 2);
+}
+
+QSize MonitorChannelGrid::minimumSizeHint() const
+{
+    return sizeHint();
+}
+
+void MonitorChannelGrid::paintEvent(QPaintEvent* e)
+{
+    QPainter painter(this);
+    QSize cell = cellSize();
+
+    if (cell.width() <= 0 || m_values.isEmpty() == true)
+        return;
+
+    /* Paint only the columns intersecting the exposed area */
+    QRect exposed = e->rect();
+    int first = qMax(0, exposed.left() / cell.width());
+    int last = qMin(m_values.size() - 1, exposed.right() / cell.width());
+
+    QFont bold(font());
+    bold.setBold(true);
+
+    if (exposed.top() < cell.height())
+    {
+        painter.setFont(bold);
+        for (int i = first; i <= last; i++)
+        {
+            QRect rect(i * cell.width(), 0, cell.width(), cell.height());
+            painter.drawText(rect, Qt::AlignCenter, channelText(i));
+        }
+    }
+
+    if (exposed.bottom() >= cell.height())
+    {
+        painter.setFont(font());
+        for (int i = first; i <= last; i++)
+            painter.drawText(valueRect(i), Qt::AlignCenter, valueText(i));
+    }
+}
+
+void MonitorChannelGrid::changeEvent(QEvent* e)
+{
+    if (e->type() == QEvent::FontChange)
+    {
+        updateGeometry();
+        update();
+    }
+
+    QWidget::changeEvent(e);
+}
@@ -0,0 +1,124 @@
+/*
+  Q Light Controller Plus
+  monitorchannelgrid.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef MONITORCHANNELGRID_H
+#define MONITORCHANNELGRID_H
+
+#include <QByteArray>
+#include <QWidget>
+
+#include "monitor.h"
+
+class QPaintEvent;
+
+/** @addtogroup ui UI
+ * @{
+ */
+
+/**
+ * MonitorChannelGrid draws the channel numbers and values of a
+ * monitored fixture as a single widget: one column per channel, with the
+ * channel number on the first row and its value on the second row.
+ * Only the cells whose value has changed are repainted.
+ */
+class MonitorChannelGrid : public QWidget
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(MonitorChannelGrid)
+
+public:
+    MonitorChannelGrid(QWidget* parent);
+    ~MonitorChannelGrid();
+
+    /********************************************************************
+     * Channels
+     ********************************************************************/
+public:
+    /** Set the number of channels and reset their values to zero */
+    void setChannelCount(int count);
+
+    /** Get the number of channels */
+    int channelCount() const;
+
+    /** Set the number displayed on the first channel column */
+    void setFirstChannelNumber(int number);
+
+    /** Get the number displayed on the first channel column */
+    int firstChannelNumber() const;
+
+    /** Get the text displayed for the number of $channel */
+    QString channelText(int channel) const;
+
+    /********************************************************************
+     * Values
+     ********************************************************************/
+public:
+    /**
+     * Update the channel values from $universe, starting at $address.
+     * Only the changed cells are repainted.
+     *
+     * @return The number of changed channels
+     */
+    int setValues(const QByteArray& universe, int address);
+
+    /** Get the current value of $channel */
+    uchar value(int channel) const;
+
+    /** Get the text displayed for the value of $channel */
+    QString valueText(int channel) const;
+
+    /** Set the style used to display values */
+    void setValueStyle(Monitor::ValueStyle style);
+
+    /** Get the style used to display values */
+    Monitor::ValueStyle valueStyle() const;
+
+private:
+    int m_firstChannelNumber;
+    QByteArray m_values;
+    Monitor::ValueStyle m_valueStyle;
+
+    /********************************************************************
+     * Painting
+     ********************************************************************/
+public:
+    /** @reimp */
+    QSize sizeHint() const;
+
+    /** @reimp */
+    QSize minimumSizeHint() const;
+
+protected:
+    /** @reimp */
+    void paintEvent(QPaintEvent* e);
+
+    /** @reimp */
+    void changeEvent(QEvent* e);
+
+private:
+    /** Get the size of a single cell, based on the current font */
+    QSize cellSize() const;
+
+    /** Get the rectangle of the value cell of $channel */
+    QRect valueRect(int channel) const;
+};
+
+/** @} */
+
+#endif
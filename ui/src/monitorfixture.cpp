@@ -17,18 +17,17 @@
   limitations under the License.
 */
 
-#include <QGridLayout>
+#include <QVBoxLayout>
 #include <QByteArray>
 #include <QString>
 #include <QFrame>
 #include <QLabel>
 #include <QDebug>
 #include <QFont>
-#include <cmath>
 
+#include "monitorchannelgrid.h"
 #include "monitorfixture.h"
 #include "outputpatch.h"
-#include "qlcmacros.h"
 #include "fixture.h"
 #include "doc.h"
 
@@ -39,11 +38,14 @@ MonitorFixture::MonitorFixture(QWidget* parent, Doc* doc)
     Q_ASSERT(doc != NULL);
 
     m_fixtureLabel = NULL;
+    m_channelGrid = NULL;
     m_fixture = Fixture::invalidId();
+    m_universe = 0;
+    m_address = 0;
     m_channelStyle = Monitor::DMXChannels;
     m_valueStyle = Monitor::DMXValues;
 
-    new QGridLayout(this);
+    new QVBoxLayout(this);
     layout()->setMargin(3);
 
     setFrameStyle(QFrame::StyledPanel | QFrame::Sunken);
@@ -55,11 +57,8 @@ MonitorFixture::~MonitorFixture()
 {
     if (m_fixtureLabel != NULL)
         delete m_fixtureLabel;
-
-    while (m_channelLabels.isEmpty() == false)
-        delete m_channelLabels.takeFirst();
-    while (m_valueLabels.isEmpty() == false)
-        delete m_valueLabels.takeFirst();
+    if (m_channelGrid != NULL)
+        delete m_channelGrid;
 }
 
 bool MonitorFixture::operator<(const MonitorFixture& mof)
@@ -98,45 +97,29 @@ void MonitorFixture::setFixture(quint32 fxi_id)
     /* Get rid of old stuff first, if such exists */
     if (m_fixtureLabel != NULL)
         delete m_fixtureLabel;
-    while (m_channelLabels.isEmpty() == false)
-        delete m_channelLabels.takeFirst();
-    while (m_valueLabels.isEmpty() == false)
-        delete m_valueLabels.takeFirst();
+    m_fixtureLabel = NULL;
+    if (m_channelGrid != NULL)
+        delete m_channelGrid;
+    m_channelGrid = NULL;
 
     m_fixture = fxi_id;
     fxi = m_doc->fixture(m_fixture);
     if (fxi != NULL)
     {
-        /* The grid layout uses columns and rows. The first row is for
-           the fixture name, second row for channel numbers and the
-           third row for channel values. Each channel is in its own
-           column. */
-        QGridLayout* lay = qobject_cast<QGridLayout*> (layout());
+        m_universe = fxi->universe();
+        m_address = fxi->address();
 
-        /* Create a new fixture label and set the fixture name there */
+        /* The first row is for the fixture name. Channel numbers and
+           values are drawn below it by a single grid widget, with each
+           channel in its own column. */
         m_fixtureLabel = new QLabel(this);
         m_fixtureLabel->setText(QString("<B>%1</B>").arg(fxi->name()));
+        layout()->addWidget(m_fixtureLabel);
 
-        /* Set the fixture name to span all channels horizontally */
-        lay->addWidget(m_fixtureLabel, 0, 0, 1, fxi->channels(),
-                       Qt::AlignLeft);
-
-        /* Create channel numbers and value labels */
-        for (quint32 i = 0; i < fxi->channels(); i++)
-        {
-            QLabel* label;
-            QString str;
-
-            /* Create a label for channel number */
-            label = new QLabel(this);
-            lay->addWidget(label, 1, i, Qt::AlignHCenter);
-            m_channelLabels.append(label);
-
-            /* Create a label for value */
-            label = new QLabel(this);
-            lay->addWidget(label, 2, i, Qt::AlignHCenter);
-            m_valueLabels.append(label);
-        }
+        m_channelGrid = new MonitorChannelGrid(this);
+        m_channelGrid->setChannelCount(fxi->channels());
+        layout()->addWidget(m_channelGrid);
+        updateLabelStyles();
     }
 }
 
@@ -147,27 +130,17 @@ quint32 MonitorFixture::fixture() const
 
 void MonitorFixture::slotChannelStyleChanged(Monitor::ChannelStyle style)
 {
-    QString str;
-    int i = 0;
-
     m_channelStyle = style;
 
     /* Check that this MonitorFixture represents a fixture */
-    if (m_fixture == Fixture::invalidId())
+    if (m_channelGrid == NULL)
         return;
 
-    Fixture* fxi = m_doc->fixture(m_fixture);
-    Q_ASSERT(fxi != NULL);
-
     /* Start channel numbering from this fixture's address */
     if (style == Monitor::DMXChannels)
-        i = fxi->address() + 1;
+        m_channelGrid->setFirstChannelNumber(m_address + 1);
     else
-        i = 1;
-
-    QListIterator <QLabel*> it(m_channelLabels);
-    while (it.hasNext() == true)
-        it.next()->setText(str.sprintf("<B>%.3d</B>", i++));
+        m_channelGrid->setFirstChannelNumber(1);
 }
 
 /****************************************************************************
@@ -176,76 +149,17 @@ void MonitorFixture::slotChannelStyleChanged(Monitor::ChannelStyle style)
 
 void MonitorFixture::updateValues(int index, const QByteArray& ua)
 {
-    QLabel* label;
-    uchar value;
-    Fixture* fxi;
-    QString str;
-    int i = 0;
-
-    /* Check that this MonitorFixture represents a fixture */
-    if (m_fixture == Fixture::invalidId())
-        return;
-
-    /* Check that this MonitorFixture's fixture really exists */
-    fxi = m_doc->fixture(m_fixture);
-    if (fxi == NULL)
-        return;
-
-    if (fxi->universe() != (quint32)index)
+    /* Check that this MonitorFixture represents an existing fixture */
+    if (m_channelGrid == NULL || m_universe != (quint32)index)
         return;
 
-    QListIterator <QLabel*> it(m_valueLabels);
-    while (it.hasNext() == true)
-    {
-        label = it.next();
-        Q_ASSERT(label != NULL);
-
-        value = uchar(ua.at(fxi->address() + i));
-        i++;
-
-        /* Set the label's text to reflect the changed value */
-        if (m_valueStyle == Monitor::DMXValues)
-        {
-            label->setText(str.sprintf("%.3d", value));
-        }
-        else
-        {
-            label->setText(str.sprintf("%.3d", int(ceil(SCALE(qreal(value),
-                                                              qreal(0), qreal(UCHAR_MAX),
-                                                              qreal(0), qreal(100))))));
-        }
-    }
+    m_channelGrid->setValues(ua, m_address);
 }
 
 void MonitorFixture::slotValueStyleChanged(Monitor::ValueStyle style)
 {
     m_valueStyle = style;
 
-    QListIterator <QLabel*> it(m_valueLabels);
-    while (it.hasNext() == true)
-    {
-        QLabel* label;
-        QString str;
-        int value;
-
-        label = it.next();
-        Q_ASSERT(label != NULL);
-
-        value = label->text().toInt();
-
-        if (style == Monitor::DMXValues)
-        {
-            value = int(ceil(SCALE(qreal(value),
-                                   qreal(0), qreal(100),
-                                   qreal(0), qreal(UCHAR_MAX))));
-        }
-        else
-        {
-            value = int(ceil(SCALE(qreal(value),
-                                   qreal(0), qreal(UCHAR_MAX),
-                                   qreal(0), qreal(100))));
-        }
-
-        label->setText(str.sprintf("%.3d", value));
-    }
+    if (m_channelGrid != NULL)
+        m_channelGrid->setValueStyle(style);
 }
@@ -26,6 +26,7 @@
 
 #include "monitor.h"
 
+class MonitorChannelGrid;
 class QByteArray;
 class OutputMap;
 class QFrame;
@@ -65,21 +66,27 @@ public slots:
 
 protected:
     quint32 m_fixture;
+    /** The fixture's universe & address, cached for updateValues() */
+    quint32 m_universe;
+    quint32 m_address;
     Monitor::ChannelStyle m_channelStyle;
     QLabel* m_fixtureLabel;
-    QList <QLabel*> m_channelLabels;
+    MonitorChannelGrid* m_channelGrid;
 
     /********************************************************************
      * Values
      ********************************************************************/
 public:
+    /**
+     * Update the displayed values from the universe with the given $index.
+     * Only the channels whose value changed are repainted.
+     */
     void updateValues(int index, const QByteArray& universes);
 
 public slots:
     void slotValueStyleChanged(Monitor::ValueStyle style);
 
 protected:
-    QList <QLabel*> m_valueLabels;
     Monitor::ValueStyle m_valueStyle;
 };
 
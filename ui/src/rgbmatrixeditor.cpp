@@ -56,6 +56,7 @@ RGBMatrixEditor::RGBMatrixEditor(QWidget* parent, RGBMatrix* mtx, Doc* doc)
     : QWidget(parent)
     , m_doc(doc)
     , m_matrix(mtx)
+    , m_previewStepCount(0)
     , m_speedDials(NULL)
     , m_scene(new QGraphicsScene(this))
     , m_previewTimer(new QTimer(this))
@@ -341,22 +342,23 @@ bool RGBMatrixEditor::createPreviewItems()
     }
 
     m_matrix->calculateColorDelta();
-    m_previewMaps = m_matrix->previewMaps();
+    m_previewStepCount = m_matrix->stepsCount();
 
-    if ((m_previewDirection == Function::Forward) || m_previewMaps.isEmpty())
+    if ((m_previewDirection == Function::Forward) || m_previewStepCount == 0)
     {
         m_previewStep = 0;
     }
     else
     {
-        m_previewStep = m_previewMaps.size() - 1;
+        m_previewStep = m_previewStepCount - 1;
     }
 
-    RGBMap map;
-    if (m_previewStep < m_previewMaps.size())
-        map = m_previewMaps[m_previewStep];
+    if (m_previewStep < m_previewStepCount)
+        m_matrix->previewMap(m_previewStep, m_previewMap);
+    else
+        m_previewMap.clear();
 
-    if (map.isEmpty())
+    if (m_previewMap.isEmpty())
         return false;
 
     for (int x = 0; x < grp->size().width(); x++)
@@ -372,7 +374,7 @@ bool RGBMatrixEditor::createPreviewItems()
                               y * RECT_SIZE + RECT_PADDING + ITEM_PADDING,
                               ITEM_SIZE - (2 * ITEM_PADDING),
                               ITEM_SIZE - (2 * ITEM_PADDING));
-                item->setColor(map[y][x]);
+                item->setColor(m_previewMap[y][x]);
                 item->draw(0);
                 m_scene->addItem(item);
                 m_previewHash[pt] = item;
@@ -395,7 +397,7 @@ void RGBMatrixEditor::slotPreviewTimeout()
         //qDebug() << "previewTimeout. Step:" << m_previewStep;
         if (m_matrix->runOrder() == RGBMatrix::PingPong)
         {
-            if (m_previewDirection == Function::Forward && (m_previewStep + 1) == m_previewMaps.size())
+            if (m_previewDirection == Function::Forward && (m_previewStep + 1) == m_previewStepCount)
                 m_previewDirection = Function::Backward;
             else if (m_previewDirection == Function::Backward && (m_previewStep - 1) < 0)
                 m_previewDirection = Function::Forward;
@@ -404,7 +406,7 @@ void RGBMatrixEditor::slotPreviewTimeout()
         if (m_previewDirection == Function::Forward)
         {
             m_previewStep++;
-            if (m_previewStep >= m_previewMaps.size())
+            if (m_previewStep >= m_previewStepCount)
             {
                 m_previewStep = 0;
                 m_matrix->setStepColor(m_matrix->startColor());
@@ -417,7 +419,7 @@ void RGBMatrixEditor::slotPreviewTimeout()
             m_previewStep--;
             if (m_previewStep < 0)
             {
-                m_previewStep = m_previewMaps.size() - 1;
+                m_previewStep = m_previewStepCount - 1;
                 if (m_matrix->endColor().isValid())
                     m_matrix->setStepColor(m_matrix->endColor());
                 else
@@ -426,17 +428,18 @@ void RGBMatrixEditor::slotPreviewTimeout()
             else
                 m_matrix->updateStepColor(m_previewDirection);
         }
-        m_previewMaps = m_matrix->previewMaps();
+        m_previewStepCount = m_matrix->stepsCount();
+        if (m_previewStep >= 0 && m_previewStep < m_previewStepCount)
+            m_matrix->previewMap(m_previewStep, m_previewMap);
+        else
+            m_previewMap.clear();
         m_previewIterator = 0;
     }
 
-    RGBMap map;
-    if (m_previewStep >= 0 && m_previewStep < m_previewMaps.size())
-        map = m_previewMaps[m_previewStep];
-
-    for (int y = 0; y < map.size(); y++)
+    const RGBMap& map = m_previewMap;
+    for (int y = 0; y < map.height(); y++)
     {
-        for (int x = 0; x < map[y].size(); x++)
+        for (int x = 0; x < map.width(); x++)
         {
             QLCPoint pt(x, y);
             if (m_previewHash.contains(pt) == true)
@@ -709,7 +712,7 @@ void RGBMatrixEditor::slotTestClicked()
 void RGBMatrixEditor::slotRestartTest()
 {
     m_previewTimer->stop();
-    m_previewMaps = m_matrix->previewMaps();
+    m_previewStepCount = m_matrix->stepsCount();
 
     if (m_testButton->isChecked() == true)
     {
@@ -812,7 +815,7 @@ void RGBMatrixEditor::slotSaveToSequenceClicked()
         }
         m_doc->addFunction(grpScene);
 
-        int mapSize = m_previewMaps.size();
+        int mapSize = m_matrix->stepsCount();
         int totalSteps = mapSize;
         int increment = 1;
         int currentStep = 0;
@@ -849,9 +852,9 @@ void RGBMatrixEditor::slotSaveToSequenceClicked()
 
         for (int i = 0; i < totalSteps; i++)
         {
-            m_previewMaps = m_matrix->previewMaps();
+            m_matrix->previewMap(currentStep, m_previewMap);
 
-            RGBMap map = m_previewMaps[currentStep];
+            const RGBMap& map = m_previewMap;
             ChaserStep step;
             step.fid = grpScene->id();
             step.hold = m_matrix->duration() - m_matrix->fadeInSpeed() - m_matrix->fadeOutSpeed();
@@ -859,9 +862,9 @@ void RGBMatrixEditor::slotSaveToSequenceClicked()
             step.fadeIn = m_matrix->fadeInSpeed();
             step.fadeOut = m_matrix->fadeOutSpeed();
 
-            for (int y = 0; y < map.size(); y++)
+            for (int y = 0; y < map.height(); y++)
             {
-                for (int x = 0; x < map[y].size(); x++)
+                for (int x = 0; x < map.width(); x++)
                 {
                     QColor rgb = QColor(map[y][x]);
                     GroupHead head = grp->head(QLCPoint(x, y));
@@ -889,7 +892,6 @@ void RGBMatrixEditor::slotSaveToSequenceClicked()
                 currentStep = mapSize - 2;
                 increment = -1;
             }
-            m_previewMaps = m_matrix->previewMaps();
             m_matrix->updateStepColor(m_matrix->direction());
         }
 
@@ -110,7 +110,8 @@ private:
     RGBMatrix* m_matrix; // The RGBMatrix being edited
 
     QList <RGBScript> m_scripts;
-    QList <RGBMap> m_previewMaps;
+    RGBMap m_previewMap;
+    int m_previewStepCount;
     Function::Direction m_previewDirection;
 
     QPointer<SpeedDialWidget> m_speedDials;
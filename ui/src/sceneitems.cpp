@@ -21,6 +21,7 @@
 #include <QtGui>
 #include <QMenu>
 
+#include "audiopeakcache.h"
 #include "audiodecoder.h"
 #include "sceneitems.h"
 #include "chaserstep.h"
@@ -697,7 +698,9 @@ AudioItem::AudioItem(Audio *aud)
     , m_previewRightAction(NULL)
     , m_previewStereoAction(NULL)
     , m_alignToCursor(NULL)
-    , m_preview(NULL)
+    , m_peakCache(NULL)
+    , m_previewLeft(false)
+    , m_previewRight(false)
     , m_pressed(false)
 {
     Q_ASSERT(aud != NULL);
@@ -770,7 +773,6 @@ QRectF AudioItem::boundingRect() const
 
 void AudioItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
-    Q_UNUSED(option);
     Q_UNUSED(widget);
 
     float timeScale = 50/(float)m_timeScale;
@@ -784,12 +786,8 @@ void AudioItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
     painter->drawRect(0, 0, m_width, TRACK_HEIGHT - 3);
 
     painter->setFont(m_font);
-    if (m_preview != NULL)
-    {
-        // show preview here
-        QPixmap waveform = m_preview->scaled(m_width, TRACK_HEIGHT - 4);
-        painter->drawPixmap(0, 0, waveform);
-    }
+    if (m_previewLeft == true || m_previewRight == true)
+        drawWaveform(painter, option->exposedRect);
 
     if (m_audio->fadeInSpeed() != 0)
     {
@@ -866,45 +864,25 @@ void AudioItem::slotAudioChanged(quint32)
     calculateWidth();
 }
 
-qint32 AudioItem::getSample(unsigned char *data, quint32 *idx, int sampleSize)
-{
-    qint32 value = 0;
-    if (sampleSize == 1)
-        value = (qint32)data[(*idx)++];
-    if (sampleSize == 2)
-    {
-        qint16 *tmpdata = (qint16 *)data;
-        qint16 twobytes = tmpdata[*idx];
-        value = twobytes;
-        *idx+=2;
-    }
-    else if (sampleSize == 4)
-    {
-        value = (value + ((qint32)data[*idx] << 24) + ((qint32)data[*idx + 1] << 16) + ((qint32)data[*idx + 2] << 8));
-        *idx+=3;
-    }
-    return value;
-}
-
 void AudioItem::slotAudioPreviewLeft(bool active)
 {
     m_previewRightAction->setChecked(false);
     m_previewStereoAction->setChecked(false);
-    createWaveform(active, false);
+    setWaveformPreview(active, false);
 }
 
 void AudioItem::slotAudioPreviewRight(bool active)
 {
     m_previewLeftAction->setChecked(false);
     m_previewStereoAction->setChecked(false);
-    createWaveform(false, active);
+    setWaveformPreview(false, active);
 }
 
 void AudioItem::slotAudioPreviewStero(bool active)
 {
     m_previewLeftAction->setChecked(false);
     m_previewRightAction->setChecked(false);
-    createWaveform(active, active);
+    setWaveformPreview(active, active);
 }
 
 void AudioItem::slotAlignToCursorClicked()
@@ -912,154 +890,70 @@ void AudioItem::slotAlignToCursorClicked()
     emit alignToCursor(this);
 }
 
-void AudioItem::createWaveform(bool left, bool right)
+void AudioItem::slotPeaksReady()
+{
+    update();
+}
+
+void AudioItem::setWaveformPreview(bool left, bool right)
 {
-    if ((left == true || right == true) && m_audio->getAudioDecoder() != NULL)
+    m_previewLeft = left;
+    m_previewRight = right;
+
+    if ((left == true || right == true) && m_peakCache == NULL &&
+        m_audio->getAudioDecoder() != NULL)
     {
-        AudioDecoder *ad = m_audio->getAudioDecoder();
-        AudioParameters ap = ad->audioParameters();
-        // 1- find out how many samples have to be represented on a single pixel on a 1:1 time scale
-        int sampleSize = ap.sampleSize();
-        int channels = ap.channels();
-        int oneSecondSamples = ap.sampleRate() * channels;
-        int onePixelSamples = oneSecondSamples / 50;
-        //qint32 maxValue = qPow(0xFF, sampleSize);
-        qint32 maxValue = 0;
-        if (left == true && right == true)
-            maxValue = 0x7F << (8 * (sampleSize - 1));
-        else
-            maxValue = 0x3F << (8 * (sampleSize - 1));
-        quint32 defaultDataLen = onePixelSamples * sampleSize;
-
-        // 2- decode the whole file and fill a QPixmap with a sample block RMS value for each pixel
-        qint64 dataRead = 1;
-        unsigned char audioData[defaultDataLen * 4];
-        quint32 audioDataOffset = 0;
-        m_preview = new QPixmap((50 * m_audio->getDuration()) / 1000, 76);
-        m_preview->fill(Qt::transparent);
-        QPainter p(m_preview);
-        int xpos = 0;
-
-        qDebug() << "Audio duration: " << m_audio->getDuration() <<
-                    ", pixmap width: " << ((50 * m_audio->getDuration()) / 1000) <<
-                    ", maxValue: " << maxValue;
-        qDebug() << "Samples per second: " << oneSecondSamples << ", for one pixel: " << onePixelSamples;
-
-        while (dataRead)
-        {
-            quint32 tmpExceedData = 0;
-            if (audioDataOffset < defaultDataLen)
-            {
-                dataRead = ad->read((char *)audioData + audioDataOffset, defaultDataLen * 2);
-                if (dataRead > 0)
-                {
-                    if(dataRead + audioDataOffset >= defaultDataLen)
-                    {
-                        tmpExceedData = dataRead + audioDataOffset - defaultDataLen;
-                        dataRead = defaultDataLen;
-                    }
-                    else
-                    {
-                        audioDataOffset = dataRead;
-                        continue;
-                    }
-                }
-            }
-            else
-            {
-                dataRead = defaultDataLen;
-                tmpExceedData = audioDataOffset - defaultDataLen;
-            }
+        QString cacheDir;
+        QString wsPath = m_audio->doc()->getWorkspacePath();
+        if (wsPath.isEmpty() == false)
+            cacheDir = QDir(wsPath).absoluteFilePath(PEAK_CACHE_DIRECTORY);
+
+        m_peakCache = new AudioPeakCache(m_audio->getSourceFileName(), cacheDir, this);
+        connect(m_peakCache, SIGNAL(peaksReady()), this, SLOT(slotPeaksReady()));
+        m_peakCache->load();
+    }
 
-            if (dataRead > 0)
-            {
-                quint32 i = 0;
-                // calculate the RMS value (peak) for this data block
-                double rmsLeft = 0;
-                double rmsRight = 0;
-                bool done = false;
-                while (!done)
-                {
-                    if (left == true)
-                    {
-                        qint32 sampleVal = getSample(audioData, &i, sampleSize);
-                        rmsLeft += (sampleVal * sampleVal);
-                    }
-                    if (channels == 2)
-                    {
-                        if (right == true)
-                        {
-                            qint32 sampleVal = getSample(audioData, &i, sampleSize);
-                            rmsRight += (sampleVal * sampleVal);
-                        }
-                        else
-                            getSample(audioData, &i, sampleSize); // got to read it anyway and discard data
-                    }
-
-                    if (i >= dataRead / sampleSize)
-                        done = true;
-                }
-                quint32 divisor = (dataRead / sampleSize) / channels;
-                if (left == true)
-                    rmsLeft = sqrt(rmsLeft / divisor);
-                if (right == true)
-                    rmsRight = sqrt(rmsRight / divisor);
+    update();
+}
 
-                // 3- Draw the actual waveform
-                unsigned short lineHeightLeft = 0, lineHeightRight = 0;
+void AudioItem::drawWaveform(QPainter *painter, const QRectF& exposed)
+{
+    if (m_peakCache == NULL || m_peakCache->isReady() == false)
+        return;
 
-                if (left == true)
-                    lineHeightLeft = (76 * rmsLeft) / maxValue;
-                if (right == true)
-                    lineHeightRight = (76 * rmsRight) / maxValue;
+    int height = TRACK_HEIGHT - 4;
+    bool stereo = (m_previewLeft == true && m_previewRight == true &&
+                   m_peakCache->channels() > 1);
+    int channel = (m_previewLeft == false && m_peakCache->channels() > 1) ? 1 : 0;
+    int halfHeight = stereo ? (height / 4) - 2 : (height / 2) - 2;
+    int center = stereo ? height / 4 : height / 2;
 
-                if (left == true && right == true)
-                {
-                    if (lineHeightLeft > 1)
-                        p.drawLine(xpos, 19 - (lineHeightLeft / 2), xpos, 19 + (lineHeightLeft / 2));
-                    else
-                        p.drawLine(xpos, 19, xpos + 1, 19);
-
-                    if (lineHeightRight > 1)
-                        p.drawLine(xpos, 51 - (lineHeightRight / 2), xpos, 51 + (lineHeightRight / 2));
-                    else
-                        p.drawLine(xpos, 51, xpos + 1, 51);
-                }
-                else
-                {
-                    unsigned short lineHeight = 0;
-                    if (left == true)
-                        lineHeight = lineHeightLeft;
-                    else
-                        lineHeight = lineHeightRight;
-                    if (lineHeight > 1)
-                        p.drawLine(xpos, 38 - (lineHeight / 2), xpos, 38 + (lineHeight / 2));
-                    else
-                        p.drawLine(xpos, 38, xpos + 1, 38);
-                    //qDebug() << "Data read: " << dataRead << ", rms: " << rms << ", line height: " << lineHeight << ", xpos = " << xpos;
-                }
-                xpos++;
+    /* Milliseconds represented by a single pixel at the current time scale */
+    double msPerPixel = (1000.0 * m_timeScale) / 50.0;
 
-                if (tmpExceedData > 0)
-                {
-                    //qDebug() << "Exceed data found: " << tmpExceedData;
-                    memmove(audioData, audioData + defaultDataLen, tmpExceedData);
-                    audioDataOffset = tmpExceedData;
-                }
-                else
-                    audioDataOffset = 0;
-            }
-        }
-        //qDebug() << "Iterations done: " << xpos;
-        ad->seek(0);
-    }
-    else // no preview selected. Delete pixmap
+    int startX = qMax(0, (int)exposed.left());
+    int endX = qMin(m_width, (int)exposed.right() + 1);
+
+    QPen peakPen(m_color.darker(150), 1);
+    QPen rmsPen(Qt::black, 1);
+
+    for (int ch = channel; ch <= (stereo ? 1 : channel); ch++)
     {
-        delete m_preview;
-        m_preview = NULL;
+        for (int x = startX; x < endX; x++)
+        {
+            AudioPeak peak;
+            if (m_peakCache->peak(ch, x * msPerPixel, (x + 1) * msPerPixel, peak) == false)
+                break;
+
+            painter->setPen(peakPen);
+            painter->drawLine(x, center - (peak.max * halfHeight),
+                              x, center - (peak.min * halfHeight));
+            int rmsHeight = peak.rms * halfHeight;
+            painter->setPen(rmsPen);
+            painter->drawLine(x, center - rmsHeight, x, center + rmsHeight);
+        }
+        center += height / 2;
     }
-
-    update();
 }
 
 void AudioItem::mousePressEvent(QGraphicsSceneMouseEvent *event)
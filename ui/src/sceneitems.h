@@ -45,6 +45,8 @@
  *
  *********************************************************************/
 
+class AudioPeakCache;
+
 class SceneHeaderItem :  public QObject, public QGraphicsItem
 {
     Q_OBJECT
@@ -313,14 +315,16 @@ protected slots:
     void slotAudioPreviewRight(bool active);
     void slotAudioPreviewStero(bool active);
     void slotAlignToCursorClicked();
+    void slotPeaksReady();
 
 private:
     /** Calculate sequence width for paint() and boundingRect() */
     void calculateWidth();
-    /** Retrieve a sample value from an audio buffer, given the sample size */
-    qint32 getSample(unsigned char *data, quint32 *idx, int sampleSize);
-    /** Routine that decode the whole and create the waveform QPixmap */
-    void createWaveform(bool left, bool right);
+    /** Enable the waveform preview of the given channels. The peak summary
+     *  is computed in background the first time a preview is requested */
+    void setWaveformPreview(bool left, bool right);
+    /** Draw the waveform of the exposed area at the current time scale */
+    void drawWaveform(QPainter *painter, const QRectF& exposed);
 
 private:
     QFont m_font;
@@ -342,8 +346,10 @@ private:
     QAction *m_previewStereoAction;
     QAction *m_alignToCursor;
 
-    /** Pixmap holding the waveform (if enabled) */
-    QPixmap *m_preview;
+    /** Multi-resolution peak summary of the audio file */
+    AudioPeakCache *m_peakCache;
+    /** Channels to preview */
+    bool m_previewLeft, m_previewRight;
 
     bool m_pressed;
 };
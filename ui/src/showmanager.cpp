@@ -69,6 +69,8 @@ ShowManager::ShowManager(QWidget* parent, Doc* doc)
     , m_deleteAction(NULL)
     , m_colorAction(NULL)
     , m_snapGridAction(NULL)
+    , m_audioSyncAction(NULL)
+    , m_timecodeCombo(NULL)
     , m_stopAction(NULL)
     , m_playAction(NULL)
 {
@@ -229,6 +231,12 @@ void ShowManager::initActions()
     connect(m_snapGridAction, SIGNAL(triggered(bool)),
            this, SLOT(slotToggleSnapToGrid(bool)));
 
+    m_audioSyncAction = new QAction(QIcon(":/audio.png"),
+                                   tr("S&ync timeline to audio"), this);
+    m_audioSyncAction->setCheckable(true);
+    connect(m_audioSyncAction, SIGNAL(triggered(bool)),
+           this, SLOT(slotToggleAudioSync(bool)));
+
     m_stopAction = new QAction(QIcon(":/player_stop.png"),
                                  tr("St&op"), this);
     m_stopAction->setShortcut(QKeySequence("CTRL+O"));
@@ -270,6 +278,16 @@ void ShowManager::initToolbar()
 
     m_toolbar->addAction(m_colorAction);
     m_toolbar->addAction(m_snapGridAction);
+    m_toolbar->addAction(m_audioSyncAction);
+
+    m_timecodeCombo = new QComboBox();
+    m_timecodeCombo->setToolTip(tr("Timecode the timeline chases"));
+    m_timecodeCombo->addItem(tr("Internal clock"), Show::NoTimecode);
+    m_timecodeCombo->addItem(tr("MIDI timecode"), Show::MIDITimecode);
+    m_timecodeCombo->addItem(tr("LTC (audio input)"), Show::LinearTimecode);
+    m_toolbar->addWidget(m_timecodeCombo);
+    connect(m_timecodeCombo, SIGNAL(currentIndexChanged(int)),
+            this, SLOT(slotTimecodeSourceChanged(int)));
     m_toolbar->addSeparator();
 
     // Time label and playback buttons
@@ -1035,6 +1053,25 @@ void ShowManager::slotToggleSnapToGrid(bool enable)
     m_showview->setSnapToGrid(enable);
 }
 
+void ShowManager::slotToggleAudioSync(bool enable)
+{
+    if (m_show == NULL)
+        return;
+
+    m_show->setAudioSync(enable);
+    m_doc->setModified();
+}
+
+void ShowManager::slotTimecodeSourceChanged(int idx)
+{
+    QVariant var = m_timecodeCombo->itemData(idx);
+    if (var.isValid() && m_show != NULL)
+    {
+        m_show->setTimecodeSource(Show::TimecodeSource(var.toInt()));
+        m_doc->setModified();
+    }
+}
+
 void ShowManager::slotChangeSize(int width, int height)
 {
     if (m_showview != NULL)
@@ -1171,6 +1208,10 @@ void ShowManager::updateMultiTrackView()
     m_showview->setBPMValue(m_show->getTimeDivisionBPM());
     int tIdx = m_timeDivisionCombo->findData(QVariant(SceneHeaderItem::stringToTempo(m_show->getTimeDivisionType())));
     m_timeDivisionCombo->setCurrentIndex(tIdx);
+    m_audioSyncAction->setChecked(m_show->audioSync());
+    m_timecodeCombo->blockSignals(true);
+    m_timecodeCombo->setCurrentIndex(m_timecodeCombo->findData(int(m_show->timecodeSource())));
+    m_timecodeCombo->blockSignals(false);
 
     connect(m_bpmField, SIGNAL(valueChanged(int)), this, SLOT(slotBPMValueChanged(int)));
     connect(m_show, SIGNAL(timeChanged(quint32)), this, SLOT(slotupdateTimeAndCursor(quint32)));
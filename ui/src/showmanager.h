@@ -121,6 +121,8 @@ private:
     QAction* m_deleteAction;
     QAction* m_colorAction;
     QAction* m_snapGridAction;
+    QAction* m_audioSyncAction;
+    QComboBox* m_timecodeCombo;
     QAction* m_stopAction;
     QAction* m_playAction;
     QComboBox* m_timeDivisionCombo;
@@ -162,6 +164,8 @@ protected slots:
     void slotTrackMoved(Track *track, int direction);
     void slotChangeColor();
     void slotToggleSnapToGrid(bool enable);
+    void slotToggleAudioSync(bool enable);
+    void slotTimecodeSourceChanged(int idx);
     void slotChangeSize(int width, int height);
     void slotStepSelectionChanged(int index);
 
@@ -78,6 +78,7 @@ HEADERS += aboutbox.h \
            inputprofileeditor.h \
            knobwidget.h \
            monitor.h \
+           monitorchannelgrid.h \
            monitorfixture.h \
            monitorlayout.h \
            multitrackview.h \
@@ -97,6 +98,7 @@ HEADERS += aboutbox.h \
            simpledeskengine.h \
            speeddial.h \
            speeddialwidget.h \
+           tickprofilerview.h \
            universeitemwidget.h \
            vcaudiotriggers.h \
            vcaudiotriggersproperties.h \
@@ -117,6 +119,7 @@ HEADERS += aboutbox.h \
            vcsoloframe.h \
            vcspeeddial.h \
            vcspeeddialproperties.h \
+           vcinputdispatcher.h \
            vcwidget.h \
            vcwidgetproperties.h \
            vcwidgetselection.h \
@@ -212,6 +215,7 @@ SOURCES += aboutbox.cpp \
            inputprofileeditor.cpp \
            knobwidget.cpp \
            monitor.cpp \
+           monitorchannelgrid.cpp \
            monitorfixture.cpp \
            monitorlayout.cpp \
            multitrackview.cpp \
@@ -231,6 +235,7 @@ SOURCES += aboutbox.cpp \
            simpledeskengine.cpp \
            speeddial.cpp \
            speeddialwidget.cpp \
+           tickprofilerview.cpp \
            universeitemwidget.cpp \
            vcaudiotriggers.cpp \
            vcaudiotriggersproperties.cpp \
@@ -251,6 +256,7 @@ SOURCES += aboutbox.cpp \
            vcsoloframe.cpp \
            vcspeeddial.cpp \
            vcspeeddialproperties.cpp \
+           vcinputdispatcher.cpp \
            vcwidget.cpp \
            vcwidgetproperties.cpp \
            vcwidgetselection.cpp \
@@ -0,0 +1,184 @@
+/*
+  Q Light Controller Plus
+  tickprofilerview.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QTreeWidgetItem>
+#include <QTreeWidget>
+#include <QPushButton>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QHeaderView>
+#include <QCheckBox>
+#include <QSettings>
+#include <QTimer>
+#include <QIcon>
+
+#include "tickprofilerview.h"
+#include "tickprofiler.h"
+#include "mastertimer.h"
+#include "function.h"
+#include "apputil.h"
+#include "doc.h"
+
+#define SETTINGS_GEOMETRY "tickprofiler/geometry"
+
+#define UPDATE_INTERVAL 500
+
+#define KColumnName    0
+#define KColumnType    1
+#define KColumnLast    2
+#define KColumnMean    3
+#define KColumnP50     4
+#define KColumnP95     5
+#define KColumnP99     6
+#define KColumnMax     7
+#define KColumnSamples 8
+
+TickProfilerView* TickProfilerView::s_instance = NULL;
+
+/*****************************************************************************
+ * Initialization
+ *****************************************************************************/
+
+TickProfilerView::TickProfilerView(QWidget* parent, Doc* doc, Qt::WindowFlags f)
+    : QWidget(parent, f)
+    , m_doc(doc)
+    , m_enableCheck(NULL)
+    , m_tree(NULL)
+    , m_updateTimer(NULL)
+{
+    Q_ASSERT(doc != NULL);
+
+    QVBoxLayout* vbox = new QVBoxLayout(this);
+    QHBoxLayout* hbox = new QHBoxLayout;
+    vbox->addLayout(hbox);
+
+    m_enableCheck = new QCheckBox(tr("Enable profiling"), this);
+    m_enableCheck->setChecked(m_doc->masterTimer()->profiler()->isEnabled());
+    connect(m_enableCheck, SIGNAL(toggled(bool)), this, SLOT(slotEnableToggled(bool)));
+    hbox->addWidget(m_enableCheck);
+    hbox->addStretch();
+
+    QPushButton* resetButton = new QPushButton(tr("Reset"), this);
+    connect(resetButton, SIGNAL(clicked()), this, SLOT(slotReset()));
+    hbox->addWidget(resetButton);
+
+    m_tree = new QTreeWidget(this);
+    m_tree->setRootIsDecorated(false);
+    m_tree->setAllColumnsShowFocus(true);
+    m_tree->setHeaderLabels(QStringList()
+                            << tr("Name") << tr("Type")
+                            << tr("Last (us)") << tr("Mean (us)")
+                            << tr("50% (us)") << tr("95% (us)")
+                            << tr("99% (us)") << tr("Max (us)")
+                            << tr("Samples"));
+    vbox->addWidget(m_tree);
+
+    m_updateTimer = new QTimer(this);
+    connect(m_updateTimer, SIGNAL(timeout()), this, SLOT(slotUpdateTimeout()));
+    m_updateTimer->start(UPDATE_INTERVAL);
+
+    slotUpdateTimeout();
+}
+
+TickProfilerView::~TickProfilerView()
+{
+    QSettings settings;
+    settings.setValue(SETTINGS_GEOMETRY, saveGeometry());
+
+    /* Reset the singleton instance */
+    TickProfilerView::s_instance = NULL;
+}
+
+void TickProfilerView::createAndShow(QWidget* parent, Doc* doc)
+{
+    /* Must not create more than one instance */
+    if (s_instance == NULL)
+    {
+        s_instance = new TickProfilerView(parent, doc, Qt::Window);
+
+        /* Set some common properties for the window and show it */
+        s_instance->setAttribute(Qt::WA_DeleteOnClose);
+        s_instance->setWindowIcon(QIcon(":/speed.png"));
+        s_instance->setWindowTitle(tr("Tick Profiler"));
+
+        QSettings settings;
+        QVariant var = settings.value(SETTINGS_GEOMETRY);
+        if (var.isValid() == true)
+            s_instance->restoreGeometry(var.toByteArray());
+        else
+            s_instance->resize(700, 400);
+        AppUtil::ensureWidgetIsVisible(s_instance);
+    }
+
+    s_instance->show();
+    s_instance->raise();
+}
+
+/*****************************************************************************
+ * Statistics
+ *****************************************************************************/
+
+void TickProfilerView::slotEnableToggled(bool enable)
+{
+    m_doc->masterTimer()->profiler()->setEnabled(enable);
+}
+
+void TickProfilerView::slotReset()
+{
+    m_doc->masterTimer()->profiler()->reset();
+    slotUpdateTimeout();
+}
+
+void TickProfilerView::slotUpdateTimeout()
+{
+    QList <TickProfiler::Statistics> stats = m_doc->masterTimer()->profiler()->statistics();
+
+    /* Reuse the existing items to keep the selection & scroll position */
+    while (m_tree->topLevelItemCount() > stats.size())
+        delete m_tree->topLevelItem(m_tree->topLevelItemCount() - 1);
+    while (m_tree->topLevelItemCount() < stats.size())
+        new QTreeWidgetItem(m_tree);
+
+    for (int i = 0; i < stats.size(); i++)
+    {
+        const TickProfiler::Statistics& st(stats.at(i));
+        QTreeWidgetItem* item = m_tree->topLevelItem(i);
+
+        QString name = st.name;
+        if (st.type == TickProfiler::FunctionItem)
+        {
+            Function* function = m_doc->function(st.id);
+            if (function != NULL)
+                name = function->name();
+        }
+
+        item->setText(KColumnName, name);
+        item->setText(KColumnType, TickProfiler::itemTypeToString(st.type));
+        item->setText(KColumnLast, QString::number(st.last, 'f', 1));
+        item->setText(KColumnMean, QString::number(st.mean, 'f', 1));
+        item->setText(KColumnP50, QString::number(st.p50, 'f', 1));
+        item->setText(KColumnP95, QString::number(st.p95, 'f', 1));
+        item->setText(KColumnP99, QString::number(st.p99, 'f', 1));
+        item->setText(KColumnMax, QString::number(st.max, 'f', 1));
+        item->setText(KColumnSamples, QString::number(st.samples));
+
+        for (int col = KColumnLast; col <= KColumnSamples; col++)
+            item->setTextAlignment(col, Qt::AlignRight | Qt::AlignVCenter);
+    }
+}
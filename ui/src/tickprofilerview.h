@@ -0,0 +1,80 @@
+/*
+  Q Light Controller Plus
+  tickprofilerview.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef TICKPROFILERVIEW_H
+#define TICKPROFILERVIEW_H
+
+#include <QWidget>
+
+class QTreeWidget;
+class QCheckBox;
+class QTimer;
+class Doc;
+
+/** @addtogroup ui UI
+ * @{
+ */
+
+/**
+ * TickProfilerView shows the statistics collected by the MasterTimer's
+ * TickProfiler: the time spent in each stage of a tick, and by each running
+ * function, DMX source and output plugin, refreshed twice a second.
+ */
+class TickProfilerView : public QWidget
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(TickProfilerView)
+
+    /*********************************************************************
+     * Initialization
+     *********************************************************************/
+public:
+    ~TickProfilerView();
+
+    /** Create or show the TickProfilerView singleton window */
+    static void createAndShow(QWidget* parent, Doc* doc);
+
+protected:
+    /** Protected constructor to prevent multiple instances. */
+    TickProfilerView(QWidget* parent, Doc* doc, Qt::WindowFlags f = 0);
+
+protected:
+    /** The singleton TickProfilerView instance */
+    static TickProfilerView* s_instance;
+
+private:
+    Doc* m_doc;
+
+    /*********************************************************************
+     * Statistics
+     *********************************************************************/
+private slots:
+    void slotEnableToggled(bool enable);
+    void slotReset();
+    void slotUpdateTimeout();
+
+private:
+    QCheckBox* m_enableCheck;
+    QTreeWidget* m_tree;
+    QTimer* m_updateTimer;
+};
+
+/** @} */
+
+#endif
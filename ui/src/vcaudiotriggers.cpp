@@ -52,6 +52,7 @@ VCAudioTriggers::VCAudioTriggers(QWidget* parent, Doc* doc)
     , m_label(NULL)
     , m_spectrum(NULL)
     , m_inputCapture(NULL)
+    , m_captureEnabled(false)
 {
     /* Set the class name "VCAudioTriggers" as the object name as well */
     setObjectName(VCAudioTriggers::staticMetaObject.className());
@@ -136,37 +137,42 @@ void VCAudioTriggers::enableCapture(bool enable)
 {
     if (enable == true)
     {
+        if (m_captureEnabled == true)
+            return;
+
         // in case the audio input device has been changed in the meantime...
         m_inputCapture = m_doc->audioInputCapture();
 
-        if (m_inputCapture->isRunning())
-            return;
+        // the capture may already be running for another user (e.g. LTC)
+        if (m_inputCapture->isRunning() == false)
+            m_inputCapture->setBandsNumber(m_spectrum->barsNumber());
 
-        m_inputCapture->setBandsNumber(m_spectrum->barsNumber());
-        if (m_inputCapture->isInitialized() == false)
+        if (m_inputCapture->acquire() == false)
         {
-            if (m_inputCapture->initialize(44100, 1, 2048) == false)
-            {
-                QMessageBox::warning(this, tr("Audio open error"),
-                                     tr("An error occurred while initializing the selected audio device. Please review your audio input settings."));
-                m_button->setChecked(false);
-                return;
-            }
+            QMessageBox::warning(this, tr("Audio open error"),
+                                 tr("An error occurred while initializing the selected audio device. Please review your audio input settings."));
+            m_button->setChecked(false);
+            return;
         }
 
-        m_inputCapture->start();
+        m_captureEnabled = true;
         m_button->setChecked(true);
         connect(m_inputCapture, SIGNAL(dataProcessed(double *, double, quint32)),
                 this, SLOT(slotDisplaySpectrum(double *, double, quint32)));
+        connect(m_inputCapture, SIGNAL(onsetDetected(double)),
+                this, SLOT(slotOnsetDetected()));
     }
     else
     {
-        if (m_inputCapture->isRunning())
-            m_inputCapture->stop();
+        if (m_captureEnabled == true)
+            m_inputCapture->release();
+        m_captureEnabled = false;
 
         m_button->setChecked(false);
         disconnect(m_inputCapture, SIGNAL(dataProcessed(double *, double, quint32)),
                 this, SLOT(slotDisplaySpectrum(double *, double, quint32)));
+        disconnect(m_inputCapture, SIGNAL(onsetDetected(double)),
+                this, SLOT(slotOnsetDetected()));
     }
 }
 
@@ -188,22 +194,33 @@ void VCAudioTriggers::slotEnableButtonToggled(bool toggle)
 void VCAudioTriggers::slotDisplaySpectrum(double *spectrumBands, double maxMagnitude, quint32 power)
 {
     m_spectrum->displaySpectrum(spectrumBands, maxMagnitude, power);
-    m_volumeBar->m_value = m_spectrum->getUcharVolume();
+    updateWidgetBars();
+}
+
+void VCAudioTriggers::slotOnsetDetected()
+{
+    updateWidgetBars();
+}
+
+void VCAudioTriggers::updateWidgetBars()
+{
+    if (m_captureEnabled == false)
+        return;
+
+    m_volumeBar->m_value = m_inputCapture->volumeLevel();
+    for (int i = 0; i < m_spectrumBars.count(); i++)
+        m_spectrumBars[i]->m_value = m_inputCapture->bandLevel(i);
 
     if (m_doc->mode() == Doc::Design)
         return;
 
-    if (m_volumeBar->m_type == AudioBar::FunctionBar)
-        m_volumeBar->checkFunctionThresholds(m_doc);
-    else if (m_volumeBar->m_type == AudioBar::VCWidgetBar)
+    // Function and DMX bars are handled by writeDMX() at every tick
+    if (m_volumeBar->m_type == AudioBar::VCWidgetBar)
         m_volumeBar->checkWidgetFunctionality();
 
     for (int i = 0; i < m_spectrumBars.count(); i++)
     {
-        m_spectrumBars[i]->m_value = m_spectrum->getUcharBand(i);
-        if (m_spectrumBars[i]->m_type == AudioBar::FunctionBar)
-            m_spectrumBars[i]->checkFunctionThresholds(m_doc);
-        else if (m_spectrumBars[i]->m_type == AudioBar::VCWidgetBar)
+        if (m_spectrumBars[i]->m_type == AudioBar::VCWidgetBar)
             m_spectrumBars[i]->checkWidgetFunctionality();
     }
 }
@@ -220,26 +237,43 @@ void VCAudioTriggers::writeDMX(MasterTimer *timer, QList<Universe *> universes)
     if (m_doc->mode() == Doc::Design)
         return;
 
-    if (m_volumeBar->m_type == AudioBar::DMXBar)
+    /* Read the levels directly from the capture thread, so that DMX and
+     * Function bars react within one tick instead of waiting for the GUI */
+    AudioCapture *capture = m_captureEnabled ? m_inputCapture : NULL;
+
+    if (m_volumeBar->m_type == AudioBar::FunctionBar)
+    {
+        if (capture != NULL)
+            m_volumeBar->checkFunctionThresholds(m_doc, capture->volumeLevel());
+    }
+    else if (m_volumeBar->m_type == AudioBar::DMXBar)
     {
+        uchar value = capture ? capture->volumeLevel() : m_volumeBar->m_value;
         for(int i = 0; i < m_volumeBar->m_absDmxChannels.count(); i++)
         {
             quint32 address = m_volumeBar->m_absDmxChannels.at(i) & 0x01FF;
             int uni = m_volumeBar->m_absDmxChannels.at(i) >> 9;
             if (uni < universes.count())
-                universes[uni]->write(address, m_volumeBar->m_value);
+                universes[uni]->write(address, value);
         }
     }
-    foreach(AudioBar *sb, m_spectrumBars)
+    for (int b = 0; b < m_spectrumBars.count(); b++)
     {
-        if (sb->m_type == AudioBar::DMXBar)
+        AudioBar *sb = m_spectrumBars.at(b);
+        if (sb->m_type == AudioBar::FunctionBar)
+        {
+            if (capture != NULL)
+                sb->checkFunctionThresholds(m_doc, capture->bandLevel(b));
+        }
+        else if (sb->m_type == AudioBar::DMXBar)
         {
+            uchar value = capture ? capture->bandLevel(b) : sb->m_value;
             for(int i = 0; i < sb->m_absDmxChannels.count(); i++)
             {
                 quint32 address = sb->m_absDmxChannels.at(i) & 0x01FF;
                 int uni = sb->m_absDmxChannels.at(i) >> 9;
                 if (uni < universes.count())
-                    universes[uni]->write(address, sb->m_value);
+                    universes[uni]->write(address, value);
             }
         }
     }
@@ -69,12 +69,25 @@ public slots:
 protected slots:
     void slotDisplaySpectrum(double *spectrumBands, double maxMagnitude, quint32 power);
 
+    /** React to a beat right away, without waiting for the next spectrum */
+    void slotOnsetDetected();
+
+protected:
+    /**
+     * Read the bar levels from m_inputCapture, the same levels that
+     * writeDMX() uses, and apply them to the VC widgets attached to bars
+     */
+    void updateWidgetBars();
+
 protected:
     QHBoxLayout *m_hbox;
     QToolButton *m_button;
     QLabel *m_label;
     AudioTriggerWidget *m_spectrum;
     AudioCapture *m_inputCapture;
+    /** True when this widget has started the capture. In this case
+     *  all bars read their levels straight from m_inputCapture */
+    bool m_captureEnabled;
 
     AudioBar *m_volumeBar;
     QList <AudioBar *> m_spectrumBars;
@@ -41,7 +41,6 @@
 VCClock::VCClock(QWidget* parent, Doc* doc)
     : VCWidget(parent, doc)
     , m_clocktype(Clock)
-    , m_scheduleIndex(-1)
     , m_hh(0)
     , m_mm(0)
     , m_ss(0)
@@ -70,29 +69,18 @@ VCClock::VCClock(QWidget* parent, Doc* doc)
 
 VCClock::~VCClock()
 {
+    unregisterSchedules();
 }
 
 void VCClock::slotModeChanged(Doc::Mode mode)
 {
     qDebug() << Q_FUNC_INFO;
 
-    if (mode == Doc::Operate)
-    {
-        if (m_scheduleList.count() > 0)
-        {
-            QTime currTime = QDateTime::currentDateTime().time();
-            for(int i = 0; i < m_scheduleList.count(); i++)
-            {
-                VCClockSchedule sch = m_scheduleList.at(i);
-                if (sch.time().time() >= currTime)
-                {
-                    m_scheduleIndex = i;
-                    qDebug() << "VC Clock set to play index:" << i;
-                    break;
-                }
-            }
-        }
-    }
+    if (mode == Doc::Operate && m_clocktype == Clock)
+        registerSchedules();
+    else
+        unregisterSchedules();
+
     VCWidget::slotModeChanged(mode);
 }
 
@@ -157,6 +145,27 @@ QList<VCClockSchedule> VCClock::schedules()
     return m_scheduleList;
 }
 
+void VCClock::registerSchedules()
+{
+    unregisterSchedules();
+
+    Scheduler* scheduler = m_doc->masterTimer()->scheduler();
+    foreach(VCClockSchedule sch, m_scheduleList)
+    {
+        quint32 id = scheduler->addEntry(sch.function(), sch.time().time());
+        if (id != Scheduler::invalidId())
+            m_scheduleEntries.append(id);
+    }
+}
+
+void VCClock::unregisterSchedules()
+{
+    Scheduler* scheduler = m_doc->masterTimer()->scheduler();
+    foreach(quint32 id, m_scheduleEntries)
+        scheduler->removeEntry(id);
+    m_scheduleEntries.clear();
+}
+
 void VCClock::setCountdown(int h, int m, int s)
 {
     m_hh = h;
@@ -187,31 +196,6 @@ void VCClock::slotUpdateTime()
             else if (m_clocktype == Countdown && m_currentTime > 0)
                 m_currentTime--;
         }
-        else
-        {
-            if (m_clocktype == Clock)
-            {
-                if (m_scheduleIndex != -1 && m_scheduleIndex < m_scheduleList.count())
-                {
-                    QTime currTime = QDateTime::currentDateTime().time();
-                    VCClockSchedule sch = m_scheduleList.at(m_scheduleIndex);
-                    //qDebug() << "--- > currTime:" << currTime.toString() << ", schTime:" << sch.time().time().toString();
-                    if (sch.time().time().toString() == currTime.toString())
-                    {
-                        quint32 fid = sch.function();
-                        Function *func = m_doc->function(fid);
-                        if (func != NULL)
-                        {
-                            func->start(m_doc->masterTimer());
-                            qDebug() << "VC Clock starting function:" << func->name();
-                        }
-                        m_scheduleIndex++;
-                        if (m_scheduleIndex == m_scheduleList.count())
-                            m_scheduleIndex = 0;
-                    }
-                }
-            }
-        }
     }
     update();
 }
@@ -101,10 +101,21 @@ public:
     void removeAllSchedule();
     QList<VCClockSchedule> schedules();
 
+private:
+    /**
+     * Hand the schedules over to the engine scheduler, which starts
+     * their functions from the MasterTimer thread
+     */
+    void registerSchedules();
+
+    /** Remove the schedules from the engine scheduler */
+    void unregisterSchedules();
+
 private:
     ClockType m_clocktype;
     QList<VCClockSchedule>m_scheduleList;
-    int m_scheduleIndex;
+    /** Engine scheduler entries of m_scheduleList, while in operate mode */
+    QList<quint32> m_scheduleEntries;
 
     /*********************************************************************
      * Time
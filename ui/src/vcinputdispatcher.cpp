@@ -0,0 +1,203 @@
+/*
+  Q Light Controller Plus
+  vcinputdispatcher.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QMetaObject>
+#include <QTimer>
+#include <QDebug>
+
+#include "vcinputdispatcher.h"
+#include "qlcinputsource.h"
+#include "inputoutputmap.h"
+#include "vcwidget.h"
+
+/*****************************************************************************
+ * Initialization
+ *****************************************************************************/
+
+VCInputDispatcher::VCInputDispatcher(InputOutputMap* ioMap)
+    : QObject(ioMap)
+    , m_dispatchScheduled(false)
+    , m_timer(new QTimer(this))
+{
+    Q_ASSERT(ioMap != NULL);
+
+    m_timer->setSingleShot(true);
+    connect(m_timer, SIGNAL(timeout()), this, SLOT(slotDispatch()));
+
+    /* Values are collected directly in the emitting thread and delivered
+       later in the thread of this object */
+    connect(ioMap, SIGNAL(inputValueChanged(quint32,quint32,uchar)),
+            this, SLOT(slotInputValueChanged(quint32,quint32,uchar)),
+            Qt::DirectConnection);
+}
+
+VCInputDispatcher::~VCInputDispatcher()
+{
+}
+
+VCInputDispatcher* VCInputDispatcher::instance(InputOutputMap* ioMap)
+{
+    Q_ASSERT(ioMap != NULL);
+
+    VCInputDispatcher* dispatcher = ioMap->findChild<VCInputDispatcher*>();
+    if (dispatcher == NULL)
+        dispatcher = new VCInputDispatcher(ioMap);
+
+    return dispatcher;
+}
+
+/*****************************************************************************
+ * Bindings
+ *****************************************************************************/
+
+quint64 VCInputDispatcher::bindingKey(quint32 universe, quint32 channel)
+{
+    return (quint64(universe) << 32) | quint64(channel & 0x0000FFFF);
+}
+
+void VCInputDispatcher::setWidgetSources(VCWidget* widget, const QList <QLCInputSource>& sources)
+{
+    Q_ASSERT(widget != NULL);
+
+    removeWidget(widget);
+
+    QList <quint64> keys;
+    foreach (QLCInputSource src, sources)
+    {
+        if (src.isValid() == false)
+            continue;
+
+        Binding binding;
+        binding.widget = widget;
+        binding.page = src.page();
+
+        quint64 key = bindingKey(src.universe(), src.channel());
+        QList <Binding>& list = m_bindings[key];
+        bool found = false;
+        foreach (Binding b, list)
+        {
+            if (b.widget == widget && b.page == binding.page)
+                found = true;
+        }
+        if (found == false)
+            list.append(binding);
+        if (keys.contains(key) == false)
+            keys.append(key);
+    }
+
+    if (keys.isEmpty() == false)
+        m_widgetKeys[widget] = keys;
+}
+
+void VCInputDispatcher::removeWidget(VCWidget* widget)
+{
+    if (m_widgetKeys.contains(widget) == false)
+        return;
+
+    foreach (quint64 key, m_widgetKeys.take(widget))
+    {
+        QList <Binding>& list = m_bindings[key];
+        for (int i = list.size() - 1; i >= 0; i--)
+        {
+            if (list.at(i).widget == widget)
+                list.removeAt(i);
+        }
+
+        if (list.isEmpty() == true)
+            m_bindings.remove(key);
+    }
+}
+
+/*****************************************************************************
+ * Dispatching
+ *****************************************************************************/
+
+void VCInputDispatcher::slotInputValueChanged(quint32 universe, quint32 channel, uchar value)
+{
+    quint64 key = bindingKey(universe, channel);
+
+    QMutexLocker locker(&m_pendingMutex);
+
+    QHash <quint64, int>::const_iterator it = m_pendingIndex.constFind(key);
+    if (it != m_pendingIndex.constEnd())
+    {
+        PendingValue& last = m_pending[it.value()];
+        /* Coalesce continuous movements, but never hide a press/release */
+        if (last.value != 0 && value != 0)
+        {
+            last.value = value;
+            return;
+        }
+    }
+
+    PendingValue pv;
+    pv.universe = universe;
+    pv.channel = channel;
+    pv.value = value;
+    m_pending.append(pv);
+    m_pendingIndex[key] = m_pending.size() - 1;
+
+    if (m_dispatchScheduled == false)
+    {
+        m_dispatchScheduled = true;
+        QMetaObject::invokeMethod(this, "slotScheduleDispatch", Qt::QueuedConnection);
+    }
+}
+
+void VCInputDispatcher::slotScheduleDispatch()
+{
+    /* Nothing delivered yet, or the last frame is over */
+    if (m_lastDispatch.isValid() == false || m_lastDispatch.elapsed() >= VC_INPUT_FRAME_TIME)
+        slotDispatch();
+    else if (m_timer->isActive() == false)
+        m_timer->start(int(VC_INPUT_FRAME_TIME - m_lastDispatch.elapsed()));
+}
+
+void VCInputDispatcher::slotDispatch()
+{
+    QList <PendingValue> pending;
+
+    m_lastDispatch.start();
+
+    m_pendingMutex.lock();
+    pending = m_pending;
+    m_pending.clear();
+    m_pendingIndex.clear();
+    m_dispatchScheduled = false;
+    m_pendingMutex.unlock();
+
+    foreach (PendingValue pv, pending)
+    {
+        QHash <quint64, QList <Binding> >::const_iterator it =
+                m_bindings.constFind(bindingKey(pv.universe, pv.channel));
+        if (it == m_bindings.constEnd())
+            continue;
+
+        /* Work on a copy, since widgets may change their bindings
+           (e.g. frame page changes) while handling the value */
+        QList <Binding> bindings = it.value();
+        foreach (Binding binding, bindings)
+        {
+            if (int(binding.page) != binding.widget->page())
+                continue;
+
+            binding.widget->slotInputValueChanged(pv.universe, pv.channel, pv.value);
+        }
+    }
+}
@@ -0,0 +1,138 @@
+/*
+  Q Light Controller Plus
+  vcinputdispatcher.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef VCINPUTDISPATCHER_H
+#define VCINPUTDISPATCHER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QMutex>
+#include <QHash>
+#include <QList>
+
+class QLCInputSource;
+class InputOutputMap;
+class VCWidget;
+class QTimer;
+
+/** @addtogroup ui_vc
+ * @{
+ */
+
+/** Input values are delivered to widgets at most once every this many ms */
+#define VC_INPUT_FRAME_TIME 20
+
+/**
+ * VCInputDispatcher delivers external input values only to the Virtual
+ * Console widgets that are bound to them, instead of having every widget
+ * listening and filtering all the values coming from InputOutputMap.
+ *
+ * Bindings are indexed by (universe, channel) and store the input source
+ * page, so that a value reaches only the widgets whose current page
+ * matches. Values are collected from any thread and delivered at most
+ * once per VC_INPUT_FRAME_TIME: the first value after an idle period is
+ * delivered on the next event loop iteration, the following ones wait for
+ * the end of the frame. Consecutive non-zero values of the same channel
+ * are coalesced, so that only the latest fader position is delivered,
+ * while transitions from/to zero (button press and release) are always
+ * delivered. Values are delivered in the order of their channel's first
+ * pending value.
+ */
+class VCInputDispatcher : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(VCInputDispatcher)
+
+    /*********************************************************************
+     * Initialization
+     *********************************************************************/
+public:
+    /** Get the dispatcher of $ioMap, creating it if necessary */
+    static VCInputDispatcher* instance(InputOutputMap* ioMap);
+
+    ~VCInputDispatcher();
+
+private:
+    VCInputDispatcher(InputOutputMap* ioMap);
+
+    /*********************************************************************
+     * Bindings
+     *********************************************************************/
+public:
+    /**
+     * Set the input sources that $widget listens to, replacing any
+     * previous binding of the widget. An empty list removes the widget.
+     */
+    void setWidgetSources(VCWidget* widget, const QList <QLCInputSource>& sources);
+
+    /** Remove all bindings of $widget */
+    void removeWidget(VCWidget* widget);
+
+private:
+    /** Build the index key of an input universe and channel (without page) */
+    static quint64 bindingKey(quint32 universe, quint32 channel);
+
+    typedef struct
+    {
+        VCWidget* widget;
+        ushort page;
+    } Binding;
+
+    /** Widgets bound to each (universe, channel) pair */
+    QHash <quint64, QList <Binding> > m_bindings;
+
+    /** Index keys used by each widget, to remove its bindings quickly */
+    QHash <VCWidget*, QList <quint64> > m_widgetKeys;
+
+    /*********************************************************************
+     * Dispatching
+     *********************************************************************/
+private slots:
+    /** Collect a value coming from InputOutputMap, from any thread */
+    void slotInputValueChanged(quint32 universe, quint32 channel, uchar value);
+
+    /** Deliver the collected values now, or at the end of the current frame */
+    void slotScheduleDispatch();
+
+    /** Deliver the collected values to the bound widgets */
+    void slotDispatch();
+
+private:
+    typedef struct
+    {
+        quint32 universe;
+        quint32 channel;
+        uchar value;
+    } PendingValue;
+
+    /** Guards the pending values, filled from the input threads */
+    QMutex m_pendingMutex;
+    QList <PendingValue> m_pending;
+    /** Index in m_pending of the last value queued for each key */
+    QHash <quint64, int> m_pendingIndex;
+    bool m_dispatchScheduled;
+
+    /** Time since the last delivery and end of frame timer, GUI thread only */
+    QElapsedTimer m_lastDispatch;
+    QTimer* m_timer;
+};
+
+/** @} */
+
+#endif
@@ -111,6 +111,9 @@ VCSlider::VCSlider(QWidget* parent, Doc* doc) : VCWidget(parent, doc)
 
     m_levelValue = 0;
     m_levelValueChanged = false;
+    m_levelCngValues[0] = m_levelCngValues[1] = m_levelCngValues[2] = 0;
+    m_levelLastIntensity = -1;
+    m_levelHTPActive = false;
 
     m_playbackFunction = Function::invalidId();
     m_playbackValue = 0;
@@ -210,6 +213,11 @@ VCSlider::VCSlider(QWidget* parent, Doc* doc) : VCWidget(parent, doc)
        they no longer point to an existing fixture->channel */
     connect(m_doc, SIGNAL(fixtureRemoved(quint32)),
             this, SLOT(slotFixtureRemoved(quint32)));
+    /* Level channels are resolved to DMX addresses, which depend on fixtures */
+    connect(m_doc, SIGNAL(fixtureAdded(quint32)),
+            this, SLOT(slotFixtureChanged(quint32)));
+    connect(m_doc, SIGNAL(fixtureChanged(quint32)),
+            this, SLOT(slotFixtureChanged(quint32)));
 }
 
 VCSlider::~VCSlider()
@@ -259,6 +267,7 @@ bool VCSlider::copyFrom(const VCWidget* widget)
     setLevelLowLimit(slider->levelLowLimit());
     setLevelHighLimit(slider->levelHighLimit());
     m_levelChannels = slider->m_levelChannels;
+    updateLevelChannelsCache();
 
     /* Copy playback stuff */
     m_playbackFunction = slider->m_playbackFunction;
@@ -566,18 +575,21 @@ void VCSlider::addLevelChannel(quint32 fixture, quint32 channel)
     {
         m_levelChannels.append(lch);
         qSort(m_levelChannels.begin(), m_levelChannels.end());
+        updateLevelChannelsCache();
     }
 }
 
 void VCSlider::removeLevelChannel(quint32 fixture, quint32 channel)
 {
     LevelChannel lch(fixture, channel);
-    m_levelChannels.removeAll(lch);
+    if (m_levelChannels.removeAll(lch) > 0)
+        updateLevelChannelsCache();
 }
 
 void VCSlider::clearLevelChannels()
 {
     m_levelChannels.clear();
+    updateLevelChannelsCache();
 }
 
 QList <VCSlider::LevelChannel> VCSlider::levelChannels()
@@ -610,6 +622,7 @@ void VCSlider::setLevelValue(uchar value)
     m_levelValueMutex.lock();
     m_levelValue = value;
     m_levelValueChanged = true;
+    updateClickAndGoLevels();
     m_levelValueMutex.unlock();
 }
 
@@ -627,6 +640,105 @@ void VCSlider::slotFixtureRemoved(quint32 fxi_id)
         if (it.value().fixture == fxi_id)
             it.remove();
     }
+
+    updateLevelChannelsCache();
+}
+
+void VCSlider::slotFixtureChanged(quint32 fxi_id)
+{
+    QListIterator <LevelChannel> it(m_levelChannels);
+    while (it.hasNext() == true)
+    {
+        if (it.next().fixture == fxi_id)
+        {
+            updateLevelChannelsCache();
+            break;
+        }
+    }
+}
+
+void VCSlider::updateLevelChannelsCache()
+{
+    QVector <LevelChannelCache> cache;
+    cache.reserve(m_levelChannels.size());
+
+    QListIterator <LevelChannel> it(m_levelChannels);
+    while (it.hasNext() == true)
+    {
+        LevelChannel lch(it.next());
+        Fixture* fxi = m_doc->fixture(lch.fixture);
+        if (fxi == NULL)
+            continue;
+
+        const QLCChannel* qlcch = fxi->channel(lch.channel);
+        if (qlcch == NULL)
+            continue;
+
+        LevelChannelCache entry;
+        entry.universe = fxi->universe();
+        entry.address = fxi->address() + lch.channel;
+        entry.intensity = (qlcch->group() == QLCChannel::Intensity);
+        entry.colourIndex = -1;
+
+        if (entry.intensity == true)
+        {
+            QLCChannel::PrimaryColour col = qlcch->colour();
+            if (m_cngType == ClickAndGoWidget::RGB)
+            {
+                if (col == QLCChannel::Red)
+                    entry.colourIndex = 0;
+                else if (col == QLCChannel::Green)
+                    entry.colourIndex = 1;
+                else if (col == QLCChannel::Blue)
+                    entry.colourIndex = 2;
+            }
+            else if (m_cngType == ClickAndGoWidget::CMY)
+            {
+                if (col == QLCChannel::Cyan)
+                    entry.colourIndex = 0;
+                else if (col == QLCChannel::Magenta)
+                    entry.colourIndex = 1;
+                else if (col == QLCChannel::Yellow)
+                    entry.colourIndex = 2;
+            }
+        }
+
+        cache.append(entry);
+    }
+
+    QMutexLocker locker(&m_levelValueMutex);
+    m_levelChannelsCache = cache;
+    /* Make sure LTP channels get written with the new addresses */
+    m_levelValueChanged = true;
+}
+
+void VCSlider::updateClickAndGoLevels()
+{
+    m_levelCngValues[0] = m_levelCngValues[1] = m_levelCngValues[2] = 0;
+
+    if (m_cngType != ClickAndGoWidget::RGB && m_cngType != ClickAndGoWidget::CMY)
+        return;
+
+    float f = 0;
+    if (m_slider)
+        f = SCALE(float(m_levelValue), float(m_slider->minimum()),
+                  float(m_slider->maximum()), float(0), float(200));
+    if ((uchar)f == 0)
+        return;
+
+    QColor modColor = m_cngRGBvalue.lighter((uchar)f);
+    if (m_cngType == ClickAndGoWidget::RGB)
+    {
+        m_levelCngValues[0] = modColor.red();
+        m_levelCngValues[1] = modColor.green();
+        m_levelCngValues[2] = modColor.blue();
+    }
+    else
+    {
+        m_levelCngValues[0] = modColor.cyan();
+        m_levelCngValues[1] = modColor.magenta();
+        m_levelCngValues[2] = modColor.yellow();
+    }
 }
 
 /*********************************************************************
@@ -636,6 +748,12 @@ void VCSlider::slotFixtureRemoved(quint32 fxi_id)
 void VCSlider::setClickAndGoType(ClickAndGoWidget::ClickAndGo type)
 {
     m_cngType = type;
+
+    updateLevelChannelsCache();
+
+    m_levelValueMutex.lock();
+    updateClickAndGoLevels();
+    m_levelValueMutex.unlock();
 }
 
 ClickAndGoWidget::ClickAndGo VCSlider::clickAndGoType() const
@@ -716,6 +834,11 @@ void VCSlider::slotClickAndGoColorChanged(QRgb color)
 {
     QColor col(color);
     m_cngRGBvalue = col;
+
+    m_levelValueMutex.lock();
+    updateClickAndGoLevels();
+    m_levelValueChanged = true;
+    m_levelValueMutex.unlock();
     QPixmap px(42, 42);
     px.fill(col);
     m_cngButton->setIcon(px);
@@ -815,88 +938,42 @@ void VCSlider::writeDMXLevel(MasterTimer* timer, QList<Universe *> universes)
 {
     Q_UNUSED(timer);
 
-    m_levelValueMutex.lock();
+    QMutexLocker locker(&m_levelValueMutex);
 
-    uchar modLevel = m_levelValue;
+    qreal currentIntensity = intensity();
+    bool changed = m_levelValueChanged || currentIntensity != m_levelLastIntensity;
 
-    int r = 0, g = 0, b = 0, c = 0, m = 0, y = 0;
-    if (m_cngType == ClickAndGoWidget::RGB)
-    {
-        float f = 0;
-        if (m_slider)
-            f = SCALE(float(m_levelValue), float(m_slider->minimum()),
-                      float(m_slider->maximum()), float(0), float(200));
-        if ((uchar)f != 0)
-        {
-            QColor modColor = m_cngRGBvalue.lighter((uchar)f);
-            r = modColor.red();
-            g = modColor.green();
-            b = modColor.blue();
-        }
-    }
-    else if (m_cngType == ClickAndGoWidget::CMY)
-    {
-        float f = 0;
-        if (m_slider)
-            f = SCALE(float(m_levelValue), float(m_slider->minimum()),
-                      float(m_slider->maximum()), float(0), float(200));
-        if ((uchar)f != 0)
-        {
-            QColor modColor = m_cngRGBvalue.lighter((uchar)f);
-            c = modColor.cyan();
-            m = modColor.magenta();
-            y = modColor.yellow();
-        }
-    }
+    /* Intensity channels are HTP and get zeroed on every cycle, so they must
+       be written again as long as they hold a non-zero value. LTP channels
+       keep their value, so nothing to do if nothing changed. */
+    if (changed == false && m_levelHTPActive == false)
+        return;
 
-    QListIterator <LevelChannel> it(m_levelChannels);
-    while (it.hasNext() == true)
+    bool htpActive = false;
+    int count = m_levelChannelsCache.size();
+    for (int i = 0; i < count; i++)
     {
-        LevelChannel lch(it.next());
-        Fixture* fxi = m_doc->fixture(lch.fixture);
-        if (fxi != NULL)
-        {
-            const QLCChannel* qlcch = fxi->channel(lch.channel);
-            if (qlcch == NULL)
-                continue;
+        const LevelChannelCache& lch = m_levelChannelsCache.at(i);
 
-            if (qlcch->group() != QLCChannel::Intensity &&
-                m_levelValueChanged == false)
-            {
-                /* Value has not changed and this is not an intensity channel.
-                   LTP in effect. */
-                continue;
-            }
-            if (qlcch->group() == QLCChannel::Intensity)
-            {
-                if (m_cngType == ClickAndGoWidget::RGB)
-                {
-                    if (qlcch->colour() == QLCChannel::Red)
-                        modLevel = (uchar)r;
-                    else if (qlcch->colour() == QLCChannel::Green)
-                        modLevel = (uchar)g;
-                    else if (qlcch->colour() == QLCChannel::Blue)
-                        modLevel = (uchar)b;
-                }
-                else if (m_cngType == ClickAndGoWidget::CMY)
-                {
-                    if (qlcch->colour() == QLCChannel::Cyan)
-                        modLevel = (uchar)c;
-                    else if (qlcch->colour() == QLCChannel::Magenta)
-                        modLevel = (uchar)m;
-                    else if (qlcch->colour() == QLCChannel::Yellow)
-                        modLevel = (uchar)y;
-                }
-            }
+        /* Value has not changed and this is not an intensity channel.
+           LTP in effect. */
+        if (lch.intensity == false && changed == false)
+            continue;
 
-            quint32 dmx_ch = fxi->address() + lch.channel;
-            int uni = fxi->universe();
-            if (uni < universes.count())
-                universes[uni]->write(dmx_ch, modLevel * intensity());
-        }
+        uchar modLevel = m_levelValue;
+        if (lch.colourIndex >= 0)
+            modLevel = m_levelCngValues[lch.colourIndex];
+
+        if (lch.intensity == true && modLevel != 0)
+            htpActive = true;
+
+        if (lch.universe < (quint32)universes.count())
+            universes[lch.universe]->write(lch.address, modLevel * currentIntensity);
     }
+
+    m_levelHTPActive = htpActive;
+    m_levelLastIntensity = currentIntensity;
     m_levelValueChanged = false;
-    m_levelValueMutex.unlock();
 }
 
 void VCSlider::writeDMXPlayback(MasterTimer* timer, QList<Universe *> ua)
@@ -20,6 +20,7 @@
 #ifndef VCSLIDER_H
 #define VCSLIDER_H
 
+#include <QVector>
 #include <QMutex>
 #include <QList>
 
@@ -300,6 +301,35 @@ protected slots:
     /** Removes all level channels related to removed fixture */
     void slotFixtureRemoved(quint32 fxi_id);
 
+    /** Resolves again the level channels when a fixture is added or changed */
+    void slotFixtureChanged(quint32 fxi_id);
+
+protected:
+    /**
+     * A level channel resolved to its DMX address, so that writeDMXLevel()
+     * doesn't need to look up fixtures and channel definitions every cycle.
+     */
+    typedef struct
+    {
+        quint32 universe;
+        quint32 address;
+        /** Index of the Click & Go colour component in m_levelCngValues or -1 */
+        int colourIndex;
+        bool intensity;
+    } LevelChannelCache;
+
+    /**
+     * Rebuild m_levelChannelsCache from m_levelChannels. Must be called
+     * every time level channels, fixtures or the Click & Go type change.
+     */
+    void updateLevelChannelsCache();
+
+    /**
+     * Compute the Click & Go colour components for the current level.
+     * m_levelValueMutex must be locked by the caller.
+     */
+    void updateClickAndGoLevels();
+
 protected:
     QList <VCSlider::LevelChannel> m_levelChannels;
     uchar m_levelLowLimit;
@@ -309,6 +339,15 @@ protected:
     bool m_levelValueChanged;
     uchar m_levelValue;
 
+    /** Level channels resolved for writeDMXLevel(), guarded by m_levelValueMutex */
+    QVector <LevelChannelCache> m_levelChannelsCache;
+    /** RGB or CMY components written to Click & Go colour channels */
+    uchar m_levelCngValues[3];
+    /** Widget intensity used for the last write */
+    qreal m_levelLastIntensity;
+    /** True if the last write put a non-zero value on an HTP channel */
+    bool m_levelHTPActive;
+
     /*********************************************************************
      * Playback
      *********************************************************************/
@@ -44,6 +44,7 @@
 #include "qlcfile.h"
 
 #include "qlcinputchannel.h"
+#include "vcinputdispatcher.h"
 #include "virtualconsole.h"
 #include "vcproperties.h"
 #include "inputpatch.h"
@@ -96,6 +97,8 @@ VCWidget::VCWidget(QWidget* parent, Doc* doc)
 
 VCWidget::~VCWidget()
 {
+    if (m_inputs.isEmpty() == false)
+        VCInputDispatcher::instance(m_doc->inputOutputMap())->removeWidget(this);
 }
 
 
@@ -492,21 +495,14 @@ qreal VCWidget::intensity()
 
 void VCWidget::setInputSource(const QLCInputSource& source, quint8 id)
 {
-    // Connect when the first valid input source is set
-    if (m_inputs.isEmpty() == true && source.isValid() == true)
-        connect(m_doc->inputOutputMap(), SIGNAL(inputValueChanged(quint32,quint32,uchar)),
-                this, SLOT(slotInputValueChanged(quint32,quint32,uchar)));
-
     // Assign or clear
     if (source.isValid() == true)
         m_inputs[id] = source;
-    else
-        m_inputs.remove(id);
+    else if (m_inputs.remove(id) == 0)
+        return;
 
-    // Disconnect when there are no more input sources present
-    if (m_inputs.isEmpty() == true)
-        disconnect(m_doc->inputOutputMap(), SIGNAL(inputValueChanged(quint32,quint32,uchar)),
-                   this, SLOT(slotInputValueChanged(quint32,quint32,uchar)));
+    // Only the widgets bound to an input source receive its values
+    VCInputDispatcher::instance(m_doc->inputOutputMap())->setWidgetSources(this, m_inputs.values());
 }
 
 QLCInputSource VCWidget::inputSource(quint8 id) const
@@ -74,6 +74,8 @@ class VCWidget : public QWidget
     Q_OBJECT
     Q_DISABLE_COPY(VCWidget)
 
+    friend class VCInputDispatcher;
+
     /*********************************************************************
      * Initialization
      *********************************************************************/
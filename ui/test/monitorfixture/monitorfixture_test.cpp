@@ -22,6 +22,7 @@
 
 #define protected public
 #define private public
+#include "monitorchannelgrid.h"
 #include "monitorfixture.h"
 #undef protected
 #undef private
@@ -53,8 +54,7 @@ void MonitorFixture_Test::initial()
     QCOMPARE(mof.m_valueStyle, Monitor::DMXValues);
     QCOMPARE(mof.frameStyle(), QFrame::StyledPanel | QFrame::Sunken);
     QVERIFY(mof.layout() != NULL);
-    QCOMPARE(mof.m_channelLabels.size(), 0);
-    QCOMPARE(mof.m_valueLabels.size(), 0);
+    QVERIFY(mof.m_channelGrid == NULL);
     QCOMPARE(mof.autoFillBackground(), true);
     QCOMPARE(mof.backgroundRole(), QPalette::Window);
 }
@@ -75,16 +75,12 @@ void MonitorFixture_Test::fixture()
     QCOMPARE(mof.fixture(), fxi->id());
     QVERIFY(mof.m_fixtureLabel != NULL);
     QCOMPARE(mof.m_fixtureLabel->text(), QString("<B>Foobar</B>"));
-    QCOMPARE(mof.m_channelLabels.size(), 6);
-    QCOMPARE(mof.m_valueLabels.size(), 6);
-    for (int i = 0; i < mof.m_channelLabels.size(); i++)
-    {
-        QVERIFY(mof.m_channelLabels[i] != NULL);
-        QCOMPARE(mof.m_channelLabels[i]->text(), QString());
-
-        QVERIFY(mof.m_valueLabels[i] != NULL);
-        QCOMPARE(mof.m_valueLabels[i]->text(), QString());
-    }
+    QVERIFY(mof.m_channelGrid != NULL);
+    QCOMPARE(mof.m_channelGrid->channelCount(), 6);
+    QCOMPARE(mof.m_universe, fxi->universe());
+    QCOMPARE(mof.m_address, fxi->address());
+    for (int i = 0; i < mof.m_channelGrid->channelCount(); i++)
+        QCOMPARE(mof.m_channelGrid->value(i), uchar(0));
 }
 
 void MonitorFixture_Test::lessThan()
@@ -140,58 +136,47 @@ void MonitorFixture_Test::channelValueStyles()
 
     MonitorFixture mof(&w, m_doc);
     mof.setFixture(fxi->id());
+    MonitorChannelGrid* grid = mof.m_channelGrid;
+    QVERIFY(grid != NULL);
 
     mof.updateLabelStyles();
-    for (int i = 0; i < mof.m_channelLabels.size(); i++)
+    for (int i = 0; i < grid->channelCount(); i++)
     {
         QString str;
-        QVERIFY(mof.m_channelLabels[i] != NULL);
-        QCOMPARE(mof.m_channelLabels[i]->text(), str.sprintf("<B>%.3d</B>", i + fxi->address() + 1));
-
-        QVERIFY(mof.m_valueLabels[i] != NULL);
-        QCOMPARE(mof.m_valueLabels[i]->text(), QString("000"));
+        QCOMPARE(grid->channelText(i), str.sprintf("%.3d", i + fxi->address() + 1));
+        QCOMPARE(grid->valueText(i), QString("000"));
     }
 
     mof.slotChannelStyleChanged(Monitor::RelativeChannels);
     mof.updateLabelStyles();
-    for (int i = 0; i < mof.m_channelLabels.size(); i++)
+    for (int i = 0; i < grid->channelCount(); i++)
     {
         QString str;
-        QVERIFY(mof.m_channelLabels[i] != NULL);
-        QCOMPARE(mof.m_channelLabels[i]->text(), str.sprintf("<B>%.3d</B>", i + 1));
-
-        QVERIFY(mof.m_valueLabels[i] != NULL);
-        QCOMPARE(mof.m_valueLabels[i]->text(), QString("000"));
+        QCOMPARE(grid->channelText(i), str.sprintf("%.3d", i + 1));
+        QCOMPARE(grid->valueText(i), QString("000"));
     }
 
     mof.slotChannelStyleChanged(Monitor::DMXChannels);
-    for (int i = 0; i < mof.m_channelLabels.size(); i++)
+    for (int i = 0; i < grid->channelCount(); i++)
     {
         QString str;
-        QVERIFY(mof.m_channelLabels[i] != NULL);
-        QCOMPARE(mof.m_channelLabels[i]->text(), str.sprintf("<B>%.3d</B>", i + fxi->address() + 1));
-
-        QVERIFY(mof.m_valueLabels[i] != NULL);
-        QCOMPARE(mof.m_valueLabels[i]->text(), QString("000"));
+        QCOMPARE(grid->channelText(i), str.sprintf("%.3d", i + fxi->address() + 1));
+        QCOMPARE(grid->valueText(i), QString("000"));
     }
 
-    for (int i = 0; i < mof.m_valueLabels.size(); i++)
-    {
-        QString str;
-        mof.m_valueLabels[i]->setText(str.sprintf("%.3d", (i + 1) * 10));
-    }
+    QByteArray ba(32, 0);
+    for (int i = 0; i < grid->channelCount(); i++)
+        ba[fxi->address() + i] = (i + 1) * 10;
+    mof.updateValues(0, ba);
 
     mof.slotValueStyleChanged(Monitor::PercentageValues);
-    for (int i = 0; i < mof.m_channelLabels.size(); i++)
+    for (int i = 0; i < grid->channelCount(); i++)
     {
         QString str;
-        QVERIFY(mof.m_channelLabels[i] != NULL);
-        QCOMPARE(mof.m_channelLabels[i]->text(), str.sprintf("<B>%.3d</B>", i + fxi->address() + 1));
-
-        QVERIFY(mof.m_valueLabels[i] != NULL);
-        QCOMPARE(mof.m_valueLabels[i]->text(), str.sprintf("%.3d", (int) ceil(SCALE(qreal((i + 1) * 10), 
-                                                                                    qreal(0), qreal(UCHAR_MAX), 
-                                                                                    qreal(0), qreal(100)))));
+        QCOMPARE(grid->channelText(i), str.sprintf("%.3d", i + fxi->address() + 1));
+        QCOMPARE(grid->valueText(i), str.sprintf("%.3d", (int) ceil(SCALE(qreal((i + 1) * 10),
+                                                                          qreal(0), qreal(UCHAR_MAX),
+                                                                          qreal(0), qreal(100)))));
     }
 }
 
@@ -208,24 +193,40 @@ void MonitorFixture_Test::updateValues()
 
     MonitorFixture mof(&w, m_doc);
     mof.setFixture(fxi->id());
+    MonitorChannelGrid* grid = mof.m_channelGrid;
+    QVERIFY(grid != NULL);
 
     QByteArray ba(10, 0);
     for (int i = 0; i < 10; i++)
         ba[i] = 127 + i;
 
+    /* Values of other universes are ignored */
+    mof.updateValues(1, ba);
+    for (int i = 0; i < grid->channelCount(); i++)
+        QCOMPARE(grid->value(i), uchar(0));
+
     mof.updateValues(0, ba);
-    for (int i = 0; i < mof.m_valueLabels.size(); i++)
+    for (int i = 0; i < grid->channelCount(); i++)
     {
         QString str;
-        QCOMPARE(mof.m_valueLabels[i]->text(), str.sprintf("%.3d", 127 + i));
+        QCOMPARE(grid->valueText(i), str.sprintf("%.3d", 127 + i));
     }
 
+    /* Only changed values are reported */
+    QCOMPARE(grid->setValues(ba, 0), 0);
+    ba[2] = 0;
+    QCOMPARE(grid->setValues(ba, 0), 1);
+    QCOMPARE(grid->value(2), uchar(0));
+
+    /* Short universes don't overflow */
+    QCOMPARE(grid->setValues(QByteArray(3, 0), 0), 2);
+
     mof.slotValueStyleChanged(Monitor::PercentageValues);
     mof.updateValues(0, ba);
-    for (int i = 0; i < mof.m_valueLabels.size(); i++)
+    for (int i = 3; i < grid->channelCount(); i++)
     {
         QString str;
-        QCOMPARE(mof.m_valueLabels[i]->text(), str.sprintf("%.3d",
+        QCOMPARE(grid->valueText(i), str.sprintf("%.3d",
             int(ceil(SCALE(qreal(127 + i), qreal(0), qreal(UCHAR_MAX), qreal(0), qreal(100))))));
     }
 }
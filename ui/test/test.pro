@@ -10,6 +10,7 @@ SUBDIRS += vcbutton
 SUBDIRS += vccuelist
 SUBDIRS += vcframe
 SUBDIRS += vcframeproperties
+SUBDIRS += vcinputdispatcher
 SUBDIRS += vclabel
 SUBDIRS += vcproperties
 SUBDIRS += vcwidget
@@ -0,0 +1,4 @@
+#!/bin/sh
+LD_LIBRARY_PATH=../../src:../../../engine/src \
+    DYLD_FALLBACK_LIBRARY_PATH=../../src:../../../engine/src \
+    ./vcinputdispatcher_test
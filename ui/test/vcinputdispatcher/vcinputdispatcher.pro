@@ -0,0 +1,22 @@
+include(../../../variables.pri)
+
+TEMPLATE = app
+LANGUAGE = C++
+TARGET   = vcinputdispatcher_test
+
+QT      += testlib xml gui script
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+INCLUDEPATH += ../../../plugins/interfaces
+INCLUDEPATH += ../../../engine/src
+INCLUDEPATH += ../../src
+INCLUDEPATH += ../vcwidget
+DEPENDPATH  += ../../src
+
+QMAKE_LIBDIR += ../../../engine/src
+QMAKE_LIBDIR += ../../src
+LIBS        += -lqlcplusengine -lqlcplusui
+
+# Test sources
+SOURCES += vcinputdispatcher_test.cpp ../vcwidget/stubwidget.cpp
+HEADERS += vcinputdispatcher_test.h ../vcwidget/stubwidget.h
@@ -0,0 +1,231 @@
+/*
+  Q Light Controller Plus
+  vcinputdispatcher_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#define private public
+#define protected public
+#include "vcinputdispatcher_test.h"
+#include "vcinputdispatcher.h"
+#include "inputoutputmap.h"
+#include "virtualconsole.h"
+#include "qlcinputsource.h"
+#include "doc.h"
+#undef protected
+#undef private
+
+typedef QPair<quint32,uchar> Received;
+
+RecorderWidget::RecorderWidget(QWidget* parent, Doc* doc)
+    : StubWidget(parent, doc)
+{
+}
+
+void RecorderWidget::slotInputValueChanged(quint32 universe, quint32 channel, uchar value)
+{
+    Q_UNUSED(universe);
+    m_received << Received(channel, value);
+}
+
+/****************************************************************************
+ * Helpers
+ ****************************************************************************/
+
+void VCInputDispatcher_Test::input(quint32 universe, quint32 channel, uchar value)
+{
+    emit m_doc->inputOutputMap()->inputValueChanged(universe, channel, value);
+}
+
+VCInputDispatcher* VCInputDispatcher_Test::dispatcher()
+{
+    return VCInputDispatcher::instance(m_doc->inputOutputMap());
+}
+
+void VCInputDispatcher_Test::dispatch()
+{
+    dispatcher()->m_timer->stop();
+    dispatcher()->slotDispatch();
+}
+
+/****************************************************************************
+ * Tests
+ ****************************************************************************/
+
+void VCInputDispatcher_Test::initTestCase()
+{
+    m_doc = NULL;
+}
+
+void VCInputDispatcher_Test::init()
+{
+    m_doc = new Doc(this);
+    new VirtualConsole(NULL, m_doc);
+}
+
+void VCInputDispatcher_Test::cleanup()
+{
+    delete VirtualConsole::instance();
+    delete m_doc;
+}
+
+void VCInputDispatcher_Test::routing()
+{
+    QWidget w;
+    RecorderWidget w1(&w, m_doc);
+    RecorderWidget w2(&w, m_doc);
+    w1.setInputSource(QLCInputSource(0, 1));
+    w2.setInputSource(QLCInputSource(1, 2));
+
+    input(0, 1, 10);
+    input(1, 2, 20);
+    input(0, 2, 30);
+    input(1, 1, 40);
+    dispatch();
+
+    QCOMPARE(w1.m_received.count(), 1);
+    QCOMPARE(w1.m_received.at(0), Received(1, 10));
+    QCOMPARE(w2.m_received.count(), 1);
+    QCOMPARE(w2.m_received.at(0), Received(2, 20));
+}
+
+void VCInputDispatcher_Test::page()
+{
+    QWidget w;
+    RecorderWidget w1(&w, m_doc);
+
+    // Channel 3 on page 1
+    w1.setInputSource(QLCInputSource(0, (1 << 16) | 3));
+
+    input(0, 3, 10);
+    dispatch();
+    QCOMPARE(w1.m_received.count(), 0);
+
+    w1.setPage(1);
+    input(0, 3, 20);
+    dispatch();
+    QCOMPARE(w1.m_received.count(), 1);
+    QCOMPARE(w1.m_received.at(0).second, uchar(20));
+}
+
+void VCInputDispatcher_Test::removeWidget()
+{
+    QWidget w;
+    RecorderWidget w1(&w, m_doc);
+    w1.setInputSource(QLCInputSource(0, 1));
+
+    w1.setInputSource(QLCInputSource());
+    input(0, 1, 10);
+    dispatch();
+    QCOMPARE(w1.m_received.count(), 0);
+
+    w1.setInputSource(QLCInputSource(0, 1));
+    dispatcher()->removeWidget(&w1);
+    input(0, 1, 10);
+    dispatch();
+    QCOMPARE(w1.m_received.count(), 0);
+}
+
+void VCInputDispatcher_Test::coalesce()
+{
+    QWidget w;
+    RecorderWidget w1(&w, m_doc);
+    w1.setInputSource(QLCInputSource(0, 1));
+
+    // A fader moving fast: only the latest position is delivered
+    for (int i = 1; i <= 200; i++)
+        input(0, 1, uchar(i));
+    dispatch();
+
+    QCOMPARE(w1.m_received.count(), 1);
+    QCOMPARE(w1.m_received.at(0), Received(1, 200));
+}
+
+void VCInputDispatcher_Test::pressRelease()
+{
+    QWidget w;
+    RecorderWidget w1(&w, m_doc);
+    w1.setInputSource(QLCInputSource(0, 1));
+
+    // A button pressed twice in the same frame: nothing is lost
+    input(0, 1, 127);
+    input(0, 1, 0);
+    input(0, 1, 127);
+    input(0, 1, 0);
+    dispatch();
+
+    QCOMPARE(w1.m_received.count(), 4);
+    QCOMPARE(w1.m_received.at(0).second, uchar(127));
+    QCOMPARE(w1.m_received.at(1).second, uchar(0));
+    QCOMPARE(w1.m_received.at(2).second, uchar(127));
+    QCOMPARE(w1.m_received.at(3).second, uchar(0));
+}
+
+void VCInputDispatcher_Test::ordering()
+{
+    QWidget w;
+    RecorderWidget w1(&w, m_doc);
+    w1.setInputSource(QLCInputSource(0, 1), 0);
+    w1.setInputSource(QLCInputSource(0, 2), 1);
+
+    input(0, 1, 10);
+    input(0, 2, 20);
+    input(0, 1, 30);
+    input(0, 2, 40);
+    input(0, 2, 0);
+    dispatch();
+
+    // Coalesced values keep the position of their first pending value
+    QCOMPARE(w1.m_received.count(), 3);
+    QCOMPARE(w1.m_received.at(0), Received(1, 30));
+    QCOMPARE(w1.m_received.at(1), Received(2, 40));
+    QCOMPARE(w1.m_received.at(2), Received(2, 0));
+}
+
+void VCInputDispatcher_Test::frame()
+{
+    QWidget w;
+    RecorderWidget w1(&w, m_doc);
+    w1.setInputSource(QLCInputSource(0, 1));
+
+    // Nothing delivered yet: the first value goes out right away
+    QVERIFY(dispatcher()->m_lastDispatch.isValid() == false);
+    input(0, 1, 10);
+    QCoreApplication::processEvents();
+    QCOMPARE(w1.m_received.count(), 1);
+    QVERIFY(dispatcher()->m_timer->isActive() == false);
+
+    // Right after a delivery, values wait for the end of the frame
+    dispatcher()->m_lastDispatch.start();
+    input(0, 1, 20);
+    input(0, 1, 0);
+    QCoreApplication::processEvents();
+    input(0, 1, 30);
+    QCoreApplication::processEvents();
+    QCOMPARE(w1.m_received.count(), 1);
+    QVERIFY(dispatcher()->m_timer->isActive() == true);
+
+    // End of the frame
+    dispatch();
+    QCOMPARE(w1.m_received.count(), 4);
+    QCOMPARE(w1.m_received.at(1), Received(1, 20));
+    QCOMPARE(w1.m_received.at(2), Received(1, 0));
+    QCOMPARE(w1.m_received.at(3), Received(1, 30));
+}
+
+QTEST_MAIN(VCInputDispatcher_Test)
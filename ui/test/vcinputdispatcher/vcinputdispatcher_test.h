@@ -0,0 +1,76 @@
+/*
+  Q Light Controller Plus
+  vcinputdispatcher_test.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef VCINPUTDISPATCHER_TEST_H
+#define VCINPUTDISPATCHER_TEST_H
+
+#include <QObject>
+#include <QPair>
+#include <QList>
+
+#include "stubwidget.h"
+
+class VCInputDispatcher;
+class Doc;
+
+/** A widget that records the input values it receives */
+class RecorderWidget : public StubWidget
+{
+public:
+    RecorderWidget(QWidget* parent, Doc* doc);
+
+    /** Received (channel, value) pairs */
+    QList < QPair<quint32,uchar> > m_received;
+
+protected:
+    void slotInputValueChanged(quint32 universe, quint32 channel, uchar value);
+};
+
+class VCInputDispatcher_Test : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void routing();
+    void page();
+    void removeWidget();
+    void coalesce();
+    void pressRelease();
+    void ordering();
+    void frame();
+
+private:
+    /** Emit a value as if it came from an input plugin */
+    void input(quint32 universe, quint32 channel, uchar value);
+
+    /** Get the dispatcher of the test Doc */
+    VCInputDispatcher* dispatcher();
+
+    /** Deliver the pending values, as at the end of a frame */
+    void dispatch();
+
+private:
+    Doc* m_doc;
+};
+
+#endif
@@ -57,6 +57,20 @@ do
     fi
 done
 
+#############################################################################
+# Web access tests
+#############################################################################
+
+pushd .
+cd webaccess/test
+./test.sh
+RESULT=$?
+if [ $RESULT != 0 ]; then
+	echo "${RESULT} Web access unit tests failed. Please fix before commit."
+	exit $RESULT
+fi
+popd
+
 #############################################################################
 # Enttec wing tests
 #############################################################################
@@ -25,25 +25,53 @@
     " websocket.onerror = function(ev) {\n" \
     "  alert(\"QLC+ connection error!\");\n" \
     " };\n" \
+    " websocket.binaryType = \"arraybuffer\";\n" \
     " websocket.onmessage = function(ev) {\n" \
+    "  if (ev.data instanceof ArrayBuffer) {\n" \
+    "   // Widget state records: ID, type, value(s)\n" \
+    "   var view = new DataView(ev.data);\n" \
+    "   var pos = 0;\n" \
+    "   while (pos < view.byteLength) {\n" \
+    "    var id = view.getUint32(pos);\n" \
+    "    var type = view.getUint8(pos + 4);\n" \
+    "    var obj = document.getElementById(id);\n" \
+    "    pos += 5;\n" \
+    "    if (type == 1) {\n" \
+    "     var on = view.getUint8(pos);\n" \
+    "     pos += 1;\n" \
+    "     if (obj == null) continue;\n" \
+    "     if (on == 1) { obj.value = \"255\";\n obj.style.border = \"3px solid #00E600\"; }\n" \
+    "     else { obj.value = \"0\";\n obj.style.border = \"3px solid #A0A0A0\"; }\n" \
+    "    }\n" \
+    "    else if (type == 2) {\n" \
+    "     var value = view.getUint8(pos);\n" \
+    "     var len = view.getUint8(pos + 1);\n" \
+    "     // The text is UTF-8: collect its bytes, then decode them\n" \
+    "     var text = \"\";\n" \
+    "     for (var i = 0; i < len; i++)\n" \
+    "      text += String.fromCharCode(view.getUint8(pos + 2 + i));\n" \
+    "     try { text = decodeURIComponent(escape(text)); } catch (e) { }\n" \
+    "     pos += 2 + len;\n" \
+    "     if (obj == null) continue;\n" \
+    "     obj.value = value;\n" \
+    "     var labelObj = document.getElementById(\"slv\" + id);\n" \
+    "     labelObj.innerHTML = text;\n" \
+    "    }\n" \
+    "    else if (type == 3) {\n" \
+    "     var idx = view.getInt32(pos);\n" \
+    "     pos += 4;\n" \
+    "     if (obj == null) continue;\n" \
+    "     setCueIndex(id, idx);\n" \
+    "     var playBbj = document.getElementById(\"play\" + id);\n" \
+    "     playBbj.innerHTML = \"Stop\";\n" \
+    "    }\n" \
+    "    else break;\n" \
+    "   }\n" \
+    "   return;\n" \
+    "  }\n" \
     "  //alert(ev.data);\n" \
     "  var msgParams = ev.data.split('|');\n" \
-    "  var obj = document.getElementById(msgParams[0]);\n" \
-    "  if (msgParams[1] == \"BUTTON\") {\n" \
-    "    if (msgParams[2] == 1) { obj.value = \"255\";\n obj.style.border = \"3px solid #00E600\"; }\n" \
-    "    else { obj.value = \"0\";\n obj.style.border = \"3px solid #A0A0A0\"; }\n" \
-    "  }\n" \
-    "  else if (msgParams[1] == \"SLIDER\") {\n" \
-    "    obj.value = msgParams[2];\n" \
-    "    var labelObj = document.getElementById(\"slv\" + msgParams[0]);\n" \
-    "    labelObj.innerHTML = msgParams[2];\n" \
-    "  }\n" \
-    "  else if (msgParams[1] == \"CUE\") {\n" \
-    "    setCueIndex(msgParams[0], msgParams[2]);\n" \
-    "    var playBbj = document.getElementById(\"play\" + msgParams[0]);\n" \
-    "    playBbj.innerHTML = \"Stop\";\n" \
-    "  }\n" \
-    "  else if (msgParams[0] == \"URL\") {\n" \
+    "  if (msgParams[0] == \"URL\") {\n" \
     "    window.location = msgParams[1];\n" \
     "  }\n" \
     "  else if (msgParams[0] == \"ALERT\") {\n" \
@@ -0,0 +1,42 @@
+/*
+  Q Light Controller Plus
+  main.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QApplication>
+#include <QtTest>
+
+#include "webpagecache_test.h"
+#include "websockethub_test.h"
+
+int main(int argc, char** argv)
+{
+    QApplication qapp(argc, argv);
+    int r;
+
+    WebPageCache_Test cache;
+    r = QTest::qExec(&cache, argc, argv);
+    if (r != 0)
+        return r;
+
+    WebSocketHub_Test hub;
+    r = QTest::qExec(&hub, argc, argv);
+    if (r != 0)
+        return r;
+
+    return 0;
+}
@@ -0,0 +1,25 @@
+include(../../variables.pri)
+
+TEMPLATE = app
+LANGUAGE = C++
+TARGET   = webaccess_test
+
+QT     += core gui network testlib
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+INCLUDEPATH += ..
+DEFINES     += USE_WEBSOCKET NO_SSL
+win32:LIBS  += -lws2_32
+
+SOURCES += ../mongoose.c \
+           ../webpagecache.cpp \
+           ../websockethub.cpp \
+           webpagecache_test.cpp \
+           websockethub_test.cpp \
+           main.cpp
+
+HEADERS += ../mongoose.h \
+           ../webpagecache.h \
+           ../websockethub.h \
+           webpagecache_test.h \
+           websockethub_test.h
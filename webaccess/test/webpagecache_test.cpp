@@ -0,0 +1,197 @@
+/*
+  Q Light Controller Plus
+  webpagecache_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#include "webpagecache_test.h"
+#include "webpagecache.h"
+
+/**
+ * Decompress $gzip, checking its header and trailer. The deflate data is
+ * wrapped in the zlib stream that qUncompress() expects. That stream ends
+ * with the Adler-32 of the data, which gzip doesn't carry: it is computed
+ * from $expected, so data inflating to anything else fails.
+ */
+static QByteArray gunzip(const QByteArray& gzip, const QByteArray& expected)
+{
+    if (gzip.length() < 18 || gzip.startsWith(QByteArray("\x1f\x8b\x08", 3)) == false)
+        return QByteArray();
+
+    quint32 crc = 0, size = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        crc |= quint32(uchar(gzip.at(gzip.length() - 8 + i))) << (i * 8);
+        size |= quint32(uchar(gzip.at(gzip.length() - 4 + i))) << (i * 8);
+    }
+
+    quint32 a = 1, b = 0;
+    for (int i = 0; i < expected.length(); i++)
+    {
+        a = (a + uchar(expected.at(i))) % 65521;
+        b = (b + a) % 65521;
+    }
+    quint32 adler = (b << 16) | a;
+
+    // Big endian size, zlib header, deflate data, Adler-32
+    QByteArray stream;
+    for (int i = 3; i >= 0; i--)
+        stream.append(char((size >> (i * 8)) & 0xFF));
+    stream.append(char(0x78));
+    stream.append(char(0xDA));
+    stream.append(gzip.mid(10, gzip.length() - 18));
+    for (int i = 3; i >= 0; i--)
+        stream.append(char((adler >> (i * 8)) & 0xFF));
+
+    QByteArray data = qUncompress(stream);
+    if (crc != WebPageCache::gzipCrc32(data) || size != quint32(data.length()))
+        return QByteArray();
+
+    return data;
+}
+
+void WebPageCache_Test::crc32()
+{
+    // The check value of CRC-32
+    QCOMPARE(WebPageCache::gzipCrc32(QByteArray("123456789")), quint32(0xCBF43926));
+    QCOMPARE(WebPageCache::gzipCrc32(QByteArray()), quint32(0));
+}
+
+void WebPageCache_Test::gzip()
+{
+    QByteArray page;
+    for (int i = 0; i < 1000; i++)
+        page.append(QString("<div id=\"%1\">Widget %1</div>\n").arg(i).toLatin1());
+
+    QByteArray gzip = WebPageCache::gzipCompress(page);
+    QVERIFY(gzip.length() < page.length());
+    QCOMPARE(gunzip(gzip, page), page);
+
+    QCOMPARE(gunzip(WebPageCache::gzipCompress(QByteArray("x")), QByteArray("x")), QByteArray("x"));
+}
+
+void WebPageCache_Test::reply()
+{
+    WebPageCache cache;
+    QVERIFY(cache.isEmpty() == true);
+
+    QByteArray page("<html><body>QLC+</body></html>");
+    cache.setPage(page);
+    QVERIFY(cache.isEmpty() == false);
+    QCOMPARE(cache.page(), page);
+    QCOMPARE(gunzip(cache.pageGzip(), page), page);
+
+    // Plain
+    QByteArray reply = cache.reply(NULL, NULL);
+    QVERIFY(reply.startsWith("HTTP/1.1 200 OK\r\n"));
+    QVERIFY(reply.contains("Content-Encoding") == false);
+    QVERIFY(reply.contains("Content-Length: " + QByteArray::number(page.length()) + "\r\n"));
+    QVERIFY(reply.endsWith("\r\n\r\n" + page));
+
+    // Compressed, with another entity tag
+    QByteArray gzipReply = cache.reply("gzip, deflate", NULL);
+    QVERIFY(gzipReply.startsWith("HTTP/1.1 200 OK\r\n"));
+    QVERIFY(gzipReply.contains("Content-Encoding: gzip\r\n"));
+    QVERIFY(gzipReply.contains("-gzip\"\r\n"));
+    int headerEnd = gzipReply.indexOf("\r\n\r\n") + 4;
+    QCOMPARE(gunzip(gzipReply.mid(headerEnd), page), page);
+}
+
+/** Get the ETag header value of $reply */
+static QByteArray etag(const QByteArray& reply)
+{
+    int start = reply.indexOf("ETag: ") + 6;
+    return reply.mid(start, reply.indexOf("\r\n", start) - start);
+}
+
+void WebPageCache_Test::notModified()
+{
+    WebPageCache cache;
+    cache.setPage(QByteArray("<html>page</html>"));
+
+    QByteArray plainTag = etag(cache.reply(NULL, NULL));
+    QByteArray gzipTag = etag(cache.reply("gzip", NULL));
+    QVERIFY(plainTag.isEmpty() == false);
+    QVERIFY(plainTag != gzipTag);
+
+    // The browser has the page already
+    QByteArray reply = cache.reply(NULL, plainTag.constData());
+    QVERIFY(reply.startsWith("HTTP/1.1 304 Not Modified\r\n"));
+    QVERIFY(reply.contains("Content-Length") == false);
+    QVERIFY(reply.endsWith("\r\n\r\n"));
+    QCOMPARE(etag(reply), plainTag);
+
+    reply = cache.reply("gzip", gzipTag.constData());
+    QVERIFY(reply.startsWith("HTTP/1.1 304 Not Modified\r\n"));
+
+    // ...but not in this encoding
+    reply = cache.reply("gzip", plainTag.constData());
+    QVERIFY(reply.startsWith("HTTP/1.1 200 OK\r\n"));
+
+    // A list of tags
+    QByteArray list = "\"0123\", " + plainTag;
+    reply = cache.reply(NULL, list.constData());
+    QVERIFY(reply.startsWith("HTTP/1.1 304 Not Modified\r\n"));
+}
+
+void WebPageCache_Test::clear()
+{
+    WebPageCache cache;
+    cache.setPage(QByteArray("<html>old</html>"));
+    QByteArray oldTag = etag(cache.reply(NULL, NULL));
+
+    cache.clear();
+    QVERIFY(cache.isEmpty() == true);
+
+    // The page changed: the old one is not valid anymore
+    cache.setPage(QByteArray("<html>new</html>"));
+    QByteArray reply = cache.reply(NULL, oldTag.constData());
+    QVERIFY(reply.startsWith("HTTP/1.1 200 OK\r\n"));
+    QVERIFY(reply.endsWith("<html>new</html>"));
+    QVERIFY(etag(reply) != oldTag);
+}
+
+void WebPageCache_Test::cachingDisabled()
+{
+    WebPageCache cache;
+    QVERIFY(cache.isCachingEnabled() == true);
+    cache.setPage(QByteArray("<html>cached</html>"));
+    QVERIFY(cache.isEmpty() == false);
+
+    // The page is being edited: build it for each request
+    cache.setCachingEnabled(false);
+    QVERIFY(cache.isCachingEnabled() == false);
+    QVERIFY(cache.isEmpty() == true);
+
+    cache.setPage(QByteArray("<html>edit 1</html>"));
+    QVERIFY(cache.isEmpty() == true);
+    QVERIFY(cache.reply(NULL, NULL).endsWith("<html>edit 1</html>"));
+    QByteArray editTag = etag(cache.reply(NULL, NULL));
+
+    cache.setPage(QByteArray("<html>edit 2</html>"));
+    QByteArray reply = cache.reply(NULL, editTag.constData());
+    QVERIFY(reply.startsWith("HTTP/1.1 200 OK\r\n"));
+    QVERIFY(reply.endsWith("<html>edit 2</html>"));
+
+    // Editing is over: the page is built once more, then kept
+    cache.setCachingEnabled(true);
+    QVERIFY(cache.isEmpty() == true);
+    cache.setPage(QByteArray("<html>final</html>"));
+    QVERIFY(cache.isEmpty() == false);
+    QVERIFY(cache.reply(NULL, NULL).endsWith("<html>final</html>"));
+}
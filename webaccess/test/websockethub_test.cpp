@@ -0,0 +1,474 @@
+/*
+  Q Light Controller Plus
+  websockethub_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QElapsedTimer>
+#include <QDataStream>
+#include <QTcpSocket>
+#include <QtTest>
+#include <cstring>
+
+#include "websockethub_test.h"
+#include "websockethub.h"
+
+#define TEST_PORT       9997
+#define TEST_CLIENTS    50
+#define TEST_TIMEOUT    5000
+
+/****************************************************************************
+ * Web server callbacks
+ ****************************************************************************/
+
+static WebSocketHub* s_hub = NULL;
+
+static void websocket_ready_handler(mg_connection* conn)
+{
+    s_hub->addClient(conn);
+}
+
+static int websocket_data_handler(mg_connection* conn, int bits,
+                                  char* data, size_t data_len)
+{
+    Q_UNUSED(conn);
+    Q_UNUSED(bits);
+    Q_UNUSED(data);
+    Q_UNUSED(data_len);
+
+    // Keep the connection open
+    return 1;
+}
+
+static void end_request_handler(const mg_connection* conn, int reply_status_code)
+{
+    Q_UNUSED(reply_status_code);
+    s_hub->removeClient(conn);
+}
+
+/****************************************************************************
+ * Test client
+ ****************************************************************************/
+
+struct Record
+{
+    quint8 type;
+    int value;
+    QByteArray text;
+};
+
+/** Decode the widget state records of a binary message */
+static QMap <quint32,Record> decode(const QByteArray& data)
+{
+    QMap <quint32,Record> records;
+
+    QDataStream stream(data);
+    stream.setByteOrder(QDataStream::BigEndian);
+
+    while (stream.atEnd() == false)
+    {
+        quint32 id;
+        Record record;
+        stream >> id >> record.type;
+
+        if (record.type == WebSocketHub::Button || record.type == WebSocketHub::Slider)
+        {
+            quint8 value;
+            stream >> value;
+            record.value = value;
+        }
+
+        if (record.type == WebSocketHub::Slider)
+        {
+            quint8 length;
+            stream >> length;
+            record.text.resize(length);
+            stream.readRawData(record.text.data(), length);
+        }
+        else if (record.type == WebSocketHub::Cue)
+        {
+            qint32 index;
+            stream >> index;
+            record.value = index;
+        }
+
+        if (stream.status() != QDataStream::Ok)
+            break;
+
+        records[id] = record;
+    }
+
+    return records;
+}
+
+/** Connect to the test server and complete the websocket handshake */
+static QTcpSocket* openClient()
+{
+    QTcpSocket* socket = new QTcpSocket();
+    socket->connectToHost(QHostAddress::LocalHost, TEST_PORT);
+    if (socket->waitForConnected(TEST_TIMEOUT) == false)
+    {
+        delete socket;
+        return NULL;
+    }
+
+    socket->write("GET /qlcplusWS HTTP/1.1\r\n"
+                  "Host: 127.0.0.1\r\n"
+                  "Upgrade: websocket\r\n"
+                  "Connection: Upgrade\r\n"
+                  "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                  "Sec-WebSocket-Version: 13\r\n\r\n");
+    socket->flush();
+
+    // Nothing else is sent before the first flush, so read the reply headers only
+    QByteArray reply;
+    while (reply.endsWith("\r\n\r\n") == false)
+    {
+        if (socket->bytesAvailable() == 0 && socket->waitForReadyRead(TEST_TIMEOUT) == false)
+        {
+            delete socket;
+            return NULL;
+        }
+        reply.append(socket->read(1));
+    }
+
+    if (reply.startsWith("HTTP/1.1 101") == false)
+    {
+        delete socket;
+        return NULL;
+    }
+
+    return socket;
+}
+
+/**
+ * Read one websocket frame from $socket. The bytes received after the
+ * frame are kept in $buffer for the next call. Returns false if no
+ * complete frame arrives in time.
+ */
+static bool readFrame(QTcpSocket* socket, QByteArray& buffer, int& opcode, QByteArray& payload)
+{
+    forever
+    {
+        buffer.append(socket->readAll());
+
+        if (buffer.length() >= 2)
+        {
+            quint64 length = uchar(buffer.at(1)) & 0x7F;
+            int header = 2;
+
+            if (length == 126 && buffer.length() >= 4)
+            {
+                length = (uchar(buffer.at(2)) << 8) | uchar(buffer.at(3));
+                header = 4;
+            }
+            else if (length == 127 && buffer.length() >= 10)
+            {
+                length = 0;
+                for (int i = 2; i < 10; i++)
+                    length = (length << 8) | uchar(buffer.at(i));
+                header = 10;
+            }
+
+            if (length < 126 || header > 2)
+            {
+                if (quint64(buffer.length()) >= header + length)
+                {
+                    opcode = uchar(buffer.at(0)) & 0x0F;
+                    payload = buffer.mid(header, int(length));
+                    buffer.remove(0, header + int(length));
+                    return true;
+                }
+            }
+        }
+
+        if (socket->waitForReadyRead(TEST_TIMEOUT) == false)
+            return false;
+    }
+}
+
+/****************************************************************************
+ * Tests
+ ****************************************************************************/
+
+void WebSocketHub_Test::initTestCase()
+{
+    // One worker thread per websocket, plus some for the handshakes
+    const char *options[] = {"listening_ports", "9997", "num_threads", "64", NULL};
+
+    memset(&m_callbacks, 0, sizeof(m_callbacks));
+    m_callbacks.websocket_ready = websocket_ready_handler;
+    m_callbacks.websocket_data = websocket_data_handler;
+    m_callbacks.end_request = end_request_handler;
+
+    m_hub = NULL;
+    m_ctx = mg_start(&m_callbacks, NULL, options);
+    QVERIFY(m_ctx != NULL);
+}
+
+void WebSocketHub_Test::cleanupTestCase()
+{
+    mg_stop(m_ctx);
+}
+
+void WebSocketHub_Test::init()
+{
+    m_hub = new WebSocketHub();
+    s_hub = m_hub;
+}
+
+void WebSocketHub_Test::cleanup()
+{
+    QCOMPARE(m_hub->clientsCount(), 0);
+    delete m_hub;
+    m_hub = NULL;
+    s_hub = NULL;
+}
+
+void WebSocketHub_Test::encode()
+{
+    QCOMPARE(m_hub->version(), quint32(0));
+    QVERIFY(m_hub->encodeChanges(0).isEmpty());
+
+    m_hub->setButtonState(1, true);
+    QCOMPARE(m_hub->version(), quint32(1));
+    QCOMPARE(m_hub->encodeChanges(0), QByteArray("\x00\x00\x00\x01\x01\x01", 6));
+    QVERIFY(m_hub->encodeChanges(1).isEmpty());
+
+    m_hub->setSliderState(2, 128, "50%");
+    QCOMPARE(m_hub->encodeChanges(1), QByteArray("\x00\x00\x00\x02\x02\x80\x03" "50%", 10));
+
+    m_hub->setCueState(3, 258);
+    QCOMPARE(m_hub->encodeChanges(2), QByteArray("\x00\x00\x00\x03\x03\x00\x00\x01\x02", 9));
+
+    QMap <quint32,Record> records = decode(m_hub->encodeChanges(0));
+    QCOMPARE(records.count(), 3);
+    QCOMPARE(int(records[1].type), int(WebSocketHub::Button));
+    QCOMPARE(records[1].value, 1);
+    QCOMPARE(int(records[2].type), int(WebSocketHub::Slider));
+    QCOMPARE(records[2].value, 128);
+    QCOMPARE(records[2].text, QByteArray("50%"));
+    QCOMPARE(int(records[3].type), int(WebSocketHub::Cue));
+    QCOMPARE(records[3].value, 258);
+}
+
+void WebSocketHub_Test::utf8Text()
+{
+    // Slider texts are sent as UTF-8, with their length in bytes
+    QString text = QString::fromUtf8("\xC3\x84 50 \xE2\x82\xAC");
+    m_hub->setSliderState(1, 10, text);
+
+    QMap <quint32,Record> records = decode(m_hub->encodeChanges(0));
+    QCOMPARE(records.count(), 1);
+    QCOMPARE(records[1].text, text.toUtf8());
+    QCOMPARE(records[1].text.length(), 9);
+    QCOMPARE(QString::fromUtf8(records[1].text), text);
+
+    // Long texts are cut to 255 bytes, but not in the middle of a character
+    QString longText = QString(128, QChar('a')) + QString(100, QChar(0x00C4));
+    m_hub->setSliderState(2, 20, longText);
+
+    records = decode(m_hub->encodeChanges(1));
+    QCOMPARE(records.count(), 1);
+    QCOMPARE(records[2].text.length(), 254);
+    QCOMPARE(QString::fromUtf8(records[2].text), longText.left(128 + 63));
+}
+
+void WebSocketHub_Test::coalesce()
+{
+    for (int i = 0; i < 256; i++)
+        m_hub->setSliderState(5, uchar(i), QString::number(i));
+    m_hub->setButtonState(6, false);
+
+    QCOMPARE(m_hub->version(), quint32(257));
+
+    // Only the latest state of each widget is sent
+    QMap <quint32,Record> records = decode(m_hub->encodeChanges(0));
+    QCOMPARE(records.count(), 2);
+    QCOMPARE(records[5].value, 255);
+    QCOMPARE(records[5].text, QByteArray("255"));
+    QCOMPARE(records[6].value, 0);
+
+    // The slider hasn't changed since version 256
+    records = decode(m_hub->encodeChanges(256));
+    QCOMPARE(records.count(), 1);
+    QVERIFY(records.contains(6));
+}
+
+void WebSocketHub_Test::clearState()
+{
+    m_hub->setButtonState(1, true);
+    m_hub->setCueState(2, 0);
+    QCOMPARE(m_hub->encodeChanges(0).isEmpty(), false);
+
+    m_hub->clearState();
+    QVERIFY(m_hub->encodeChanges(0).isEmpty());
+
+    m_hub->setButtonState(1, false);
+    QCOMPARE(decode(m_hub->encodeChanges(0)).count(), 1);
+}
+
+void WebSocketHub_Test::broadcast()
+{
+    QList <QTcpSocket*> sockets;
+    QList <QByteArray> buffers;
+
+    for (int i = 0; i < TEST_CLIENTS; i++)
+    {
+        QTcpSocket* socket = openClient();
+        QVERIFY(socket != NULL);
+        sockets << socket;
+        buffers << QByteArray();
+    }
+
+    // Clients are added from the web server threads
+    for (int i = 0; i < TEST_TIMEOUT / 10 && m_hub->clientsCount() < TEST_CLIENTS; i++)
+        QTest::qWait(10);
+    QCOMPARE(m_hub->clientsCount(), TEST_CLIENTS);
+
+    // Many updates in less than a frame
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < 1000; i++)
+        m_hub->setSliderState(i % 10, uchar(i), QString("%1%").arg(i));
+    m_hub->setCueState(100, 3);
+    m_hub->setButtonState(101, true);
+    QTest::qWait(WEBSOCKET_FRAME_TIME * 3);
+
+    // Every client gets a single message with the latest state only
+    for (int i = 0; i < TEST_CLIENTS; i++)
+    {
+        int opcode = 0;
+        QByteArray payload;
+        QVERIFY(readFrame(sockets[i], buffers[i], opcode, payload) == true);
+        QCOMPARE(opcode, int(WEBSOCKET_OPCODE_BINARY));
+
+        QMap <quint32,Record> records = decode(payload);
+        QCOMPARE(records.count(), 12);
+        for (quint32 id = 0; id < 10; id++)
+        {
+            QCOMPARE(records[id].value, int(uchar(990 + id)));
+            QCOMPARE(records[id].text, QString("%1%").arg(990 + id).toUtf8());
+        }
+        QCOMPARE(records[100].value, 3);
+        QCOMPARE(records[101].value, 1);
+    }
+    qDebug() << TEST_CLIENTS << "clients updated in" << timer.elapsed() << "ms";
+
+    // ...and nothing else
+    QTest::qWait(WEBSOCKET_FRAME_TIME * 3);
+    for (int i = 0; i < TEST_CLIENTS; i++)
+    {
+        QVERIFY(buffers[i].isEmpty() == true);
+        QCOMPARE(sockets[i]->bytesAvailable(), qint64(0));
+    }
+
+    // Next frame: only what changed
+    m_hub->setButtonState(101, false);
+    QTest::qWait(WEBSOCKET_FRAME_TIME * 3);
+
+    for (int i = 0; i < TEST_CLIENTS; i++)
+    {
+        int opcode = 0;
+        QByteArray payload;
+        QVERIFY(readFrame(sockets[i], buffers[i], opcode, payload) == true);
+        QCOMPARE(opcode, int(WEBSOCKET_OPCODE_BINARY));
+        QCOMPARE(payload, QByteArray("\x00\x00\x00\x65\x01\x00", 6));
+    }
+
+    // Text messages are sent right away
+    m_hub->broadcastText("URL|/");
+    for (int i = 0; i < TEST_CLIENTS; i++)
+    {
+        int opcode = 0;
+        QByteArray payload;
+        QVERIFY(readFrame(sockets[i], buffers[i], opcode, payload) == true);
+        QCOMPARE(opcode, int(WEBSOCKET_OPCODE_TEXT));
+        QCOMPARE(payload, QByteArray("URL|/"));
+    }
+
+    // A late client gets the whole state with its first message
+    QTcpSocket* late = openClient();
+    QVERIFY(late != NULL);
+    for (int i = 0; i < TEST_TIMEOUT / 10 && m_hub->clientsCount() <= TEST_CLIENTS; i++)
+        QTest::qWait(10);
+    QTest::qWait(WEBSOCKET_FRAME_TIME * 3);
+
+    QByteArray lateBuffer;
+    int opcode = 0;
+    QByteArray payload;
+    QVERIFY(readFrame(late, lateBuffer, opcode, payload) == true);
+    QCOMPARE(decode(payload).count(), 12);
+    sockets << late;
+
+    // Clients are removed when their connection closes
+    foreach (QTcpSocket* socket, sockets)
+    {
+        socket->abort();
+        delete socket;
+    }
+
+    for (int i = 0; i < TEST_TIMEOUT / 10 && m_hub->clientsCount() > 0; i++)
+        QTest::qWait(10);
+    QCOMPARE(m_hub->clientsCount(), 0);
+}
+
+void WebSocketHub_Test::slowClient()
+{
+    QTcpSocket* slow = openClient();
+    QVERIFY(slow != NULL);
+    QTcpSocket* fast = openClient();
+    QVERIFY(fast != NULL);
+
+    for (int i = 0; i < TEST_TIMEOUT / 10 && m_hub->clientsCount() < 2; i++)
+        QTest::qWait(10);
+    QCOMPARE(m_hub->clientsCount(), 2);
+
+    // This client stops reading, so its socket buffers fill up
+    slow->setReadBufferSize(1);
+
+    QByteArray buffer;
+    QString text(200, QChar('x'));
+    for (int frame = 0; frame < 100; frame++)
+    {
+        for (quint32 id = 0; id < 1000; id++)
+            m_hub->setSliderState(id, uchar(frame), text);
+
+        // Flushing never waits for the clients
+        QElapsedTimer timer;
+        timer.start();
+        m_hub->flush();
+        QVERIFY(timer.elapsed() < WEBSOCKET_SEND_TIMEOUT);
+
+        // The other client keeps getting the latest state
+        int opcode = 0;
+        QByteArray payload;
+        QVERIFY(readFrame(fast, buffer, opcode, payload) == true);
+        QCOMPARE(opcode, int(WEBSOCKET_OPCODE_BINARY));
+        QMap <quint32,Record> records = decode(payload);
+        QCOMPARE(records.count(), 1000);
+        QCOMPARE(records[999].value, frame);
+    }
+
+    slow->abort();
+    delete slow;
+    fast->abort();
+    delete fast;
+
+    for (int i = 0; i < TEST_TIMEOUT / 10 && m_hub->clientsCount() > 0; i++)
+        QTest::qWait(10);
+    QCOMPARE(m_hub->clientsCount(), 0);
+}
@@ -17,15 +17,22 @@
   limitations under the License.
 */
 
+#include <QMutexLocker>
 #include <QDebug>
 #include <QProcess>
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+  #include <QTextDocument>
+#endif
 
 #include "webaccess.h"
 
 #include "vcaudiotriggers.h"
 #include "virtualconsole.h"
+#include "websockethub.h"
 #include "inputoutputmap.h"
 #include "commonjscss.h"
+#include "tickprofiler.h"
+#include "mastertimer.h"
 #include "vcsoloframe.h"
 #include "outputpatch.h"
 #include "inputpatch.h"
@@ -69,6 +76,13 @@ static void websocket_ready_handler(struct mg_connection *conn)
     s_instance->websocketReadyHandler(conn);
 }
 
+static void end_request_handler(const struct mg_connection *conn,
+                                int reply_status_code)
+{
+    Q_UNUSED(reply_status_code)
+    s_instance->endRequestHandler(conn);
+}
+
 static int websocket_data_handler(struct mg_connection *conn, int flags,
                                   char *data, size_t data_len)
 {
@@ -80,7 +94,7 @@ WebAccess::WebAccess(Doc *doc, VirtualConsole *vcInstance, QObject *parent) :
   , m_doc(doc)
   , m_vc(vcInstance)
   , m_ctx(NULL)
-  , m_conn(NULL)
+  , m_hub(new WebSocketHub(this))
 {
     Q_ASSERT(s_instance == NULL);
     Q_ASSERT(m_doc != NULL);
@@ -91,9 +105,10 @@ WebAccess::WebAccess(Doc *doc, VirtualConsole *vcInstance, QObject *parent) :
     // List of options. Last element must be NULL.
     const char *options[] = {"listening_ports", "9999", NULL};
 
-    // Prepare callbacks structure. We have only one callback, the rest are NULL.
+    // Prepare callbacks structure. The ones we don't use are NULL.
     memset(&m_callbacks, 0, sizeof(m_callbacks));
     m_callbacks.begin_request = begin_request_handler;
+    m_callbacks.end_request = end_request_handler;
     m_callbacks.websocket_ready = websocket_ready_handler;
     m_callbacks.websocket_data = websocket_data_handler;
 
@@ -102,6 +117,15 @@ WebAccess::WebAccess(Doc *doc, VirtualConsole *vcInstance, QObject *parent) :
 
     connect(m_vc, SIGNAL(loaded()),
             this, SLOT(slotVCLoaded()));
+    // The Virtual Console can only be edited in Design mode
+    m_vcPage.setCachingEnabled(m_doc->mode() == Doc::Operate);
+    connect(m_doc, SIGNAL(modeChanged(Doc::Mode)),
+            this, SLOT(slotDocModeChanged(Doc::Mode)));
+    // ...but the page also shows function contents, like cue list steps
+    connect(m_doc, SIGNAL(functionChanged(quint32)),
+            this, SLOT(slotVCLayoutChanged()));
+    connect(m_doc, SIGNAL(functionRemoved(quint32)),
+            this, SLOT(slotVCLayoutChanged()));
 }
 
 WebAccess::~WebAccess()
@@ -200,6 +224,10 @@ int WebAccess::beginRequestHandler(mg_connection *conn)
   {
       content = getSystemConfigHTML();
   }
+  else if (QString(ri->uri) == "/profiler")
+  {
+      content = getProfilerHTML();
+  }
   else if (QString(ri->uri) == "/loadFixture")
   {
       QString fxName;
@@ -227,7 +255,10 @@ int WebAccess::beginRequestHandler(mg_connection *conn)
   else if (QString(ri->uri) != "/")
       return 1;
   else
-      content = getVCHTML();
+  {
+      sendVCPage(conn);
+      return 1;
+  }
 
   // Prepare the message we're going to send
   int content_length = content.length();
@@ -246,17 +277,40 @@ int WebAccess::beginRequestHandler(mg_connection *conn)
   return 1;
 }
 
+void WebAccess::sendVCPage(mg_connection *conn)
+{
+    QByteArray reply;
+
+    m_vcPageMutex.lock();
+    if (m_vcPage.isEmpty())
+    {
+        m_vcPage.setPage(getVCHTML().toLatin1());
+        qDebug() << "[WebAccess] VC page built:" << m_vcPage.page().length() << "bytes,"
+                 << m_vcPage.pageGzip().length() << "compressed";
+    }
+    reply = m_vcPage.reply(mg_get_header(conn, "Accept-Encoding"),
+                           mg_get_header(conn, "If-None-Match"));
+    m_vcPageMutex.unlock();
+
+    mg_write(conn, reply.constData(), reply.length());
+}
+
 void WebAccess::websocketReadyHandler(mg_connection *conn)
 {
     qDebug() << Q_FUNC_INFO;
-    m_conn = conn;
-    static const char *message = "QLC+ is ready";
-    mg_websocket_write(conn, WEBSOCKET_OPCODE_TEXT, message, strlen(message));
+    m_hub->addClient(conn);
+    m_hub->sendText(conn, QString("QLC+ is ready"));
+}
+
+// Called by mongoose when a request is over. For websockets, that's when
+// the connection is closed.
+void WebAccess::endRequestHandler(const mg_connection *conn)
+{
+    m_hub->removeClient(conn);
 }
 
 int WebAccess::websocketDataHandler(mg_connection *conn, int flags, char *data, size_t data_len)
 {
-    Q_UNUSED(conn)
     Q_UNUSED(flags)
 
     QString qData = QString(data);
@@ -366,7 +420,7 @@ int WebAccess::websocketDataHandler(mg_connection *conn, int flags, char *data,
             else
                 emit storeAutostartProject(asName);
             QString wsMessage = QString("ALERT|" + tr("Autostart configuration changed"));
-            mg_websocket_write(m_conn, WEBSOCKET_OPCODE_TEXT, wsMessage.toLatin1().data(), wsMessage.length());
+            m_hub->sendText(conn, wsMessage);
             return 1;
         }
         else if (cmdList.at(1) == "REBOOT")
@@ -375,6 +429,21 @@ int WebAccess::websocketDataHandler(mg_connection *conn, int flags, char *data,
             rebootProcess->start("reboot", QStringList());
         }
     }
+    else if (cmdList[0] == "QLC+PROF")
+    {
+        if (cmdList.count() < 2)
+            return 0;
+
+        TickProfiler *profiler = m_doc->masterTimer()->profiler();
+        if (cmdList[1] == "ENABLE" && cmdList.count() > 2)
+            profiler->setEnabled(cmdList[2] == "1");
+        else if (cmdList[1] == "RESET")
+            profiler->reset();
+        else
+            qDebug() << "[webaccess] Command" << cmdList[1] << "not supported !";
+
+        return 1;
+    }
     else if(cmdList[0] == "POLL")
         return 1;
 
@@ -506,13 +575,7 @@ void WebAccess::slotButtonToggled(bool on)
 {
     VCButton *btn = (VCButton *)sender();
 
-    QString wsMessage = QString::number(btn->id());
-    if (on == true)
-        wsMessage.append("|BUTTON|1");
-    else
-        wsMessage.append("|BUTTON|0");
-
-    mg_websocket_write(m_conn, WEBSOCKET_OPCODE_TEXT, wsMessage.toLatin1().data(), wsMessage.length());
+    m_hub->setButtonState(btn->id(), on);
 }
 
 QString WebAccess::getButtonHTML(VCButton *btn)
@@ -524,10 +587,6 @@ QString WebAccess::getButtonHTML(VCButton *btn)
         m_buttonFound = true;
     }
 
-    QString onCSS = "";
-    if (btn->isOn())
-        onCSS = "border: 3px solid #00E600;";
-
     QString str = "<div class=\"vcbutton-wrapper\" style=\""
             "left: " + QString::number(btn->x()) + "px; "
             "top: " + QString::number(btn->y()) + "px;\">\n";
@@ -537,11 +596,12 @@ QString WebAccess::getButtonHTML(VCButton *btn)
             "width: " + QString::number(btn->width()) + "px; "
             "height: " + QString::number(btn->height()) + "px; "
             "color: " + btn->foregroundColor().name() + "; "
-            "background-color: " + btn->backgroundColor().name() + "; " + onCSS + "\">" +
+            "background-color: " + btn->backgroundColor().name() + ";\">" +
             btn->caption() + "</a>\n</div>\n";
 
     connect(btn, SIGNAL(pressedState(bool)),
-            this, SLOT(slotButtonToggled(bool)));
+            this, SLOT(slotButtonToggled(bool)), Qt::UniqueConnection);
+    m_hub->setButtonState(btn->id(), btn->isOn());
 
     return str;
 }
@@ -550,9 +610,7 @@ void WebAccess::slotSliderValueChanged(QString val)
 {
     VCSlider *slider = (VCSlider *)sender();
 
-    QString wsMessage = QString("%1|SLIDER|%2").arg(slider->id()).arg(val);
-
-    mg_websocket_write(m_conn, WEBSOCKET_OPCODE_TEXT, wsMessage.toLatin1().data(), wsMessage.length());
+    m_hub->setSliderState(slider->id(), slider->sliderValue(), val);
 }
 
 QString WebAccess::getSliderHTML(VCSlider *slider)
@@ -574,8 +632,7 @@ QString WebAccess::getSliderHTML(VCSlider *slider)
             "background-color: " + slider->backgroundColor().name() + ";\">\n";
 
     str += "<div id=\"slv" + slID + "\" "
-            "class=\"vcslLabel\" style=\"top:0px;\">" +
-            QString::number(slider->sliderValue()) + "</div>\n";
+            "class=\"vcslLabel\" style=\"top:0px;\"></div>\n";
 
     str +=  "<input type=\"range\" class=\"vVertical\" "
             "id=\"" + slID + "\" "
@@ -583,8 +640,7 @@ QString WebAccess::getSliderHTML(VCSlider *slider)
             "width: " + QString::number(slider->height() - 50) + "px; "
             "margin-top: " + QString::number(slider->height() - 50) + "px; "
             "margin-left: " + QString::number(slider->width() / 2) + "px;\" "
-            "min=\"0\" max=\"255\" step=\"1\" value=\"" +
-            QString::number(slider->sliderValue()) + "\" />\n";
+            "min=\"0\" max=\"255\" step=\"1\" value=\"0\" />\n";
 
     str += "<div id=\"sln" + slID + "\" "
             "class=\"vcslLabel\" style=\"bottom:0px;\">" +
@@ -592,7 +648,8 @@ QString WebAccess::getSliderHTML(VCSlider *slider)
             "</div>\n";
 
     connect(slider, SIGNAL(valueChanged(QString)),
-            this, SLOT(slotSliderValueChanged(QString)));
+            this, SLOT(slotSliderValueChanged(QString)), Qt::UniqueConnection);
+    m_hub->setSliderState(slider->id(), slider->sliderValue(), slider->topLabelText());
     return str;
 }
 
@@ -652,9 +709,7 @@ void WebAccess::slotCueIndexChanged(int idx)
 {
     VCCueList *cue = (VCCueList *)sender();
 
-    QString wsMessage = QString("%1|CUE|%2").arg(cue->id()).arg(idx);
-
-    mg_websocket_write(m_conn, WEBSOCKET_OPCODE_TEXT, wsMessage.toLatin1().data(), wsMessage.length());
+    m_hub->setCueState(cue->id(), idx);
 }
 
 QString WebAccess::getCueListHTML(VCCueList *cue)
@@ -787,7 +842,7 @@ QString WebAccess::getCueListHTML(VCCueList *cue)
     str += "</div>\n";
 
     connect(cue, SIGNAL(stepChanged(int)),
-            this, SLOT(slotCueIndexChanged(int)));
+            this, SLOT(slotCueIndexChanged(int)), Qt::UniqueConnection);
 
     return str;
 }
@@ -1090,10 +1145,10 @@ QString WebAccess::getConfigHTML()
             TABLE_CSS
             "</style>\n";
 
-    QString extraButtons = "";
+    QString extraButtons = "<a class=\"button button-blue\" href=\"/profiler\"><span>" + tr("Profiler") + "</span></a>\n";
     if (QLCFile::isRaspberry() == true)
     {
-        extraButtons = "<a class=\"button button-blue\" href=\"/system\"><span>" + tr("System") + "</span></a>\n";
+        extraButtons += "<a class=\"button button-blue\" href=\"/system\"><span>" + tr("System") + "</span></a>\n";
     }
 
     QString bodyHTML = "<form action=\"/loadFixture\" method=\"POST\" enctype=\"multipart/form-data\">\n"
@@ -1328,6 +1383,89 @@ QString WebAccess::getSystemConfigHTML()
     return str;
 }
 
+QString WebAccess::getProfilerHTML()
+{
+    TickProfiler *profiler = m_doc->masterTimer()->profiler();
+
+    m_JScode = "<script language=\"javascript\" type=\"text/javascript\">\n" WEBSOCKET_JS;
+    m_JScode += "function profilerCmd(cmd, val)\n"
+            "{\n"
+            " websocket.send(\"QLC+PROF|\" + cmd + \"|\" + val);\n"
+            " window.setTimeout(function() { window.location.reload(); }, 200);\n"
+            "};\n\n"
+            "window.setTimeout(function() { window.location.reload(); }, 2000);\n";
+    m_JScode += "</script>\n";
+
+    m_CSScode = "<style>\n"
+            "html { height: 100%; background-color: #111; }\n"
+            "body {\n"
+            " margin: 0px;\n"
+            " background-image: linear-gradient(to bottom, #45484d 0%, #111 100%);\n"
+            " background-image: -webkit-linear-gradient(top, #45484d 0%, #111 100%);\n"
+            "}\n"
+            CONTROL_BAR_CSS
+            BUTTON_BASE_CSS
+            BUTTON_SPAN_CSS
+            BUTTON_STATE_CSS
+            BUTTON_BLUE_CSS
+            SWINFO_CSS
+            TABLE_CSS
+            "</style>\n";
+
+    QString bodyHTML = "<div class=\"controlBar\">\n"
+                       "<a class=\"button button-blue\" href=\"/config\"><span>" + tr("Back") + "</span></a>\n";
+    if (profiler->isEnabled() == true)
+        bodyHTML += "<a class=\"button button-blue\" href=\"javascript:profilerCmd('ENABLE', '0');\"><span>" + tr("Disable") + "</span></a>\n";
+    else
+        bodyHTML += "<a class=\"button button-blue\" href=\"javascript:profilerCmd('ENABLE', '1');\"><span>" + tr("Enable") + "</span></a>\n";
+    bodyHTML += "<a class=\"button button-blue\" href=\"javascript:profilerCmd('RESET', '');\"><span>" + tr("Reset") + "</span></a>\n"
+                "<div class=\"swInfo\">" + QString(APPNAME) + " " + QString(APPVERSION) + "</div>"
+                "</div>\n";
+
+    bodyHTML += "<div style=\"margin: 30px 7% 30px 7%; width: 86%;\" >\n";
+    bodyHTML += "<div style=\"font-family: verdana,arial,sans-serif; font-size:20px; text-align:center; color:#CCCCCC;\">";
+    bodyHTML += tr("Tick profiler") + "</div><br>\n";
+
+    bodyHTML += "<table class=\"hovertable\" style=\"width: 100%;\">\n";
+    bodyHTML += "<tr><th>" + tr("Name") + "</th><th>" + tr("Type") + "</th>"
+                "<th>" + tr("Last (us)") + "</th><th>" + tr("Mean (us)") + "</th>"
+                "<th>50% (us)</th><th>95% (us)</th><th>99% (us)</th>"
+                "<th>" + tr("Max (us)") + "</th><th>" + tr("Samples") + "</th></tr>\n";
+
+    foreach (TickProfiler::Statistics st, profiler->statistics())
+    {
+        QString name = st.name;
+        if (st.type == TickProfiler::FunctionItem)
+        {
+            Function *function = m_doc->function(st.id);
+            if (function != NULL)
+                name = function->name();
+        }
+
+        /* Names are user defined: never let them inject markup */
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+        name = Qt::escape(name);
+#else
+        name = name.toHtmlEscaped();
+#endif
+
+        bodyHTML += "<tr><td>" + name + "</td>"
+                    "<td>" + TickProfiler::itemTypeToString(st.type) + "</td>"
+                    "<td>" + QString::number(st.last, 'f', 1) + "</td>"
+                    "<td>" + QString::number(st.mean, 'f', 1) + "</td>"
+                    "<td>" + QString::number(st.p50, 'f', 1) + "</td>"
+                    "<td>" + QString::number(st.p95, 'f', 1) + "</td>"
+                    "<td>" + QString::number(st.p99, 'f', 1) + "</td>"
+                    "<td>" + QString::number(st.max, 'f', 1) + "</td>"
+                    "<td>" + QString::number(st.samples) + "</td></tr>\n";
+    }
+    bodyHTML += "</table></div>\n";
+
+    QString str = HTML_HEADER + m_JScode + m_CSScode + "</head>\n<body>\n" + bodyHTML + "</body>\n</html>";
+
+    return str;
+}
+
 bool WebAccess::writeNetworkFile()
 {
     QFile netFile(IFACES_SYSTEM_FILE);
@@ -1358,11 +1496,23 @@ bool WebAccess::writeNetworkFile()
 
 void WebAccess::slotVCLoaded()
 {
-    if (m_conn == NULL)
-        return;
+    // Widget IDs are not valid anymore: make all the clients reload the page
+    slotVCLayoutChanged();
+    m_hub->clearState();
+    m_hub->broadcastText(QString("URL|/"));
+}
 
-    QString wsMessage = QString("URL|/");
-    mg_websocket_write(m_conn, WEBSOCKET_OPCODE_TEXT, wsMessage.toLatin1().data(), wsMessage.length());
+void WebAccess::slotDocModeChanged(Doc::Mode mode)
+{
+    // Widgets added, removed or edited in Design mode are seen right away
+    QMutexLocker locker(&m_vcPageMutex);
+    m_vcPage.setCachingEnabled(mode == Doc::Operate);
+}
+
+void WebAccess::slotVCLayoutChanged()
+{
+    QMutexLocker locker(&m_vcPageMutex);
+    m_vcPage.clear();
 }
 
 
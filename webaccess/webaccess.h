@@ -20,8 +20,12 @@
 #ifndef WEBACCESS_H
 #define WEBACCESS_H
 
+#include <QByteArray>
 #include <QObject>
+#include <QMutex>
+#include "webpagecache.h"
 #include "mongoose.h"
+#include "doc.h"
 
 class VirtualConsole;
 class VCAudioTriggers;
@@ -30,9 +34,9 @@ class VCCueList;
 class VCWidget;
 class VCButton;
 class VCSlider;
+class WebSocketHub;
 class VCLabel;
 class VCFrame;
-class Doc;
 
 typedef struct
 {
@@ -53,6 +57,7 @@ public:
 
     int beginRequestHandler(struct mg_connection *conn);
     void websocketReadyHandler(struct mg_connection *conn);
+    void endRequestHandler(const struct mg_connection *conn);
     int websocketDataHandler(struct mg_connection *conn, int flags,
                                char *data, size_t data_len);
 
@@ -70,6 +75,9 @@ private:
     QString getChildrenHTML(VCWidget *frame);
     QString getVCHTML();
 
+    /** Send the Virtual Console page, building it if it's not cached */
+    void sendVCPage(struct mg_connection *conn);
+
     QString getIOConfigHTML();
     QString getAudioConfigHTML();
     QString getUserFixturesConfigHTML();
@@ -81,10 +89,14 @@ private:
     QString getNetworkHTML();
     QString getSystemConfigHTML();
 
+    QString getProfilerHTML();
+
     bool writeNetworkFile();
 
 protected slots:
     void slotVCLoaded();
+    void slotDocModeChanged(Doc::Mode mode);
+    void slotVCLayoutChanged();
     void slotButtonToggled(bool on);
     void slotSliderValueChanged(QString val);
     void slotCueIndexChanged(int idx);
@@ -111,9 +123,19 @@ protected:
     VirtualConsole *m_vc;
 
     struct mg_context *m_ctx;
-    struct mg_connection *m_conn;
     struct mg_callbacks m_callbacks;
 
+    /** All the websocket clients */
+    WebSocketHub *m_hub;
+
+    /**
+     * The Virtual Console page, built on the first request after the
+     * layout has changed. Widget states are not part of the page: they
+     * are sent to each client through its websocket.
+     */
+    QMutex m_vcPageMutex;
+    WebPageCache m_vcPage;
+
 signals:
     void toggleDocMode();
     void loadProject(QString xmlData);
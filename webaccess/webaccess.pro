@@ -30,10 +30,14 @@ win32:INCLUDEPATH += ./
 
 HEADERS += mongoose.h \
            commonjscss.h \
-           webaccess.h
+           webaccess.h \
+           webpagecache.h \
+           websockethub.h
 
 SOURCES += mongoose.c \
-           webaccess.cpp
+           webaccess.cpp \
+           webpagecache.cpp \
+           websockethub.cpp
            
 TRANSLATIONS += webaccess_fi_FI.ts
 TRANSLATIONS += webaccess_de_DE.ts
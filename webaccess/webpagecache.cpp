@@ -0,0 +1,145 @@
+/*
+  Q Light Controller Plus
+  webpagecache.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+
+#include <QCryptographicHash>
+
+#include "webpagecache.h"
+
+WebPageCache::WebPageCache()
+    : m_cachingEnabled(true)
+{
+}
+
+WebPageCache::~WebPageCache()
+{
+}
+
+void WebPageCache::clear()
+{
+    m_page.clear();
+    m_pageGzip.clear();
+    m_etag.clear();
+}
+
+bool WebPageCache::isEmpty() const
+{
+    return (m_cachingEnabled == false || m_page.isEmpty());
+}
+
+void WebPageCache::setCachingEnabled(bool enable)
+{
+    if (enable == m_cachingEnabled)
+        return;
+
+    m_cachingEnabled = enable;
+    clear();
+}
+
+bool WebPageCache::isCachingEnabled() const
+{
+    return m_cachingEnabled;
+}
+
+void WebPageCache::setPage(const QByteArray& page)
+{
+    m_page = page;
+    m_pageGzip = gzipCompress(page);
+    m_etag = QCryptographicHash::hash(page, QCryptographicHash::Md5).toHex();
+}
+
+QByteArray WebPageCache::page() const
+{
+    return m_page;
+}
+
+QByteArray WebPageCache::pageGzip() const
+{
+    return m_pageGzip;
+}
+
+QByteArray WebPageCache::reply(const char* acceptEncoding, const char* ifNoneMatch) const
+{
+    bool gzip = acceptEncoding != NULL && QByteArray(acceptEncoding).contains("gzip");
+
+    // Each encoding is a different representation, with its own entity tag
+    QByteArray etag = "\"" + m_etag + (gzip ? "-gzip\"" : "\"");
+
+    if (ifNoneMatch != NULL && QByteArray(ifNoneMatch).contains(etag))
+    {
+        return QByteArray("HTTP/1.1 304 Not Modified\r\n"
+                          "ETag: ") + etag + "\r\n"
+                          "Vary: Accept-Encoding\r\n\r\n";
+    }
+
+    const QByteArray& body = gzip ? m_pageGzip : m_page;
+
+    // no-cache makes browsers revalidate the page, so they see layout changes
+    QByteArray reply("HTTP/1.1 200 OK\r\n"
+                     "Content-Type: text/html\r\n");
+    if (gzip == true)
+        reply += "Content-Encoding: gzip\r\n";
+    reply += "Cache-Control: no-cache\r\n"
+             "ETag: " + etag + "\r\n"
+             "Vary: Accept-Encoding\r\n"
+             "Content-Length: " + QByteArray::number(body.length()) + "\r\n\r\n";
+    reply += body;
+
+    return reply;
+}
+
+/****************************************************************************
+ * gzip
+ ****************************************************************************/
+
+/**
+ * qCompress() output is a 4 bytes length, followed by a zlib stream: a
+ * 2 bytes header, the deflate data and a 4 bytes Adler-32 checksum.
+ * gzip wraps the same deflate data with its own header and trailer.
+ */
+QByteArray WebPageCache::gzipCompress(const QByteArray& data)
+{
+    QByteArray zlib = qCompress(data, 9);
+
+    // Magic, deflate, no flags, no time, best compression, unknown OS
+    QByteArray gzip("\x1f\x8b\x08\x00\x00\x00\x00\x00\x02\xff", 10);
+    gzip.append(zlib.constData() + 6, zlib.length() - 10);
+
+    // CRC-32 and size of the uncompressed data, little endian
+    quint32 crc = gzipCrc32(data);
+    quint32 size = data.length();
+    for (int i = 0; i < 4; i++)
+        gzip.append(char((crc >> (i * 8)) & 0xFF));
+    for (int i = 0; i < 4; i++)
+        gzip.append(char((size >> (i * 8)) & 0xFF));
+
+    return gzip;
+}
+
+quint32 WebPageCache::gzipCrc32(const QByteArray& data)
+{
+    quint32 crc = 0xFFFFFFFF;
+    for (int i = 0; i < data.length(); i++)
+    {
+        crc ^= uchar(data.at(i));
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+    return ~crc;
+}
@@ -0,0 +1,90 @@
+/*
+  Q Light Controller Plus
+  webpagecache.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef WEBPAGECACHE_H
+#define WEBPAGECACHE_H
+
+#include <QByteArray>
+
+/**
+ * WebPageCache keeps a generated page, with its gzip version and entity
+ * tag, so that the page is built and compressed once for all the requests
+ * until it changes. It also builds the HTTP replies for the page: gzip
+ * encoded for the browsers accepting it, and 304 Not Modified for those
+ * that have the current page already.
+ *
+ * WebPageCache is not thread safe: its owner serializes the calls.
+ */
+class WebPageCache
+{
+public:
+    WebPageCache();
+    ~WebPageCache();
+
+    /** Forget the page, e.g. when what it shows has changed */
+    void clear();
+
+    /** Check if the page must be built (again) with setPage() */
+    bool isEmpty() const;
+
+    /**
+     * Enable or disable caching. When disabled, e.g. while the page
+     * contents are being edited, isEmpty() is always true, so the page is
+     * built again for each request. Changing it forgets the page.
+     */
+    void setCachingEnabled(bool enable);
+
+    /** Check if the page is kept between requests */
+    bool isCachingEnabled() const;
+
+    /** Store $page, compress it and compute its entity tag */
+    void setPage(const QByteArray& page);
+
+    /** Get the page */
+    QByteArray page() const;
+
+    /** Get the page in the gzip format */
+    QByteArray pageGzip() const;
+
+    /**
+     * Build the whole HTTP reply (status, headers and body) for a request
+     * carrying the given Accept-Encoding and If-None-Match header values,
+     * which are NULL when the request doesn't have them
+     */
+    QByteArray reply(const char* acceptEncoding, const char* ifNoneMatch) const;
+
+    /*********************************************************************
+     * gzip
+     *********************************************************************/
+public:
+    /** Compress $data in the gzip format, which all the browsers accept */
+    static QByteArray gzipCompress(const QByteArray& data);
+
+    /** Get the CRC-32 of $data, as stored in the gzip trailer */
+    static quint32 gzipCrc32(const QByteArray& data);
+
+private:
+    QByteArray m_page;
+    QByteArray m_pageGzip;
+    /** MD5 of m_page in hex, without quotes nor encoding suffix */
+    QByteArray m_etag;
+    bool m_cachingEnabled;
+};
+
+#endif
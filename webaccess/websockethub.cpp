@@ -0,0 +1,370 @@
+/*
+  Q Light Controller Plus
+  websockethub.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QMutexLocker>
+#include <QDataStream>
+#include <QThread>
+#include <QTimer>
+#include <QDebug>
+
+#include "websockethub.h"
+#include "mongoose.h"
+
+/**
+ * Writes the messages of one client, so that a client that doesn't read
+ * them blocks its own thread only.
+ */
+class WebSocketWriter : public QThread
+{
+public:
+    WebSocketWriter(WebSocketHub* hub, mg_connection* conn)
+        : QThread()
+        , m_hub(hub)
+        , m_conn(conn)
+    {
+    }
+
+protected:
+    void run()
+    {
+        m_hub->writeLoop(m_conn);
+    }
+
+private:
+    WebSocketHub* m_hub;
+    mg_connection* m_conn;
+};
+
+WebSocketHub::WebSocketHub(QObject* parent)
+    : QObject(parent)
+    , m_version(0)
+    , m_flushedVersion(0)
+    , m_timer(new QTimer(this))
+{
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(WEBSOCKET_FRAME_TIME);
+    connect(m_timer, SIGNAL(timeout()), this, SLOT(flush()));
+}
+
+WebSocketHub::~WebSocketHub()
+{
+    // Clients are normally removed when their connection closes
+    m_mutex.lock();
+    for (int i = 0; i < m_clients.count(); i++)
+        m_clients[i].closing = true;
+    m_wakeWriters.wakeAll();
+    QList <Client> clients = m_clients;
+    m_mutex.unlock();
+
+    foreach (Client client, clients)
+    {
+        client.writer->wait();
+        delete client.writer;
+    }
+}
+
+/****************************************************************************
+ * Clients
+ ****************************************************************************/
+
+void WebSocketHub::addClient(mg_connection* conn)
+{
+    QMutexLocker locker(&m_mutex);
+
+    Client client;
+    client.conn = conn;
+    client.writer = new WebSocketWriter(this, conn);
+    client.version = 0;
+    client.writing = false;
+    client.dropped = false;
+    client.closing = false;
+    m_clients.append(client);
+    client.writer->start();
+
+    qDebug() << "[WebSocketHub] client added, total:" << m_clients.count();
+
+    // The new client gets the state of all widgets on the next frame
+    QMetaObject::invokeMethod(this, "slotScheduleFlush", Qt::QueuedConnection);
+}
+
+void WebSocketHub::removeClient(const mg_connection* conn)
+{
+    QMutexLocker locker(&m_mutex);
+
+    int i = clientIndex(conn);
+    if (i == -1)
+        return;
+
+    m_clients[i].closing = true;
+    m_wakeWriters.wakeAll();
+    QThread* writer = m_clients.at(i).writer;
+
+    // The connection is reused by the web server once it's closed, so
+    // wait for the writer to end
+    locker.unlock();
+    writer->wait();
+    delete writer;
+    locker.relock();
+
+    m_clients.removeAt(clientIndex(conn));
+    qDebug() << "[WebSocketHub] client removed, total:" << m_clients.count();
+}
+
+int WebSocketHub::clientsCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_clients.count();
+}
+
+void WebSocketHub::sendText(mg_connection* conn, const QString& message)
+{
+    QByteArray data = message.toUtf8();
+
+    QMutexLocker locker(&m_mutex);
+
+    int i = clientIndex(conn);
+    if (i == -1)
+    {
+        // Not a client (yet): nothing else writes to it
+        locker.unlock();
+        mg_websocket_write(conn, WEBSOCKET_OPCODE_TEXT, data.constData(), data.length());
+        return;
+    }
+
+    if (m_clients.at(i).dropped == false)
+    {
+        m_clients[i].texts.append(data);
+        m_wakeWriters.wakeAll();
+    }
+}
+
+void WebSocketHub::broadcastText(const QString& message)
+{
+    QByteArray data = message.toUtf8();
+
+    QMutexLocker locker(&m_mutex);
+    for (int i = 0; i < m_clients.count(); i++)
+    {
+        if (m_clients.at(i).dropped == false)
+            m_clients[i].texts.append(data);
+    }
+    m_wakeWriters.wakeAll();
+}
+
+int WebSocketHub::clientIndex(const mg_connection* conn) const
+{
+    for (int i = 0; i < m_clients.count(); i++)
+    {
+        if (m_clients.at(i).conn == conn)
+            return i;
+    }
+    return -1;
+}
+
+void WebSocketHub::dropClient(Client& client)
+{
+    if (client.dropped == true)
+        return;
+
+    qWarning() << "[WebSocketHub] client can't keep up, dropped";
+    client.dropped = true;
+    client.texts.clear();
+}
+
+void WebSocketHub::writeLoop(mg_connection* conn)
+{
+    QMutexLocker locker(&m_mutex);
+
+    forever
+    {
+        // The client is removed only after this thread has ended
+        int i = clientIndex(conn);
+        Q_ASSERT(i != -1);
+        Client& client = m_clients[i];
+
+        if (client.closing == true)
+            return;
+
+        if (client.dropped == true ||
+            (client.texts.isEmpty() == true && client.version >= m_flushedVersion))
+        {
+            m_wakeWriters.wait(&m_mutex);
+            continue;
+        }
+
+        QList <QByteArray> texts = client.texts;
+        client.texts.clear();
+
+        QByteArray data;
+        if (client.version < m_flushedVersion)
+        {
+            data = encodeChangesLocked(client.version);
+            client.version = m_version;
+        }
+
+        client.writing = true;
+        client.writeTimer.start();
+        locker.unlock();
+
+        bool ok = true;
+        foreach (QByteArray text, texts)
+        {
+            ok = (mg_websocket_write(conn, WEBSOCKET_OPCODE_TEXT, text.constData(), text.length()) > 0);
+            if (ok == false)
+                break;
+        }
+
+        if (ok == true && data.isEmpty() == false)
+            ok = (mg_websocket_write(conn, WEBSOCKET_OPCODE_BINARY, data.constData(), data.length()) > 0);
+
+        locker.relock();
+
+        Client& written = m_clients[clientIndex(conn)];
+        written.writing = false;
+        if (ok == false || written.writeTimer.elapsed() > WEBSOCKET_SEND_TIMEOUT)
+            dropClient(written);
+    }
+}
+
+/****************************************************************************
+ * Widget state
+ ****************************************************************************/
+
+void WebSocketHub::setButtonState(quint32 id, bool on)
+{
+    State state;
+    state.type = Button;
+    state.value = on ? 1 : 0;
+
+    QMutexLocker locker(&m_mutex);
+    updateState(id, state);
+}
+
+void WebSocketHub::setSliderState(quint32 id, uchar value, const QString& text)
+{
+    State state;
+    state.type = Slider;
+    state.value = value;
+    state.text = text.toUtf8();
+
+    // The length is a byte: cut at 255 bytes, at a character boundary
+    if (state.text.length() > 255)
+    {
+        int length = 255;
+        while (length > 0 && (uchar(state.text.at(length)) & 0xC0) == 0x80)
+            length--;
+        state.text.truncate(length);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    updateState(id, state);
+}
+
+void WebSocketHub::setCueState(quint32 id, int index)
+{
+    State state;
+    state.type = Cue;
+    state.value = index;
+
+    QMutexLocker locker(&m_mutex);
+    updateState(id, state);
+}
+
+void WebSocketHub::clearState()
+{
+    QMutexLocker locker(&m_mutex);
+    m_states.clear();
+}
+
+quint32 WebSocketHub::version() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_version;
+}
+
+QByteArray WebSocketHub::encodeChanges(quint32 version) const
+{
+    QMutexLocker locker(&m_mutex);
+    return encodeChangesLocked(version);
+}
+
+void WebSocketHub::flush()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_flushedVersion = m_version;
+
+    // The writers of slow clients are still blocked on their previous message
+    for (int i = 0; i < m_clients.count(); i++)
+    {
+        Client& client = m_clients[i];
+        if (client.writing == true && client.writeTimer.elapsed() > WEBSOCKET_SEND_TIMEOUT)
+            dropClient(client);
+    }
+
+    m_wakeWriters.wakeAll();
+}
+
+void WebSocketHub::slotScheduleFlush()
+{
+    if (m_timer->isActive() == false)
+        m_timer->start();
+}
+
+void WebSocketHub::updateState(quint32 id, const State& state)
+{
+    State& stored = m_states[id];
+    stored = state;
+    stored.version = ++m_version;
+
+    // Called from the main thread, or queued to it
+    QMetaObject::invokeMethod(this, "slotScheduleFlush", Qt::AutoConnection);
+}
+
+QByteArray WebSocketHub::encodeChangesLocked(quint32 version) const
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::BigEndian);
+
+    QHash <quint32,State>::const_iterator it = m_states.begin();
+    for (; it != m_states.end(); ++it)
+    {
+        const State& state = it.value();
+        if (state.version <= version)
+            continue;
+
+        stream << quint32(it.key()) << quint8(state.type);
+        switch (state.type)
+        {
+            case Button:
+                stream << quint8(state.value);
+            break;
+            case Slider:
+                stream << quint8(state.value) << quint8(state.text.length());
+                stream.writeRawData(state.text.constData(), state.text.length());
+            break;
+            case Cue:
+                stream << qint32(state.value);
+            break;
+        }
+    }
+
+    return data;
+}
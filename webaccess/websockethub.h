@@ -0,0 +1,190 @@
+/*
+  Q Light Controller Plus
+  websockethub.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef WEBSOCKETHUB_H
+#define WEBSOCKETHUB_H
+
+#include <QElapsedTimer>
+#include <QByteArray>
+#include <QObject>
+#include <QWaitCondition>
+#include <QString>
+#include <QMutex>
+#include <QHash>
+#include <QList>
+
+struct mg_connection;
+class QThread;
+class QTimer;
+
+/** Widget state updates are collected and sent at most once every this many ms */
+#define WEBSOCKET_FRAME_TIME 40
+
+/** A client whose write fails or is blocked for longer than this many ms is dropped */
+#define WEBSOCKET_SEND_TIMEOUT 500
+
+/**
+ * WebSocketHub keeps track of all the web access websocket clients and
+ * sends them the state of the Virtual Console widgets.
+ *
+ * Widget updates are not sent right away: the latest state of each widget
+ * is stored with a version number, and once per frame every client
+ * receives, in a single binary message, the widgets that changed since the
+ * last version it got. So a slider moving fast costs one record per frame,
+ * a slow client catches up with the latest values only, and a new client
+ * gets the state of every widget with its first message.
+ *
+ * A binary message is a sequence of records:
+ * @code
+ * quint32 widget ID (big endian)
+ * quint8  type (Button, Slider or Cue)
+ * Button: quint8 on
+ * Slider: quint8 value, quint8 text length in bytes, UTF-8 text
+ * Cue:    qint32 cue index (big endian)
+ * @endcode
+ *
+ * Clients are added and removed from the web server threads, while widget
+ * states are set and flushed from the main thread. Each client has its own
+ * writer thread, which is woken up by flush() and writes without holding
+ * the hub lock, so the main thread never waits for a client. A client that
+ * can't keep up (its write fails or is still blocked after
+ * WEBSOCKET_SEND_TIMEOUT) is dropped: it gets no more messages.
+ */
+class WebSocketHub : public QObject
+{
+    Q_OBJECT
+
+public:
+    WebSocketHub(QObject* parent = 0);
+    ~WebSocketHub();
+
+    /** Widget state record types */
+    enum StateType
+    {
+        Button = 1,
+        Slider = 2,
+        Cue = 3
+    };
+
+    /*********************************************************************
+     * Clients
+     *********************************************************************/
+public:
+    /** Add a client whose websocket handshake has just completed */
+    void addClient(mg_connection* conn);
+
+    /** Remove a client whose connection is closing */
+    void removeClient(const mg_connection* conn);
+
+    /** Get the number of connected clients */
+    int clientsCount() const;
+
+    /** Send a text message to $conn only. Call from $conn's web server thread. */
+    void sendText(mg_connection* conn, const QString& message);
+
+    /** Send a text message to all the clients right away */
+    void broadcastText(const QString& message);
+
+private:
+    struct Client
+    {
+        mg_connection* conn;
+        /** The thread writing the messages of this client */
+        QThread* writer;
+        /** The state version this client has received */
+        quint32 version;
+        /** Text messages waiting to be written */
+        QList <QByteArray> texts;
+        /** A message is being written to this client, without m_mutex held */
+        bool writing;
+        /** Time since the write in progress started */
+        QElapsedTimer writeTimer;
+        /** The client couldn't keep up and gets no more messages */
+        bool dropped;
+        /** The connection is closing: the writer thread must end */
+        bool closing;
+    };
+
+    /** Get the index of $conn in m_clients, or -1. Call with m_mutex held. */
+    int clientIndex(const mg_connection* conn) const;
+
+    /** Stop sending messages to $client. Call with m_mutex held. */
+    void dropClient(Client& client);
+
+    /** Write the messages of $conn until it closes. Run by its writer thread. */
+    void writeLoop(mg_connection* conn);
+    friend class WebSocketWriter;
+
+    QList <Client> m_clients;
+
+    /** Signalled when there's something to write, or a client is closing */
+    QWaitCondition m_wakeWriters;
+
+    /*********************************************************************
+     * Widget state
+     *********************************************************************/
+public:
+    void setButtonState(quint32 id, bool on);
+    void setSliderState(quint32 id, uchar value, const QString& text);
+    void setCueState(quint32 id, int index);
+
+    /** Forget the state of all widgets, e.g. when the Virtual Console is reloaded */
+    void clearState();
+
+    /** Get the current state version, incremented by each widget update */
+    quint32 version() const;
+
+    /** Encode the widgets changed after $version. Empty if none did. */
+    QByteArray encodeChanges(quint32 version) const;
+
+public slots:
+    /** Have the pending changes sent to every client */
+    void flush();
+
+private slots:
+    void slotScheduleFlush();
+
+private:
+    struct State
+    {
+        StateType type;
+        int value;
+        QByteArray text;
+        quint32 version;
+    };
+
+    /** Store the new state of widget $id. Call with m_mutex held. */
+    void updateState(quint32 id, const State& state);
+
+    /** Encode the changes after $version. Call with m_mutex held. */
+    QByteArray encodeChangesLocked(quint32 version) const;
+
+private:
+    /** Protects clients and states */
+    mutable QMutex m_mutex;
+
+    QHash <quint32,State> m_states;
+    quint32 m_version;
+    /** The state version of the last flush: writers send the changes up to it */
+    quint32 m_flushedVersion;
+
+    QTimer* m_timer;
+};
+
+#endif